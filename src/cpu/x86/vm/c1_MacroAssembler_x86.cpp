@@ -48,11 +48,17 @@ int C1_MacroAssembler::lock_object(Register hdr, Register obj, Register disp_hdr
   // save object being locked into the BasicObjectLock
   movptr(Address(disp_hdr, BasicObjectLock::obj_offset_in_bytes()), obj);
 
+  // A mixed object keeps its lock word in the phantom object; obj must
+  // survive for the slow path, so lock it there.
+  null_check_offset = offset();
+  movptr(hdr, Address(obj, hdr_offset));
+  andptr(hdr, markOopDesc::mixed_object_mask_in_place);
+  cmpptr(hdr, markOopDesc::mixed_object_value);
+  jcc(Assembler::equal, slow_case);
+
   if (UseBiasedLocking) {
     assert(scratch != noreg, "should have scratch register at this point");
-    null_check_offset = biased_locking_enter(disp_hdr, obj, hdr, scratch, false, done, &slow_case);
-  } else {
-    null_check_offset = offset();
+    biased_locking_enter(disp_hdr, obj, hdr, scratch, false, done, &slow_case);
   }
 
   // Load object header
@@ -105,9 +111,19 @@ void C1_MacroAssembler::unlock_object(Register hdr, Register obj, Register disp_
   assert(hdr != obj && hdr != disp_hdr && obj != disp_hdr, "registers must be different");
   Label done;
 
+  // load object, or the phantom object of a mixed object, which holds
+  // the lock word
+  Label notMix;
+  movptr(obj, Address(disp_hdr, BasicObjectLock::obj_offset_in_bytes()));
+  movptr(hdr, Address(obj, hdr_offset));
+  andptr(hdr, markOopDesc::mixed_object_mask_in_place);
+  cmpptr(hdr, markOopDesc::mixed_object_value);
+  jcc(Assembler::notEqual, notMix);
+  movptr(obj, Address(obj, hdr_offset));
+  andptr(obj, ~markOopDesc::mixed_object_mask_in_place);
+  bind(notMix);
+
   if (UseBiasedLocking) {
-    // load object
-    movptr(obj, Address(disp_hdr, BasicObjectLock::obj_offset_in_bytes()));
     biased_locking_exit(obj, hdr, done);
   }
 
@@ -117,10 +133,6 @@ void C1_MacroAssembler::unlock_object(Register hdr, Register obj, Register disp_
   testptr(hdr, hdr);
   // if we had recursive locking, we are done
   jcc(Assembler::zero, done);
-  if (!UseBiasedLocking) {
-    // load object
-    movptr(obj, Address(disp_hdr, BasicObjectLock::obj_offset_in_bytes()));
-  }
   verify_oop(obj);
   // test if object header is pointing to the displaced header, and if so, restore
   // the displaced header in the object - if the object header is not pointing to
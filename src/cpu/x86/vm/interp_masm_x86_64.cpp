@@ -708,19 +708,18 @@ void InterpreterMacroAssembler::lock_object(Register lock_reg) {
     // Load object pointer into obj_reg %c_rarg3
     movptr(obj_reg, Address(lock_reg, obj_offset));
 
-    // Check whether swap_reg is mixed object
+    // A mixed object keeps its lock word in the phantom object, so lock
+    // the phantom object instead.  The BasicObjectLock still refers to
+    // the object itself.
     Label notMix;
     assert_different_registers(swap_reg, obj_reg, lock_reg);
     movptr(swap_reg, Address(obj_reg, oopDesc::mark_offset_in_bytes()));
     andptr(swap_reg, markOopDesc::mixed_object_mask_in_place);
     cmpptr(swap_reg, markOopDesc::mixed_object_value);
     jcc(Assembler::notEqual, notMix);
-    call_VM(noreg,
-            CAST_FROM_FN_PTR(address, InterpreterRuntime::monitorenter),
-            lock_reg);
-    jmp(done);
+    movptr(obj_reg, Address(obj_reg, oopDesc::mark_offset_in_bytes()));
+    andptr(obj_reg, ~markOopDesc::mixed_object_mask_in_place);
     bind(notMix);
-    /* end of mix support*/
 
     if (UseBiasedLocking) {
       biased_locking_enter(lock_reg, obj_reg, swap_reg, rscratch1, false, done, &slow_case);
@@ -803,22 +802,23 @@ void InterpreterMacroAssembler::unlock_object(Register lock_reg) {
     const Register swap_reg   = rax;  // Must use rax for cmpxchg instruction
     const Register header_reg = c_rarg2;  // Will contain the old oopMark
     const Register obj_reg    = c_rarg3;  // Will contain the oop
+    const Register holder_reg = rscratch1; // Will contain the oop holding the lock word
 
     save_bcp(); // Save in case of exception
 
     // Load oop into obj_reg(%c_rarg3)
     movptr(obj_reg, Address(lock_reg, BasicObjectLock::obj_offset_in_bytes()));
 
+    // A mixed object keeps its lock word in the phantom object.
     Label notMix;
-    assert_different_registers(swap_reg, obj_reg, lock_reg);
+    assert_different_registers(swap_reg, obj_reg, lock_reg, holder_reg);
+    movptr(holder_reg, obj_reg);
     movptr(swap_reg, Address(obj_reg, oopDesc::mark_offset_in_bytes()));
     andptr(swap_reg, markOopDesc::mixed_object_mask_in_place);
     cmpptr(swap_reg, markOopDesc::mixed_object_value);
     jcc(Assembler::notEqual, notMix);
-    call_VM(noreg,
-            CAST_FROM_FN_PTR(address, InterpreterRuntime::monitorexit),
-            lock_reg);
-    jmp(done);
+    movptr(holder_reg, Address(obj_reg, oopDesc::mark_offset_in_bytes()));
+    andptr(holder_reg, ~markOopDesc::mixed_object_mask_in_place);
     bind(notMix);
 
     // Convert from BasicObjectLock structure to object and BasicLock
@@ -829,7 +829,7 @@ void InterpreterMacroAssembler::unlock_object(Register lock_reg) {
     movptr(Address(lock_reg, BasicObjectLock::obj_offset_in_bytes()), (int32_t)NULL_WORD);
 
     if (UseBiasedLocking) {
-      biased_locking_exit(obj_reg, header_reg, done);
+      biased_locking_exit(holder_reg, header_reg, done);
     }
 
     // Load the old header from BasicLock structure
@@ -844,7 +844,7 @@ void InterpreterMacroAssembler::unlock_object(Register lock_reg) {
 
     // Atomic swap back the old header
     if (os::is_MP()) lock();
-    cmpxchgptr(header_reg, Address(obj_reg, 0));
+    cmpxchgptr(header_reg, Address(holder_reg, 0));
 
     // zero for recursive case
     jcc(Assembler::zero, done);
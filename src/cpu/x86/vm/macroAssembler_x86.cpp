@@ -1762,12 +1762,38 @@ void MacroAssembler::fast_lock(Register objReg, Register boxReg, Register tmpReg
 
     Label IsInflated, DONE_LABEL;
 
-    Label notMix;
+    // A mixed object keeps its lock word in the phantom object.  Bias or
+    // stack-lock the phantom object; leave an inflated one to the slow
+    // path.  objReg must survive and scrReg is the scratch register of
+    // biased_locking_enter, so borrow objReg for the phantom object as
+    // fast_unlock does.  C2 does not inline the bias of a phantom object,
+    // so do it here regardless of UseOptoBiasInlining.
+    Label notMix, MixDone;
     movptr(tmpReg, Address(objReg, 0));          // [FETCH]
     andptr(tmpReg, markOopDesc::mixed_object_mask_in_place);
     cmpptr(tmpReg, markOopDesc::mixed_object_value);
     jcc(Assembler::notEqual, notMix);
-    cmpptr (rsp, (int32_t)NULL_WORD); // goto slow case
+    push(objReg);
+    movptr(objReg, Address(objReg, 0));
+    andptr(objReg, ~markOopDesc::mixed_object_mask_in_place);
+    if (UseBiasedLocking) {
+      biased_locking_enter(boxReg, objReg, tmpReg, scrReg, false, MixDone, NULL, counters);
+    }
+    movptr(tmpReg, Address(objReg, 0));
+    testptr(tmpReg, markOopDesc::monitor_value);
+    jcc(Assembler::notZero, MixDone);            // ZF == 0: inflated, slow path
+    orptr (tmpReg, markOopDesc::unlocked_value);
+    movptr(Address(boxReg, 0), tmpReg);          // Anticipate successful CAS
+    if (os::is_MP()) {
+      lock();
+    }
+    cmpxchgptr(boxReg, Address(objReg, 0));      // Updates tmpReg
+    jcc(Assembler::equal, MixDone);              // Success
+    subptr(tmpReg, rsp);                         // Recursive locking
+    andptr(tmpReg, (int32_t) (NOT_LP64(0xFFFFF003) LP64_ONLY(7 - os::vm_page_size())) );
+    movptr(Address(boxReg, 0), tmpReg);
+    bind(MixDone);
+    pop(objReg);                                 // Preserves ZF
     jmp(DONE_LABEL);
     bind(notMix);
 
@@ -2044,12 +2070,31 @@ void MacroAssembler::fast_unlock(Register objReg, Register boxReg, Register tmpR
   } else {
     Label DONE_LABEL, Stacked, CheckSucc;
 
-    Label notMix;
+    // A mixed object keeps its lock word in the phantom object.  objReg
+    // must survive, so borrow it for the phantom object around the unlock.
+    Label notMix, MixDone;
     movptr(tmpReg, Address(objReg, 0));          // [FETCH]
     andptr(tmpReg, markOopDesc::mixed_object_mask_in_place);
     cmpptr(tmpReg, markOopDesc::mixed_object_value);
     jcc(Assembler::notEqual, notMix);
-    cmpptr (rsp, (int32_t)NULL_WORD); // goto slow case
+    push(objReg);
+    movptr(objReg, Address(objReg, 0));
+    andptr(objReg, ~markOopDesc::mixed_object_mask_in_place);
+    if (UseBiasedLocking) {
+      biased_locking_exit(objReg, tmpReg, MixDone);
+    }
+    cmpptr(Address(boxReg, 0), (int32_t)NULL_WORD); // Recursive stack-lock?
+    jcc   (Assembler::zero, MixDone);
+    movptr(tmpReg, Address(objReg, 0));
+    testptr(tmpReg, markOopDesc::monitor_value);
+    jcc   (Assembler::notZero, MixDone);         // ZF == 0: inflated, slow path
+    movptr(tmpReg, Address(boxReg, 0));
+    if (os::is_MP()) {
+      lock();
+    }
+    cmpxchgptr(tmpReg, Address(objReg, 0));      // Uses RAX which is box
+    bind(MixDone);
+    pop(objReg);                                 // Preserves ZF
     jmp(DONE_LABEL);
     bind(notMix);
 
@@ -760,6 +760,7 @@ address InterpreterGenerator::generate_accessor_entry(void) {
 
     // rdi: temp
     Label noCheck, notStale;
+    TemplateTable::skip_dsu_check(_masm, noCheck);
     __ movl(rdi, rdx);
     __ shrl(rdi, ConstantPoolCacheEntry::stale_object_check_shift);
     __ andl(rdi, 0x1);
@@ -1519,6 +1520,7 @@ address InterpreterGenerator::generate_dsu_method_entry(AbstractInterpreter::Met
   // r13: sender sp
   address entry = __ pc();
   Label no_update;
+  TemplateTable::skip_dsu_check(_masm, no_update);
 
   const Address constMethod(rbx, Method::const_offset());
   const Address size_of_parameters(rdx,
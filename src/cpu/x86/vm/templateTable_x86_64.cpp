@@ -32,6 +32,8 @@
 #include "oops/objArrayKlass.hpp"
 #include "oops/oop.inline.hpp"
 #include "prims/methodHandles.hpp"
+#include "runtime/dsu.hpp"
+#include "runtime/icache.hpp"
 #include "runtime/sharedRuntime.hpp"
 #include "runtime/stubRoutines.hpp"
 #include "runtime/synchronizer.hpp"
@@ -2989,6 +2991,7 @@ void TemplateTable::check_and_update_stale_object_before_accessing_member(Regist
   assert_different_registers(obj, flags, temp);
 
   Label skip_check;
+  skip_dsu_check(skip_check);
 
   {
     // move flags to temp
@@ -3045,6 +3048,7 @@ void TemplateTable::check_and_update_stale_object(Register obj, Register temp) {
   assert_different_registers(obj, temp);
 
   Label skip_update;
+  skip_dsu_check(skip_update);
   __ load_klass(temp, obj);
   __ movl(temp, Address(temp, Klass::dsu_flags_offset()));
   __ andl(temp, DSU_FLAGS_CLASS_IS_STALE_CLASS);
@@ -3058,11 +3062,33 @@ void TemplateTable::type_narrow_check(Register obj, Register temp) {
   Label skip_slow_check;
   assert_different_registers(obj, temp, rsp);
 
+  skip_dsu_check(skip_slow_check);
   __ load_klass(temp, obj);
   __ movl(temp, Address(temp, Klass::dsu_flags_offset()));
   __ andl(temp, DSU_FLAGS_CLASS_IS_TYPE_NARROWED_CLASS);
   __ jcc(Assembler::zero, skip_slow_check);// not a type narrowed class, skip slow type narrow check.
 
+  if (UseDSUTypeNarrowCache) {
+    // Skip the slow check if the klass of obj has been validated at this bcp.
+    Label slow_check;
+    __ get_method(temp);
+    __ movptr(temp, Address(temp, Method::method_counters_offset()));
+    __ testptr(temp, temp);
+    __ jcc(Assembler::zero, slow_check);
+    __ movptr(temp, Address(temp, MethodCounters::type_narrow_cache_offset()));
+    __ testptr(temp, temp);
+    __ jcc(Assembler::zero, slow_check);
+    __ movptr(temp, Address(temp, DSUTypeNarrowCache::bcp_base_offset()));
+    __ movptr(temp, Address(temp, r13, Address::times_8));
+    if (UseCompressedClassPointers) {
+      __ cmpl(temp, Address(obj, oopDesc::klass_offset_in_bytes()));
+    } else {
+      __ cmpptr(temp, Address(obj, oopDesc::klass_offset_in_bytes()));
+    }
+    __ jcc(Assembler::equal, skip_slow_check);
+    __ bind(slow_check);
+  }
+
   __ movptr(Address(rbp, frame::interpreter_frame_last_sp_offset * wordSize), NULL_WORD);
   __ movq(temp, rsp);
   __ andq(rsp, -16);     // align stack as required by push_CPU_state and call
@@ -3091,6 +3117,51 @@ void TemplateTable::check_and_load_mixed_object(Register obj, Register temp) {
 }
 
 
+// No class is stale, type narrowed or mixed before the first DSU, so a
+// check site starts with a jump over the check. The jump is replaced with
+// a nop when a DSU is installed.
+GrowableArray<address>* TemplateTable::_dsu_check_sites = NULL;
+bool                    TemplateTable::_dsu_checks_enabled = false;
+
+void TemplateTable::skip_dsu_check(Label& skip) {
+  skip_dsu_check(_masm, skip);
+}
+
+// Also used by the method entries of the interpreter.
+void TemplateTable::skip_dsu_check(MacroAssembler* masm, Label& skip) {
+  if (!UseDSUCheckFreeInterpreter) {
+    _dsu_checks_enabled = true;
+    return;
+  }
+  if (_dsu_check_sites == NULL) {
+    _dsu_check_sites = new (ResourceObj::C_HEAP, mtInternal) GrowableArray<address>(64, true);
+  }
+  address site = masm->pc();
+  masm->jmp(skip);
+  assert(masm->pc() - site == 5, "must be a patchable jmp rel32");
+  _dsu_check_sites->append(site);
+}
+
+void TemplateTable::enable_dsu_checks() {
+  assert(SafepointSynchronize::is_at_safepoint(), "no thread executes the check sites");
+  if (_dsu_checks_enabled) {
+    return;
+  }
+  // 5-byte nop
+  static const u_char nop5[] = { 0x0F, 0x1F, 0x44, 0x00, 0x00 };
+  int length = _dsu_check_sites == NULL ? 0 : _dsu_check_sites->length();
+  for (int i = 0; i < length; i++) {
+    address site = _dsu_check_sites->at(i);
+    assert(*site == 0xE9, "must be a jmp rel32");
+    for (int j = 0; j < 5; j++) {
+      site[j] = nop5[j];
+    }
+    ICache::invalidate_range(site, 5);
+  }
+  _dsu_checks_enabled = true;
+  DSU_INFO(("Enable %d DSU checks in the interpreter.", length));
+}
+
 void TemplateTable::explicit_stale_object_updating(Register obj, Register temp) {
     assert_different_registers(obj, temp, rsp);
 
@@ -41,6 +41,15 @@
   static void type_narrow_check(Register obj, Register temp);
   static void check_and_load_mixed_object(Register obj, Register temp);
   static void explicit_stale_object_updating(Register obj, Register temp);
+  // DSU checks are jumped over until the first DSU is installed.
+  static void skip_dsu_check(Label& skip);
+  static GrowableArray<address>* _dsu_check_sites;
+  static bool                    _dsu_checks_enabled;
+ public:
+  static void skip_dsu_check(MacroAssembler* masm, Label& skip);
+  static void enable_dsu_checks();
+  static bool dsu_checks_enabled() { return _dsu_checks_enabled; }
+ private:
   static void index_check(Register array, Register index);
   static void index_check_without_pop(Register array, Register index);
 
@@ -171,6 +171,7 @@ public:
 
   bool needs_mixed_object_check  () { return dsu_flags().needs_mixed_object_check(); }
   bool needs_stale_object_check  () { return dsu_flags().needs_stale_object_check(); }
+  bool needs_type_narrow_check   () { return dsu_flags().needs_type_narrow_check(); }
 
   // Java access flags
   bool is_public      () { return flags().is_public(); }
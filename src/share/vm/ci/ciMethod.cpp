@@ -46,6 +46,7 @@
 #include "oops/oop.inline.hpp"
 #include "prims/nativeLookup.hpp"
 #include "runtime/deoptimization.hpp"
+#include "runtime/dsu.hpp"
 #include "utilities/bitMap.inline.hpp"
 #include "utilities/xmlstream.hpp"
 #ifdef COMPILER2
@@ -1101,6 +1102,24 @@ bool ciMethod::break_at_execute() {
   return CompilerOracle::should_break_at(mh);
 }
 
+// ------------------------------------------------------------------
+// ciMethod::type_narrow_validated_klass
+//
+ciKlass* ciMethod::type_narrow_validated_klass(int bci) {
+  check_is_loaded();
+  VM_ENTRY_MARK;
+  MethodCounters* mcs = get_Method()->method_counters();
+  if (mcs == NULL || mcs->type_narrow_cache() == NULL) {
+    return NULL;
+  }
+  intptr_t word = mcs->type_narrow_cache()->validated_klass_word(bci);
+  Klass* k = DSUTypeNarrowCache::decode_klass_word(word);
+  if (k == NULL) {
+    return NULL;
+  }
+  return CURRENT_ENV->get_klass(k);
+}
+
 // ------------------------------------------------------------------
 // ciMethod::has_option
 //
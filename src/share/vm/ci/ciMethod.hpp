@@ -160,6 +160,9 @@ class ciMethod : public ciMetadata {
 
   bool needs_mixed_object_check () const         { return dsu_flags().needs_mixed_object_check(); }
   bool needs_stale_object_check () const         { return dsu_flags().needs_stale_object_check(); }
+  bool needs_type_narrow_check () const          { return dsu_flags().needs_type_narrow_check(); }
+  // the klass validated by the last type-narrowing check at bci, or NULL
+  ciKlass* type_narrow_validated_klass(int bci);
 
   // Method code and related information.
   address code()                                 { if (_code == NULL) load_code(); return _code; }
@@ -64,6 +64,7 @@
 #include "utilities/array.hpp"
 #include "utilities/globalDefinitions.hpp"
 #include "utilities/ostream.hpp"
+#include "utilities/quickSort.hpp"
 
 // We generally try to create the oops directly when parsing, rather than
 // allocating temporary data structures and copying the bytes twice. A
@@ -3182,6 +3183,132 @@ class FieldLayoutInfo : public StackObj {
 };
 
 // Layout fields and fill in FieldLayoutInfo.  Could use more refactoring!
+static int nonstatic_field_size_of(FieldAllocationType atype) {
+  switch (atype) {
+    case NONSTATIC_OOP:    return heapOopSize;
+    case NONSTATIC_BYTE:   return 1;
+    case NONSTATIC_SHORT:  return BytesPerShort;
+    case NONSTATIC_WORD:   return BytesPerInt;
+    case NONSTATIC_DOUBLE: return BytesPerLong;
+    default:               ShouldNotReachHere(); return 0;
+  }
+}
+
+static bool field_bytes_free(const bool* used, int offset, int size) {
+  for (int i = 0; i < size; i++) {
+    if (used[offset + i]) return false;
+  }
+  return true;
+}
+
+static void mark_field_bytes(bool* used, int offset, int size) {
+  for (int i = 0; i < size; i++) {
+    used[offset + i] = true;
+  }
+}
+
+static int compare_field_offsets(int a, int b) {
+  return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+// Lay out the instance fields of a new version of a class updated by DSU.
+// A field declared by old_version with the same name and signature keeps
+// its old offset, so that it stays in place when old instances are updated.
+// The other fields fill the holes left by deleted fields, largest first,
+// and then go after the old fields. Returns the end of the instance fields.
+static int layout_nonstatic_fields_like(InstanceKlass* old_version,
+                                        Array<u2>* fields,
+                                        constantPoolHandle cp,
+                                        int fields_start,
+                                        int* oop_offsets,
+                                        unsigned int* oop_counts,
+                                        unsigned int* oop_map_count,
+                                        int* first_oop_offset,
+                                        TRAPS) {
+  int old_end = old_version->size_helper() << LogBytesPerWord;
+  int limit = MAX2(old_end, fields_start);
+  int oop_count = 0;
+  for (AllFieldStream fs(fields, cp); !fs.done(); fs.next()) {
+    if (fs.access_flags().is_static()) continue;
+    FieldAllocationType atype = (FieldAllocationType) fs.allocation_type();
+    // room for the field and its alignment
+    limit += 2 * nonstatic_field_size_of(atype);
+    if (atype == NONSTATIC_OOP) oop_count++;
+  }
+
+  bool* used = NEW_RESOURCE_ARRAY_IN_THREAD(THREAD, bool, limit);
+  for (int i = 0; i < limit; i++) {
+    used[i] = i < fields_start;
+  }
+  int* oops = NEW_RESOURCE_ARRAY_IN_THREAD(THREAD, int, oop_count + 1);
+  int oops_laid_out = 0;
+  int end = fields_start;
+
+  // keep the offsets of the surviving fields
+  for (AllFieldStream fs(fields, cp); !fs.done(); fs.next()) {
+    if (fs.access_flags().is_static()) continue;
+    FieldAllocationType atype = (FieldAllocationType) fs.allocation_type();
+    int size = nonstatic_field_size_of(atype);
+    for (JavaFieldStream ofs(old_version); !ofs.done(); ofs.next()) {
+      if (ofs.access_flags().is_static() ||
+          ofs.name() != fs.name() || ofs.signature() != fs.signature()) {
+        continue;
+      }
+      int offset = ofs.offset();
+      if (offset >= fields_start && offset + size <= old_end &&
+          (offset % size) == 0 && field_bytes_free(used, offset, size)) {
+        mark_field_bytes(used, offset, size);
+        fs.set_offset(offset);
+        end = MAX2(end, offset + size);
+        if (atype == NONSTATIC_OOP) oops[oops_laid_out++] = offset;
+      }
+      break;
+    }
+  }
+
+  // first fit the remaining fields, largest first
+  static const FieldAllocationType order[] = {
+    NONSTATIC_DOUBLE, NONSTATIC_OOP, NONSTATIC_WORD, NONSTATIC_SHORT, NONSTATIC_BYTE
+  };
+  for (size_t i = 0; i < ARRAY_SIZE(order); i++) {
+    for (AllFieldStream fs(fields, cp); !fs.done(); fs.next()) {
+      if (fs.is_offset_set() || fs.access_flags().is_static() ||
+          (FieldAllocationType) fs.allocation_type() != order[i]) {
+        continue;
+      }
+      int size = nonstatic_field_size_of(order[i]);
+      int offset = align_size_up(fields_start, size);
+      while (!field_bytes_free(used, offset, size)) {
+        offset += size;
+        assert(offset + size <= limit, "field must fit");
+      }
+      mark_field_bytes(used, offset, size);
+      fs.set_offset(offset);
+      end = MAX2(end, offset + size);
+      if (order[i] == NONSTATIC_OOP) oops[oops_laid_out++] = offset;
+    }
+  }
+  assert(oops_laid_out == oop_count, "every oop field is laid out");
+
+  // oop maps describe contiguous runs of oops in ascending order
+  QuickSort::sort<int>(oops, oops_laid_out, compare_field_offsets, false);
+  for (int i = 0; i < oops_laid_out; i++) {
+    unsigned int count = *oop_map_count;
+    if (count > 0 &&
+        oop_offsets[count - 1] + int(oop_counts[count - 1]) * heapOopSize == oops[i]) {
+      oop_counts[count - 1] += 1;
+    } else {
+      oop_offsets[count] = oops[i];
+      oop_counts[count] = 1;
+      *oop_map_count = count + 1;
+    }
+  }
+  if (oops_laid_out > 0) {
+    *first_oop_offset = oops[0];
+  }
+  return end;
+}
+
 void ClassFileParser::layout_fields(Handle class_loader,
                                     FieldAllocationCount* fac,
                                     ClassAnnotationCollector* parsed_annotations,
@@ -3292,6 +3419,17 @@ void ClassFileParser::layout_fields(Handle class_loader,
 
   first_nonstatic_oop_offset = 0; // will be set for first oop field
 
+  // A new version of a class updated by DSU is laid out like the old
+  // version, unless its fields are padded for contention.
+  InstanceKlass* layout_hint = NULL;
+  if (DSUStableFieldLayout && THREAD->is_DSU_thread() &&
+      !is_contended_class && nonstatic_contended_count == 0) {
+    InstanceKlass* old_version = ((JavaThread*)THREAD)->as_DSUThread()->class_being_updated();
+    if (old_version != NULL && old_version->name() == _class_name) {
+      layout_hint = old_version;
+    }
+  }
+
   bool compact_fields   = CompactFields;
   int  allocation_style = FieldsAllocationStyle;
   if( allocation_style < 0 || allocation_style > 2 ) { // Out of range?
@@ -3321,6 +3459,7 @@ void ClassFileParser::layout_fields(Handle class_loader,
        _class_name == vmSymbols::java_lang_Long())) {
     allocation_style = 0;     // Allocate oops first
     compact_fields   = false; // Don't compact fields
+    layout_hint      = NULL;  // Offsets are hard coded
   }
 
   // Rearrange fields for a given allocation style
@@ -3423,6 +3562,17 @@ void ClassFileParser::layout_fields(Handle class_loader,
     next_nonstatic_padded_offset = next_nonstatic_oop_offset + (nonstatic_oop_count * heapOopSize);
   }
 
+  // Lay out the instance fields of a new version around the surviving ones.
+  // The loop below then skips them and only lays out the static fields.
+  if (layout_hint != NULL) {
+    next_nonstatic_padded_offset =
+      layout_nonstatic_fields_like(layout_hint, _fields, _cp,
+                                   nonstatic_fields_start,
+                                   nonstatic_oop_offsets, nonstatic_oop_counts,
+                                   &nonstatic_oop_map_count,
+                                   &first_nonstatic_oop_offset, CHECK);
+  }
+
   // Iterate over fields again and compute correct offsets.
   // The field allocation type was temporarily stored in the offset slot.
   // oop fields are located before non-oop fields (static and non-static).
@@ -37,7 +37,7 @@
 #include "utilities/hashtable.inline.hpp"
 #if INCLUDE_ALL_GCS
 #include "gc_implementation/g1/g1SATBCardTableModRefBS.hpp"
-#include "gc_implementation/g1/g1StringDedup.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #endif
 
 PRAGMA_FORMAT_MUTE_WARNINGS_FOR_GCC
@@ -46,6 +46,18 @@ PRAGMA_FORMAT_MUTE_WARNINGS_FOR_GCC
 
 // the number of buckets a thread claims
 const int ClaimChunkSize = 32;
+// the number of buckets the service thread moves per lock hold when growing
+const int GrowChunkSize = 256;
+
+// Start growing a table that has filled up, and let the service thread
+// move its buckets.  Called with the table lock held.
+template <class T> static void grow_if_needed(RehashableHashtable<T, mtSymbol>* table) {
+  if (table->should_grow()) {
+    table->start_growth();
+    MutexLockerEx ml(Service_lock, Mutex::_no_safepoint_check_flag);
+    Service_lock->notify_all();
+  }
+}
 
 SymbolTable* SymbolTable::_the_table = NULL;
 // Static arena for symbols that are not deallocated
@@ -82,9 +94,9 @@ void SymbolTable::initialize_symbols(int arena_alloc_size) {
 
 // Call function for all symbols in the symbol table.
 void SymbolTable::symbols_do(SymbolClosure *cl) {
-  const int n = the_table()->table_size();
+  const int n = the_table()->chain_count();
   for (int i = 0; i < n; i++) {
-    for (HashtableEntry<Symbol*, mtSymbol>* p = the_table()->bucket(i);
+    for (HashtableEntry<Symbol*, mtSymbol>* p = the_table()->chain(i);
          p != NULL;
          p = p->next()) {
       cl->do_symbol(p->literal_addr());
@@ -97,6 +109,7 @@ int SymbolTable::_symbols_counted = 0;
 volatile int SymbolTable::_parallel_claimed_idx = 0;
 
 void SymbolTable::buckets_unlink(int start_idx, int end_idx, int* processed, int* removed, size_t* memory_total) {
+  assert(!is_growing(), "growth is completed at the start of a safepoint");
   for (int i = start_idx; i < end_idx; ++i) {
     HashtableEntry<Symbol*, mtSymbol>** p = the_table()->bucket_addr(i);
     HashtableEntry<Symbol*, mtSymbol>* entry = the_table()->bucket(i);
@@ -175,8 +188,9 @@ void SymbolTable::rehash_table() {
   assert(SafepointSynchronize::is_at_safepoint(), "must be at safepoint");
   // This should never happen with -Xshare:dump but it might in testing mode.
   if (DumpSharedSpaces) return;
-  // Create a new symbol table
-  SymbolTable* new_table = new SymbolTable();
+  assert(!is_growing(), "growth is completed first");
+  // Create a new symbol table of the same size
+  SymbolTable* new_table = new SymbolTable(the_table()->table_size());
 
   the_table()->move_to(new_table);
 
@@ -193,7 +207,7 @@ void SymbolTable::rehash_table() {
 Symbol* SymbolTable::lookup(int index, const char* name,
                               int len, unsigned int hash) {
   int count = 0;
-  for (HashtableEntry<Symbol*, mtSymbol>* e = bucket(index); e != NULL; e = e->next()) {
+  for (HashtableEntry<Symbol*, mtSymbol>* e = chain_for(index, hash); e != NULL; e = e->next()) {
     count++;  // count all entries in this bucket, not just ones with same hash
     if (e->hash() == hash) {
       Symbol* sym = e->literal();
@@ -224,7 +238,8 @@ unsigned int SymbolTable::hash_symbol(const char* s, int len) {
 // symboltable is used during compilation (VM_thread) The lock free
 // synchronization is simplified by the fact that we do not delete
 // entries in the symbol table during normal execution (only during
-// safepoints).
+// safepoints).  Growing the table copies entries, and the old copies
+// are likewise only released at a safepoint.
 
 Symbol* SymbolTable::lookup(const char* name, int len, TRAPS) {
   unsigned int hashValue = hash_symbol(name, len);
@@ -297,7 +312,7 @@ Symbol** SymbolTable::lookup_symbol_addr(Symbol* sym){
   unsigned int hash = hash_symbol((char*)sym->bytes(), sym->utf8_length());
   int index = the_table()->hash_to_index(hash);
 
-  for (HashtableEntry<Symbol*, mtSymbol>* e = the_table()->bucket(index); e != NULL; e = e->next()) {
+  for (HashtableEntry<Symbol*, mtSymbol>* e = the_table()->chain_for(index, hash); e != NULL; e = e->next()) {
     if (e->hash() == hash) {
       Symbol* literal_sym = e->literal();
       if (sym == literal_sym) {
@@ -392,16 +407,15 @@ Symbol* SymbolTable::basic_add(int index_arg, u1 *name, int len,
   No_Safepoint_Verifier nsv;
 
   // Check if the symbol table has been rehashed, if so, need to recalculate
-  // the hash value and index.
+  // the hash value.  The table may also have grown at a safepoint since
+  // index_arg was computed, so the index is always recalculated.
   unsigned int hashValue;
-  int index;
   if (use_alternate_hashcode()) {
     hashValue = hash_symbol((const char*)name, len);
-    index = hash_to_index(hashValue);
   } else {
     hashValue = hashValue_arg;
-    index = index_arg;
   }
+  int index = hash_to_index(hashValue);
 
   // Since look-up was done lock-free, we need to check if another
   // thread beat us in the race to insert the symbol.
@@ -417,7 +431,8 @@ Symbol* SymbolTable::basic_add(int index_arg, u1 *name, int len,
   assert(sym->equals((char*)name, len), "symbol must be properly initialized");
 
   HashtableEntry<Symbol*, mtSymbol>* entry = new_entry(hashValue, sym);
-  add_entry(index, entry);
+  add_to_chain(index, entry);
+  grow_if_needed(this);
   return sym;
 }
 
@@ -465,23 +480,24 @@ bool SymbolTable::basic_add(ClassLoaderData* loader_data, constantPoolHandle cp,
       Symbol* sym = allocate_symbol((const u1*)names[i], lengths[i], c_heap, CHECK_(false));
       assert(sym->equals(names[i], lengths[i]), "symbol must be properly initialized");  // why wouldn't it be???
       HashtableEntry<Symbol*, mtSymbol>* entry = new_entry(hashValue, sym);
-      add_entry(index, entry);
+      add_to_chain(index, entry);
       cp->symbol_at_put(cp_indices[i], sym);
     }
   }
+  grow_if_needed(this);
   return true;
 }
 
 
 void SymbolTable::verify() {
-  for (int i = 0; i < the_table()->table_size(); ++i) {
-    HashtableEntry<Symbol*, mtSymbol>* p = the_table()->bucket(i);
+  for (int i = 0; i < the_table()->chain_count(); ++i) {
+    HashtableEntry<Symbol*, mtSymbol>* p = the_table()->chain(i);
     for ( ; p != NULL; p = p->next()) {
       Symbol* s = (Symbol*)(p->literal());
       guarantee(s != NULL, "symbol is NULL");
       unsigned int h = hash_symbol((char*)s->bytes(), s->utf8_length());
       guarantee(p->hash() == h, "broken hash in symbol table entry");
-      guarantee(the_table()->hash_to_index(h) == i,
+      guarantee(the_table()->chain_index(h) == i,
                 "wrong index in symbol table");
     }
   }
@@ -491,6 +507,16 @@ void SymbolTable::dump(outputStream* st) {
   the_table()->dump_table(st, "SymbolTable");
 }
 
+// See StringTable::grow_concurrently()
+void SymbolTable::grow_concurrently(JavaThread* thread) {
+  bool done = false;
+  while (!done) {
+    MutexLocker ml(SymbolTable_lock, thread);
+    No_Safepoint_Verifier nsv;
+    done = the_table()->grow_step(GrowChunkSize);
+  }
+}
+
 
 //---------------------------------------------------------------------------
 // Non-product code
@@ -513,8 +539,8 @@ void SymbolTable::print_histogram() {
   int out_of_range = 0;
   int memory_total = 0;
   int count = 0;
-  for (i = 0; i < the_table()->table_size(); i++) {
-    HashtableEntry<Symbol*, mtSymbol>* p = the_table()->bucket(i);
+  for (i = 0; i < the_table()->chain_count(); i++) {
+    HashtableEntry<Symbol*, mtSymbol>* p = the_table()->chain(i);
     for ( ; p != NULL; p = p->next()) {
       memory_total += p->literal()->size();
       count++;
@@ -574,16 +600,14 @@ void SymbolTable::print_histogram() {
 }
 
 void SymbolTable::print() {
-  for (int i = 0; i < the_table()->table_size(); ++i) {
-    HashtableEntry<Symbol*, mtSymbol>** p = the_table()->bucket_addr(i);
-    HashtableEntry<Symbol*, mtSymbol>* entry = the_table()->bucket(i);
+  for (int i = 0; i < the_table()->chain_count(); ++i) {
+    HashtableEntry<Symbol*, mtSymbol>* entry = the_table()->chain(i);
     if (entry != NULL) {
       while (entry != NULL) {
         tty->print(PTR_FORMAT " ", entry->literal());
         entry->literal()->print();
         tty->print(" %d", entry->literal()->refcount());
-        p = entry->next_addr();
-        entry = (HashtableEntry<Symbol*, mtSymbol>*)HashtableEntry<Symbol*, mtSymbol>::make_ptr(*p);
+        entry = entry->next();
       }
       tty->cr();
     }
@@ -647,7 +671,7 @@ unsigned int StringTable::hash_string(const jchar* s, int len) {
 oop StringTable::lookup(int index, jchar* name,
                         int len, unsigned int hash) {
   int count = 0;
-  for (HashtableEntry<oop, mtSymbol>* l = bucket(index); l != NULL; l = l->next()) {
+  for (HashtableEntry<oop, mtSymbol>* l = chain_for(index, hash); l != NULL; l = l->next()) {
     count++;
     if (l->hash() == hash) {
       if (java_lang_String::equals(l->literal(), name, len)) {
@@ -672,16 +696,16 @@ oop StringTable::basic_add(int index_arg, Handle string, jchar* name,
   No_Safepoint_Verifier nsv;
 
   // Check if the symbol table has been rehashed, if so, need to recalculate
-  // the hash value and index before second lookup.
+  // the hash value before second lookup.  The table may also have grown at
+  // a safepoint since index_arg was computed, e.g., while the String was
+  // allocated, so the index is always recalculated.
   unsigned int hashValue;
-  int index;
   if (use_alternate_hashcode()) {
     hashValue = hash_string(name, len);
-    index = hash_to_index(hashValue);
   } else {
     hashValue = hashValue_arg;
-    index = index_arg;
   }
+  int index = hash_to_index(hashValue);
 
   // Since look-up was done lock-free, we need to check if another
   // thread beat us in the race to insert the symbol.
@@ -693,7 +717,8 @@ oop StringTable::basic_add(int index_arg, Handle string, jchar* name,
   }
 
   HashtableEntry<oop, mtSymbol>* entry = new_entry(hashValue, string());
-  add_entry(index, entry);
+  add_to_chain(index, entry);
+  grow_if_needed(this);
   return string();
 }
 
@@ -753,11 +778,11 @@ oop StringTable::intern(Handle string_or_null, jchar* name,
   }
 
 #if INCLUDE_ALL_GCS
-  if (G1StringDedup::is_enabled()) {
+  if (StringDedup::is_enabled()) {
     // Deduplicate the string before it is interned. Note that we should never
     // deduplicate a string after it has been interned. Doing so will counteract
     // compiler optimizations done on e.g. interned string literals.
-    G1StringDedup::deduplicate(string());
+    StringDedup::deduplicate(string());
   }
 #endif
 
@@ -844,6 +869,8 @@ void StringTable::buckets_oops_do(OopClosure* f, int start_idx, int end_idx) {
          err_msg("Index ordering: start_idx=" INT32_FORMAT", end_idx=" INT32_FORMAT,
                  start_idx, end_idx));
 
+  assert(!is_growing(), "growth is completed at the start of a safepoint");
+
   for (int i = start_idx; i < end_idx; i += 1) {
     HashtableEntry<oop, mtSymbol>* entry = the_table()->bucket(i);
     while (entry != NULL) {
@@ -867,6 +894,8 @@ void StringTable::buckets_unlink_or_oops_do(BoolObjectClosure* is_alive, OopClos
          err_msg("Index ordering: start_idx=" INT32_FORMAT", end_idx=" INT32_FORMAT,
                  start_idx, end_idx));
 
+  assert(!is_growing(), "growth is completed at the start of a safepoint");
+
   for (int i = start_idx; i < end_idx; ++i) {
     HashtableEntry<oop, mtSymbol>** p = the_table()->bucket_addr(i);
     HashtableEntry<oop, mtSymbol>* entry = the_table()->bucket(i);
@@ -912,14 +941,14 @@ void StringTable::possibly_parallel_oops_do(OopClosure* f) {
 // This verification is part of Universe::verify() and needs to be quick.
 // See StringTable::verify_and_compare() below for exhaustive verification.
 void StringTable::verify() {
-  for (int i = 0; i < the_table()->table_size(); ++i) {
-    HashtableEntry<oop, mtSymbol>* p = the_table()->bucket(i);
+  for (int i = 0; i < the_table()->chain_count(); ++i) {
+    HashtableEntry<oop, mtSymbol>* p = the_table()->chain(i);
     for ( ; p != NULL; p = p->next()) {
       oop s = p->literal();
       guarantee(s != NULL, "interned string is NULL");
       unsigned int h = java_lang_String::hash_string(s);
       guarantee(p->hash() == h, "broken hash in string table entry");
-      guarantee(the_table()->hash_to_index(h) == i,
+      guarantee(the_table()->chain_index(h) == i,
                 "wrong index in string table");
     }
   }
@@ -990,11 +1019,11 @@ StringTable::VerifyRetTypes StringTable::verify_entry(int bkt, int e_cnt,
     ret = _verify_fail_continue;
   }
 
-  if (the_table()->hash_to_index(h) != bkt) {
+  if (the_table()->chain_index(h) != bkt) {
     if (mesg_mode == _verify_with_mesgs) {
       tty->print_cr("ERROR: wrong index value for entry @ bucket[%d][%d], "
                     "str_hash=%d, hash_to_index=%d", bkt, e_cnt, h,
-                    the_table()->hash_to_index(h));
+                    the_table()->chain_index(h));
     }
     ret = _verify_fail_continue;
   }
@@ -1023,8 +1052,8 @@ int StringTable::verify_and_compare_entries() {
   int  fail_cnt = 0;
 
   // first, verify all the entries individually:
-  for (int bkt = 0; bkt < the_table()->table_size(); bkt++) {
-    HashtableEntry<oop, mtSymbol>* e_ptr = the_table()->bucket(bkt);
+  for (int bkt = 0; bkt < the_table()->chain_count(); bkt++) {
+    HashtableEntry<oop, mtSymbol>* e_ptr = the_table()->chain(bkt);
     for (int e_cnt = 0; e_ptr != NULL; e_ptr = e_ptr->next(), e_cnt++) {
       VerifyRetTypes ret = verify_entry(bkt, e_cnt, e_ptr, _verify_with_mesgs);
       if (ret != _verify_pass) {
@@ -1043,8 +1072,8 @@ int StringTable::verify_and_compare_entries() {
   bool need_entry_verify = (fail_cnt != 0);
 
   // second, verify all entries relative to each other:
-  for (int bkt1 = 0; bkt1 < the_table()->table_size(); bkt1++) {
-    HashtableEntry<oop, mtSymbol>* e_ptr1 = the_table()->bucket(bkt1);
+  for (int bkt1 = 0; bkt1 < the_table()->chain_count(); bkt1++) {
+    HashtableEntry<oop, mtSymbol>* e_ptr1 = the_table()->chain(bkt1);
     for (int e_cnt1 = 0; e_ptr1 != NULL; e_ptr1 = e_ptr1->next(), e_cnt1++) {
       if (need_entry_verify) {
         VerifyRetTypes ret = verify_entry(bkt1, e_cnt1, e_ptr1,
@@ -1055,8 +1084,8 @@ int StringTable::verify_and_compare_entries() {
         }
       }
 
-      for (int bkt2 = bkt1; bkt2 < the_table()->table_size(); bkt2++) {
-        HashtableEntry<oop, mtSymbol>* e_ptr2 = the_table()->bucket(bkt2);
+      for (int bkt2 = bkt1; bkt2 < the_table()->chain_count(); bkt2++) {
+        HashtableEntry<oop, mtSymbol>* e_ptr2 = the_table()->chain(bkt2);
         int e_cnt2;
         for (e_cnt2 = 0; e_ptr2 != NULL; e_ptr2 = e_ptr2->next(), e_cnt2++) {
           if (bkt1 == bkt2 && e_cnt2 <= e_cnt1) {
@@ -1092,7 +1121,8 @@ void StringTable::rehash_table() {
   assert(SafepointSynchronize::is_at_safepoint(), "must be at safepoint");
   // This should never happen with -Xshare:dump but it might in testing mode.
   if (DumpSharedSpaces) return;
-  StringTable* new_table = new StringTable();
+  assert(!is_growing(), "growth is completed first");
+  StringTable* new_table = new StringTable(the_table()->table_size());
 
   // Rehash the table
   the_table()->move_to(new_table);
@@ -1104,3 +1134,15 @@ void StringTable::rehash_table() {
   _needs_rehashing = false;
   _the_table = new_table;
 }
+
+// Move the buckets of a growing table in chunks, so that interning threads
+// are held up for at most one chunk.  A safepoint can come between two
+// chunks and complete the growth, or replace the table when rehashing.
+void StringTable::grow_concurrently(JavaThread* thread) {
+  bool done = false;
+  while (!done) {
+    MutexLocker ml(StringTable_lock, thread);
+    No_Safepoint_Verifier nsv;
+    done = the_table()->grow_step(GrowChunkSize);
+  }
+}
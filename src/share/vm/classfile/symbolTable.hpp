@@ -109,8 +109,8 @@ private:
 
   Symbol* lookup(int index, const char* name, int len, unsigned int hash);
 
-  SymbolTable()
-    : RehashableHashtable<Symbol*, mtSymbol>(SymbolTableSize, sizeof (HashtableEntry<Symbol*, mtSymbol>)) {}
+  SymbolTable(int table_size)
+    : RehashableHashtable<Symbol*, mtSymbol>(table_size, sizeof (HashtableEntry<Symbol*, mtSymbol>)) {}
 
   SymbolTable(HashtableBucket<mtSymbol>* t, int number_of_entries)
     : RehashableHashtable<Symbol*, mtSymbol>(SymbolTableSize, sizeof (HashtableEntry<Symbol*, mtSymbol>), t,
@@ -141,7 +141,7 @@ public:
 
   static void create_table() {
     assert(_the_table == NULL, "One symbol table allowed.");
-    _the_table = new SymbolTable();
+    _the_table = new SymbolTable(SymbolTableSize);
     initialize_symbols(symbol_alloc_arena_size);
   }
 
@@ -247,6 +247,20 @@ public:
   // Rehash the symbol table if it gets out of balance
   static void rehash_table();
   static bool needs_rehashing()         { return _needs_rehashing; }
+
+  // Grow the symbol table as it fills up: the service thread moves the
+  // buckets and the next safepoint installs them.
+  static bool is_growing() {
+    return the_table()->RehashableHashtable<Symbol*, mtSymbol>::is_growing();
+  }
+  static bool has_buckets_to_move() {
+    return the_table()->RehashableHashtable<Symbol*, mtSymbol>::has_buckets_to_move();
+  }
+  static void grow_concurrently(JavaThread* thread);
+  static void complete_growth() {
+    the_table()->RehashableHashtable<Symbol*, mtSymbol>::complete_growth();
+  }
+
   // Parallel chunked scanning
   static void clear_parallel_claimed_index() { _parallel_claimed_idx = 0; }
   static int parallel_claimed_index()        { return _parallel_claimed_idx; }
@@ -278,7 +292,7 @@ private:
   // in the range [start_idx, end_idx).
   static void buckets_unlink_or_oops_do(BoolObjectClosure* is_alive, OopClosure* f, int start_idx, int end_idx, int* processed, int* removed);
 
-  StringTable() : RehashableHashtable<oop, mtSymbol>((int)StringTableSize,
+  StringTable(int table_size) : RehashableHashtable<oop, mtSymbol>(table_size,
                               sizeof (HashtableEntry<oop, mtSymbol>)) {}
 
   StringTable(HashtableBucket<mtSymbol>* t, int number_of_entries)
@@ -293,7 +307,7 @@ public:
 
   static void create_table() {
     assert(_the_table == NULL, "One string table allowed.");
-    _the_table = new StringTable();
+    _the_table = new StringTable((int)StringTableSize);
   }
 
   // GC support
@@ -378,6 +392,18 @@ public:
   static void rehash_table();
   static bool needs_rehashing() { return _needs_rehashing; }
 
+  // Grow the string table as it fills up
+  static bool is_growing() {
+    return the_table()->RehashableHashtable<oop, mtSymbol>::is_growing();
+  }
+  static bool has_buckets_to_move() {
+    return the_table()->RehashableHashtable<oop, mtSymbol>::has_buckets_to_move();
+  }
+  static void grow_concurrently(JavaThread* thread);
+  static void complete_growth() {
+    the_table()->RehashableHashtable<oop, mtSymbol>::complete_growth();
+  }
+
   // Parallel chunked scanning
   static void clear_parallel_claimed_index() { _parallel_claimed_idx = 0; }
   static int parallel_claimed_index() { return _parallel_claimed_idx; }
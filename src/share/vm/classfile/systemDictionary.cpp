@@ -1808,6 +1808,8 @@ bool SystemDictionary::do_unloading(BoolObjectClosure* is_alive, bool clean_aliv
     dictionary()->do_unloading();
     constraints()->purge_loader_constraints();
     resolution_errors()->purge_resolution_errors();
+    // Javelus: validated klasses may be unloaded
+    DSUTypeNarrowCache::clear_all();
   }
   // Oops referenced by the system dictionary may get unreachable independently
   // of the class loader (eg. cached protection domain oops). So we need to
@@ -2177,7 +2179,9 @@ void SystemDictionary::update_dictionary(int d_index, unsigned int d_hash,
   Klass* sd_check = find_class(d_index, d_hash, name, loader_data);
   if (sd_check == NULL) {
     dictionary()->add_klass(name, loader_data, k);
-    k->set_born_rn(Javelus::system_revision_number());
+    // Classes defined by class loaders keep the default born revision,
+    // only classes installed by a DSU record theirs, see
+    // redefine_instance_class.
     notice_modification();
   }
 #ifdef ASSERT
@@ -203,6 +203,7 @@ class SystemDictionary : AllStatic {
   friend class SystemDictionaryHandles;
   friend class Javelus;
   friend class DSUClassLoader;
+  friend class DSUReclaim;
 
  public:
   enum WKID {
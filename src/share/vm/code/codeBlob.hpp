@@ -30,6 +30,17 @@
 #include "runtime/frame.hpp"
 #include "runtime/handles.hpp"
 
+// The segments of the code cache, see SegmentedCodeCache
+struct CodeBlobType {
+  enum {
+    MethodNonProfiled   = 0,    // nmethods at tiers 1 and 4, and native wrappers
+    MethodProfiled      = 1,    // nmethods at tiers 2 and 3
+    NonNMethod          = 2,    // adapters, buffers, runtime and singleton stubs
+    All                 = 3,    // everything, without SegmentedCodeCache
+    NumTypes            = 4
+  };
+};
+
 // CodeBlob - superclass for all entries in the CodeCache.
 //
 // Suptypes are:
@@ -117,7 +117,10 @@ class CodeBlob_sizes {
 
 // CodeCache implementation
 
-CodeHeap * CodeCache::_heap = new CodeHeap();
+CodeHeap * CodeCache::_heap = NULL;
+CodeHeap * CodeCache::_heaps[CodeBlobType::NumTypes] = { NULL, NULL, NULL, NULL };
+CodeHeap * CodeCache::_heap_list[CodeBlobType::All] = { NULL, NULL, NULL };
+int CodeCache::_number_of_heaps = 0;
 int CodeCache::_number_of_blobs = 0;
 int CodeCache::_number_of_adapters = 0;
 int CodeCache::_number_of_nmethods = 0;
@@ -127,15 +130,46 @@ nmethod* CodeCache::_scavenge_root_nmethods = NULL;
 
 int CodeCache::_codemem_full_count = 0;
 
+int CodeCache::heap_index_containing(const void* p) {
+  for (int i = 0; i < _number_of_heaps; i++) {
+    if (_heap_list[i]->contains(p)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int CodeCache::get_code_blob_type(int comp_level) {
+  if (!SegmentedCodeCache) {
+    return CodeBlobType::All;
+  }
+  if (comp_level == CompLevel_limited_profile || comp_level == CompLevel_full_profile) {
+    return CodeBlobType::MethodProfiled;
+  }
+  return CodeBlobType::MethodNonProfiled;
+}
+
 CodeBlob* CodeCache::first() {
   assert_locked_or_safepoint(CodeCache_lock);
-  return (CodeBlob*)_heap->first();
+  for (int i = 0; i < _number_of_heaps; i++) {
+    CodeBlob* cb = (CodeBlob*)_heap_list[i]->first();
+    if (cb != NULL) {
+      return cb;
+    }
+  }
+  return NULL;
 }
 
 
 CodeBlob* CodeCache::next(CodeBlob* cb) {
   assert_locked_or_safepoint(CodeCache_lock);
-  return (CodeBlob*)_heap->next(cb);
+  int i = heap_index_containing(cb);
+  assert(i >= 0, "not in the code cache");
+  CodeBlob* next = (CodeBlob*)_heap_list[i]->next(cb);
+  while (next == NULL && ++i < _number_of_heaps) {
+    next = (CodeBlob*)_heap_list[i]->first();
+  }
+  return next;
 }
 
 
@@ -170,9 +204,28 @@ nmethod* CodeCache::next_nmethod (CodeBlob* cb) {
   return (nmethod*)cb;
 }
 
+nmethod* CodeCache::first_nmethod(CodeHeap* heap) {
+  assert_locked_or_safepoint(CodeCache_lock);
+  CodeBlob* cb = (CodeBlob*)heap->first();
+  while (cb != NULL && !cb->is_nmethod()) {
+    cb = (CodeBlob*)heap->next(cb);
+  }
+  return (nmethod*)cb;
+}
+
+nmethod* CodeCache::next_nmethod(CodeHeap* heap, CodeBlob* cb) {
+  assert_locked_or_safepoint(CodeCache_lock);
+  assert(heap->contains(cb), "not in this code heap");
+  cb = (CodeBlob*)heap->next(cb);
+  while (cb != NULL && !cb->is_nmethod()) {
+    cb = (CodeBlob*)heap->next(cb);
+  }
+  return (nmethod*)cb;
+}
+
 static size_t maxCodeCacheUsed = 0;
 
-CodeBlob* CodeCache::allocate(int size, bool is_critical) {
+CodeBlob* CodeCache::allocate(int size, int code_blob_type, bool is_critical) {
   // Do not seize the CodeCache lock here--if the caller has not
   // already done so, we are going to lose bigtime, since the code
   // cache will contain a garbage CodeBlob until the caller can
@@ -180,24 +233,41 @@ CodeBlob* CodeCache::allocate(int size, bool is_critical) {
   // instantiating.
   guarantee(size >= 0, "allocation request must be reasonable");
   assert_locked_or_safepoint(CodeCache_lock);
+  CodeHeap* heap = get_code_heap(code_blob_type);
+  // When a segment is full, nmethods may still go to the other nmethod
+  // segment, and critical stubs to the non-profiled one.
+  int fallback = CodeBlobType::All;
+  if (SegmentedCodeCache) {
+    if (code_blob_type == CodeBlobType::MethodProfiled) {
+      fallback = CodeBlobType::MethodNonProfiled;
+    } else if (code_blob_type == CodeBlobType::MethodNonProfiled) {
+      fallback = CodeBlobType::MethodProfiled;
+    } else if (is_critical) {
+      fallback = CodeBlobType::MethodNonProfiled;
+    }
+  }
   CodeBlob* cb = NULL;
   _number_of_blobs++;
   while (true) {
-    cb = (CodeBlob*)_heap->allocate(size, is_critical);
+    cb = (CodeBlob*)heap->allocate(size, is_critical);
     if (cb != NULL) break;
-    if (!_heap->expand_by(CodeCacheExpansionSize)) {
+    if (!heap->expand_by(CodeCacheExpansionSize)) {
+      if (fallback != CodeBlobType::All && get_code_heap(fallback) != heap) {
+        heap = get_code_heap(fallback);
+        fallback = CodeBlobType::All;
+        continue;
+      }
       // Expansion failed
       return NULL;
     }
     if (PrintCodeCacheExtension) {
       ResourceMark rm;
-      tty->print_cr("code cache extended to [" INTPTR_FORMAT ", " INTPTR_FORMAT "] (" SSIZE_FORMAT " bytes)",
-                    (intptr_t)_heap->low_boundary(), (intptr_t)_heap->high(),
-                    (address)_heap->high() - (address)_heap->low_boundary());
+      tty->print_cr("%s extended to [" INTPTR_FORMAT ", " INTPTR_FORMAT "] (" SSIZE_FORMAT " bytes)",
+                    heap->name(), (intptr_t)heap->low_boundary(), (intptr_t)heap->high(),
+                    (address)heap->high() - (address)heap->low_boundary());
     }
   }
-  maxCodeCacheUsed = MAX2(maxCodeCacheUsed, ((address)_heap->high_boundary() -
-                          (address)_heap->low_boundary()) - unallocated_capacity());
+  maxCodeCacheUsed = MAX2(maxCodeCacheUsed, max_capacity() - unallocated_capacity());
   verify_if_often();
   print_trace("allocation", cb, size);
   return cb;
@@ -219,7 +289,7 @@ void CodeCache::free(CodeBlob* cb) {
   }
   _number_of_blobs--;
 
-  _heap->deallocate(cb);
+  heap_containing(cb)->deallocate(cb);
 
   verify_if_often();
   assert(_number_of_blobs >= 0, "sanity check");
@@ -259,7 +329,7 @@ void CodeCache::flush() {
 
 bool CodeCache::contains(void *p) {
   // It should be ok to call contains without holding a lock
-  return _heap->contains(p);
+  return heap_index_containing(p) >= 0;
 }
 
 
@@ -553,13 +623,37 @@ void CodeCache::verify_oops() {
 
 address CodeCache::first_address() {
   assert_locked_or_safepoint(CodeCache_lock);
-  return (address)_heap->low_boundary();
+  return low_bound();
 }
 
 
 address CodeCache::last_address() {
   assert_locked_or_safepoint(CodeCache_lock);
-  return (address)_heap->high();
+  return high();
+}
+
+size_t CodeCache::capacity() {
+  size_t capacity = 0;
+  for (int i = 0; i < _number_of_heaps; i++) {
+    capacity += _heap_list[i]->capacity();
+  }
+  return capacity;
+}
+
+size_t CodeCache::max_capacity() {
+  size_t max_capacity = 0;
+  for (int i = 0; i < _number_of_heaps; i++) {
+    max_capacity += _heap_list[i]->max_capacity();
+  }
+  return max_capacity;
+}
+
+size_t CodeCache::unallocated_capacity() {
+  size_t unallocated_capacity = 0;
+  for (int i = 0; i < _number_of_heaps; i++) {
+    unallocated_capacity += _heap_list[i]->unallocated_capacity();
+  }
+  return unallocated_capacity;
 }
 
 /**
@@ -586,12 +680,20 @@ void CodeCache::initialize() {
   CodeCacheExpansionSize = round_to(CodeCacheExpansionSize, os::vm_page_size());
   InitialCodeCacheSize = round_to(InitialCodeCacheSize, os::vm_page_size());
   ReservedCodeCacheSize = round_to(ReservedCodeCacheSize, os::vm_page_size());
-  if (!_heap->reserve(ReservedCodeCacheSize, InitialCodeCacheSize, CodeCacheSegmentSize)) {
-    vm_exit_during_initialization("Could not reserve enough space for code cache");
+  if (SegmentedCodeCache) {
+    initialize_heaps();
+  } else {
+    _heap = new CodeHeap();
+    if (!_heap->reserve(ReservedCodeCacheSize, InitialCodeCacheSize, CodeCacheSegmentSize)) {
+      vm_exit_during_initialization("Could not reserve enough space for code cache");
+    }
+    _heap_list[_number_of_heaps++] = _heap;
+    for (int type = 0; type < CodeBlobType::NumTypes; type++) {
+      _heaps[type] = _heap;
+    }
+    MemoryService::add_code_heap_memory_pool(_heap);
   }
 
-  MemoryService::add_code_heap_memory_pool(_heap);
-
   // Initialize ICache flush mechanism
   // This service is needed for os::register_code_area
   icache_init();
@@ -599,7 +701,74 @@ void CodeCache::initialize() {
   // Give OS a chance to register generated code area.
   // This is used on Windows 64 bit platforms to register
   // Structured Exception Handlers for our generated code.
-  os::register_code_area(_heap->low_boundary(), _heap->high_boundary());
+  os::register_code_area((char*)low_bound(), (char*)high_bound());
+}
+
+// Splits one reservation of ReservedCodeCacheSize into the code heaps, laid
+// out as [profiled | non-nmethods | non-profiled].  A size flag of 0 means
+// the size is chosen here: the non-nmethods get at least the initial code
+// cache size and at most 8M, and the profiled nmethods half of the rest
+// with TieredCompilation.  Without TieredCompilation there are no profiled
+// nmethods and CodeBlobType::MethodProfiled maps to the non-profiled heap.
+// The initial code cache size is split across the heaps in proportion to
+// their reserved sizes, so the heaps together commit InitialCodeCacheSize.
+void CodeCache::initialize_heaps() {
+  size_t page_size;
+  ReservedCodeSpace rs = CodeHeap::reserve_memory(ReservedCodeCacheSize, &page_size);
+  if (!rs.is_reserved()) {
+    vm_exit_during_initialization("Could not reserve enough space for code cache");
+  }
+  os::trace_page_sizes("code heap", InitialCodeCacheSize, ReservedCodeCacheSize,
+                       page_size, rs.base(), rs.size());
+  const size_t alignment = MAX2(page_size, (size_t)os::vm_allocation_granularity());
+
+  size_t non_nmethod_size = NonNMethodCodeHeapSize;
+  if (non_nmethod_size == 0) {
+    non_nmethod_size = MAX2((size_t)InitialCodeCacheSize, MIN2((size_t)8*M, rs.size() / 8));
+  }
+  non_nmethod_size = align_size_up(non_nmethod_size, alignment);
+  if (non_nmethod_size >= rs.size()) {
+    vm_exit_during_initialization("Not enough space in ReservedCodeCacheSize for the code heaps");
+  }
+  size_t profiled_size = 0;
+  if (TieredCompilation) {
+    profiled_size = ProfiledCodeHeapSize;
+    if (profiled_size == 0) {
+      profiled_size = (rs.size() - non_nmethod_size) / 2;
+    }
+    profiled_size = align_size_up(profiled_size, alignment);
+  }
+  if (non_nmethod_size + profiled_size >= rs.size()) {
+    vm_exit_during_initialization("Not enough space in ReservedCodeCacheSize for the code heaps");
+  }
+
+  ReservedSpace rest = rs;
+  if (profiled_size > 0) {
+    CodeHeap* heap = new CodeHeap("CodeHeap 'profiled nmethods'");
+    add_heap(heap, rs.first_part(profiled_size), rs.size());
+    _heaps[CodeBlobType::MethodProfiled] = heap;
+    rest = rs.last_part(profiled_size);
+  }
+  _heap = new CodeHeap("CodeHeap 'non-nmethods'");
+  add_heap(_heap, rest.first_part(non_nmethod_size), rs.size());
+  _heaps[CodeBlobType::NonNMethod] = _heap;
+
+  CodeHeap* heap = new CodeHeap("CodeHeap 'non-profiled nmethods'");
+  add_heap(heap, rest.last_part(non_nmethod_size), rs.size());
+  _heaps[CodeBlobType::MethodNonProfiled] = heap;
+  if (profiled_size == 0) {
+    _heaps[CodeBlobType::MethodProfiled] = heap;
+  }
+}
+
+void CodeCache::add_heap(CodeHeap* heap, ReservedSpace rs, size_t total_size) {
+  size_t committed_size = (size_t)((julong)InitialCodeCacheSize * rs.size() / total_size);
+  committed_size = round_to(MAX2(committed_size, (size_t)os::vm_page_size()), os::vm_page_size());
+  if (!heap->reserve(rs, MIN2(committed_size, rs.size()), CodeCacheSegmentSize)) {
+    vm_exit_during_initialization("Could not reserve enough space for code cache");
+  }
+  _heap_list[_number_of_heaps++] = heap;
+  MemoryService::add_code_heap_memory_pool(heap);
 }
 
 
@@ -707,6 +876,27 @@ int CodeCache::mark_for_evol_deoptimization(instanceKlassHandle dependee) {
 }
 #endif // HOTSWAP
 
+int CodeCache::mark_for_dsu_deoptimization() {
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  MutexLockerEx mu(CodeCache_lock, Mutex::_no_safepoint_check_flag);
+  int number_of_marked_CodeBlobs = 0;
+
+  FOR_ALL_ALIVE_NMETHODS(nm) {
+    if (nm->method()->is_method_handle_intrinsic()) {
+      continue;
+    }
+    if (nm->is_dsu_dependent_on_swapped_class()) {
+      nm->mark_for_deoptimization();
+      number_of_marked_CodeBlobs++;
+    } else {
+      // flush caches in case they refer to a swapped Method*
+      nm->clear_inline_caches();
+    }
+  }
+
+  return number_of_marked_CodeBlobs;
+}
+
 
 // Deoptimize all methods
 void CodeCache::mark_all_nmethods_for_deoptimization() {
@@ -765,7 +955,9 @@ void CodeCache::make_marked_nmethods_not_entrant() {
 }
 
 void CodeCache::verify() {
-  _heap->verify();
+  for (int i = 0; i < _number_of_heaps; i++) {
+    _heap_list[i]->verify();
+  }
   FOR_ALL_ALIVE_BLOBS(p) {
     p->verify();
   }
@@ -794,7 +986,9 @@ void CodeCache::report_codemem_full() {
 
 void CodeCache::verify_if_often() {
   if (VerifyCodeCacheOften) {
-    _heap->verify();
+    for (int i = 0; i < _number_of_heaps; i++) {
+      _heap_list[i]->verify();
+    }
   }
 }
 
@@ -966,17 +1160,27 @@ void CodeCache::print() {
 }
 
 void CodeCache::print_summary(outputStream* st, bool detailed) {
-  size_t total = (_heap->high_boundary() - _heap->low_boundary());
+  size_t total = max_capacity();
   st->print_cr("CodeCache: size=" SIZE_FORMAT "Kb used=" SIZE_FORMAT
                "Kb max_used=" SIZE_FORMAT "Kb free=" SIZE_FORMAT "Kb",
                total/K, (total - unallocated_capacity())/K,
                maxCodeCacheUsed/K, unallocated_capacity()/K);
 
   if (detailed) {
-    st->print_cr(" bounds [" INTPTR_FORMAT ", " INTPTR_FORMAT ", " INTPTR_FORMAT "]",
-                 p2i(_heap->low_boundary()),
-                 p2i(_heap->high()),
-                 p2i(_heap->high_boundary()));
+    for (int i = 0; i < _number_of_heaps; i++) {
+      CodeHeap* heap = _heap_list[i];
+      if (SegmentedCodeCache) {
+        size_t heap_total = heap->max_capacity();
+        st->print_cr(" %s: size=" SIZE_FORMAT "Kb used=" SIZE_FORMAT "Kb free=" SIZE_FORMAT "Kb",
+                     heap->name(), heap_total/K,
+                     (heap_total - heap->unallocated_capacity())/K,
+                     heap->unallocated_capacity()/K);
+      }
+      st->print_cr(" bounds [" INTPTR_FORMAT ", " INTPTR_FORMAT ", " INTPTR_FORMAT "]",
+                   p2i(heap->low_boundary()),
+                   p2i(heap->high()),
+                   p2i(heap->high_boundary()));
+    }
     st->print_cr(" total_blobs=" UINT32_FORMAT " nmethods=" UINT32_FORMAT
                  " adapters=" UINT32_FORMAT,
                  nof_blobs(), nof_nmethods(), nof_adapters());
@@ -39,6 +39,13 @@
 //   - Each CodeBlob occupies one chunk of memory.
 //   - Like the offset table in oldspace the zone has at table for
 //     locating a method given a addess of an instruction.
+//   - With SegmentedCodeCache, the reserved space is split into one CodeHeap
+//     per CodeBlobType, laid out as
+//         [profiled nmethods | non-nmethods | non-profiled nmethods]
+//     so that stubs do not end up between hot methods, and so that the
+//     sweeper and deoptimization only disturb the segment they work on.
+//     The segments are contiguous: low_bound() and high_bound() still span
+//     the whole code cache.
 
 class OopClosure;
 class DepChange;
@@ -51,6 +58,11 @@ class CodeCache : AllStatic {
   // This may cause memory leak, but is necessary, for now. See 4423824,
   // 4422213 or 4436291 for details.
   static CodeHeap * _heap;
+  // The code heap of each CodeBlobType, all _heap without SegmentedCodeCache,
+  // and the distinct code heaps in address order.
+  static CodeHeap * _heaps[CodeBlobType::NumTypes];
+  static CodeHeap * _heap_list[CodeBlobType::All];
+  static int _number_of_heaps;
   static int _number_of_blobs;
   static int _number_of_adapters;
   static int _number_of_nmethods;
@@ -65,15 +77,37 @@ class CodeCache : AllStatic {
 
   static int _codemem_full_count;
 
+  static void initialize_heaps();
+  // commits its share of InitialCodeCacheSize out of total_size reserved bytes
+  static void add_heap(CodeHeap* heap, ReservedSpace rs, size_t total_size);
+
  public:
 
   // Initialization
   static void initialize();
 
+  // Segments
+  static int  number_of_heaps()                  { return _number_of_heaps; }
+  static CodeHeap* heap_at(int i)                { return _heap_list[i]; }
+  static CodeHeap* get_code_heap(int code_blob_type) {
+    assert(0 <= code_blob_type && code_blob_type < CodeBlobType::NumTypes, "no such segment");
+    assert(_heaps[code_blob_type] != NULL, "CodeBlobType::All needs a single code heap");
+    return _heaps[code_blob_type];
+  }
+  // The index of the code heap containing p in address order, -1 if none
+  static int  heap_index_containing(const void* p);
+  static CodeHeap* heap_containing(const void* p) {
+    int i = heap_index_containing(p);
+    return i < 0 ? NULL : _heap_list[i];
+  }
+  // The segment for an nmethod compiled at comp_level, CodeBlobType::All
+  // without SegmentedCodeCache
+  static int  get_code_blob_type(int comp_level);
+
   static void report_codemem_full();
 
   // Allocation/administration
-  static CodeBlob* allocate(int size, bool is_critical = false); // allocates a new CodeBlob
+  static CodeBlob* allocate(int size, int code_blob_type, bool is_critical = false); // allocates a new CodeBlob
   static void commit(CodeBlob* cb);                 // called when the allocated CodeBlob has been filled
   static int alignment_unit();                      // guaranteed alignment of all CodeBlobs
   static int alignment_offset();                    // guaranteed offset of first CodeBlob byte within alignment unit (i.e., allocation header)
@@ -93,9 +127,10 @@ class CodeCache : AllStatic {
   // what you are doing)
   static CodeBlob* find_blob_unsafe(void* start) {
     // NMT can walk the stack before code cache is created
-    if (_heap == NULL) return NULL;
+    CodeHeap* heap = heap_containing(start);
+    if (heap == NULL) return NULL;
 
-    CodeBlob* result = (CodeBlob*)_heap->find_start(start);
+    CodeBlob* result = (CodeBlob*)heap->find_start(start);
     // this assert is too strong because the heap code will return the
     // heapblock containing start. That block can often be larger than
     // the codeBlob itself. If you look up an address that is within
@@ -122,6 +157,9 @@ class CodeCache : AllStatic {
   static nmethod* alive_nmethod(CodeBlob *cb);
   static nmethod* first_nmethod();
   static nmethod* next_nmethod (CodeBlob* cb);
+  // Iteration over the nmethods of one code heap, for the sweeper
+  static nmethod* first_nmethod(CodeHeap* heap);
+  static nmethod* next_nmethod(CodeHeap* heap, CodeBlob* cb);
   static int       nof_blobs()                 { return _number_of_blobs; }
   static int       nof_adapters()              { return _number_of_adapters; }
   static int       nof_nmethods()              { return _number_of_nmethods; }
@@ -152,16 +190,18 @@ class CodeCache : AllStatic {
   static void log_state(outputStream* st);
 
   // The full limits of the codeCache
-  static address  low_bound()                    { return (address) _heap->low_boundary(); }
-  static address  high_bound()                   { return (address) _heap->high_boundary(); }
-  static address  high()                         { return (address) _heap->high(); }
+  static address  low_bound()                    { return (address) _heap_list[0]->low_boundary(); }
+  static address  high_bound()                   { return (address) _heap_list[_number_of_heaps - 1]->high_boundary(); }
+  static address  high()                         { return (address) _heap_list[_number_of_heaps - 1]->high(); }
 
   // Profiling
   static address first_address();                // first address used for CodeBlobs
   static address last_address();                 // last  address used for CodeBlobs
-  static size_t  capacity()                      { return _heap->capacity(); }
-  static size_t  max_capacity()                  { return _heap->max_capacity(); }
-  static size_t  unallocated_capacity()          { return _heap->unallocated_capacity(); }
+  static size_t  capacity();
+  static size_t  max_capacity();
+  static size_t  unallocated_capacity();
+  static size_t  unallocated_capacity(int code_blob_type) { return get_code_heap(code_blob_type)->unallocated_capacity(); }
+  static size_t  max_capacity(int code_blob_type)         { return get_code_heap(code_blob_type)->max_capacity(); }
   static double  reverse_free_ratio();
 
   static bool needs_cache_clean()                { return _needs_cache_clean; }
@@ -176,6 +216,8 @@ class CodeCache : AllStatic {
 #ifdef HOTSWAP
   static int  mark_for_evol_deoptimization(instanceKlassHandle dependee);
 #endif // HOTSWAP
+  // Javelus: only nmethods depending on classes swapped by the active DSU
+  static int  mark_for_dsu_deoptimization();
 
   static void mark_all_nmethods_for_deoptimization();
   static int  mark_for_deoptimization(Method* dependee);
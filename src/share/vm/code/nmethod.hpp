@@ -295,7 +295,7 @@ class nmethod : public CodeBlob {
           int comp_level);
 
   // helper methods
-  void* operator new(size_t size, int nmethod_size) throw();
+  void* operator new(size_t size, int nmethod_size, int comp_level) throw();
 
   const char* reloc_string_for(u_char* begin, u_char* end);
   // Returns true if this thread changed the state of the nmethod or
@@ -752,6 +752,10 @@ public:
   // corresponds to the given method as well.
   bool is_dependent_on_method(Method* dependee);
 
+  // Javelus: is this nmethod compiled from or inlining a method of a class
+  // that will be swapped by the active DSU?
+  bool is_dsu_dependent_on_swapped_class();
+
   // is it ok to patch at address?
   bool is_patchable_at(address instr_address);
 
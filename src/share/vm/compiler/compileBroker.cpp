@@ -369,6 +369,13 @@ void CompileTask::mark_on_stack() {
   }
 }
 
+void CompileTask::metadata_do(void f(Metadata*)) {
+  f(_method);
+  if (_hot_method != NULL) {
+    f(_hot_method);
+  }
+}
+
 // ------------------------------------------------------------------
 // CompileTask::print
 void CompileTask::print() {
@@ -819,6 +826,15 @@ void CompileQueue::mark_on_stack() {
   }
 }
 
+// methods in the compile queue must not be reclaimed by Javelus
+void CompileQueue::metadata_do(void f(Metadata*)) {
+  CompileTask* task = _first;
+  while (task != NULL) {
+    task->metadata_do(f);
+    task = task->next();
+  }
+}
+
 #ifndef PRODUCT
 /**
  * Print entire compilation queue.
@@ -1155,6 +1171,20 @@ void CompileBroker::mark_on_stack() {
   }
 }
 
+/**
+ * Apply f to the methods in the compile queues so that Javelus
+ * doesn't reclaim them. This method is executed at a safepoint.
+ */
+void CompileBroker::metadata_do(void f(Metadata*)) {
+  assert(SafepointSynchronize::is_at_safepoint(), "sanity check");
+  if (_c2_compile_queue != NULL) {
+    _c2_compile_queue->metadata_do(f);
+  }
+  if (_c1_compile_queue != NULL) {
+    _c1_compile_queue->metadata_do(f);
+  }
+}
+
 // ------------------------------------------------------------------
 // CompileBroker::compile_method
 //
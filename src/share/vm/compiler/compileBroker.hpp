@@ -128,6 +128,8 @@ public:
 
   // Redefine Classes support
   void mark_on_stack();
+  // Javelus support
+  void metadata_do(void f(Metadata*));
 
   static void  print_inline_indent(int inline_level, outputStream* st = tty);
 
@@ -233,6 +235,8 @@ class CompileQueue : public CHeapObj<mtCompiler> {
 
   // Redefine Classes support
   void mark_on_stack();
+  // Javelus support
+  void metadata_do(void f(Metadata*));
   void free_all();
   NOT_PRODUCT (void print();)
 
@@ -449,6 +453,8 @@ class CompileBroker: AllStatic {
 
   // Redefine Classes support
   static void mark_on_stack();
+  // Javelus support
+  static void metadata_do(void f(Metadata*));
 
   // Print a detailed accounting of compilation time
   static void print_times();
@@ -0,0 +1,371 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+*/
+
+#include "precompiled.hpp"
+#include "classfile/symbolTable.hpp"
+#include "classfile/systemDictionary.hpp"
+#include "code/codeCache.hpp"
+#include "code/nmethod.hpp"
+#include "compiler/compileBroker.hpp"
+#include "compiler/compileCache.hpp"
+#include "memory/resourceArea.hpp"
+#include "oops/instanceKlass.hpp"
+#include "oops/method.hpp"
+#include "prims/jvm.h"
+#include "runtime/compilationPolicy.hpp"
+#include "runtime/dsu.hpp"
+#include "runtime/handles.inline.hpp"
+#include "runtime/mutexLocker.hpp"
+#include "runtime/os.hpp"
+#include "runtime/vm_version.hpp"
+
+CompileCacheEntry::CompileCacheEntry(Symbol* class_name, julong fingerprint)
+: _class_name(class_name),
+  _fingerprint(fingerprint),
+  _methods(NULL),
+  _levels(NULL),
+  _state(pending),
+  _next(NULL) {
+  _class_name->increment_refcount();
+  _methods = new (ResourceObj::C_HEAP, mtCompiler) GrowableArray<Symbol*>(8, true);
+  _levels = new (ResourceObj::C_HEAP, mtCompiler) GrowableArray<int>(4, true);
+}
+
+CompileCacheEntry::~CompileCacheEntry() {
+  _class_name->decrement_refcount();
+  for (int i = 0; i < _methods->length(); i++) {
+    _methods->at(i)->decrement_refcount();
+  }
+  delete _methods;
+  delete _levels;
+}
+
+void CompileCacheEntry::add_method(Symbol* name, Symbol* signature, int level) {
+  name->increment_refcount();
+  signature->increment_refcount();
+  _methods->append(name);
+  _methods->append(signature);
+  _levels->append(level);
+}
+
+// A method compiled by this VM, collected for saving
+class CompileCacheRecord VALUE_OBJ_CLASS_SPEC {
+ public:
+  Method* _method;
+  int     _level;
+};
+
+static int compare_by_holder(CompileCacheRecord* a, CompileCacheRecord* b) {
+  address holder_a = (address) a->_method->method_holder();
+  address holder_b = (address) b->_method->method_holder();
+  return holder_a < holder_b ? -1 : (holder_a == holder_b ? 0 : 1);
+}
+
+static const char* compile_cache_magic = "# Javelus compile cache";
+
+CompileCacheEntry* CompileCache::_table[CompileCache::table_size];
+bool CompileCache::_loaded = false;
+
+int CompileCache::index_for(Symbol* class_name) {
+  return (int) ((juint) class_name->identity_hash() % table_size);
+}
+
+void CompileCache::add(CompileCacheEntry* entry) {
+  int index = index_for(entry->class_name());
+  entry->set_next(_table[index]);
+  _table[index] = entry;
+}
+
+CompileCacheEntry* CompileCache::lookup(Symbol* class_name, julong fingerprint) {
+  if (fingerprint == 0) {
+    return NULL;
+  }
+  for (CompileCacheEntry* entry = _table[index_for(class_name)]; entry != NULL; entry = entry->next()) {
+    if (entry->class_name() == class_name && entry->fingerprint() == fingerprint) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// The flags that change which methods are compiled and at which levels
+void CompileCache::print_flags(char* buffer, size_t length) {
+  jio_snprintf(buffer, length,
+               "TieredCompilation=%d TieredStopAtLevel=" INTX_FORMAT
+               " UseCompressedOops=%d UseCompressedClassPointers=%d",
+               TieredCompilation ? 1 : 0, TieredStopAtLevel,
+               UseCompressedOops ? 1 : 0, UseCompressedClassPointers ? 1 : 0);
+}
+
+// vm <internal vm info string>
+// flags <flags>
+// class <name> <fingerprint>
+// method <name> <signature> <level>
+//
+// Returns false if the file is for another VM.
+bool CompileCache::parse_line(char* line, CompileCacheEntry* &current, TRAPS) {
+  char name[1024];
+  char signature[1024];
+  julong fingerprint;
+  int level;
+  if (strncmp(line, "vm ", 3) == 0) {
+    return strcmp(line + 3, VM_Version::internal_vm_info_string()) == 0;
+  } else if (strncmp(line, "flags ", 6) == 0) {
+    char flags[256];
+    print_flags(flags, sizeof(flags));
+    return strcmp(line + 6, flags) == 0;
+  } else if (sscanf(line, "class %1023s " JULONG_FORMAT, name, &fingerprint) == 2) {
+    Symbol* class_name = SymbolTable::new_symbol(name, (int) strlen(name), CHECK_false);
+    current = new CompileCacheEntry(class_name, fingerprint);
+    // the entry holds its own reference
+    class_name->decrement_refcount();
+    add(current);
+  } else if (current != NULL && sscanf(line, "method %1023s %1023s %d", name, signature, &level) == 3) {
+    TempNewSymbol method_name = SymbolTable::new_symbol(name, (int) strlen(name), CHECK_false);
+    TempNewSymbol method_signature = SymbolTable::new_symbol(signature, (int) strlen(signature), CHECK_false);
+    current->add_method(method_name, method_signature, level);
+  } else if (line[0] != '#' && line[0] != '\0') {
+    warning("Ignore malformed line of compile cache: %s", line);
+  }
+  return true;
+}
+
+void CompileCache::load(TRAPS) {
+  struct stat st;
+  if (os::stat(CompileCacheFile, &st) != 0) {
+    // created at exit
+    _loaded = true;
+    return;
+  }
+  int file_handle = os::open(CompileCacheFile, 0, 0);
+  if (file_handle == -1) {
+    warning("Cannot open compile cache %s.", CompileCacheFile);
+    _loaded = true;
+    return;
+  }
+
+  ResourceMark rm(THREAD);
+  char* buffer = NEW_RESOURCE_ARRAY(char, st.st_size + 1);
+  size_t num_read = os::read(file_handle, buffer, st.st_size);
+  os::close(file_handle);
+  if (num_read != (size_t) st.st_size) {
+    warning("File size of compile cache %s error!", CompileCacheFile);
+    _loaded = true;
+    return;
+  }
+  buffer[num_read] = '\0';
+
+  if (strncmp(buffer, compile_cache_magic, strlen(compile_cache_magic)) != 0) {
+    warning("Compile cache %s is not a compile cache, it will be overwritten.", CompileCacheFile);
+    _loaded = true;
+    return;
+  }
+
+  CompileCacheEntry* current = NULL;
+  bool valid = true;
+  char* line = buffer;
+  for (size_t pos = 0; valid && pos <= num_read; pos++) {
+    if (buffer[pos] == '\n' || buffer[pos] == '\0') {
+      buffer[pos] = '\0';
+      valid = parse_line(line, current, CHECK);
+      line = buffer + pos + 1;
+    }
+  }
+  if (!valid) {
+    // Like the CDS archive, the file cannot be used by another VM build or
+    // with other flags. Drop what has been read so far.
+    if (PrintCompileCache) {
+      tty->print_cr("Compile cache %s was created by another VM or with other flags, ignored", CompileCacheFile);
+    }
+    for (int i = 0; i < table_size; i++) {
+      while (_table[i] != NULL) {
+        CompileCacheEntry* entry = _table[i];
+        _table[i] = entry->next();
+        delete entry;
+      }
+    }
+  }
+  _loaded = true;
+
+  // Classes initialized before the compilers are all loaded by the boot loader
+  for (int i = 0; i < table_size; i++) {
+    for (CompileCacheEntry* entry = _table[i]; entry != NULL; entry = entry->next()) {
+      Klass* k = SystemDictionary::find(entry->class_name(), Handle(), Handle(), CHECK);
+      if (k != NULL && k->oop_is_instance() && InstanceKlass::cast(k)->is_initialized()) {
+        class_initialized(InstanceKlass::cast(k), CHECK);
+      }
+    }
+  }
+}
+
+void CompileCache::class_initialized(InstanceKlass* ik, TRAPS) {
+  if (!_loaded || ik->is_anonymous() || !UseCompiler || !CompileBroker::should_compile_new_jobs()) {
+    return;
+  }
+  // cheap check before computing the fingerprint
+  bool has_entries = false;
+  for (CompileCacheEntry* entry = _table[index_for(ik->name())]; entry != NULL; entry = entry->next()) {
+    if (entry->class_name() == ik->name() && entry->state() == CompileCacheEntry::pending) {
+      has_entries = true;
+      break;
+    }
+  }
+  if (!has_entries) {
+    return;
+  }
+  CompileCacheEntry* entry = lookup(ik->name(), DSUPlan::fingerprint(ik, THREAD));
+  if (entry != NULL && entry->state() == CompileCacheEntry::pending) {
+    entry->set_state(CompileCacheEntry::applied);
+    compile(ik, entry, THREAD);
+  }
+}
+
+void CompileCache::compile(InstanceKlass* ik, CompileCacheEntry* entry, TRAPS) {
+  for (int i = 0; i < entry->methods_count(); i++) {
+    Method* m = ik->find_method(entry->method_name_at(i), entry->method_signature_at(i));
+    int level = entry->level_at(i);
+    if (level == CompLevel_full_optimization) {
+      // C2 code compiled without a profile is poor and soon deoptimized.
+      // Profile the method first, the policy compiles it with C2 once hot.
+      if (!TieredCompilation) {
+        continue;
+      }
+      level = CompLevel_full_profile;
+    }
+    if (m == NULL || m->is_abstract() || (TieredCompilation && level > TieredStopAtLevel)) {
+      continue;
+    }
+    methodHandle mh(THREAD, m);
+    if (!CompilationPolicy::can_be_compiled(mh, level)) {
+      continue;
+    }
+    if (PrintCompileCache) {
+      ResourceMark rm(THREAD);
+      tty->print_cr("Compile cache: compiling %s at level %d", mh->name_and_sig_as_C_string(), level);
+    }
+    CompileBroker::compile_method(mh, InvocationEntryBci, level, mh, 0, "compile cache", THREAD);
+    if (HAS_PENDING_EXCEPTION) {
+      // e.g., out of memory while creating the compile task; the method
+      // will be compiled when it gets hot
+      CLEAR_PENDING_EXCEPTION;
+    }
+  }
+}
+
+void CompileCache::invalidate(Symbol* class_name) {
+  for (CompileCacheEntry* entry = _table[index_for(class_name)]; entry != NULL; entry = entry->next()) {
+    if (entry->class_name() == class_name) {
+      entry->set_state(CompileCacheEntry::invalid);
+    }
+  }
+}
+
+void CompileCache::save(JavaThread* thread) {
+  ResourceMark rm(thread);
+  GrowableArray<CompileCacheRecord>* records = new GrowableArray<CompileCacheRecord>(1024);
+  {
+    MutexLockerEx mu(CodeCache_lock, Mutex::_no_safepoint_check_flag);
+    for (nmethod* nm = CodeCache::first_nmethod(); nm != NULL; nm = CodeCache::next_nmethod(nm)) {
+      if (!nm->is_in_use() || nm->is_osr_method() || nm->is_native_method()) {
+        continue;
+      }
+      Method* m = nm->method();
+      InstanceKlass* holder = m->method_holder();
+      // old versions of redefined and updated classes are not saved
+      if (m->is_old() || m->is_obsolete() || holder->is_anonymous() || holder->next_version() != NULL) {
+        continue;
+      }
+      CompileCacheRecord record;
+      record._method = m;
+      record._level = nm->comp_level();
+      records->append(record);
+    }
+  }
+  records->sort(compare_by_holder);
+
+  // Write a temporary file and rename it, so that a VM starting meanwhile
+  // or a crash never sees a truncated cache.
+  char tmp_name[JVM_MAXPATHLEN];
+  jio_snprintf(tmp_name, sizeof(tmp_name), "%s.%d.tmp", CompileCacheFile, os::current_process_id());
+  FILE* file = fopen(tmp_name, "w");
+  if (file == NULL) {
+    warning("Cannot write compile cache %s.", tmp_name);
+    return;
+  }
+  char flags[256];
+  print_flags(flags, sizeof(flags));
+  fprintf(file, "%s\n", compile_cache_magic);
+  fprintf(file, "vm %s\n", VM_Version::internal_vm_info_string());
+  fprintf(file, "flags %s\n", flags);
+
+  int count = 0;
+  InstanceKlass* holder = NULL;
+  julong fingerprint = 0;
+  for (int i = 0; i < records->length(); i++) {
+    Method* m = records->at(i)._method;
+    if (m->method_holder() != holder) {
+      holder = m->method_holder();
+      // computed outside of the CodeCache_lock, it may reconstitute the class file
+      fingerprint = DSUPlan::fingerprint(holder, thread);
+      if (fingerprint != 0) {
+        // superseded by what this VM compiled
+        CompileCacheEntry* entry = lookup(holder->name(), fingerprint);
+        if (entry != NULL) {
+          entry->set_state(CompileCacheEntry::applied);
+        }
+        fprintf(file, "class %s " JULONG_FORMAT "\n", holder->name()->as_C_string(), fingerprint);
+      }
+    }
+    // classes without a fingerprint are not saved
+    if (fingerprint == 0) {
+      continue;
+    }
+    fprintf(file, "method %s %s %d\n", m->name()->as_C_string(), m->signature()->as_C_string(),
+            records->at(i)._level);
+    count++;
+  }
+
+  // Keep the entries of classes this VM has not used
+  for (int i = 0; i < table_size; i++) {
+    for (CompileCacheEntry* entry = _table[i]; entry != NULL; entry = entry->next()) {
+      if (entry->state() != CompileCacheEntry::pending) {
+        continue;
+      }
+      fprintf(file, "class %s " JULONG_FORMAT "\n", entry->class_name()->as_C_string(), entry->fingerprint());
+      for (int j = 0; j < entry->methods_count(); j++) {
+        fprintf(file, "method %s %s %d\n", entry->method_name_at(j)->as_C_string(),
+                entry->method_signature_at(j)->as_C_string(), entry->level_at(j));
+        count++;
+      }
+    }
+  }
+  if (fclose(file) != 0 || ::rename(tmp_name, CompileCacheFile) != 0) {
+    warning("Cannot write compile cache %s.", CompileCacheFile);
+    remove(tmp_name);
+    return;
+  }
+
+  if (PrintCompileCache) {
+    tty->print_cr("Compile cache: saved %d methods to %s", count, CompileCacheFile);
+  }
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+*/
+
+#ifndef SHARE_VM_COMPILER_COMPILECACHE_HPP
+#define SHARE_VM_COMPILER_COMPILECACHE_HPP
+
+#include "memory/allocation.hpp"
+#include "oops/symbol.hpp"
+#include "utilities/growableArray.hpp"
+
+class InstanceKlass;
+
+// The methods of one class version that were compiled by an earlier VM,
+// with their compilation levels. The class version is identified by its
+// name and its DSUPlan::fingerprint.
+class CompileCacheEntry : public CHeapObj<mtCompiler> {
+ public:
+  enum State {
+    pending,          // not matched by a class of this VM yet
+    applied,          // the methods have been submitted for compilation
+    invalid           // the class has been redefined or updated
+  };
+
+ private:
+  Symbol*             _class_name;
+  julong              _fingerprint;
+  // names and signatures of the compiled methods, in pairs
+  GrowableArray<Symbol*>* _methods;
+  GrowableArray<int>*     _levels;
+  State               _state;
+  CompileCacheEntry*  _next;
+
+ public:
+  CompileCacheEntry(Symbol* class_name, julong fingerprint);
+  ~CompileCacheEntry();
+
+  Symbol* class_name() const              { return _class_name; }
+  julong  fingerprint() const             { return _fingerprint; }
+  State   state() const                   { return _state; }
+  void    set_state(State state)          { _state = state; }
+
+  CompileCacheEntry* next() const         { return _next; }
+  void set_next(CompileCacheEntry* next)  { _next = next; }
+
+  void    add_method(Symbol* name, Symbol* signature, int level);
+  int     methods_count() const           { return _levels->length(); }
+  Symbol* method_name_at(int i) const     { return _methods->at(2 * i); }
+  Symbol* method_signature_at(int i) const { return _methods->at(2 * i + 1); }
+  int     level_at(int i) const           { return _levels->at(i); }
+};
+
+// The compile cache remembers which methods a VM has compiled, so that the
+// next VM started with the same CompileCacheFile submits them for
+// compilation as soon as their classes are initialized, instead of waiting
+// for them to become hot again in the interpreter.
+//
+// Only the list of methods is saved, not their machine code: nmethods embed
+// oops and addresses of the VM that created them and the compilers cannot
+// relocate them. Like the CDS archive in FileMapInfo, a file is only used
+// by a VM of the same build with the same compilation flags. Entries are
+// keyed by class fingerprints, so a class file that changed between runs
+// does not match, and entries of a class redefined or updated by DSU in
+// this VM are dropped.
+class CompileCache : AllStatic {
+ private:
+  enum { table_size = 1009 };
+
+  static CompileCacheEntry* _table[table_size];
+  static bool _loaded;
+
+  static int  index_for(Symbol* class_name);
+  static void add(CompileCacheEntry* entry);
+  static CompileCacheEntry* lookup(Symbol* class_name, julong fingerprint);
+  static void print_flags(char* buffer, size_t length);
+  static bool parse_line(char* line, CompileCacheEntry* &current, TRAPS);
+  static void compile(InstanceKlass* ik, CompileCacheEntry* entry, TRAPS);
+
+ public:
+  static bool is_enabled() { return CompileCacheFile != NULL; }
+
+  // Loads the file after the compilers have been initialized and compiles
+  // the entries of classes that are already initialized.
+  static void load(TRAPS);
+  // Saves the methods compiled by this VM and the entries not used by it.
+  static void save(JavaThread* thread);
+
+  static void class_initialized(InstanceKlass* ik, TRAPS);
+  static void invalidate(Symbol* class_name);
+};
+
+#endif // SHARE_VM_COMPILER_COMPILECACHE_HPP
@@ -41,6 +41,7 @@
 #include "gc_implementation/shared/gcTrace.hpp"
 #include "gc_implementation/shared/gcTraceTime.hpp"
 #include "gc_implementation/shared/isGCActiveMark.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "gc_interface/collectedHeap.inline.hpp"
 #include "memory/allocation.hpp"
 #include "memory/cardTableRS.hpp"
@@ -6288,6 +6289,13 @@ void CMSCollector::refProcessingWork(bool asynch, bool clear_all_soft_refs) {
     }
   }
 
+  // The string deduplication queue and table are weak roots whether or
+  // not classes are unloaded, dead entries must go before the sweep.
+  if (StringDedup::is_enabled()) {
+    GCTraceTime t("scrub string deduplication", PrintGCDetails, false, _gc_timer_cm, _gc_tracer_cm->gc_id());
+    StringDedup::unlink(&_is_alive_closure);
+  }
+
 
   // Restore any preserved marks as a result of mark stack or
   // work queue overflow
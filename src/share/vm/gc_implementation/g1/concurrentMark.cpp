@@ -2627,9 +2627,9 @@ void ConcurrentMark::weakRefsWork(bool clear_all_soft_refs) {
       }
     }
 
-    if (G1StringDedup::is_enabled()) {
+    if (StringDedup::is_enabled()) {
       G1RemarkGCTraceTime trace("String Deduplication Unlink", G1Log::finest());
-      G1StringDedup::unlink(&g1_is_alive);
+      StringDedup::unlink(&g1_is_alive);
     }
   }
 }
@@ -47,7 +47,6 @@
 #include "gc_implementation/g1/g1RegionToSpaceMapper.hpp"
 #include "gc_implementation/g1/g1RemSet.inline.hpp"
 #include "gc_implementation/g1/g1RootProcessor.hpp"
-#include "gc_implementation/g1/g1StringDedup.hpp"
 #include "gc_implementation/g1/g1YCTypes.hpp"
 #include "gc_implementation/g1/heapRegion.inline.hpp"
 #include "gc_implementation/g1/heapRegionRemSet.hpp"
@@ -58,6 +57,9 @@
 #include "gc_implementation/shared/gcTrace.hpp"
 #include "gc_implementation/shared/gcTraceTime.hpp"
 #include "gc_implementation/shared/isGCActiveMark.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
+#include "gc_implementation/shared/stringDedupQueue.hpp"
+#include "gc_implementation/shared/stringDedupTable.hpp"
 #include "memory/allocation.hpp"
 #include "memory/gcLocker.inline.hpp"
 #include "memory/generationSpec.hpp"
@@ -1856,6 +1858,7 @@ G1CollectedHeap::G1CollectedHeap(G1CollectorPolicy* policy_) :
   _humongous_reclaim_candidates(),
   _has_humongous_reclaim_candidates(false),
   _free_regions_coming(false),
+  _time_of_last_gc_ns(os::javaTimeNanos()),
   _young_list(new YoungList(this)),
   _gc_time_stamp(0),
   _survivor_plab_stats(YoungPLABSize, PLABWeight),
@@ -2131,8 +2134,6 @@ jint G1CollectedHeap::initialize() {
   // values in the heap have been properly initialized.
   _g1mm = new G1MonitoringSupport(this);
 
-  G1StringDedup::initialize();
-
   return JNI_OK;
 }
 
@@ -2142,9 +2143,6 @@ void G1CollectedHeap::stop() {
   // that are destroyed during shutdown.
   _cg1r->stop();
   _cmThread->stop();
-  if (G1StringDedup::is_enabled()) {
-    G1StringDedup::stop();
-  }
 }
 
 size_t G1CollectedHeap::conservative_max_heap_alignment() {
@@ -2331,6 +2329,7 @@ bool G1CollectedHeap::should_do_concurrent_full_gc(GCCause::Cause cause) {
     case GCCause::_java_lang_system_gc:     return ExplicitGCInvokesConcurrent;
     case GCCause::_g1_humongous_allocation: return true;
     case GCCause::_update_allocation_context_stats_inc: return true;
+    case GCCause::_g1_periodic_collection:  return G1PeriodicGCInvokesConcurrent;
     default:                                return false;
   }
 }
@@ -2518,6 +2517,7 @@ void G1CollectedHeap::collect(GCCause::Cause cause) {
       }
     } else {
       if (cause == GCCause::_gc_locker || cause == GCCause::_wb_young_gc
+          || cause == GCCause::_g1_periodic_collection
           DEBUG_ONLY(|| cause == GCCause::_scavenge_alot)) {
 
         // Schedule a standard evacuation pause. We're setting word_size
@@ -2601,6 +2601,44 @@ void G1CollectedHeap::object_iterate(ObjectClosure* cl) {
   heap_region_iterate(&blk);
 }
 
+uint G1CollectedHeap::safepoint_workers_count() {
+  if (workers() == NULL) {
+    return 0;
+  }
+  return workers()->active_workers();
+}
+
+void G1CollectedHeap::run_task(AbstractGangTask* task) {
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  set_par_threads(workers()->active_workers());
+  workers()->run_task(task);
+  set_par_threads(0);
+}
+
+class G1ParallelObjectIterator : public ParallelObjectIterator {
+  uint _thread_num;
+public:
+  G1ParallelObjectIterator(uint thread_num) : _thread_num(thread_num) {}
+
+  ~G1ParallelObjectIterator() {
+    G1CollectedHeap::heap()->reset_heap_region_claim_values();
+  }
+
+  virtual void object_iterate(ObjectClosure* cl, uint worker_id) {
+    IterateObjectClosureRegionClosure blk(cl);
+    G1CollectedHeap::heap()->heap_region_par_iterate_chunked(&blk,
+                                                             worker_id,
+                                                             _thread_num,
+                                                             HeapRegion::ParInspectClaimValue);
+  }
+};
+
+ParallelObjectIterator* G1CollectedHeap::parallel_object_iterator(uint thread_num) {
+  assert(check_heap_region_claim_values(HeapRegion::InitialClaimValue),
+         "sanity check");
+  return new G1ParallelObjectIterator(thread_num);
+}
+
 // Calls a SpaceClosure on a HeapRegion.
 
 class SpaceClosureRegionClosure: public HeapRegionClosure {
@@ -2913,8 +2951,73 @@ size_t G1CollectedHeap::max_capacity() const {
 }
 
 jlong G1CollectedHeap::millis_since_last_gc() {
-  // assert(false, "NYI");
-  return 0;
+  return (os::javaTimeNanos() - _time_of_last_gc_ns) / NANOSECS_PER_MILLISEC;
+}
+
+bool G1CollectedHeap::should_do_periodic_collection() {
+  if (G1PeriodicGCInterval == 0) {
+    return false;
+  }
+
+  // A concurrent cycle in progress reclaims memory already.
+  if (concurrent_mark()->cmThread()->during_cycle()) {
+    return false;
+  }
+
+  if (millis_since_last_gc() < (jlong) G1PeriodicGCInterval) {
+    return false;
+  }
+
+  // The system is busy with other work, so this JVM is not idle alone.
+  if (G1PeriodicGCSystemLoadThreshold > 0) {
+    double recent_load;
+    if (os::loadavg(&recent_load, 1) == 1 &&
+        recent_load > (double) G1PeriodicGCSystemLoadThreshold) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void G1CollectedHeap::do_periodic_collection() {
+  assert(Thread::current()->is_Java_thread(), "GC operations need a Java thread");
+  ergo_verbose1(ErgoHeapSizing,
+                "request periodic collection",
+                ergo_format_reason("no collection in the periodic interval")
+                ergo_format_ms("interval"),
+                (double) G1PeriodicGCInterval);
+  collect(GCCause::_g1_periodic_collection);
+}
+
+void G1CollectedHeap::shrink_after_periodic_collection() {
+  // Regions freed by a cleanup may still be on their way to the free list.
+  if (free_regions_coming()) {
+    return;
+  }
+
+  const size_t used_after_gc = used();
+  const size_t capacity_after_gc = capacity();
+  const double minimum_used_percentage = 1.0 - (double) MaxHeapFreeRatio / 100.0;
+  const size_t min_heap_size = collector_policy()->min_heap_byte_size();
+  const size_t max_heap_size = collector_policy()->max_heap_byte_size();
+
+  double maximum_desired_capacity_d = (double) used_after_gc / minimum_used_percentage;
+  maximum_desired_capacity_d = MIN2(maximum_desired_capacity_d, (double) max_heap_size);
+  size_t maximum_desired_capacity = MAX2((size_t) maximum_desired_capacity_d, min_heap_size);
+
+  if (capacity_after_gc > maximum_desired_capacity) {
+    size_t shrink_bytes = capacity_after_gc - maximum_desired_capacity;
+    ergo_verbose4(ErgoHeapSizing,
+                  "attempt heap shrinking",
+                  ergo_format_reason("capacity higher than "
+                                     "max desired capacity after periodic GC")
+                  ergo_format_byte("capacity")
+                  ergo_format_byte("occupancy")
+                  ergo_format_byte_perc("max desired capacity"),
+                  capacity_after_gc, used_after_gc,
+                  maximum_desired_capacity, (double) MaxHeapFreeRatio);
+    shrink(shrink_bytes);
+  }
 }
 
 void G1CollectedHeap::prepare_for_verify() {
@@ -3341,9 +3444,9 @@ void G1CollectedHeap::verify(bool silent, VerifyOption vo) {
     if (!silent) gclog_or_tty->print("RemSet ");
     rem_set()->verify();
 
-    if (G1StringDedup::is_enabled()) {
+    if (StringDedup::is_enabled()) {
       if (!silent) gclog_or_tty->print("StrDedup ");
-      G1StringDedup::verify();
+      StringDedup::verify();
     }
 
     if (failures) {
@@ -3365,7 +3468,7 @@ void G1CollectedHeap::verify(bool silent, VerifyOption vo) {
   } else {
     if (!silent) {
       gclog_or_tty->print("(SKIPPING Roots, HeapRegionSets, HeapRegions, RemSet");
-      if (G1StringDedup::is_enabled()) {
+      if (StringDedup::is_enabled()) {
         gclog_or_tty->print(", StrDedup");
       }
       gclog_or_tty->print(") ");
@@ -3485,8 +3588,8 @@ void G1CollectedHeap::print_gc_threads_on(outputStream* st) const {
   st->cr();
   _cm->print_worker_threads_on(st);
   _cg1r->print_worker_threads_on(st);
-  if (G1StringDedup::is_enabled()) {
-    G1StringDedup::print_worker_threads_on(st);
+  if (StringDedup::is_enabled()) {
+    StringDedup::print_worker_threads_on(st);
   }
 }
 
@@ -3496,8 +3599,8 @@ void G1CollectedHeap::gc_threads_do(ThreadClosure* tc) const {
   }
   tc->do_thread(_cmThread);
   _cg1r->threads_do(tc);
-  if (G1StringDedup::is_enabled()) {
-    G1StringDedup::threads_do(tc);
+  if (StringDedup::is_enabled()) {
+    StringDedup::threads_do(tc);
   }
 }
 
@@ -3606,6 +3709,8 @@ void G1CollectedHeap::gc_epilogue(bool full) {
   resize_all_tlabs();
   allocation_context_stats().update(full);
 
+  _time_of_last_gc_ns = os::javaTimeNanos();
+
   // We have just completed a GC. Update the soft reference
   // policy with the new heap occupancy
   Universe::update_heap_info_at_gc();
@@ -4178,6 +4283,11 @@ G1CollectedHeap::do_collection_pause_at_safepoint(double target_pause_time_ms) {
 
         allocate_dummy_regions();
 
+        if (gc_cause() == GCCause::_g1_periodic_collection) {
+          // Uncommit the free regions before a new eden region is taken.
+          shrink_after_periodic_collection();
+        }
+
 #if YOUNG_LIST_VERBOSE
         gclog_or_tty->print_cr("\nEnd of the pause.\nYoung_list:");
         _young_list->print();
@@ -5159,8 +5269,8 @@ void G1CollectedHeap::unlink_string_and_symbol_table(BoolObjectClosure* is_alive
     }
   }
 
-  if (G1StringDedup::is_enabled()) {
-    G1StringDedup::unlink(is_alive);
+  if (StringDedup::is_enabled()) {
+    StringDedup::unlink(is_alive);
   }
 }
 
@@ -5714,6 +5824,32 @@ void G1CollectedHeap::enqueue_discovered_references(uint no_of_gc_workers) {
   g1_policy()->phase_times()->record_ref_enq_time(ref_enq_time * 1000.0);
 }
 
+// Task for the parallel string deduplication queue and table fixup at the
+// end of an evacuation pause, timing the two parts separately.
+class G1StringDedupUnlinkOrOopsDoTask : public AbstractGangTask {
+private:
+  StringDedupUnlinkOrOopsDoClosure _cl;
+  G1GCPhaseTimes* _phase_times;
+
+public:
+  G1StringDedupUnlinkOrOopsDoTask(BoolObjectClosure* is_alive,
+                                  OopClosure* keep_alive,
+                                  G1GCPhaseTimes* phase_times) :
+    AbstractGangTask("G1StringDedupUnlinkOrOopsDoTask"),
+    _cl(is_alive, keep_alive, true /* allow_resize_and_rehash */), _phase_times(phase_times) { }
+
+  virtual void work(uint worker_id) {
+    {
+      G1GCParPhaseTimesTracker x(_phase_times, G1GCPhaseTimes::StringDedupQueueFixup, worker_id);
+      StringDedupQueue::unlink_or_oops_do(&_cl);
+    }
+    {
+      G1GCParPhaseTimesTracker x(_phase_times, G1GCPhaseTimes::StringDedupTableFixup, worker_id);
+      StringDedupTable::unlink_or_oops_do(&_cl, worker_id);
+    }
+  }
+};
+
 void G1CollectedHeap::evacuate_collection_set(EvacuationInfo& evacuation_info) {
   _expand_heap_after_alloc_failure = true;
   _evacuation_failed = false;
@@ -5801,12 +5937,19 @@ void G1CollectedHeap::evacuate_collection_set(EvacuationInfo& evacuation_info) {
   // not copied during the pause.
   process_discovered_references(n_workers);
 
-  if (G1StringDedup::is_enabled()) {
+  if (StringDedup::is_enabled()) {
     double fixup_start = os::elapsedTime();
 
     G1STWIsAliveClosure is_alive(this);
     G1KeepAliveClosure keep_alive(this);
-    G1StringDedup::unlink_or_oops_do(&is_alive, &keep_alive, true, phase_times);
+    G1StringDedupUnlinkOrOopsDoTask task(&is_alive, &keep_alive, phase_times);
+    if (G1CollectedHeap::use_parallel_gc_threads()) {
+      set_par_threads(n_workers);
+      workers()->run_task(&task);
+      set_par_threads(0);
+    } else {
+      task.work(0);
+    }
 
     double fixup_time_ms = (os::elapsedTime() - fixup_start) * 1000.0;
     phase_times->record_string_dedup_fixup_time(fixup_time_ms);
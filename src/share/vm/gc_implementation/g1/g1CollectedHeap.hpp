@@ -996,6 +996,12 @@ protected:
 
   volatile bool _free_regions_coming;
 
+  // The time (in ns) the last young, mixed or full collection ended.
+  jlong _time_of_last_gc_ns;
+
+  // Shrink the heap with MaxHeapFreeRatio after a periodic collection.
+  void shrink_after_periodic_collection();
+
 public:
 
   void set_refine_cte_cl_concurrency(bool concurrent);
@@ -1215,6 +1221,12 @@ public:
   // The same as above but assume that the caller holds the Heap_lock.
   void collect_locked(GCCause::Cause cause);
 
+  // Periodic collections give the memory of free regions back to the OS
+  // after the application has been idle for G1PeriodicGCInterval ms.
+  virtual jlong periodic_collection_interval() const { return (jlong) G1PeriodicGCInterval; }
+  virtual bool should_do_periodic_collection();
+  virtual void do_periodic_collection();
+
   virtual bool copy_allocation_context_stats(const jint* contexts,
                                              jlong* totals,
                                              jbyte* accuracy,
@@ -1288,6 +1300,12 @@ public:
     object_iterate(cl);
   }
 
+  // Parallel object iteration at a safepoint: the workers claim chunks
+  // of regions.
+  virtual uint safepoint_workers_count();
+  virtual void run_task(AbstractGangTask* task);
+  virtual ParallelObjectIterator* parallel_object_iterator(uint thread_num);
+
   // Iterate over all spaces in use in the heap, in ascending address order.
   virtual void space_iterate(SpaceClosure* cl);
 
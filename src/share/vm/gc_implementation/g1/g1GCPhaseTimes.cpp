@@ -26,7 +26,7 @@
 #include "gc_implementation/g1/g1CollectedHeap.inline.hpp"
 #include "gc_implementation/g1/g1GCPhaseTimes.hpp"
 #include "gc_implementation/g1/g1Log.hpp"
-#include "gc_implementation/g1/g1StringDedup.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "memory/allocation.hpp"
 #include "runtime/os.hpp"
 
@@ -299,8 +299,8 @@ void G1GCPhaseTimes::note_gc_start(uint active_gc_threads, bool mark_in_progress
     _gc_par_phases[i]->reset();
   }
 
-  _gc_par_phases[StringDedupQueueFixup]->set_enabled(G1StringDedup::is_enabled());
-  _gc_par_phases[StringDedupTableFixup]->set_enabled(G1StringDedup::is_enabled());
+  _gc_par_phases[StringDedupQueueFixup]->set_enabled(StringDedup::is_enabled());
+  _gc_par_phases[StringDedupTableFixup]->set_enabled(StringDedup::is_enabled());
 }
 
 void G1GCPhaseTimes::note_gc_end() {
@@ -350,7 +350,7 @@ double G1GCPhaseTimes::accounted_time_ms() {
     // Strong code root purge time
     misc_time_ms += _cur_strong_code_root_purge_time_ms;
 
-    if (G1StringDedup::is_enabled()) {
+    if (StringDedup::is_enabled()) {
       // String dedup fixup time
       misc_time_ms += _cur_string_dedup_fixup_time_ms;
     }
@@ -523,7 +523,7 @@ void G1GCPhaseTimes::print(double pause_time_sec) {
 
   print_stats(1, "Code Root Fixup", _cur_collection_code_root_fixup_time_ms);
   print_stats(1, "Code Root Purge", _cur_strong_code_root_purge_time_ms);
-  if (G1StringDedup::is_enabled()) {
+  if (StringDedup::is_enabled()) {
     print_stats(1, "String Dedup Fixup", _cur_string_dedup_fixup_time_ms, _active_gc_threads);
     for (int i = StringDedupPhasesFirst; i <= StringDedupPhasesLast; i++) {
       par_phase_printer.print((GCParPhases) i);
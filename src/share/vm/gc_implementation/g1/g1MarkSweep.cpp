@@ -32,29 +32,37 @@
 #include "gc_implementation/g1/g1Log.hpp"
 #include "gc_implementation/g1/g1MarkSweep.hpp"
 #include "gc_implementation/g1/g1RootProcessor.hpp"
-#include "gc_implementation/g1/g1StringDedup.hpp"
+#include "gc_implementation/shared/adaptiveSizePolicy.hpp"
 #include "gc_implementation/shared/gcHeapSummary.hpp"
 #include "gc_implementation/shared/gcTimer.hpp"
 #include "gc_implementation/shared/gcTrace.hpp"
 #include "gc_implementation/shared/gcTraceTime.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "memory/gcLocker.hpp"
 #include "memory/genCollectedHeap.hpp"
+#include "memory/iterator.inline.hpp"
 #include "memory/modRefBarrierSet.hpp"
 #include "memory/referencePolicy.hpp"
 #include "memory/space.hpp"
 #include "oops/instanceRefKlass.hpp"
+#include "oops/markOop.inline.hpp"
 #include "oops/oop.inline.hpp"
 #include "prims/jvmtiExport.hpp"
 #include "runtime/biasedLocking.hpp"
+#include "runtime/dsu.hpp"
 #include "runtime/fprofiler.hpp"
 #include "runtime/synchronizer.hpp"
 #include "runtime/thread.hpp"
 #include "runtime/vmThread.hpp"
 #include "utilities/copy.hpp"
 #include "utilities/events.hpp"
+#include "utilities/workgroup.hpp"
 
 class HeapRegion;
 
+uint                    G1MarkSweep::_active_workers = 0;
+G1FullGCWorkerRegions** G1MarkSweep::_worker_regions = NULL;
+
 void G1MarkSweep::invoke_at_safepoint(ReferenceProcessor* rp,
                                       bool clear_all_softrefs) {
   assert(SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
@@ -73,6 +81,8 @@ void G1MarkSweep::invoke_at_safepoint(ReferenceProcessor* rp,
   GenMarkSweep::_ref_processor = rp;
   rp->setup_policy(clear_all_softrefs);
 
+  _active_workers = calc_active_workers();
+
   // When collecting the permanent generation Method*s may be moving,
   // so we either have to flush all bcp data or convert it into bci.
   CodeCache::gc_prologue();
@@ -112,6 +122,27 @@ void G1MarkSweep::invoke_at_safepoint(ReferenceProcessor* rp,
 
   // refs processing: clean slate
   GenMarkSweep::_ref_processor = NULL;
+  _active_workers = 0;
+}
+
+uint G1MarkSweep::calc_active_workers() {
+  // String deduplication enqueues its candidates from the serial marking.
+  if (!G1ParallelFullGC ||
+      !G1CollectedHeap::use_parallel_gc_threads() ||
+      StringDedup::is_enabled()) {
+    return 0;
+  }
+
+  FlexibleWorkGang* workers = G1CollectedHeap::heap()->workers();
+  uint n_workers =
+    AdaptiveSizePolicy::calc_active_workers(workers->total_workers(),
+                                            workers->active_workers(),
+                                            Threads::number_of_non_daemon_threads());
+  if (n_workers < 2) {
+    return 0;
+  }
+  workers->set_active_workers(n_workers);
+  return n_workers;
 }
 
 
@@ -132,8 +163,10 @@ void G1MarkSweep::mark_sweep_phase1(bool& marked_for_unloading,
   // Need cleared claim bits for the roots processing
   ClassLoaderDataGraph::clear_claimed_marks();
 
-  MarkingCodeBlobClosure follow_code_closure(&GenMarkSweep::follow_root_closure, !CodeBlobToOopClosure::FixRelocations);
-  {
+  if (_active_workers > 0) {
+    mark_roots_par();
+  } else {
+    MarkingCodeBlobClosure follow_code_closure(&GenMarkSweep::follow_root_closure, !CodeBlobToOopClosure::FixRelocations);
     G1RootProcessor root_processor(g1h);
     root_processor.process_strong_roots(&GenMarkSweep::follow_root_closure,
                                         &GenMarkSweep::follow_cld_closure,
@@ -207,7 +240,11 @@ void G1MarkSweep::mark_sweep_phase2() {
   GCTraceTime tm("phase 2", G1Log::fine() && Verbose, true, gc_timer(), gc_tracer()->gc_id());
   GenMarkSweep::trace("2");
 
-  prepare_compaction();
+  if (_active_workers > 0) {
+    prepare_compaction_par();
+  } else {
+    prepare_compaction();
+  }
 }
 
 class G1AdjustPointersClosure: public HeapRegionClosure {
@@ -244,8 +281,11 @@ void G1MarkSweep::mark_sweep_phase3() {
   // Need cleared claim bits for the roots processing
   ClassLoaderDataGraph::clear_claimed_marks();
 
-  CodeBlobToOopClosure adjust_code_closure(&GenMarkSweep::adjust_pointer_closure, CodeBlobToOopClosure::FixRelocations);
-  {
+  if (_active_workers > 0) {
+    // Adjusts the strong roots and the heap regions.
+    adjust_pointers_par();
+  } else {
+    CodeBlobToOopClosure adjust_code_closure(&GenMarkSweep::adjust_pointer_closure, CodeBlobToOopClosure::FixRelocations);
     G1RootProcessor root_processor(g1h);
     root_processor.process_all_roots(&GenMarkSweep::adjust_pointer_closure,
                                      &GenMarkSweep::adjust_cld_closure,
@@ -259,14 +299,16 @@ void G1MarkSweep::mark_sweep_phase3() {
   // have been cleared if they pointed to non-surviving objects.)
   JNIHandles::weak_oops_do(&always_true, &GenMarkSweep::adjust_pointer_closure);
 
-  if (G1StringDedup::is_enabled()) {
-    G1StringDedup::oops_do(&GenMarkSweep::adjust_pointer_closure);
+  if (StringDedup::is_enabled()) {
+    StringDedup::oops_do(&GenMarkSweep::adjust_pointer_closure);
   }
 
   GenMarkSweep::adjust_marks();
 
-  G1AdjustPointersClosure blk;
-  g1h->heap_region_iterate(&blk);
+  if (_active_workers == 0) {
+    G1AdjustPointersClosure blk;
+    g1h->heap_region_iterate(&blk);
+  }
 }
 
 class G1SpaceCompactClosure: public HeapRegionClosure {
@@ -303,9 +345,12 @@ void G1MarkSweep::mark_sweep_phase4() {
   GCTraceTime tm("phase 4", G1Log::fine() && Verbose, true, gc_timer(), gc_tracer()->gc_id());
   GenMarkSweep::trace("4");
 
-  G1SpaceCompactClosure blk;
-  g1h->heap_region_iterate(&blk);
-
+  if (_active_workers > 0) {
+    compact_par();
+  } else {
+    G1SpaceCompactClosure blk;
+    g1h->heap_region_iterate(&blk);
+  }
 }
 
 void G1MarkSweep::prepare_compaction_work(G1PrepareCompactClosure* blk) {
@@ -324,7 +369,10 @@ void G1PrepareCompactClosure::free_humongous_region(HeapRegion* hr) {
   hr->set_containing_set(NULL);
   _humongous_regions_removed.increment(1u, hr->capacity());
 
-  _g1h->free_humongous_region(hr, &dummy_free_list, false /* par */);
+  // When workers claim regions in parallel, the claim values must survive
+  // until all regions are claimed. The remembered sets of the freed
+  // regions are cleared after the collection like those of all regions.
+  _g1h->free_humongous_region(hr, &dummy_free_list, _par);
   prepare_for_compaction(hr, end);
   dummy_free_list.remove_all();
 }
@@ -372,3 +420,306 @@ bool G1PrepareCompactClosure::doHeapRegion(HeapRegion* hr) {
   }
   return false;
 }
+
+// Parallel full collection
+
+template <class T> inline void G1FullGCMarkClosure::do_oop_work(T* p) {
+  _marker->mark_and_push(p);
+}
+
+void G1FullGCMarkClosure::do_oop(oop* p)       { do_oop_work(p); }
+void G1FullGCMarkClosure::do_oop(narrowOop* p) { do_oop_work(p); }
+
+G1FullGCMarker::G1FullGCMarker(uint worker_id, OopQueueSet* queues,
+                               ReferenceProcessor* rp) :
+  _worker_id(worker_id),
+  _oop_queues(queues),
+  _hash_seed(17),
+  _mark_closure(this, rp),
+  _cld_closure(&_mark_closure) {
+  _oop_queue.initialize();
+}
+
+// Claim an object by installing the marked mark word. Only the worker
+// that wins the race preserves the old mark and follows the object.
+bool G1FullGCMarker::mark_object(oop obj) {
+  markOop mark = obj->mark();
+  while (!mark->is_marked()) {
+    markOop cur = obj->cas_set_mark(markOopDesc::prototype()->set_marked(), mark);
+    if (cur == mark) {
+      if (mark->must_be_preserved(obj)) {
+        _preserved_oop_stack.push(obj);
+        _preserved_mark_stack.push(mark);
+      }
+      if (DSUStaleInstances::is_enabled()) {
+        DSUStaleInstances::enqueue(obj);
+      }
+      return true;
+    }
+    mark = cur;
+  }
+  return false;
+}
+
+template <class T> inline void G1FullGCMarker::mark_and_push(T* p) {
+  T heap_oop = oopDesc::load_heap_oop(p);
+  if (!oopDesc::is_null(heap_oop)) {
+    oop obj = oopDesc::decode_heap_oop_not_null(heap_oop);
+    markOop mark = obj->mark();
+    if (mark->is_mixed_object()) {
+      // The worker marking the phantom object merges the mixed object.
+      oop phantom_object = oop(mark->decode_phantom_object_pointer());
+      if (mark_object(phantom_object)) {
+        Javelus::merge_mixed_object(obj, phantom_object);
+        _oop_queue.push(phantom_object);
+      }
+    } else if (mark_object(obj)) {
+      _oop_queue.push(obj);
+    }
+  }
+}
+
+void G1FullGCMarker::drain_stack() {
+  oop obj;
+  do {
+    // Drain the overflow stack first, so other workers can steal
+    // from the queue while we work.
+    while (_oop_queue.pop_overflow(obj)) {
+      obj->oop_iterate(&_mark_closure);
+    }
+    while (_oop_queue.pop_local(obj)) {
+      obj->oop_iterate(&_mark_closure);
+    }
+  } while (!_oop_queue.is_empty());
+}
+
+void G1FullGCMarker::complete_marking(ParallelTaskTerminator* terminator) {
+  do {
+    drain_stack();
+    oop obj;
+    while (_oop_queues->steal(_worker_id, &_hash_seed, obj)) {
+      obj->oop_iterate(&_mark_closure);
+      drain_stack();
+    }
+  } while (!terminator->offer_termination());
+}
+
+void G1FullGCMarker::flush_preserved_marks() {
+  assert(_preserved_oop_stack.size() == _preserved_mark_stack.size(),
+         "inconsistent preserved oop stacks");
+  while (!_preserved_oop_stack.is_empty()) {
+    MarkSweep::preserve_mark(_preserved_oop_stack.pop(), _preserved_mark_stack.pop());
+  }
+}
+
+class G1FullGCMarkTask : public AbstractGangTask {
+  G1RootProcessor*        _root_processor;
+  G1FullGCMarker**        _markers;
+  ParallelTaskTerminator  _terminator;
+
+ public:
+  G1FullGCMarkTask(G1RootProcessor* root_processor, G1FullGCMarker** markers,
+                   uint n_workers, G1FullGCMarker::OopQueueSet* queues) :
+    AbstractGangTask("G1 Full GC Mark"),
+    _root_processor(root_processor),
+    _markers(markers),
+    _terminator(n_workers, queues) { }
+
+  void work(uint worker_id) {
+    G1FullGCMarker* marker = _markers[worker_id];
+    {
+      MarkingCodeBlobClosure follow_code_closure(marker->mark_closure(), !CodeBlobToOopClosure::FixRelocations);
+      _root_processor->process_strong_roots(marker->mark_closure(),
+                                            marker->cld_closure(),
+                                            &follow_code_closure);
+    }
+    marker->complete_marking(&_terminator);
+  }
+};
+
+void G1MarkSweep::mark_roots_par() {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  ReferenceProcessor* rp = GenMarkSweep::ref_processor();
+  uint n_workers = _active_workers;
+
+  // Let each worker discover references into its own list.
+  ReferenceProcessorMTDiscoveryMutator rp_disc_mt(rp, true);
+
+  G1FullGCMarker::OopQueueSet queues(n_workers);
+  G1FullGCMarker** markers = NEW_C_HEAP_ARRAY(G1FullGCMarker*, n_workers, mtGC);
+  for (uint i = 0; i < n_workers; i++) {
+    markers[i] = new G1FullGCMarker(i, &queues, rp);
+    queues.register_queue(i, markers[i]->oop_queue());
+  }
+
+  {
+    G1RootProcessor root_processor(g1h);
+    root_processor.set_num_workers(n_workers);
+    G1FullGCMarkTask task(&root_processor, markers, n_workers, &queues);
+    g1h->set_par_threads(n_workers);
+    g1h->workers()->run_task(&task);
+    g1h->set_par_threads(0);
+  }
+
+  for (uint i = 0; i < n_workers; i++) {
+    markers[i]->flush_preserved_marks();
+    delete markers[i];
+  }
+  FREE_C_HEAP_ARRAY(G1FullGCMarker*, markers, mtGC);
+}
+
+void G1FullGCWorkerRegions::add_compaction_region(HeapRegion* hr) {
+  // Link the regions so the compaction point moves on to the next
+  // region of the same worker when one is full.
+  if (_compaction_regions.is_nonempty()) {
+    _compaction_regions.top()->set_next_compaction_space(hr);
+  }
+  _compaction_regions.append(hr);
+}
+
+void G1FullGCWorkerRegions::compact() {
+  for (int i = 0; i < _compaction_regions.length(); i++) {
+    HeapRegion* hr = _compaction_regions.at(i);
+    hr->compact();
+    hr->set_next_compaction_space(NULL);
+  }
+  for (int i = 0; i < _humongous_regions.length(); i++) {
+    HeapRegion* hr = _humongous_regions.at(i);
+    oop(hr->bottom())->init_mark();
+    hr->reset_during_compaction();
+  }
+}
+
+void G1ParPrepareCompactClosure::prepare_for_compaction(HeapRegion* hr, HeapWord* end) {
+  _regions->add_compaction_region(hr);
+  G1PrepareCompactClosure::prepare_for_compaction(hr, end);
+}
+
+bool G1ParPrepareCompactClosure::doHeapRegion(HeapRegion* hr) {
+  if (hr->startsHumongous()) {
+    if (oop(hr->bottom())->is_gc_marked()) {
+      _regions->add_humongous_region(hr);
+    } else {
+      // The continues humongous regions were claimed together with this
+      // region, so this worker also compacts into them once freed.
+      uint first_index = hr->hrm_index() + 1;
+      uint last_index = hr->last_hc_index();
+      G1PrepareCompactClosure::doHeapRegion(hr);
+      for (uint i = first_index; i < last_index; i++) {
+        HeapRegion* chr = _g1h->region_at(i);
+        prepare_for_compaction(chr, chr->end());
+      }
+      return false;
+    }
+  }
+  return G1PrepareCompactClosure::doHeapRegion(hr);
+}
+
+class G1FullGCPrepareTask : public AbstractGangTask {
+  G1FullGCWorkerRegions** _worker_regions;
+  uint                    _n_workers;
+
+ public:
+  G1FullGCPrepareTask(G1FullGCWorkerRegions** worker_regions, uint n_workers) :
+    AbstractGangTask("G1 Full GC Prepare"),
+    _worker_regions(worker_regions),
+    _n_workers(n_workers) { }
+
+  void work(uint worker_id) {
+    G1ParPrepareCompactClosure blk(_worker_regions[worker_id]);
+    G1CollectedHeap::heap()->heap_region_par_iterate_chunked(&blk,
+                                                             worker_id,
+                                                             _n_workers,
+                                                             HeapRegion::ParPrepareCompactClaimValue);
+    blk.update_sets();
+  }
+};
+
+void G1MarkSweep::prepare_compaction_par() {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  uint n_workers = _active_workers;
+
+  assert(_worker_regions == NULL, "no stomping");
+  _worker_regions = NEW_C_HEAP_ARRAY(G1FullGCWorkerRegions*, n_workers, mtGC);
+  for (uint i = 0; i < n_workers; i++) {
+    _worker_regions[i] = new G1FullGCWorkerRegions();
+  }
+
+  G1FullGCPrepareTask task(_worker_regions, n_workers);
+  g1h->set_par_threads(n_workers);
+  g1h->workers()->run_task(&task);
+  g1h->set_par_threads(0);
+  assert(g1h->check_heap_region_claim_values(HeapRegion::ParPrepareCompactClaimValue),
+         "sanity check");
+  g1h->reset_heap_region_claim_values();
+}
+
+class G1FullGCAdjustTask : public AbstractGangTask {
+  G1RootProcessor* _root_processor;
+  uint             _n_workers;
+
+ public:
+  G1FullGCAdjustTask(G1RootProcessor* root_processor, uint n_workers) :
+    AbstractGangTask("G1 Full GC Adjust"),
+    _root_processor(root_processor),
+    _n_workers(n_workers) { }
+
+  void work(uint worker_id) {
+    {
+      CodeBlobToOopClosure adjust_code_closure(&GenMarkSweep::adjust_pointer_closure, CodeBlobToOopClosure::FixRelocations);
+      _root_processor->process_all_roots(&GenMarkSweep::adjust_pointer_closure,
+                                         &GenMarkSweep::adjust_cld_closure,
+                                         &adjust_code_closure);
+    }
+
+    G1AdjustPointersClosure blk;
+    G1CollectedHeap::heap()->heap_region_par_iterate_chunked(&blk,
+                                                             worker_id,
+                                                             _n_workers,
+                                                             HeapRegion::ParAdjustPointersClaimValue);
+  }
+};
+
+void G1MarkSweep::adjust_pointers_par() {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  uint n_workers = _active_workers;
+
+  G1RootProcessor root_processor(g1h);
+  root_processor.set_num_workers(n_workers);
+  G1FullGCAdjustTask task(&root_processor, n_workers);
+  g1h->set_par_threads(n_workers);
+  g1h->workers()->run_task(&task);
+  g1h->set_par_threads(0);
+  assert(g1h->check_heap_region_claim_values(HeapRegion::ParAdjustPointersClaimValue),
+         "sanity check");
+  g1h->reset_heap_region_claim_values();
+}
+
+class G1FullGCCompactTask : public AbstractGangTask {
+  G1FullGCWorkerRegions** _worker_regions;
+
+ public:
+  G1FullGCCompactTask(G1FullGCWorkerRegions** worker_regions) :
+    AbstractGangTask("G1 Full GC Compact"),
+    _worker_regions(worker_regions) { }
+
+  void work(uint worker_id) {
+    _worker_regions[worker_id]->compact();
+  }
+};
+
+void G1MarkSweep::compact_par() {
+  G1CollectedHeap* g1h = G1CollectedHeap::heap();
+  uint n_workers = _active_workers;
+
+  G1FullGCCompactTask task(_worker_regions);
+  g1h->set_par_threads(n_workers);
+  g1h->workers()->run_task(&task);
+  g1h->set_par_threads(0);
+
+  for (uint i = 0; i < n_workers; i++) {
+    delete _worker_regions[i];
+  }
+  FREE_C_HEAP_ARRAY(G1FullGCWorkerRegions*, _worker_regions, mtGC);
+  _worker_regions = NULL;
+}
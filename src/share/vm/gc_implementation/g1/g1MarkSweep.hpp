@@ -29,11 +29,14 @@
 #include "gc_implementation/g1/heapRegion.hpp"
 #include "memory/genMarkSweep.hpp"
 #include "memory/generation.hpp"
+#include "memory/iterator.hpp"
 #include "memory/universe.hpp"
 #include "oops/markOop.hpp"
 #include "oops/oop.hpp"
 #include "runtime/timer.hpp"
 #include "utilities/growableArray.hpp"
+#include "utilities/stack.hpp"
+#include "utilities/taskqueue.hpp"
 
 class ReferenceProcessor;
 
@@ -44,6 +47,7 @@ class ReferenceProcessor;
 //
 // Class unloading will only occur when a full gc is invoked.
 class G1PrepareCompactClosure;
+class G1FullGCWorkerRegions;
 
 class G1MarkSweep : AllStatic {
   friend class VM_G1MarkSweep;
@@ -58,6 +62,13 @@ class G1MarkSweep : AllStatic {
   static SerialOldTracer* gc_tracer() { return GenMarkSweep::_gc_tracer; }
 
  private:
+  // Number of workers running the phases in parallel, zero when the
+  // collection runs serially on the VM thread.
+  static uint _active_workers;
+  // The regions each worker forwarded objects into during phase 2.
+  static G1FullGCWorkerRegions** _worker_regions;
+
+  static uint calc_active_workers();
 
   // Mark live objects
   static void mark_sweep_phase1(bool& marked_for_deopt,
@@ -72,6 +83,66 @@ class G1MarkSweep : AllStatic {
   static void allocate_stacks();
   static void prepare_compaction();
   static void prepare_compaction_work(G1PrepareCompactClosure* blk);
+
+  // Parallel variants of the phases using the G1 work gang
+  static void mark_roots_par();
+  static void prepare_compaction_par();
+  static void adjust_pointers_par();
+  static void compact_par();
+};
+
+class G1FullGCMarker;
+
+// Marks and pushes the objects referenced by a root or by an object
+// during the parallel marking of a full collection.
+class G1FullGCMarkClosure : public MetadataAwareOopClosure {
+  G1FullGCMarker* _marker;
+
+  template <class T> inline void do_oop_work(T* p);
+
+ public:
+  G1FullGCMarkClosure(G1FullGCMarker* marker, ReferenceProcessor* rp) :
+    MetadataAwareOopClosure(rp), _marker(marker) { }
+
+  virtual void do_oop(oop* p);
+  virtual void do_oop(narrowOop* p);
+};
+
+// Per-worker marking state of the parallel full collection. Objects are
+// marked in their mark words as the serial MarkSweep does, so reference
+// processing and the later phases can still use the MarkSweep closures.
+class G1FullGCMarker : public CHeapObj<mtGC> {
+ public:
+  typedef OverflowTaskQueue<oop, mtGC>        OopQueue;
+  typedef GenericTaskQueueSet<OopQueue, mtGC> OopQueueSet;
+
+ private:
+  uint                 _worker_id;
+  OopQueue             _oop_queue;
+  OopQueueSet*         _oop_queues;
+  int                  _hash_seed;
+  G1FullGCMarkClosure  _mark_closure;
+  CLDToOopClosure      _cld_closure;
+
+  // Marks saved here are handed over to MarkSweep after marking
+  Stack<oop, mtGC>     _preserved_oop_stack;
+  Stack<markOop, mtGC> _preserved_mark_stack;
+
+  bool mark_object(oop obj);
+  void drain_stack();
+
+ public:
+  G1FullGCMarker(uint worker_id, OopQueueSet* queues, ReferenceProcessor* rp);
+
+  OopQueue*            oop_queue()    { return &_oop_queue; }
+  G1FullGCMarkClosure* mark_closure() { return &_mark_closure; }
+  CLDToOopClosure*     cld_closure()  { return &_cld_closure; }
+
+  template <class T> inline void mark_and_push(T* p);
+
+  // Drain the own queue and steal from the others until all are empty
+  void complete_marking(ParallelTaskTerminator* terminator);
+  void flush_preserved_marks();
 };
 
 class G1PrepareCompactClosure : public HeapRegionClosure {
@@ -80,6 +151,8 @@ class G1PrepareCompactClosure : public HeapRegionClosure {
   ModRefBarrierSet* _mrbs;
   CompactPoint _cp;
   HeapRegionSetCount _humongous_regions_removed;
+  // Whether regions are claimed by parallel workers.
+  bool _par;
 
   virtual void prepare_for_compaction(HeapRegion* hr, HeapWord* end);
   void prepare_for_compaction_work(CompactPoint* cp, HeapRegion* hr, HeapWord* end);
@@ -87,13 +160,45 @@ class G1PrepareCompactClosure : public HeapRegionClosure {
   bool is_cp_initialized() const { return _cp.space != NULL; }
 
  public:
-  G1PrepareCompactClosure() :
+  G1PrepareCompactClosure(bool par = false) :
     _g1h(G1CollectedHeap::heap()),
     _mrbs(_g1h->g1_barrier_set()),
-    _humongous_regions_removed() { }
+    _humongous_regions_removed(),
+    _par(par) { }
 
   void update_sets();
   bool doHeapRegion(HeapRegion* hr);
 };
 
+// The regions one worker of the parallel full collection forwarded
+// objects into, in claim order. They are linked as compaction spaces so
+// objects only move into regions of the same worker, and the workers
+// compact their regions independently in phase 4.
+class G1FullGCWorkerRegions : public CHeapObj<mtGC> {
+  GrowableArray<HeapRegion*> _compaction_regions;
+  GrowableArray<HeapRegion*> _humongous_regions;
+
+ public:
+  G1FullGCWorkerRegions() :
+    _compaction_regions(16, true, mtGC),
+    _humongous_regions(4, true, mtGC) { }
+
+  void add_compaction_region(HeapRegion* hr);
+  void add_humongous_region(HeapRegion* hr) { _humongous_regions.append(hr); }
+  void compact();
+};
+
+class G1ParPrepareCompactClosure : public G1PrepareCompactClosure {
+  G1FullGCWorkerRegions* _regions;
+
+ protected:
+  virtual void prepare_for_compaction(HeapRegion* hr, HeapWord* end);
+
+ public:
+  G1ParPrepareCompactClosure(G1FullGCWorkerRegions* regions) :
+    G1PrepareCompactClosure(true /* par */), _regions(regions) { }
+
+  bool doHeapRegion(HeapRegion* hr);
+};
+
 #endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1MARKSWEEP_HPP
@@ -263,14 +263,14 @@ oop G1ParScanThreadState::copy_to_survivor_space(InCSetState const state,
       obj->set_mark(old_mark);
     }
 
-    if (G1StringDedup::is_enabled()) {
+    if (StringDedup::is_enabled()) {
       const bool is_from_young = state.is_young();
       const bool is_to_young = dest_state.is_young();
       assert(is_from_young == _g1h->heap_region_containing_raw(old)->is_young(),
              "sanity");
       assert(is_to_young == _g1h->heap_region_containing_raw(obj)->is_young(),
              "sanity");
-      G1StringDedup::enqueue_from_evacuation(is_from_young,
+      StringDedup::enqueue_from_evacuation(is_from_young,
                                              is_to_young,
                                              queue_num(),
                                              obj);
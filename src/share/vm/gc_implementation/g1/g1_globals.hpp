@@ -274,6 +274,23 @@
   product(uintx, G1MixedGCCountTarget, 8,                                   \
           "The target number of mixed GCs after a marking cycle.")          \
                                                                             \
+  product(bool, G1ParallelFullGC, false,                                    \
+          "Use the parallel GC threads for the marking, forwarding, "       \
+          "adjusting and compaction phases of a full GC.")                  \
+                                                                            \
+  product(uintx, G1PeriodicGCInterval, 0,                                   \
+          "Number of milliseconds without a collection after which the "    \
+          "service thread starts a periodic GC that uncommits free "        \
+          "regions. Zero disables periodic GCs.")                           \
+                                                                            \
+  product(bool, G1PeriodicGCInvokesConcurrent, true,                        \
+          "Start a concurrent cycle as periodic GC, otherwise do a young "  \
+          "GC.")                                                            \
+                                                                            \
+  product(uintx, G1PeriodicGCSystemLoadThreshold, 0,                        \
+          "Skip a periodic GC while the one minute system load average "    \
+          "is above this value. Zero disables the check.")                  \
+                                                                            \
   experimental(bool, G1EagerReclaimHumongousObjects, true,                  \
           "Try to reclaim dead large objects at every young GC.")           \
                                                                             \
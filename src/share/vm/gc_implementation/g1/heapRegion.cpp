@@ -304,6 +304,11 @@ void HeapRegion::initialize(MemRegion mr, bool clear_space, bool mangle_space) {
 }
 
 CompactibleSpace* HeapRegion::next_compaction_space() const {
+  // The parallel full collection links the regions of each worker.
+  CompactibleSpace* next = CompactibleSpace::next_compaction_space();
+  if (next != NULL) {
+    return next;
+  }
   return G1CollectedHeap::heap()->next_compaction_region(this);
 }
 
@@ -341,7 +341,10 @@ class HeapRegion: public G1OffsetTableContigSpace {
     ParEvacFailureClaimValue   = 6,
     AggregateCountClaimValue   = 7,
     VerifyCountClaimValue      = 8,
-    ParMarkRootClaimValue      = 9
+    ParMarkRootClaimValue      = 9,
+    ParPrepareCompactClaimValue = 10,
+    ParAdjustPointersClaimValue = 11,
+    ParInspectClaimValue       = 12
   };
 
   // All allocated blocks are occupied by objects in a HeapRegion
@@ -35,6 +35,7 @@
 #include "gc_implementation/shared/gcTraceTime.hpp"
 #include "gc_implementation/shared/parGCAllocBuffer.inline.hpp"
 #include "gc_implementation/shared/spaceDecorator.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "memory/defNewGeneration.inline.hpp"
 #include "memory/genCollectedHeap.hpp"
 #include "memory/genOopClosures.inline.hpp"
@@ -47,6 +48,7 @@
 #include "oops/objArrayOop.hpp"
 #include "oops/oop.inline.hpp"
 #include "oops/oop.pcgc.inline.hpp"
+#include "runtime/dsu.hpp"
 #include "runtime/handles.hpp"
 #include "runtime/handles.inline.hpp"
 #include "runtime/java.hpp"
@@ -1036,6 +1038,12 @@ void ParNewGeneration::collect(bool   full,
                                               _gc_timer, gc_tracer.gc_id());
   }
   gc_tracer.report_gc_reference_stats(stats);
+
+  if (StringDedup::is_enabled()) {
+    // Unlink dead deduplication candidates and update the ones that moved.
+    StringDedup::unlink_or_oops_do(&is_alive, &keep_alive, true /* allow_resize_and_rehash */);
+  }
+
   if (!promotion_failed()) {
     // Swap the survivor spaces.
     eden()->clear(SpaceDecorator::Mangle);
@@ -1246,6 +1254,17 @@ oop ParNewGeneration::copy_to_survivor_space_avoiding_promotion_undo(
 #endif
 
   if (forward_ptr == NULL) {
+    if (StringDedup::is_enabled() && new_obj != old) {
+      StringDedup::enqueue_from_evacuation(true /* from_young */,
+                                           is_in_reserved(new_obj),
+                                           par_scan_state->thread_num(),
+                                           new_obj);
+    }
+    if (DSUStaleInstances::is_enabled()) {
+      // Weak processing follows the forwarding pointer.
+      DSUStaleInstances::enqueue(old);
+    }
+
     oop obj_to_push = new_obj;
     if (par_scan_state->should_be_partially_scanned(obj_to_push, old)) {
       // Length field used as index of next element to be scanned.
@@ -1374,6 +1393,17 @@ oop ParNewGeneration::copy_to_survivor_space_with_undo(
   }
 
   if (forward_ptr == NULL) {
+    if (StringDedup::is_enabled() && new_obj != old) {
+      StringDedup::enqueue_from_evacuation(true /* from_young */,
+                                           is_in_reserved(new_obj),
+                                           par_scan_state->thread_num(),
+                                           new_obj);
+    }
+    if (DSUStaleInstances::is_enabled()) {
+      // Weak processing follows the forwarding pointer.
+      DSUStaleInstances::enqueue(old);
+    }
+
     oop obj_to_push = new_obj;
     if (par_scan_state->should_be_partially_scanned(obj_to_push, old)) {
       // Length field used as index of next element to be scanned.
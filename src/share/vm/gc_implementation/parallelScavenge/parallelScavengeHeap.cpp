@@ -37,13 +37,16 @@
 #include "gc_implementation/parallelScavenge/vmPSOperations.hpp"
 #include "gc_implementation/shared/gcHeapSummary.hpp"
 #include "gc_implementation/shared/gcWhen.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "memory/gcLocker.inline.hpp"
 #include "oops/oop.inline.hpp"
+#include "runtime/atomic.inline.hpp"
 #include "runtime/handles.inline.hpp"
 #include "runtime/java.hpp"
 #include "runtime/vmThread.hpp"
 #include "services/memTracker.hpp"
 #include "utilities/vmError.hpp"
+#include "utilities/workgroup.hpp"
 
 PSYoungGen*  ParallelScavengeHeap::_young_gen = NULL;
 PSOldGen*    ParallelScavengeHeap::_old_gen = NULL;
@@ -543,6 +546,76 @@ void ParallelScavengeHeap::object_iterate(ObjectClosure* cl) {
   old_gen()->object_iterate(cl);
 }
 
+// Runs a gang task on a GC task thread.
+class PSGangTaskProxy : public GCTask {
+  AbstractGangTask* _task;
+  uint              _work_id;
+public:
+  PSGangTaskProxy(AbstractGangTask* task, uint work_id)
+    : _task(task), _work_id(work_id) { }
+
+  virtual char* name() { return (char *)"gang-task-proxy"; }
+  virtual void do_it(GCTaskManager* manager, uint which) {
+    _task->work(_work_id);
+  }
+};
+
+uint ParallelScavengeHeap::safepoint_workers_count() {
+  return gc_task_manager()->active_workers();
+}
+
+void ParallelScavengeHeap::run_task(AbstractGangTask* task) {
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at a safepoint");
+  GCTaskQueue* q = GCTaskQueue::create();
+  GCTaskManager* manager = gc_task_manager();
+  for (uint i = 0; i < manager->active_workers(); i++) {
+    q->enqueue(new PSGangTaskProxy(task, i));
+  }
+  manager->execute_and_wait(q);
+}
+
+// The units of work are the young generation spaces, in the order
+// that PSYoungGen::object_iterate visits them, followed by the blocks
+// of the old generation.
+class PSParallelObjectIterator : public ParallelObjectIterator {
+  enum {
+    eden_unit,
+    from_unit,
+    to_unit,
+    num_young_units
+  };
+
+  volatile jint _next_unit;
+  jint          _num_units;
+
+public:
+  PSParallelObjectIterator() : _next_unit(0) {
+    ParallelScavengeHeap* heap = ParallelScavengeHeap::heap();
+    _num_units = num_young_units + (jint) heap->old_gen()->num_iterable_blocks();
+  }
+
+  virtual void object_iterate(ObjectClosure* cl, uint worker_id) {
+    ParallelScavengeHeap* heap = ParallelScavengeHeap::heap();
+    while (true) {
+      jint unit = Atomic::add(1, &_next_unit) - 1;
+      if (unit >= _num_units) {
+        break;
+      }
+      switch (unit) {
+        case eden_unit: heap->young_gen()->eden_space()->object_iterate(cl); break;
+        case from_unit: heap->young_gen()->from_space()->object_iterate(cl); break;
+        case to_unit:   heap->young_gen()->to_space()->object_iterate(cl);   break;
+        default:
+          heap->old_gen()->object_iterate_block(cl, unit - num_young_units);
+      }
+    }
+  }
+};
+
+ParallelObjectIterator* ParallelScavengeHeap::parallel_object_iterator(uint thread_num) {
+  return new PSParallelObjectIterator();
+}
+
 
 HeapWord* ParallelScavengeHeap::block_start(const void* addr) const {
   if (young_gen()->is_in_reserved(addr)) {
@@ -617,10 +690,16 @@ void ParallelScavengeHeap::print_on_error(outputStream* st) const {
 
 void ParallelScavengeHeap::gc_threads_do(ThreadClosure* tc) const {
   PSScavenge::gc_task_manager()->threads_do(tc);
+  if (StringDedup::is_enabled()) {
+    StringDedup::threads_do(tc);
+  }
 }
 
 void ParallelScavengeHeap::print_gc_threads_on(outputStream* st) const {
   PSScavenge::gc_task_manager()->print_threads_on(st);
+  if (StringDedup::is_enabled()) {
+    StringDedup::print_worker_threads_on(st);
+  }
 }
 
 void ParallelScavengeHeap::print_tracing_info() const {
@@ -209,6 +209,12 @@ class ParallelScavengeHeap : public CollectedHeap {
   void object_iterate(ObjectClosure* cl);
   void safe_object_iterate(ObjectClosure* cl) { object_iterate(cl); }
 
+  // Parallel object iteration at a safepoint: the GC task threads claim
+  // the young generation spaces and blocks of the old generation.
+  uint safepoint_workers_count();
+  void run_task(AbstractGangTask* task);
+  ParallelObjectIterator* parallel_object_iterator(uint thread_num);
+
   HeapWord* block_start(const void* addr) const;
   size_t block_size(const HeapWord* addr) const;
   bool block_is_obj(const HeapWord* addr) const;
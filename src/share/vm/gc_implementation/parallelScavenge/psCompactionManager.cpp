@@ -107,6 +107,7 @@ void ParCompactionManager::initialize(ParMarkBitMap* mbm) {
   for(uint i=0; i<parallel_gc_threads; i++) {
     _manager_array[i] = new ParCompactionManager();
     guarantee(_manager_array[i] != NULL, "Could not create ParCompactionManager");
+    _manager_array[i]->_worker_id = i;
     stack_array()->register_queue(i, _manager_array[i]->marking_stack());
     _objarray_queues->register_queue(i, &_manager_array[i]->_objarray_stack);
     region_array()->register_queue(i, region_list(i));
@@ -117,6 +118,7 @@ void ParCompactionManager::initialize(ParMarkBitMap* mbm) {
   _manager_array[parallel_gc_threads] = new ParCompactionManager();
   guarantee(_manager_array[parallel_gc_threads] != NULL,
     "Could not create ParCompactionManager");
+  _manager_array[parallel_gc_threads]->_worker_id = parallel_gc_threads;
   assert(PSParallelCompact::gc_task_manager()->workers() != 0,
     "Not initialized?");
 }
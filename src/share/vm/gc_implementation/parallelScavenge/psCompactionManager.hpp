@@ -114,6 +114,10 @@ private:
 
   Action _action;
 
+  // Index of this manager in _manager_array, also used as its
+  // string deduplication queue.
+  uint _worker_id;
+
   static PSOldGen* old_gen()             { return _old_gen; }
   static ObjectStartArray* start_array() { return _start_array; }
   static OopTaskQueueSet* stack_array()  { return _stack_array; }
@@ -147,6 +151,8 @@ private:
   uint region_stack_index() { return _region_stack_index; }
   void set_region_stack_index(uint v) { _region_stack_index = v; }
 
+  uint worker_id() const { return _worker_id; }
+
   // Pop and push unique reusable stack index
   static int pop_recycled_stack_index();
   static void push_recycled_stack_index(uint v);
@@ -447,6 +447,37 @@ void PSOldGen::print_on(outputStream* st) const {
   st->print("  object"); object_space()->print_on(st);
 }
 
+size_t PSOldGen::num_iterable_blocks() const {
+  return (object_space()->used_in_bytes() + IterateBlockSize - 1) / IterateBlockSize;
+}
+
+void PSOldGen::object_iterate_block(ObjectClosure* cl, size_t block_index) {
+  size_t block_word_size = IterateBlockSize / HeapWordSize;
+  assert((block_word_size % ObjectStartArray::block_size_in_words) == 0,
+         "Block size not a multiple of start_array block");
+
+  MutableSpace* space = object_space();
+
+  HeapWord* begin = space->bottom() + block_index * block_word_size;
+  HeapWord* end = MIN2(space->top(), begin + block_word_size);
+
+  if (!start_array()->object_starts_in_range(begin, end - 1)) {
+    return;
+  }
+
+  // Skip the object that reaches into this block from the previous one;
+  // the worker that claimed that block visits it.
+  HeapWord* start = start_array()->object_start(begin);
+  if (start < begin) {
+    start += oop(start)->size();
+  }
+  assert(start >= begin, "object must start in this block");
+
+  for (HeapWord* p = start; p < end; p += oop(p)->size()) {
+    cl->do_object(oop(p));
+  }
+}
+
 void PSOldGen::print_used_change(size_t prev_used) const {
   gclog_or_tty->print(" [%s:", name());
   gclog_or_tty->print(" "  SIZE_FORMAT "K"
@@ -170,6 +170,13 @@ class PSOldGen : public CHeapObj<mtGC> {
   void oop_iterate_no_header(OopClosure* cl) { object_space()->oop_iterate_no_header(cl); }
   void object_iterate(ObjectClosure* cl) { object_space()->object_iterate(cl); }
 
+  // Parallel iteration: the used part of the generation is divided into
+  // blocks of IterateBlockSize bytes, and object_iterate_block() visits
+  // the objects that start in one block.
+  static const size_t IterateBlockSize = 1024 * 1024;
+  size_t num_iterable_blocks() const;
+  void object_iterate_block(ObjectClosure* cl, size_t block_index);
+
   // Debugging - do not use for time critical operations
   virtual void print() const;
   virtual void print_on(outputStream* st) const;
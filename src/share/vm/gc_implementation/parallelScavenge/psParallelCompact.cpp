@@ -43,6 +43,7 @@
 #include "gc_implementation/shared/gcTrace.hpp"
 #include "gc_implementation/shared/gcTraceTime.hpp"
 #include "gc_implementation/shared/isGCActiveMark.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "gc_interface/gcCause.hpp"
 #include "memory/gcLocker.inline.hpp"
 #include "memory/referencePolicy.hpp"
@@ -2428,6 +2429,11 @@ void PSParallelCompact::marking_phase(ParCompactionManager* cm,
   // Delete entries for dead interned strings.
   StringTable::unlink(is_alive_closure());
 
+  // Delete dead string deduplication candidates and table entries.
+  if (StringDedup::is_enabled()) {
+    StringDedup::unlink(is_alive_closure());
+  }
+
   // Clean up unreferenced symbols in symbol table.
   SymbolTable::unlink();
   _gc_tracer.report_object_count_after_gc(is_alive_closure());
@@ -2475,6 +2481,9 @@ void PSParallelCompact::adjust_roots() {
   CodeBlobToOopClosure adjust_from_blobs(adjust_pointer_closure(), CodeBlobToOopClosure::FixRelocations);
   CodeCache::blobs_do(&adjust_from_blobs);
   StringTable::oops_do(adjust_pointer_closure());
+  if (StringDedup::is_enabled()) {
+    StringDedup::oops_do(adjust_pointer_closure());
+  }
   ref_processor()->weak_oops_do(adjust_pointer_closure());
   // Roots were visited so references into the young gen in roots
   // may have been scanned.  Process them also.
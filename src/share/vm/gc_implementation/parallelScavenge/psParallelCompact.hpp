@@ -31,6 +31,7 @@
 #include "gc_implementation/shared/collectorCounters.hpp"
 #include "gc_implementation/shared/markSweep.hpp"
 #include "gc_implementation/shared/mutableSpace.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "memory/sharedHeap.hpp"
 #include "oops/oop.hpp"
 
@@ -1346,6 +1347,9 @@ inline void PSParallelCompact::follow_root(ParCompactionManager* cm, T* p) {
     oop obj = oopDesc::decode_heap_oop_not_null(heap_oop);
     if (mark_bitmap()->is_unmarked(obj)) {
       if (mark_obj(obj)) {
+        if (StringDedup::is_enabled()) {
+          StringDedup::enqueue_from_mark(obj, cm->worker_id());
+        }
         obj->follow_contents(cm);
       }
     }
@@ -1359,6 +1363,9 @@ inline void PSParallelCompact::mark_and_push(ParCompactionManager* cm, T* p) {
   if (!oopDesc::is_null(heap_oop)) {
     oop obj = oopDesc::decode_heap_oop_not_null(heap_oop);
     if (mark_bitmap()->is_unmarked(obj) && mark_obj(obj)) {
+      if (StringDedup::is_enabled()) {
+        StringDedup::enqueue_from_mark(obj, cm->worker_id());
+      }
       cm->push(obj);
     }
   }
@@ -61,9 +61,11 @@ void PSPromotionManager::initialize() {
   // Create and register the PSPromotionManager(s) for the worker threads.
   for(uint i=0; i<ParallelGCThreads; i++) {
     stack_array_depth()->register_queue(i, _manager_array[i].claimed_stack_depth());
+    _manager_array[i]._worker_id = i;
   }
   // The VMThread gets its own PSPromotionManager, which is not available
   // for work stealing.
+  _manager_array[ParallelGCThreads]._worker_id = ParallelGCThreads;
 }
 
 PSPromotionManager* PSPromotionManager::gc_thread_promotion_manager(int index) {
@@ -91,6 +91,10 @@ class PSPromotionManager VALUE_OBJ_CLASS_SPEC {
 
   PromotionFailedInfo                 _promotion_failed_info;
 
+  // Index of this manager in _manager_array, also used as its
+  // string deduplication queue.
+  uint                                _worker_id;
+
   // Accessors
   static PSOldGen* old_gen()         { return _old_gen; }
   static MutableSpace* young_space() { return _young_space; }
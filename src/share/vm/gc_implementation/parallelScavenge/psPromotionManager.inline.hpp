@@ -29,6 +29,7 @@
 #include "gc_implementation/parallelScavenge/psPromotionManager.hpp"
 #include "gc_implementation/parallelScavenge/psPromotionLAB.inline.hpp"
 #include "gc_implementation/parallelScavenge/psScavenge.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "oops/oop.psgc.inline.hpp"
 
 inline PSPromotionManager* PSPromotionManager::manager_array(int index) {
@@ -183,6 +184,13 @@ oop PSPromotionManager::copy_to_survivor_space(oop o) {
         assert(young_space()->contains(new_obj), "Attempt to push non-promoted obj");
       }
 
+      if (StringDedup::is_enabled()) {
+        StringDedup::enqueue_from_evacuation(true /* from_young */,
+                                             !new_obj_is_tenured,
+                                             _worker_id,
+                                             new_obj);
+      }
+
       // Do the size comparison first with new_obj_size, which we
       // already have. Hopefully, only a few objects are larger than
       // _min_array_size_for_chunking, and most of them will be arrays.
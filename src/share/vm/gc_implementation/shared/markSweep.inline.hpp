@@ -31,18 +31,21 @@
 #include "utilities/macros.hpp"
 #include "runtime/dsu.hpp"
 #if INCLUDE_ALL_GCS
-#include "gc_implementation/g1/g1StringDedup.hpp"
 #include "gc_implementation/parallelScavenge/psParallelCompact.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #endif // INCLUDE_ALL_GCS
 
 inline void MarkSweep::mark_object(oop obj) {
 #if INCLUDE_ALL_GCS
-  if (G1StringDedup::is_enabled()) {
+  if (StringDedup::is_enabled()) {
     // We must enqueue the object before it is marked
     // as we otherwise can't read the object's age.
-    G1StringDedup::enqueue_from_mark(obj);
+    StringDedup::enqueue_from_mark(obj, 0 /* worker_id */);
   }
 #endif
+  if (DSUStaleInstances::is_enabled()) {
+    DSUStaleInstances::enqueue(obj);
+  }
   // some marks may contain information we need to preserve so we store them away
   // and overwrite the mark.  We'll restore it at the end of markSweep.
   markOop mark = obj->mark();
@@ -25,33 +25,48 @@
 #include "precompiled.hpp"
 #include "classfile/javaClasses.hpp"
 #include "gc_implementation/g1/g1CollectedHeap.inline.hpp"
-#include "gc_implementation/g1/g1GCPhaseTimes.hpp"
-#include "gc_implementation/g1/g1StringDedup.hpp"
-#include "gc_implementation/g1/g1StringDedupQueue.hpp"
-#include "gc_implementation/g1/g1StringDedupStat.hpp"
-#include "gc_implementation/g1/g1StringDedupTable.hpp"
-#include "gc_implementation/g1/g1StringDedupThread.hpp"
+#include "gc_implementation/parallelScavenge/parallelScavengeHeap.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
+#include "gc_implementation/shared/stringDedupQueue.hpp"
+#include "gc_implementation/shared/stringDedupStat.hpp"
+#include "gc_implementation/shared/stringDedupTable.hpp"
+#include "gc_implementation/shared/stringDedupThread.hpp"
+#include "memory/genCollectedHeap.hpp"
 
-bool G1StringDedup::_enabled = false;
+bool StringDedup::_enabled = false;
 
-void G1StringDedup::initialize() {
-  assert(UseG1GC, "String deduplication only available with G1");
+void StringDedup::initialize() {
   if (UseStringDeduplication) {
     _enabled = true;
-    G1StringDedupQueue::create();
-    G1StringDedupTable::create();
-    G1StringDedupThread::create();
+    StringDedupQueue::create();
+    StringDedupTable::create();
+    StringDedupThread::create();
   }
 }
 
-void G1StringDedup::stop() {
+void StringDedup::stop() {
   assert(is_enabled(), "String deduplication not enabled");
-  G1StringDedupThread::stop();
+  StringDedupThread::stop();
 }
 
-bool G1StringDedup::is_candidate_from_mark(oop obj) {
+bool StringDedup::is_in_young(oop obj) {
+  CollectedHeap* heap = Universe::heap();
+  switch (heap->kind()) {
+    case CollectedHeap::G1CollectedHeap:
+      return ((G1CollectedHeap*)heap)->heap_region_containing_raw(obj)->is_young();
+    case CollectedHeap::ParallelScavengeHeap:
+      return ((ParallelScavengeHeap*)heap)->is_in_young(obj);
+    case CollectedHeap::GenCollectedHeap:
+      return ((GenCollectedHeap*)heap)->is_in_young(obj);
+    default:
+      ShouldNotReachHere();
+      return false;
+  }
+}
+
+bool StringDedup::is_candidate_from_mark(oop obj) {
   if (java_lang_String::is_instance(obj)) {
-    bool from_young = G1CollectedHeap::heap()->heap_region_containing_raw(obj)->is_young();
+    bool from_young = is_in_young(obj);
     if (from_young && obj->age() < StringDeduplicationAgeThreshold) {
       // Candidate found. String is being evacuated from young to old but has not
       // reached the deduplication age threshold, i.e. has not previously been a
@@ -64,14 +79,14 @@ bool G1StringDedup::is_candidate_from_mark(oop obj) {
   return false;
 }
 
-void G1StringDedup::enqueue_from_mark(oop java_string) {
+void StringDedup::enqueue_from_mark(oop java_string, uint worker_id) {
   assert(is_enabled(), "String deduplication not enabled");
   if (is_candidate_from_mark(java_string)) {
-    G1StringDedupQueue::push(0 /* worker_id */, java_string);
+    StringDedupQueue::push(worker_id, java_string);
   }
 }
 
-bool G1StringDedup::is_candidate_from_evacuation(bool from_young, bool to_young, oop obj) {
+bool StringDedup::is_candidate_from_evacuation(bool from_young, bool to_young, oop obj) {
   if (from_young && java_lang_String::is_instance(obj)) {
     if (to_young && obj->age() == StringDeduplicationAgeThreshold) {
       // Candidate found. String is being evacuated from young to young and just
@@ -90,25 +105,25 @@ bool G1StringDedup::is_candidate_from_evacuation(bool from_young, bool to_young,
   return false;
 }
 
-void G1StringDedup::enqueue_from_evacuation(bool from_young, bool to_young, uint worker_id, oop java_string) {
+void StringDedup::enqueue_from_evacuation(bool from_young, bool to_young, uint worker_id, oop java_string) {
   assert(is_enabled(), "String deduplication not enabled");
   if (is_candidate_from_evacuation(from_young, to_young, java_string)) {
-    G1StringDedupQueue::push(worker_id, java_string);
+    StringDedupQueue::push(worker_id, java_string);
   }
 }
 
-void G1StringDedup::deduplicate(oop java_string) {
+void StringDedup::deduplicate(oop java_string) {
   assert(is_enabled(), "String deduplication not enabled");
-  G1StringDedupStat dummy; // Statistics from this path is never used
-  G1StringDedupTable::deduplicate(java_string, dummy);
+  StringDedupStat dummy; // Statistics from this path is never used
+  StringDedupTable::deduplicate(java_string, dummy);
 }
 
-void G1StringDedup::oops_do(OopClosure* keep_alive) {
+void StringDedup::oops_do(OopClosure* keep_alive) {
   assert(is_enabled(), "String deduplication not enabled");
   unlink_or_oops_do(NULL, keep_alive, true /* allow_resize_and_rehash */);
 }
 
-void G1StringDedup::unlink(BoolObjectClosure* is_alive) {
+void StringDedup::unlink(BoolObjectClosure* is_alive) {
   assert(is_enabled(), "String deduplication not enabled");
   // Don't allow a potential resize or rehash during unlink, as the unlink
   // operation itself might remove enough entries to invalidate such a decision.
@@ -119,68 +134,72 @@ void G1StringDedup::unlink(BoolObjectClosure* is_alive) {
 // Task for parallel unlink_or_oops_do() operation on the deduplication queue
 // and table.
 //
-class G1StringDedupUnlinkOrOopsDoTask : public AbstractGangTask {
+class StringDedupUnlinkOrOopsDoTask : public AbstractGangTask {
 private:
-  G1StringDedupUnlinkOrOopsDoClosure _cl;
-  G1GCPhaseTimes* _phase_times;
+  StringDedupUnlinkOrOopsDoClosure _cl;
 
 public:
-  G1StringDedupUnlinkOrOopsDoTask(BoolObjectClosure* is_alive,
-                                  OopClosure* keep_alive,
-                                  bool allow_resize_and_rehash,
-                                  G1GCPhaseTimes* phase_times) :
-    AbstractGangTask("G1StringDedupUnlinkOrOopsDoTask"),
-    _cl(is_alive, keep_alive, allow_resize_and_rehash), _phase_times(phase_times) { }
+  StringDedupUnlinkOrOopsDoTask(BoolObjectClosure* is_alive,
+                                OopClosure* keep_alive,
+                                bool allow_resize_and_rehash) :
+    AbstractGangTask("StringDedupUnlinkOrOopsDoTask"),
+    _cl(is_alive, keep_alive, allow_resize_and_rehash) { }
 
   virtual void work(uint worker_id) {
-    {
-      G1GCParPhaseTimesTracker x(_phase_times, G1GCPhaseTimes::StringDedupQueueFixup, worker_id);
-      G1StringDedupQueue::unlink_or_oops_do(&_cl);
-    }
-    {
-      G1GCParPhaseTimesTracker x(_phase_times, G1GCPhaseTimes::StringDedupTableFixup, worker_id);
-      G1StringDedupTable::unlink_or_oops_do(&_cl, worker_id);
-    }
+    StringDedup::unlink_or_oops_do(&_cl, worker_id);
   }
 };
 
-void G1StringDedup::unlink_or_oops_do(BoolObjectClosure* is_alive,
-                                      OopClosure* keep_alive,
-                                      bool allow_resize_and_rehash,
-                                      G1GCPhaseTimes* phase_times) {
+void StringDedup::unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl, uint worker_id) {
+  StringDedupQueue::unlink_or_oops_do(cl);
+  StringDedupTable::unlink_or_oops_do(cl, worker_id);
+}
+
+void StringDedup::unlink_or_oops_do(BoolObjectClosure* is_alive,
+                                    OopClosure* keep_alive,
+                                    bool allow_resize_and_rehash) {
   assert(is_enabled(), "String deduplication not enabled");
 
-  G1StringDedupUnlinkOrOopsDoTask task(is_alive, keep_alive, allow_resize_and_rehash, phase_times);
-  if (G1CollectedHeap::use_parallel_gc_threads()) {
-    G1CollectedHeap* g1h = G1CollectedHeap::heap();
-    g1h->set_par_threads();
-    g1h->workers()->run_task(&task);
-    g1h->set_par_threads(0);
+  StringDedupUnlinkOrOopsDoTask task(is_alive, keep_alive, allow_resize_and_rehash);
+
+  // The parallel scavenge heap runs its GC work through the GCTaskManager,
+  // the other heaps have a work gang when ParallelGCThreads > 0.
+  FlexibleWorkGang* workers = NULL;
+  if (Universe::heap()->kind() != CollectedHeap::ParallelScavengeHeap) {
+    workers = SharedHeap::heap()->workers();
+  }
+
+  if (CollectedHeap::use_parallel_gc_threads() && workers != NULL) {
+    SharedHeap* sh = SharedHeap::heap();
+    uint n_par_threads = sh->n_par_threads();
+    sh->set_par_threads(workers->active_workers());
+    workers->run_task(&task);
+    sh->set_par_threads(n_par_threads);
   } else {
     task.work(0);
   }
 }
 
-void G1StringDedup::threads_do(ThreadClosure* tc) {
+void StringDedup::threads_do(ThreadClosure* tc) {
   assert(is_enabled(), "String deduplication not enabled");
-  tc->do_thread(G1StringDedupThread::thread());
+  tc->do_thread(StringDedupThread::thread());
 }
 
-void G1StringDedup::print_worker_threads_on(outputStream* st) {
+void StringDedup::print_worker_threads_on(outputStream* st) {
   assert(is_enabled(), "String deduplication not enabled");
-  G1StringDedupThread::thread()->print_on(st);
+  StringDedupThread::thread()->print_on(st);
   st->cr();
 }
 
-void G1StringDedup::verify() {
+void StringDedup::verify() {
   assert(is_enabled(), "String deduplication not enabled");
-  G1StringDedupQueue::verify();
-  G1StringDedupTable::verify();
+  StringDedupQueue::verify();
+  StringDedupTable::verify();
 }
 
-G1StringDedupUnlinkOrOopsDoClosure::G1StringDedupUnlinkOrOopsDoClosure(BoolObjectClosure* is_alive,
-                                                                       OopClosure* keep_alive,
-                                                                       bool allow_resize_and_rehash) :
+StringDedupUnlinkOrOopsDoClosure::StringDedupUnlinkOrOopsDoClosure(BoolObjectClosure* is_alive,
+                                                                   OopClosure* keep_alive,
+                                                                   bool allow_resize_and_rehash) :
   _is_alive(is_alive),
   _keep_alive(keep_alive),
   _resized_table(NULL),
@@ -190,18 +209,18 @@ G1StringDedupUnlinkOrOopsDoClosure::G1StringDedupUnlinkOrOopsDoClosure(BoolObjec
   if (allow_resize_and_rehash) {
     // If both resize and rehash is needed, only do resize. Rehash of
     // the table will eventually happen if the situation persists.
-    _resized_table = G1StringDedupTable::prepare_resize();
+    _resized_table = StringDedupTable::prepare_resize();
     if (!is_resizing()) {
-      _rehashed_table = G1StringDedupTable::prepare_rehash();
+      _rehashed_table = StringDedupTable::prepare_rehash();
     }
   }
 }
 
-G1StringDedupUnlinkOrOopsDoClosure::~G1StringDedupUnlinkOrOopsDoClosure() {
+StringDedupUnlinkOrOopsDoClosure::~StringDedupUnlinkOrOopsDoClosure() {
   assert(!is_resizing() || !is_rehashing(), "Can not both resize and rehash");
   if (is_resizing()) {
-    G1StringDedupTable::finish_resize(_resized_table);
+    StringDedupTable::finish_resize(_resized_table);
   } else if (is_rehashing()) {
-    G1StringDedupTable::finish_rehash(_rehashed_table);
+    StringDedupTable::finish_rehash(_rehashed_table);
   }
 }
@@ -22,8 +22,8 @@
  *
  */
 
-#ifndef SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUP_HPP
-#define SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUP_HPP
+#ifndef SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUP_HPP
+#define SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUP_HPP
 
 //
 // String Deduplication
@@ -56,7 +56,8 @@
 //
 // - The object is an instance of java.lang.String
 //
-// - The object is being evacuated from a young heap region
+// - The object is being evacuated from a young heap region (G1) or the young
+//   generation (Parallel, ParNew and Serial)
 //
 // - The object is being evacuated to a young/survivor heap region and the
 //   object's age is equal to the deduplication age threshold
@@ -70,6 +71,21 @@
 // than the deduplication age threshold, is will never become a candidate again.
 // This approach avoids making the same object a candidate more than once.
 //
+// Full collections apply the same policy when marking: a young String that has
+// not yet reached the age threshold is a candidate, since it is about to be
+// compacted into the old generation.
+//
+// Collectors
+//
+// Deduplication is not tied to a particular collector. Each collector feeds the
+// queue from its own copying and marking code, using its GC worker id as queue
+// number (the VM thread uses the last queue), and treats the queue and table as
+// weak roots: entries are unlinked or updated after young collections with
+// unlink_or_oops_do(), unlinked after full/remark marking with unlink(), and
+// adjusted after compaction with oops_do(). The deduplication thread joins the
+// SuspendibleThreadSet, which is synchronized at every safepoint while string
+// deduplication is enabled.
+//
 // Interned strings are a bit special. They are explicitly deduplicated just before
 // being inserted into the StringTable (to avoid counteracting C2 optimizations done
 // on string literals), then they also become deduplication candidates if they reach
@@ -89,15 +105,15 @@ class OopClosure;
 class BoolObjectClosure;
 class ThreadClosure;
 class outputStream;
-class G1StringDedupTable;
-class G1GCPhaseTimes;
+class StringDedupTable;
+class StringDedupUnlinkOrOopsDoClosure;
 
 //
 // Main interface for interacting with string deduplication.
 //
-class G1StringDedup : public AllStatic {
+class StringDedup : public AllStatic {
 private:
-  // Single state for checking if both G1 and string deduplication is enabled.
+  // Single state for checking if string deduplication is enabled.
   static bool _enabled;
 
   // Candidate selection policies, returns true if the given object is
@@ -106,7 +122,7 @@ private:
   static bool is_candidate_from_evacuation(bool from_young, bool to_young, oop obj);
 
 public:
-  // Returns true if both G1 and string deduplication is enabled.
+  // Returns true if string deduplication is enabled.
   static bool is_enabled() {
     return _enabled;
   }
@@ -124,14 +140,23 @@ public:
   // Enqueues a deduplication candidate for later processing by the deduplication
   // thread. Before enqueuing, these functions apply the appropriate candidate
   // selection policy to filters out non-candidates.
-  static void enqueue_from_mark(oop java_string);
+  static void enqueue_from_mark(oop java_string, uint worker_id);
   static void enqueue_from_evacuation(bool from_young, bool to_young,
-                                      unsigned int queue, oop java_string);
+                                      uint worker_id, oop java_string);
+
+  // Returns true if the given object is in the young part of the heap,
+  // whichever collector is in use.
+  static bool is_in_young(oop obj);
 
   static void oops_do(OopClosure* keep_alive);
   static void unlink(BoolObjectClosure* is_alive);
   static void unlink_or_oops_do(BoolObjectClosure* is_alive, OopClosure* keep_alive,
-                                bool allow_resize_and_rehash, G1GCPhaseTimes* phase_times = NULL);
+                                bool allow_resize_and_rehash);
+
+  // Processes the queue and table partitions claimed by one GC worker.
+  // Collectors that time the queue and table fixup separately (G1) call
+  // StringDedupQueue and StringDedupTable directly instead.
+  static void unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl, uint worker_id);
 
   static void threads_do(ThreadClosure* tc);
   static void print_worker_threads_on(outputStream* st);
@@ -146,26 +171,26 @@ public:
 // provide a simple mechanism for GC workers to claim exclusive access to a
 // queue or a table partition.
 //
-class G1StringDedupUnlinkOrOopsDoClosure : public StackObj {
+class StringDedupUnlinkOrOopsDoClosure : public StackObj {
 private:
   BoolObjectClosure*  _is_alive;
   OopClosure*         _keep_alive;
-  G1StringDedupTable* _resized_table;
-  G1StringDedupTable* _rehashed_table;
+  StringDedupTable* _resized_table;
+  StringDedupTable* _rehashed_table;
   size_t              _next_queue;
   size_t              _next_bucket;
 
 public:
-  G1StringDedupUnlinkOrOopsDoClosure(BoolObjectClosure* is_alive,
-                                     OopClosure* keep_alive,
-                                     bool allow_resize_and_rehash);
-  ~G1StringDedupUnlinkOrOopsDoClosure();
+  StringDedupUnlinkOrOopsDoClosure(BoolObjectClosure* is_alive,
+                                   OopClosure* keep_alive,
+                                   bool allow_resize_and_rehash);
+  ~StringDedupUnlinkOrOopsDoClosure();
 
   bool is_resizing() {
     return _resized_table != NULL;
   }
 
-  G1StringDedupTable* resized_table() {
+  StringDedupTable* resized_table() {
     return _resized_table;
   }
 
@@ -204,4 +229,4 @@ public:
   }
 };
 
-#endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUP_HPP
+#endif // SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUP_HPP
@@ -24,55 +24,57 @@
 
 #include "precompiled.hpp"
 #include "classfile/javaClasses.hpp"
-#include "gc_implementation/g1/g1StringDedupQueue.hpp"
+#include "gc_implementation/shared/stringDedupQueue.hpp"
 #include "memory/gcLocker.hpp"
 #include "runtime/mutexLocker.hpp"
 #include "utilities/stack.inline.hpp"
 
-G1StringDedupQueue* G1StringDedupQueue::_queue = NULL;
-const size_t        G1StringDedupQueue::_max_size = 1000000; // Max number of elements per queue
-const size_t        G1StringDedupQueue::_max_cache_size = 0; // Max cache size per queue
+StringDedupQueue* StringDedupQueue::_queue = NULL;
+const size_t      StringDedupQueue::_max_size = 1000000; // Max number of elements per queue
+const size_t      StringDedupQueue::_max_cache_size = 0; // Max cache size per queue
 
-G1StringDedupQueue::G1StringDedupQueue() :
+StringDedupQueue::StringDedupQueue() :
   _cursor(0),
   _cancel(false),
   _empty(true),
   _dropped(0) {
-  _nqueues = MAX2(ParallelGCThreads, (size_t)1);
-  _queues = NEW_C_HEAP_ARRAY(G1StringDedupWorkerQueue, _nqueues, mtGC);
+  // One queue per GC worker plus one for the VM thread, which evacuates
+  // and marks objects itself in the serial phases of some collectors.
+  _nqueues = ParallelGCThreads + 1;
+  _queues = NEW_C_HEAP_ARRAY(StringDedupWorkerQueue, _nqueues, mtGC);
   for (size_t i = 0; i < _nqueues; i++) {
-    new (_queues + i) G1StringDedupWorkerQueue(G1StringDedupWorkerQueue::default_segment_size(), _max_cache_size, _max_size);
+    new (_queues + i) StringDedupWorkerQueue(StringDedupWorkerQueue::default_segment_size(), _max_cache_size, _max_size);
   }
 }
 
-G1StringDedupQueue::~G1StringDedupQueue() {
+StringDedupQueue::~StringDedupQueue() {
   ShouldNotReachHere();
 }
 
-void G1StringDedupQueue::create() {
+void StringDedupQueue::create() {
   assert(_queue == NULL, "One string deduplication queue allowed");
-  _queue = new G1StringDedupQueue();
+  _queue = new StringDedupQueue();
 }
 
-void G1StringDedupQueue::wait() {
+void StringDedupQueue::wait() {
   MonitorLockerEx ml(StringDedupQueue_lock, Mutex::_no_safepoint_check_flag);
   while (_queue->_empty && !_queue->_cancel) {
     ml.wait(Mutex::_no_safepoint_check_flag);
   }
 }
 
-void G1StringDedupQueue::cancel_wait() {
+void StringDedupQueue::cancel_wait() {
   MonitorLockerEx ml(StringDedupQueue_lock, Mutex::_no_safepoint_check_flag);
   _queue->_cancel = true;
   ml.notify();
 }
 
-void G1StringDedupQueue::push(uint worker_id, oop java_string) {
+void StringDedupQueue::push(uint worker_id, oop java_string) {
   assert(SafepointSynchronize::is_at_safepoint(), "Must be at safepoint");
   assert(worker_id < _queue->_nqueues, "Invalid queue");
 
   // Push and notify waiter
-  G1StringDedupWorkerQueue& worker_queue = _queue->_queues[worker_id];
+  StringDedupWorkerQueue& worker_queue = _queue->_queues[worker_id];
   if (!worker_queue.is_full()) {
     worker_queue.push(java_string);
     if (_queue->_empty) {
@@ -89,14 +91,14 @@ void G1StringDedupQueue::push(uint worker_id, oop java_string) {
   }
 }
 
-oop G1StringDedupQueue::pop() {
+oop StringDedupQueue::pop() {
   assert(!SafepointSynchronize::is_at_safepoint(), "Must not be at safepoint");
   No_Safepoint_Verifier nsv;
 
   // Try all queues before giving up
   for (size_t tries = 0; tries < _queue->_nqueues; tries++) {
     // The cursor indicates where we left of last time
-    G1StringDedupWorkerQueue* queue = &_queue->_queues[_queue->_cursor];
+    StringDedupWorkerQueue* queue = &_queue->_queues[_queue->_cursor];
     while (!queue->is_empty()) {
       oop obj = queue->pop();
       // The oop we pop can be NULL if it was marked
@@ -116,7 +118,7 @@ oop G1StringDedupQueue::pop() {
   return NULL;
 }
 
-void G1StringDedupQueue::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl) {
+void StringDedupQueue::unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl) {
   // A worker thread first claims a queue, which ensures exclusive
   // access to that queue, then continues to process it.
   for (;;) {
@@ -132,7 +134,7 @@ void G1StringDedupQueue::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* c
   }
 }
 
-void G1StringDedupQueue::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl, size_t queue) {
+void StringDedupQueue::unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl, size_t queue) {
   assert(queue < _queue->_nqueues, "Invalid queue");
   StackIterator<oop, mtGC> iter(_queue->_queues[queue]);
   while (!iter.is_empty()) {
@@ -148,13 +150,13 @@ void G1StringDedupQueue::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* c
   }
 }
 
-void G1StringDedupQueue::print_statistics(outputStream* st) {
+void StringDedupQueue::print_statistics(outputStream* st) {
   st->print_cr(
     "   [Queue]\n"
     "      [Dropped: "UINTX_FORMAT"]", _queue->_dropped);
 }
 
-void G1StringDedupQueue::verify() {
+void StringDedupQueue::verify() {
   for (size_t i = 0; i < _queue->_nqueues; i++) {
     StackIterator<oop, mtGC> iter(_queue->_queues[i]);
     while (!iter.is_empty()) {
@@ -22,14 +22,14 @@
  *
  */
 
-#ifndef SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPQUEUE_HPP
-#define SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPQUEUE_HPP
+#ifndef SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPQUEUE_HPP
+#define SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPQUEUE_HPP
 
 #include "memory/allocation.hpp"
 #include "oops/oop.hpp"
 #include "utilities/stack.hpp"
 
-class G1StringDedupUnlinkOrOopsDoClosure;
+class StringDedupUnlinkOrOopsDoClosure;
 
 //
 // The deduplication queue acts as the communication channel between the stop-the-world
@@ -54,27 +54,27 @@ class G1StringDedupUnlinkOrOopsDoClosure;
 // thread in case the queue is empty or becomes non-empty, respectively. This lock does
 // not otherwise protect the queue content.
 //
-class G1StringDedupQueue : public CHeapObj<mtGC> {
+class StringDedupQueue : public CHeapObj<mtGC> {
 private:
-  typedef Stack<oop, mtGC> G1StringDedupWorkerQueue;
+  typedef Stack<oop, mtGC> StringDedupWorkerQueue;
 
-  static G1StringDedupQueue* _queue;
-  static const size_t        _max_size;
-  static const size_t        _max_cache_size;
+  static StringDedupQueue* _queue;
+  static const size_t      _max_size;
+  static const size_t      _max_cache_size;
 
-  G1StringDedupWorkerQueue*  _queues;
-  size_t                     _nqueues;
-  size_t                     _cursor;
-  bool                       _cancel;
-  volatile bool              _empty;
+  StringDedupWorkerQueue*  _queues;
+  size_t                   _nqueues;
+  size_t                   _cursor;
+  bool                     _cancel;
+  volatile bool            _empty;
 
   // Statistics counter, only used for logging.
-  uintx                      _dropped;
+  uintx                    _dropped;
 
-  G1StringDedupQueue();
-  ~G1StringDedupQueue();
+  StringDedupQueue();
+  ~StringDedupQueue();
 
-  static void unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl, size_t queue);
+  static void unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl, size_t queue);
 
 public:
   static void create();
@@ -92,10 +92,10 @@ public:
   // all queues are empty.
   static oop pop();
 
-  static void unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl);
+  static void unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl);
 
   static void print_statistics(outputStream* st);
   static void verify();
 };
 
-#endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPQUEUE_HPP
+#endif // SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPQUEUE_HPP
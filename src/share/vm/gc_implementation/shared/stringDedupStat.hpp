@@ -22,25 +22,25 @@
  *
  */
 
-#ifndef SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPSTAT_HPP
-#define SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPSTAT_HPP
+#ifndef SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPSTAT_HPP
+#define SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPSTAT_HPP
 
 #include "memory/allocation.hpp"
 #include "runtime/os.hpp"
 
 // Macros for GC log output formating
-#define G1_STRDEDUP_OBJECTS_FORMAT         UINTX_FORMAT_W(12)
-#define G1_STRDEDUP_TIME_FORMAT            "%1.7lf secs"
-#define G1_STRDEDUP_PERCENT_FORMAT         "%5.1lf%%"
-#define G1_STRDEDUP_PERCENT_FORMAT_NS      "%.1lf%%"
-#define G1_STRDEDUP_BYTES_FORMAT           "%8.1lf%s"
-#define G1_STRDEDUP_BYTES_FORMAT_NS        "%.1lf%s"
-#define G1_STRDEDUP_BYTES_PARAM(bytes)     byte_size_in_proper_unit((double)(bytes)), proper_unit_for_byte_size((bytes))
+#define STRDEDUP_OBJECTS_FORMAT         UINTX_FORMAT_W(12)
+#define STRDEDUP_TIME_FORMAT            "%1.7lf secs"
+#define STRDEDUP_PERCENT_FORMAT         "%5.1lf%%"
+#define STRDEDUP_PERCENT_FORMAT_NS      "%.1lf%%"
+#define STRDEDUP_BYTES_FORMAT           "%8.1lf%s"
+#define STRDEDUP_BYTES_FORMAT_NS        "%.1lf%s"
+#define STRDEDUP_BYTES_PARAM(bytes)     byte_size_in_proper_unit((double)(bytes)), proper_unit_for_byte_size((bytes))
 
 //
 // Statistics gathered by the deduplication thread.
 //
-class G1StringDedupStat : public StackObj {
+class StringDedupStat : public StackObj {
 private:
   // Counters
   uintx  _inspected;
@@ -66,7 +66,7 @@ private:
   double _block_elapsed;
 
 public:
-  G1StringDedupStat();
+  StringDedupStat();
 
   void inc_inspected() {
     _inspected++;
@@ -133,10 +133,10 @@ public:
     _exec_elapsed += now - _start;
   }
 
-  void add(const G1StringDedupStat& stat);
+  void add(const StringDedupStat& stat);
 
-  static void print_summary(outputStream* st, const G1StringDedupStat& last_stat, const G1StringDedupStat& total_stat);
-  static void print_statistics(outputStream* st, const G1StringDedupStat& stat, bool total);
+  static void print_summary(outputStream* st, const StringDedupStat& last_stat, const StringDedupStat& total_stat);
+  static void print_statistics(outputStream* st, const StringDedupStat& stat, bool total);
 };
 
-#endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPSTAT_HPP
+#endif // SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPSTAT_HPP
@@ -25,9 +25,9 @@
 #include "precompiled.hpp"
 #include "classfile/altHashing.hpp"
 #include "classfile/javaClasses.hpp"
-#include "gc_implementation/g1/g1CollectedHeap.inline.hpp"
 #include "gc_implementation/g1/g1SATBCardTableModRefBS.hpp"
-#include "gc_implementation/g1/g1StringDedupTable.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
+#include "gc_implementation/shared/stringDedupTable.hpp"
 #include "memory/gcLocker.hpp"
 #include "memory/padded.inline.hpp"
 #include "oops/typeArrayOop.hpp"
@@ -37,25 +37,25 @@
 // Freelist in the deduplication table entry cache. Links table
 // entries together using their _next fields.
 //
-class G1StringDedupEntryFreeList : public CHeapObj<mtGC> {
+class StringDedupEntryFreeList : public CHeapObj<mtGC> {
 private:
-  G1StringDedupEntry* _list;
-  size_t              _length;
+  StringDedupEntry* _list;
+  size_t            _length;
 
 public:
-  G1StringDedupEntryFreeList() :
+  StringDedupEntryFreeList() :
     _list(NULL),
     _length(0) {
   }
 
-  void add(G1StringDedupEntry* entry) {
+  void add(StringDedupEntry* entry) {
     entry->set_next(_list);
     _list = entry;
     _length++;
   }
 
-  G1StringDedupEntry* remove() {
-    G1StringDedupEntry* entry = _list;
+  StringDedupEntry* remove() {
+    StringDedupEntry* entry = _list;
     if (entry != NULL) {
       _list = entry->next();
       _length--;
@@ -82,24 +82,24 @@ public:
 // Allocations are synchronized by StringDedupTable_lock as part of a table
 // modification.
 //
-class G1StringDedupEntryCache : public CHeapObj<mtGC> {
+class StringDedupEntryCache : public CHeapObj<mtGC> {
 private:
   // One freelist per GC worker to allow lock less freeing of
   // entries while doing a parallel scan of the table. Using
   // PaddedEnd to avoid false sharing.
-  PaddedEnd<G1StringDedupEntryFreeList>* _lists;
-  size_t                                 _nlists;
+  PaddedEnd<StringDedupEntryFreeList>* _lists;
+  size_t                               _nlists;
 
 public:
-  G1StringDedupEntryCache();
-  ~G1StringDedupEntryCache();
+  StringDedupEntryCache();
+  ~StringDedupEntryCache();
 
   // Get a table entry from the cache freelist, or allocate a new
   // entry if the cache is empty.
-  G1StringDedupEntry* alloc();
+  StringDedupEntry* alloc();
 
   // Insert a table entry into the cache freelist.
-  void free(G1StringDedupEntry* entry, uint worker_id);
+  void free(StringDedupEntry* entry, uint worker_id);
 
   // Returns current number of entries in the cache.
   size_t size();
@@ -109,26 +109,26 @@ public:
   void trim(size_t max_size);
 };
 
-G1StringDedupEntryCache::G1StringDedupEntryCache() {
+StringDedupEntryCache::StringDedupEntryCache() {
   _nlists = MAX2(ParallelGCThreads, (size_t)1);
-  _lists = PaddedArray<G1StringDedupEntryFreeList, mtGC>::create_unfreeable((uint)_nlists);
+  _lists = PaddedArray<StringDedupEntryFreeList, mtGC>::create_unfreeable((uint)_nlists);
 }
 
-G1StringDedupEntryCache::~G1StringDedupEntryCache() {
+StringDedupEntryCache::~StringDedupEntryCache() {
   ShouldNotReachHere();
 }
 
-G1StringDedupEntry* G1StringDedupEntryCache::alloc() {
+StringDedupEntry* StringDedupEntryCache::alloc() {
   for (size_t i = 0; i < _nlists; i++) {
-    G1StringDedupEntry* entry = _lists[i].remove();
+    StringDedupEntry* entry = _lists[i].remove();
     if (entry != NULL) {
       return entry;
     }
   }
-  return new G1StringDedupEntry();
+  return new StringDedupEntry();
 }
 
-void G1StringDedupEntryCache::free(G1StringDedupEntry* entry, uint worker_id) {
+void StringDedupEntryCache::free(StringDedupEntry* entry, uint worker_id) {
   assert(entry->obj() != NULL, "Double free");
   assert(worker_id < _nlists, "Invalid worker id");
   entry->set_obj(NULL);
@@ -136,7 +136,7 @@ void G1StringDedupEntryCache::free(G1StringDedupEntry* entry, uint worker_id) {
   _lists[worker_id].add(entry);
 }
 
-size_t G1StringDedupEntryCache::size() {
+size_t StringDedupEntryCache::size() {
   size_t size = 0;
   for (size_t i = 0; i < _nlists; i++) {
     size += _lists[i].length();
@@ -144,13 +144,13 @@ size_t G1StringDedupEntryCache::size() {
   return size;
 }
 
-void G1StringDedupEntryCache::trim(size_t max_size) {
+void StringDedupEntryCache::trim(size_t max_size) {
   size_t cache_size = 0;
   for (size_t i = 0; i < _nlists; i++) {
-    G1StringDedupEntryFreeList* list = &_lists[i];
+    StringDedupEntryFreeList* list = &_lists[i];
     cache_size += list->length();
     while (cache_size > max_size) {
-      G1StringDedupEntry* entry = list->remove();
+      StringDedupEntry* entry = list->remove();
       assert(entry != NULL, "Should not be null");
       cache_size--;
       delete entry;
@@ -158,23 +158,23 @@ void G1StringDedupEntryCache::trim(size_t max_size) {
   }
 }
 
-G1StringDedupTable*      G1StringDedupTable::_table = NULL;
-G1StringDedupEntryCache* G1StringDedupTable::_entry_cache = NULL;
+StringDedupTable*      StringDedupTable::_table = NULL;
+StringDedupEntryCache* StringDedupTable::_entry_cache = NULL;
 
-const size_t             G1StringDedupTable::_min_size = (1 << 10);   // 1024
-const size_t             G1StringDedupTable::_max_size = (1 << 24);   // 16777216
-const double             G1StringDedupTable::_grow_load_factor = 2.0; // Grow table at 200% load
-const double             G1StringDedupTable::_shrink_load_factor = _grow_load_factor / 3.0; // Shrink table at 67% load
-const double             G1StringDedupTable::_max_cache_factor = 0.1; // Cache a maximum of 10% of the table size
-const uintx              G1StringDedupTable::_rehash_multiple = 60;   // Hash bucket has 60 times more collisions than expected
-const uintx              G1StringDedupTable::_rehash_threshold = (uintx)(_rehash_multiple * _grow_load_factor);
+const size_t           StringDedupTable::_min_size = (1 << 10);   // 1024
+const size_t           StringDedupTable::_max_size = (1 << 24);   // 16777216
+const double           StringDedupTable::_grow_load_factor = 2.0; // Grow table at 200% load
+const double           StringDedupTable::_shrink_load_factor = _grow_load_factor / 3.0; // Shrink table at 67% load
+const double           StringDedupTable::_max_cache_factor = 0.1; // Cache a maximum of 10% of the table size
+const uintx            StringDedupTable::_rehash_multiple = 60;   // Hash bucket has 60 times more collisions than expected
+const uintx            StringDedupTable::_rehash_threshold = (uintx)(_rehash_multiple * _grow_load_factor);
 
-uintx                    G1StringDedupTable::_entries_added = 0;
-uintx                    G1StringDedupTable::_entries_removed = 0;
-uintx                    G1StringDedupTable::_resize_count = 0;
-uintx                    G1StringDedupTable::_rehash_count = 0;
+uintx                    StringDedupTable::_entries_added = 0;
+uintx                    StringDedupTable::_entries_removed = 0;
+uintx                    StringDedupTable::_resize_count = 0;
+uintx                    StringDedupTable::_rehash_count = 0;
 
-G1StringDedupTable::G1StringDedupTable(size_t size, jint hash_seed) :
+StringDedupTable::StringDedupTable(size_t size, jint hash_seed) :
   _size(size),
   _entries(0),
   _grow_threshold((uintx)(size * _grow_load_factor)),
@@ -182,22 +182,22 @@ G1StringDedupTable::G1StringDedupTable(size_t size, jint hash_seed) :
   _rehash_needed(false),
   _hash_seed(hash_seed) {
   assert(is_power_of_2(size), "Table size must be a power of 2");
-  _buckets = NEW_C_HEAP_ARRAY(G1StringDedupEntry*, _size, mtGC);
-  memset(_buckets, 0, _size * sizeof(G1StringDedupEntry*));
+  _buckets = NEW_C_HEAP_ARRAY(StringDedupEntry*, _size, mtGC);
+  memset(_buckets, 0, _size * sizeof(StringDedupEntry*));
 }
 
-G1StringDedupTable::~G1StringDedupTable() {
-  FREE_C_HEAP_ARRAY(G1StringDedupEntry*, _buckets, mtGC);
+StringDedupTable::~StringDedupTable() {
+  FREE_C_HEAP_ARRAY(StringDedupEntry*, _buckets, mtGC);
 }
 
-void G1StringDedupTable::create() {
+void StringDedupTable::create() {
   assert(_table == NULL, "One string deduplication table allowed");
-  _entry_cache = new G1StringDedupEntryCache();
-  _table = new G1StringDedupTable(_min_size);
+  _entry_cache = new StringDedupEntryCache();
+  _table = new StringDedupTable(_min_size);
 }
 
-void G1StringDedupTable::add(typeArrayOop value, unsigned int hash, G1StringDedupEntry** list) {
-  G1StringDedupEntry* entry = _entry_cache->alloc();
+void StringDedupTable::add(typeArrayOop value, unsigned int hash, StringDedupEntry** list) {
+  StringDedupEntry* entry = _entry_cache->alloc();
   entry->set_obj(value);
   entry->set_hash(hash);
   entry->set_next(*list);
@@ -205,23 +205,23 @@ void G1StringDedupTable::add(typeArrayOop value, unsigned int hash, G1StringDedu
   _entries++;
 }
 
-void G1StringDedupTable::remove(G1StringDedupEntry** pentry, uint worker_id) {
-  G1StringDedupEntry* entry = *pentry;
+void StringDedupTable::remove(StringDedupEntry** pentry, uint worker_id) {
+  StringDedupEntry* entry = *pentry;
   *pentry = entry->next();
   _entry_cache->free(entry, worker_id);
 }
 
-void G1StringDedupTable::transfer(G1StringDedupEntry** pentry, G1StringDedupTable* dest) {
-  G1StringDedupEntry* entry = *pentry;
+void StringDedupTable::transfer(StringDedupEntry** pentry, StringDedupTable* dest) {
+  StringDedupEntry* entry = *pentry;
   *pentry = entry->next();
   unsigned int hash = entry->hash();
   size_t index = dest->hash_to_index(hash);
-  G1StringDedupEntry** list = dest->bucket(index);
+  StringDedupEntry** list = dest->bucket(index);
   entry->set_next(*list);
   *list = entry;
 }
 
-bool G1StringDedupTable::equals(typeArrayOop value1, typeArrayOop value2) {
+bool StringDedupTable::equals(typeArrayOop value1, typeArrayOop value2) {
   return (value1 == value2 ||
           (value1->length() == value2->length() &&
            (!memcmp(value1->base(T_CHAR),
@@ -229,9 +229,9 @@ bool G1StringDedupTable::equals(typeArrayOop value1, typeArrayOop value2) {
                     value1->length() * sizeof(jchar)))));
 }
 
-typeArrayOop G1StringDedupTable::lookup(typeArrayOop value, unsigned int hash,
-                                        G1StringDedupEntry** list, uintx &count) {
-  for (G1StringDedupEntry* entry = *list; entry != NULL; entry = entry->next()) {
+typeArrayOop StringDedupTable::lookup(typeArrayOop value, unsigned int hash,
+                                      StringDedupEntry** list, uintx &count) {
+  for (StringDedupEntry* entry = *list; entry != NULL; entry = entry->next()) {
     if (entry->hash() == hash) {
       typeArrayOop existing_value = entry->obj();
       if (equals(value, existing_value)) {
@@ -246,9 +246,9 @@ typeArrayOop G1StringDedupTable::lookup(typeArrayOop value, unsigned int hash,
   return NULL;
 }
 
-typeArrayOop G1StringDedupTable::lookup_or_add_inner(typeArrayOop value, unsigned int hash) {
+typeArrayOop StringDedupTable::lookup_or_add_inner(typeArrayOop value, unsigned int hash) {
   size_t index = hash_to_index(hash);
-  G1StringDedupEntry** list = bucket(index);
+  StringDedupEntry** list = bucket(index);
   uintx count = 0;
 
   // Lookup in list
@@ -270,7 +270,7 @@ typeArrayOop G1StringDedupTable::lookup_or_add_inner(typeArrayOop value, unsigne
   return existing_value;
 }
 
-unsigned int G1StringDedupTable::hash_code(typeArrayOop value) {
+unsigned int StringDedupTable::hash_code(typeArrayOop value) {
   unsigned int hash;
   int length = value->length();
   const jchar* data = (jchar*)value->base(T_CHAR);
@@ -284,7 +284,7 @@ unsigned int G1StringDedupTable::hash_code(typeArrayOop value) {
   return hash;
 }
 
-void G1StringDedupTable::deduplicate(oop java_string, G1StringDedupStat& stat) {
+void StringDedupTable::deduplicate(oop java_string, StringDedupStat& stat) {
   assert(java_lang_String::is_instance(java_string), "Must be a string");
   No_Safepoint_Verifier nsv;
 
@@ -327,14 +327,17 @@ void G1StringDedupTable::deduplicate(oop java_string, G1StringDedupStat& stat) {
   stat.inc_new(size_in_bytes);
 
   if (existing_value != NULL) {
-    // Enqueue the reference to make sure it is kept alive. Concurrent mark might
-    // otherwise declare it dead if there are no other strong references to this object.
-    G1SATBCardTableModRefBS::enqueue(existing_value);
+    if (UseG1GC) {
+      // Enqueue the reference to make sure it is kept alive. Concurrent mark might
+      // otherwise declare it dead if there are no other strong references to this object.
+      // CMS relies on the card mark done by set_value() below instead.
+      G1SATBCardTableModRefBS::enqueue(existing_value);
+    }
 
     // Existing value found, deduplicate string
     java_lang_String::set_value(java_string, existing_value);
 
-    if (G1CollectedHeap::heap()->is_in_young(value)) {
+    if (StringDedup::is_in_young(value)) {
       stat.inc_deduped_young(size_in_bytes);
     } else {
       stat.inc_deduped_old(size_in_bytes);
@@ -342,7 +345,7 @@ void G1StringDedupTable::deduplicate(oop java_string, G1StringDedupStat& stat) {
   }
 }
 
-G1StringDedupTable* G1StringDedupTable::prepare_resize() {
+StringDedupTable* StringDedupTable::prepare_resize() {
   size_t size = _table->_size;
 
   // Check if the hashtable needs to be resized
@@ -377,10 +380,10 @@ G1StringDedupTable* G1StringDedupTable::prepare_resize() {
 
   // Allocate the new table. The new table will be populated by workers
   // calling unlink_or_oops_do() and finally installed by finish_resize().
-  return new G1StringDedupTable(size, _table->_hash_seed);
+  return new StringDedupTable(size, _table->_hash_seed);
 }
 
-void G1StringDedupTable::finish_resize(G1StringDedupTable* resized_table) {
+void StringDedupTable::finish_resize(StringDedupTable* resized_table) {
   assert(resized_table != NULL, "Invalid table");
 
   resized_table->_entries = _table->_entries;
@@ -392,7 +395,7 @@ void G1StringDedupTable::finish_resize(G1StringDedupTable* resized_table) {
   _table = resized_table;
 }
 
-void G1StringDedupTable::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl, uint worker_id) {
+void StringDedupTable::unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl, uint worker_id) {
   // The table is divided into partitions to allow lock-less parallel processing by
   // multiple worker threads. A worker thread first claims a partition, which ensures
   // exclusive access to that part of the table, then continues to process it. To allow
@@ -407,7 +410,7 @@ void G1StringDedupTable::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* c
   size_t table_half = _table->_size / 2;
 
   // Let each partition be one page worth of buckets
-  size_t partition_size = MIN2(table_half, os::vm_page_size() / sizeof(G1StringDedupEntry*));
+  size_t partition_size = MIN2(table_half, os::vm_page_size() / sizeof(StringDedupEntry*));
   assert(table_half % partition_size == 0, "Invalid partition size");
 
   // Number of entries removed during the scan
@@ -435,13 +438,13 @@ void G1StringDedupTable::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* c
   }
 }
 
-uintx G1StringDedupTable::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure* cl,
-                                            size_t partition_begin,
-                                            size_t partition_end,
-                                            uint worker_id) {
+uintx StringDedupTable::unlink_or_oops_do(StringDedupUnlinkOrOopsDoClosure* cl,
+                                          size_t partition_begin,
+                                          size_t partition_end,
+                                          uint worker_id) {
   uintx removed = 0;
   for (size_t bucket = partition_begin; bucket < partition_end; bucket++) {
-    G1StringDedupEntry** entry = _table->bucket(bucket);
+    StringDedupEntry** entry = _table->bucket(bucket);
     while (*entry != NULL) {
       oop* p = (oop*)(*entry)->obj_addr();
       if (cl->is_alive(*p)) {
@@ -475,7 +478,7 @@ uintx G1StringDedupTable::unlink_or_oops_do(G1StringDedupUnlinkOrOopsDoClosure*
   return removed;
 }
 
-G1StringDedupTable* G1StringDedupTable::prepare_rehash() {
+StringDedupTable* StringDedupTable::prepare_rehash() {
   if (!_table->_rehash_needed && !StringDeduplicationRehashALot) {
     // Rehash not needed
     return NULL;
@@ -488,15 +491,15 @@ G1StringDedupTable* G1StringDedupTable::prepare_rehash() {
   _table->_hash_seed = AltHashing::compute_seed();
 
   // Allocate the new table, same size and hash seed
-  return new G1StringDedupTable(_table->_size, _table->_hash_seed);
+  return new StringDedupTable(_table->_size, _table->_hash_seed);
 }
 
-void G1StringDedupTable::finish_rehash(G1StringDedupTable* rehashed_table) {
+void StringDedupTable::finish_rehash(StringDedupTable* rehashed_table) {
   assert(rehashed_table != NULL, "Invalid table");
 
   // Move all newly rehashed entries into the correct buckets in the new table
   for (size_t bucket = 0; bucket < _table->_size; bucket++) {
-    G1StringDedupEntry** entry = _table->bucket(bucket);
+    StringDedupEntry** entry = _table->bucket(bucket);
     while (*entry != NULL) {
       _table->transfer(entry, rehashed_table);
     }
@@ -511,10 +514,10 @@ void G1StringDedupTable::finish_rehash(G1StringDedupTable* rehashed_table) {
   _table = rehashed_table;
 }
 
-void G1StringDedupTable::verify() {
+void StringDedupTable::verify() {
   for (size_t bucket = 0; bucket < _table->_size; bucket++) {
     // Verify entries
-    G1StringDedupEntry** entry = _table->bucket(bucket);
+    StringDedupEntry** entry = _table->bucket(bucket);
     while (*entry != NULL) {
       typeArrayOop value = (*entry)->obj();
       guarantee(value != NULL, "Object must not be NULL");
@@ -531,10 +534,10 @@ void G1StringDedupTable::verify() {
     // We only need to compare entries in the same bucket. If the same oop or an
     // identical array has been inserted more than once into different/incorrect
     // buckets the verification step above will catch that.
-    G1StringDedupEntry** entry1 = _table->bucket(bucket);
+    StringDedupEntry** entry1 = _table->bucket(bucket);
     while (*entry1 != NULL) {
       typeArrayOop value1 = (*entry1)->obj();
-      G1StringDedupEntry** entry2 = (*entry1)->next_addr();
+      StringDedupEntry** entry2 = (*entry1)->next_addr();
       while (*entry2 != NULL) {
         typeArrayOop value2 = (*entry2)->obj();
         guarantee(!equals(value1, value2), "Table entries must not have identical arrays");
@@ -545,22 +548,22 @@ void G1StringDedupTable::verify() {
   }
 }
 
-void G1StringDedupTable::trim_entry_cache() {
+void StringDedupTable::trim_entry_cache() {
   MutexLockerEx ml(StringDedupTable_lock, Mutex::_no_safepoint_check_flag);
   size_t max_cache_size = (size_t)(_table->_size * _max_cache_factor);
   _entry_cache->trim(max_cache_size);
 }
 
-void G1StringDedupTable::print_statistics(outputStream* st) {
+void StringDedupTable::print_statistics(outputStream* st) {
   st->print_cr(
     "   [Table]\n"
-    "      [Memory Usage: "G1_STRDEDUP_BYTES_FORMAT_NS"]\n"
+    "      [Memory Usage: "STRDEDUP_BYTES_FORMAT_NS"]\n"
     "      [Size: "SIZE_FORMAT", Min: "SIZE_FORMAT", Max: "SIZE_FORMAT"]\n"
-    "      [Entries: "UINTX_FORMAT", Load: "G1_STRDEDUP_PERCENT_FORMAT_NS", Cached: " UINTX_FORMAT ", Added: "UINTX_FORMAT", Removed: "UINTX_FORMAT"]\n"
-    "      [Resize Count: "UINTX_FORMAT", Shrink Threshold: "UINTX_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT_NS"), Grow Threshold: "UINTX_FORMAT"("G1_STRDEDUP_PERCENT_FORMAT_NS")]\n"
+    "      [Entries: "UINTX_FORMAT", Load: "STRDEDUP_PERCENT_FORMAT_NS", Cached: " UINTX_FORMAT ", Added: "UINTX_FORMAT", Removed: "UINTX_FORMAT"]\n"
+    "      [Resize Count: "UINTX_FORMAT", Shrink Threshold: "UINTX_FORMAT"("STRDEDUP_PERCENT_FORMAT_NS"), Grow Threshold: "UINTX_FORMAT"("STRDEDUP_PERCENT_FORMAT_NS")]\n"
     "      [Rehash Count: "UINTX_FORMAT", Rehash Threshold: "UINTX_FORMAT", Hash Seed: 0x%x]\n"
     "      [Age Threshold: "UINTX_FORMAT"]",
-    G1_STRDEDUP_BYTES_PARAM(_table->_size * sizeof(G1StringDedupEntry*) + (_table->_entries + _entry_cache->size()) * sizeof(G1StringDedupEntry)),
+    STRDEDUP_BYTES_PARAM(_table->_size * sizeof(StringDedupEntry*) + (_table->_entries + _entry_cache->size()) * sizeof(StringDedupEntry)),
     _table->_size, _min_size, _max_size,
     _table->_entries, (double)_table->_entries / (double)_table->_size * 100.0, _entry_cache->size(), _entries_added, _entries_removed,
     _resize_count, _table->_shrink_threshold, _shrink_load_factor * 100.0, _table->_grow_threshold, _grow_load_factor * 100.0,
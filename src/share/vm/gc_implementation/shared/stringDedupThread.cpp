@@ -24,55 +24,55 @@
 
 #include "precompiled.hpp"
 #include "gc_implementation/g1/g1Log.hpp"
-#include "gc_implementation/g1/g1StringDedup.hpp"
-#include "gc_implementation/g1/g1StringDedupTable.hpp"
-#include "gc_implementation/g1/g1StringDedupThread.hpp"
-#include "gc_implementation/g1/g1StringDedupQueue.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
+#include "gc_implementation/shared/stringDedupTable.hpp"
+#include "gc_implementation/shared/stringDedupThread.hpp"
+#include "gc_implementation/shared/stringDedupQueue.hpp"
 
-G1StringDedupThread* G1StringDedupThread::_thread = NULL;
+StringDedupThread* StringDedupThread::_thread = NULL;
 
-G1StringDedupThread::G1StringDedupThread() :
+StringDedupThread::StringDedupThread() :
   ConcurrentGCThread() {
   set_name("String Deduplication Thread");
   create_and_start();
 }
 
-G1StringDedupThread::~G1StringDedupThread() {
+StringDedupThread::~StringDedupThread() {
   ShouldNotReachHere();
 }
 
-void G1StringDedupThread::create() {
-  assert(G1StringDedup::is_enabled(), "String deduplication not enabled");
+void StringDedupThread::create() {
+  assert(StringDedup::is_enabled(), "String deduplication not enabled");
   assert(_thread == NULL, "One string deduplication thread allowed");
-  _thread = new G1StringDedupThread();
+  _thread = new StringDedupThread();
 }
 
-G1StringDedupThread* G1StringDedupThread::thread() {
-  assert(G1StringDedup::is_enabled(), "String deduplication not enabled");
+StringDedupThread* StringDedupThread::thread() {
+  assert(StringDedup::is_enabled(), "String deduplication not enabled");
   assert(_thread != NULL, "String deduplication thread not created");
   return _thread;
 }
 
-void G1StringDedupThread::print_on(outputStream* st) const {
+void StringDedupThread::print_on(outputStream* st) const {
   st->print("\"%s\" ", name());
   Thread::print_on(st);
   st->cr();
 }
 
-void G1StringDedupThread::run() {
-  G1StringDedupStat total_stat;
+void StringDedupThread::run() {
+  StringDedupStat total_stat;
 
   initialize_in_thread();
   wait_for_universe_init();
 
   // Main loop
   for (;;) {
-    G1StringDedupStat stat;
+    StringDedupStat stat;
 
     stat.mark_idle();
 
     // Wait for the queue to become non-empty
-    G1StringDedupQueue::wait();
+    StringDedupQueue::wait();
     if (_should_terminate) {
       break;
     }
@@ -85,12 +85,12 @@ void G1StringDedupThread::run() {
 
       // Process the queue
       for (;;) {
-        oop java_string = G1StringDedupQueue::pop();
+        oop java_string = StringDedupQueue::pop();
         if (java_string == NULL) {
           break;
         }
 
-        G1StringDedupTable::deduplicate(java_string, stat);
+        StringDedupTable::deduplicate(java_string, stat);
 
         // Safepoint this thread if needed
         if (sts.should_yield()) {
@@ -100,7 +100,7 @@ void G1StringDedupThread::run() {
         }
       }
 
-      G1StringDedupTable::trim_entry_cache();
+      StringDedupTable::trim_entry_cache();
 
       stat.mark_done();
 
@@ -113,13 +113,13 @@ void G1StringDedupThread::run() {
   terminate();
 }
 
-void G1StringDedupThread::stop() {
+void StringDedupThread::stop() {
   {
     MonitorLockerEx ml(Terminator_lock);
     _thread->_should_terminate = true;
   }
 
-  G1StringDedupQueue::cancel_wait();
+  StringDedupQueue::cancel_wait();
 
   {
     MonitorLockerEx ml(Terminator_lock);
@@ -129,14 +129,16 @@ void G1StringDedupThread::stop() {
   }
 }
 
-void G1StringDedupThread::print(outputStream* st, const G1StringDedupStat& last_stat, const G1StringDedupStat& total_stat) {
-  if (G1Log::fine() || PrintStringDeduplicationStatistics) {
-    G1StringDedupStat::print_summary(st, last_stat, total_stat);
+void StringDedupThread::print(outputStream* st, const StringDedupStat& last_stat, const StringDedupStat& total_stat) {
+  // G1 has its own log levels, the other collectors print with PrintGC.
+  bool print_summary = UseG1GC ? G1Log::fine() : PrintGC;
+  if (print_summary || PrintStringDeduplicationStatistics) {
+    StringDedupStat::print_summary(st, last_stat, total_stat);
     if (PrintStringDeduplicationStatistics) {
-      G1StringDedupStat::print_statistics(st, last_stat, false);
-      G1StringDedupStat::print_statistics(st, total_stat, true);
-      G1StringDedupTable::print_statistics(st);
-      G1StringDedupQueue::print_statistics(st);
+      StringDedupStat::print_statistics(st, last_stat, false);
+      StringDedupStat::print_statistics(st, total_stat, true);
+      StringDedupTable::print_statistics(st);
+      StringDedupQueue::print_statistics(st);
     }
   }
 }
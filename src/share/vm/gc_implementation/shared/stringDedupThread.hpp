@@ -22,10 +22,10 @@
  *
  */
 
-#ifndef SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPTHREAD_HPP
-#define SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPTHREAD_HPP
+#ifndef SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPTHREAD_HPP
+#define SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPTHREAD_HPP
 
-#include "gc_implementation/g1/g1StringDedupStat.hpp"
+#include "gc_implementation/shared/stringDedupStat.hpp"
 #include "gc_implementation/shared/concurrentGCThread.hpp"
 
 //
@@ -36,23 +36,23 @@
 // concurrently with the Java application but participates in safepoints to allow
 // the GC to adjust and unlink oops from the deduplication queue and table.
 //
-class G1StringDedupThread: public ConcurrentGCThread {
+class StringDedupThread: public ConcurrentGCThread {
 private:
-  static G1StringDedupThread* _thread;
+  static StringDedupThread* _thread;
 
-  G1StringDedupThread();
-  ~G1StringDedupThread();
+  StringDedupThread();
+  ~StringDedupThread();
 
-  void print(outputStream* st, const G1StringDedupStat& last_stat, const G1StringDedupStat& total_stat);
+  void print(outputStream* st, const StringDedupStat& last_stat, const StringDedupStat& total_stat);
 
 public:
   static void create();
   static void stop();
 
-  static G1StringDedupThread* thread();
+  static StringDedupThread* thread();
 
   virtual void run();
   virtual void print_on(outputStream* st) const;
 };
 
-#endif // SHARE_VM_GC_IMPLEMENTATION_G1_G1STRINGDEDUPTHREAD_HPP
+#endif // SHARE_VM_GC_IMPLEMENTATION_SHARED_STRINGDEDUPTHREAD_HPP
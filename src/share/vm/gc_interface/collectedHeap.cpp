@@ -305,6 +305,27 @@ HeapWord* CollectedHeap::allocate_from_tlab_slow(KlassHandle klass, Thread* thre
   return obj;
 }
 
+HeapWord* CollectedHeap::allocate_from_phantom_buffer_slow(JavaThread* thread, size_t size) {
+  const size_t buffer_size = align_size_down(PhantomAllocBufferSize, HeapWordSize) / HeapWordSize;
+
+  // Large phantom objects are allocated as ordinary objects
+  // so that refilling the buffer never wastes more than half of it.
+  if (size + min_fill_size() > buffer_size / 2) {
+    return NULL;
+  }
+
+  thread->retire_phantom_buffer();
+
+  HeapWord* obj = Universe::heap()->allocate_new_tlab(buffer_size);
+  if (obj == NULL) {
+    return NULL;
+  }
+
+  thread->incr_allocated_bytes(buffer_size * HeapWordSize);
+  thread->set_phantom_buffer(obj + size, obj + buffer_size);
+  return obj;
+}
+
 void CollectedHeap::flush_deferred_store_barrier(JavaThread* thread) {
   MemRegion deferred = thread->deferred_card_mark();
   if (!deferred.is_empty()) {
@@ -524,6 +545,7 @@ void CollectedHeap::ensure_parsability(bool retire_tlabs) {
          " to threads list is doomed to failure!");
   for (JavaThread *thread = Threads::first(); thread; thread = thread->next()) {
      if (use_tlab) thread->tlab().make_parsable(retire_tlabs);
+     thread->retire_phantom_buffer();
 #ifdef COMPILER2
      // The deferred store barriers must all have been flushed to the
      // card-table (or other remembered set structure) before GC starts
@@ -39,6 +39,7 @@
 // class defines the functions that a heap must implement, and contains
 // infrastructure common to all heaps.
 
+class AbstractGangTask;
 class AdaptiveSizePolicy;
 class BarrierSet;
 class CollectorPolicy;
@@ -51,6 +52,16 @@ class ThreadClosure;
 class VirtualSpaceSummary;
 class nmethod;
 
+// Iterates over the objects of the heap from several GC worker threads
+// at a safepoint.  Each call of object_iterate() visits the objects of
+// the parts of the heap that the calling worker claims, so that all
+// calls together visit every object exactly once.
+class ParallelObjectIterator : public CHeapObj<mtGC> {
+ public:
+  virtual void object_iterate(ObjectClosure* cl, uint worker_id) = 0;
+  virtual ~ParallelObjectIterator() {}
+};
+
 class GCMessage : public FormatBuffer<1024> {
  public:
   bool is_before;
@@ -146,6 +157,10 @@ class CollectedHeap : public CHeapObj<mtInternal> {
   // is guaranteed initialized to zeros.
   inline static HeapWord* common_mem_allocate_init(KlassHandle klass, size_t size, TRAPS);
 
+  // Allocate from the phantom buffer of a JavaThread, or return NULL.
+  inline static HeapWord* allocate_from_phantom_buffer(Thread* thread, size_t size);
+  static HeapWord* allocate_from_phantom_buffer_slow(JavaThread* thread, size_t size);
+
   // Helper functions for (VM) allocation.
   inline static void post_allocation_setup_common(KlassHandle klass, HeapWord* obj);
   inline static void post_allocation_setup_no_klass_install(KlassHandle klass,
@@ -317,6 +332,9 @@ class CollectedHeap : public CHeapObj<mtInternal> {
 
   // General obj/array allocation facilities.
   inline static oop obj_allocate(KlassHandle klass, int size, TRAPS);
+  // Phantom objects of mixed objects are allocated together in a thread
+  // local phantom buffer so that they are close to each other.
+  inline static oop phantom_obj_allocate(KlassHandle klass, int size, TRAPS);
   inline static oop array_allocate(KlassHandle klass, int size, int length, TRAPS);
   inline static oop array_allocate_nozero(KlassHandle klass, int size, int length, TRAPS);
 
@@ -468,6 +486,13 @@ class CollectedHeap : public CHeapObj<mtInternal> {
   // Perform a full collection
   virtual void do_full_collection(bool clear_all_soft_refs) = 0;
 
+  // Collections started by the service thread while the application is
+  // idle. periodic_collection_interval() is how often (in ms) the service
+  // thread asks, zero if the heap does not do periodic collections.
+  virtual jlong periodic_collection_interval() const { return 0; }
+  virtual bool should_do_periodic_collection()      { return false; }
+  virtual void do_periodic_collection()             { ShouldNotReachHere(); }
+
   // This interface assumes that it's being called by the
   // vm thread. It collects the heap assuming that the
   // heap lock is already held and that we are executing in
@@ -516,6 +541,18 @@ class CollectedHeap : public CHeapObj<mtInternal> {
   // over live objects.
   virtual void safe_object_iterate(ObjectClosure* cl) = 0;
 
+  // Parallel object iteration at a safepoint, used by heap inspection.
+  // safepoint_workers_count() is the number of GC worker threads that
+  // run_task() runs "task" on, or 0 if the heap has no worker threads
+  // that are idle at a safepoint.  parallel_object_iterator() returns a
+  // C-heap allocated iterator for "thread_num" workers, or NULL if the
+  // heap can only be iterated serially.
+  virtual uint safepoint_workers_count() { return 0; }
+  virtual void run_task(AbstractGangTask* task) { ShouldNotReachHere(); }
+  virtual ParallelObjectIterator* parallel_object_iterator(uint thread_num) {
+    return NULL;
+  }
+
   // NOTE! There is no requirement that a collector implement these
   // functions.
   //
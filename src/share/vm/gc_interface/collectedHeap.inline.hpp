@@ -206,6 +206,38 @@ oop CollectedHeap::obj_allocate(KlassHandle klass, int size, TRAPS) {
   return (oop)obj;
 }
 
+HeapWord* CollectedHeap::allocate_from_phantom_buffer(Thread* thread, size_t size) {
+  if (!UsePhantomAllocBuffer || !UseTLAB || !thread->is_Java_thread()) {
+    return NULL;
+  }
+
+  JavaThread* jt = (JavaThread*) thread;
+  HeapWord* top = jt->phantom_buffer_top();
+  if (top != NULL) {
+    size_t available = pointer_delta(jt->phantom_buffer_end(), top);
+    // The rest of the buffer must be large enough for a filler object.
+    if (size == available || size + min_fill_size() <= available) {
+      jt->set_phantom_buffer_top(top + size);
+      return top;
+    }
+  }
+  return allocate_from_phantom_buffer_slow(jt, size);
+}
+
+oop CollectedHeap::phantom_obj_allocate(KlassHandle klass, int size, TRAPS) {
+  debug_only(check_for_valid_allocation_state());
+  assert(!Universe::heap()->is_gc_active(), "Allocation during gc not allowed");
+  assert(size >= 0, "int won't convert to size_t");
+  HeapWord* obj = allocate_from_phantom_buffer(THREAD, size);
+  if (obj == NULL) {
+    return obj_allocate(klass, size, THREAD);
+  }
+  init_obj(obj, size);
+  post_allocation_setup_obj(klass, obj, size);
+  NOT_PRODUCT(Universe::heap()->check_for_bad_heap_word_value(obj, size));
+  return (oop)obj;
+}
+
 oop CollectedHeap::array_allocate(KlassHandle klass,
                                   int size,
                                   int length,
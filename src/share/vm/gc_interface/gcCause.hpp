@@ -71,6 +71,7 @@ class GCCause : public AllStatic {
 
     _g1_inc_collection_pause,
     _g1_humongous_allocation,
+    _g1_periodic_collection,
 
     _last_ditch_collection,
     _last_gc_cause
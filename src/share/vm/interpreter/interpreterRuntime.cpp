@@ -729,17 +729,6 @@ IRT_ENTRY(void, InterpreterRuntime::type_narrow_check(JavaThread* thread, oopDes
     return;
   }
 
-  InstanceKlass* obj_klass = (InstanceKlass*)obj->klass();
-  if (obj_klass->is_stale_class()) {
-    Javelus::transform_object_common(obj, thread);
-    obj_klass = (InstanceKlass*)obj->klass();
-  }
-
-  assert(!obj_klass->is_stale_class(), "sanity check");
-  if (obj_klass->is_inplace_new_class()) {
-    obj_klass = obj_klass->next_version();
-  }
-
   Klass* target_class = NULL;
   methodHandle m (thread, method(thread));
   Bytecodes::Code code  = Bytecodes::code_at(m(), bcp(thread));
@@ -771,13 +760,16 @@ IRT_ENTRY(void, InterpreterRuntime::type_narrow_check(JavaThread* thread, oopDes
 
   assert(target_class != NULL, "sanity check");
 
-  if (!obj_klass->is_subtype_of(target_class)) {
-    ResourceMark rm(thread);
-    char* message = SharedRuntime::generate_class_cast_message(
-        thread, obj->klass()->external_name());
+  Javelus::type_narrow_check(obj, target_class, CHECK);
 
-    // create exception
-    THROW_MSG(vmSymbols::java_lang_ClassCastException(), message);
+  // the template checks the cache before calling into the runtime next time
+  if (UseDSUTypeNarrowCache) {
+    DSUTypeNarrowCache* cache = DSUTypeNarrowCache::cache_for(m(), THREAD);
+    if (HAS_PENDING_EXCEPTION) {
+      CLEAR_PENDING_EXCEPTION;
+    } else if (cache != NULL) {
+      cache->record(bci(thread), obj());
+    }
   }
 IRT_END
 
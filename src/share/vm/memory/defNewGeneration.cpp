@@ -41,11 +41,16 @@
 #include "memory/space.inline.hpp"
 #include "oops/instanceRefKlass.hpp"
 #include "oops/oop.inline.hpp"
+#include "runtime/dsu.hpp"
 #include "runtime/java.hpp"
 #include "runtime/prefetch.inline.hpp"
 #include "runtime/thread.inline.hpp"
 #include "utilities/copy.hpp"
 #include "utilities/stack.inline.hpp"
+#include "utilities/macros.hpp"
+#if INCLUDE_ALL_GCS
+#include "gc_implementation/shared/stringDedup.hpp"
+#endif // INCLUDE_ALL_GCS
 
 PRAGMA_FORMAT_MUTE_WARNINGS_FOR_GCC
 
@@ -646,6 +651,13 @@ void DefNewGeneration::collect(bool   full,
                                     NULL, _gc_timer, gc_tracer.gc_id());
   gc_tracer.report_gc_reference_stats(stats);
 
+#if INCLUDE_ALL_GCS
+  if (StringDedup::is_enabled()) {
+    // Unlink dead deduplication candidates and update the ones that moved.
+    StringDedup::unlink_or_oops_do(&is_alive, &keep_alive, true /* allow_resize_and_rehash */);
+  }
+#endif // INCLUDE_ALL_GCS
+
   if (!_promotion_failed) {
     // Swap the survivor spaces.
     eden()->clear(SpaceDecorator::Mangle);
@@ -812,6 +824,20 @@ oop DefNewGeneration::copy_to_survivor_space(oop old) {
     age_table()->add(obj, s);
   }
 
+#if INCLUDE_ALL_GCS
+  if (StringDedup::is_enabled()) {
+    StringDedup::enqueue_from_evacuation(true /* from_young */,
+                                         is_in_reserved(obj),
+                                         0 /* worker_id */,
+                                         obj);
+  }
+#endif // INCLUDE_ALL_GCS
+
+  if (DSUStaleInstances::is_enabled()) {
+    // Weak processing follows the forwarding pointer.
+    DSUStaleInstances::enqueue(old);
+  }
+
   // Done, insert forward pointer to obj in this header
   old->forward_to(obj);
 
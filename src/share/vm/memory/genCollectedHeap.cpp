@@ -58,6 +58,7 @@
 #if INCLUDE_ALL_GCS
 #include "gc_implementation/concurrentMarkSweep/concurrentMarkSweepThread.hpp"
 #include "gc_implementation/concurrentMarkSweep/vmCMSOperations.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #endif // INCLUDE_ALL_GCS
 
 GenCollectedHeap* GenCollectedHeap::_gch;
@@ -1226,6 +1227,9 @@ void GenCollectedHeap::gc_threads_do(ThreadClosure* tc) const {
   if (UseConcMarkSweepGC) {
     ConcurrentMarkSweepThread::threads_do(tc);
   }
+  if (StringDedup::is_enabled()) {
+    StringDedup::threads_do(tc);
+  }
 #endif // INCLUDE_ALL_GCS
 }
 
@@ -1237,6 +1241,9 @@ void GenCollectedHeap::print_gc_threads_on(outputStream* st) const {
   if (UseConcMarkSweepGC) {
     ConcurrentMarkSweepThread::print_all_on(st);
   }
+  if (StringDedup::is_enabled()) {
+    StringDedup::print_worker_threads_on(st);
+  }
 #endif // INCLUDE_ALL_GCS
 }
 
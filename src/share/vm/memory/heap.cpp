@@ -35,7 +35,8 @@ size_t CodeHeap::header_size() {
 
 // Implementation of Heap
 
-CodeHeap::CodeHeap() {
+CodeHeap::CodeHeap(const char* name) {
+  _name                         = name;
   _number_of_committed_segments = 0;
   _number_of_reserved_segments  = 0;
   _segment_size                 = 0;
@@ -87,31 +88,51 @@ void CodeHeap::on_code_mapping(char* base, size_t size) {
 }
 
 
+ReservedCodeSpace CodeHeap::reserve_memory(size_t reserved_size, size_t* page_size) {
+  size_t ps = os::vm_page_size();
+  if (os::can_execute_large_page_memory()) {
+    ps = os::page_size_for_region_unaligned(reserved_size, 8);
+  }
+
+  const size_t granularity = os::vm_allocation_granularity();
+  const size_t r_align = MAX2(ps, granularity);
+  const size_t r_size = align_size_up(reserved_size, r_align);
+
+  const size_t rs_align = ps == (size_t) os::vm_page_size() ? 0 :
+    MAX2(ps, granularity);
+  *page_size = ps;
+  return ReservedCodeSpace(r_size, rs_align, rs_align > 0);
+}
+
 bool CodeHeap::reserve(size_t reserved_size, size_t committed_size,
                        size_t segment_size) {
   assert(reserved_size >= committed_size, "reserved < committed");
+
+  // Reserve and initialize space for _memory.
+  size_t page_size;
+  ReservedCodeSpace rs = reserve_memory(reserved_size, &page_size);
+  os::trace_page_sizes("code heap", committed_size, reserved_size, page_size,
+                       rs.base(), rs.size());
+  return reserve(rs, committed_size, segment_size);
+}
+
+// Use the given part of a code space reserved by reserve_memory()
+bool CodeHeap::reserve(ReservedSpace rs, size_t committed_size,
+                       size_t segment_size) {
+  assert(rs.size() >= committed_size, "reserved < committed");
   assert(segment_size >= sizeof(FreeBlock), "segment size is too small");
   assert(is_power_of_2(segment_size), "segment_size must be a power of 2");
 
   _segment_size      = segment_size;
   _log2_segment_size = exact_log2(segment_size);
 
-  // Reserve and initialize space for _memory.
   size_t page_size = os::vm_page_size();
   if (os::can_execute_large_page_memory()) {
-    page_size = os::page_size_for_region_unaligned(reserved_size, 8);
+    page_size = os::page_size_for_region_unaligned(rs.size(), 8);
   }
-
   const size_t granularity = os::vm_allocation_granularity();
-  const size_t r_align = MAX2(page_size, granularity);
-  const size_t r_size = align_size_up(reserved_size, r_align);
   const size_t c_size = align_size_up(committed_size, page_size);
 
-  const size_t rs_align = page_size == (size_t) os::vm_page_size() ? 0 :
-    MAX2(page_size, granularity);
-  ReservedCodeSpace rs(r_size, rs_align, rs_align > 0);
-  os::trace_page_sizes("code heap", committed_size, reserved_size, page_size,
-                       rs.base(), rs.size());
   if (!_memory.initialize(rs, c_size)) {
     return false;
   }
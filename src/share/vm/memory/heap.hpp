@@ -80,6 +80,7 @@ class FreeBlock: public HeapBlock {
 class CodeHeap : public CHeapObj<mtCode> {
   friend class VMStructs;
  private:
+  const char*  _name;                            // the name of the heap, e.g. for its memory pool
   VirtualSpace _memory;                          // the memory holding the blocks
   VirtualSpace _segmap;                          // the memory holding the segment map
 
@@ -122,10 +123,13 @@ class CodeHeap : public CHeapObj<mtCode> {
   void on_code_mapping(char* base, size_t size);
 
  public:
-  CodeHeap();
+  CodeHeap(const char* name = "Code Cache");
 
   // Heap extents
   bool  reserve(size_t reserved_size, size_t committed_size, size_t segment_size);
+  bool  reserve(ReservedSpace rs, size_t committed_size, size_t segment_size);
+  // Reserves memory for one or more code heaps, with large pages if possible
+  static ReservedCodeSpace reserve_memory(size_t reserved_size, size_t* page_size);
   void  release();                               // releases all allocated memory
   bool  expand_by(size_t size);                  // expands commited memory by size
   void  shrink_by(size_t size);                  // shrinks commited memory by size
@@ -136,6 +140,7 @@ class CodeHeap : public CHeapObj<mtCode> {
   void  deallocate(void* p);                     // deallocates a block
 
   // Attributes
+  const char* name() const                       { return _name; }
   char* low_boundary() const                     { return _memory.low_boundary (); }
   char* high() const                             { return _memory.high(); }
   char* high_boundary() const                    { return _memory.high_boundary(); }
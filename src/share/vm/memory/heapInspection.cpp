@@ -28,9 +28,11 @@
 #include "memory/genCollectedHeap.hpp"
 #include "memory/heapInspection.hpp"
 #include "memory/resourceArea.hpp"
+#include "runtime/mutexLocker.hpp"
 #include "runtime/os.hpp"
 #include "utilities/globalDefinitions.hpp"
 #include "utilities/macros.hpp"
+#include "utilities/workgroup.hpp"
 #if INCLUDE_ALL_GCS
 #include "gc_implementation/parallelScavenge/parallelScavengeHeap.hpp"
 #endif // INCLUDE_ALL_GCS
@@ -200,6 +202,46 @@ size_t KlassInfoTable::size_of_instances_in_words() const {
   return _size_of_instances_in_words;
 }
 
+// Return false if the entry could not be recorded on account
+// of running out of space required to create a new entry.
+bool KlassInfoTable::merge_entry(const KlassInfoEntry* cie) {
+  Klass*          k = cie->klass();
+  KlassInfoEntry* elt = lookup(k);
+  if (elt != NULL) {
+    elt->set_count(elt->count() + cie->count());
+    elt->set_words(elt->words() + cie->words());
+    _size_of_instances_in_words += cie->words();
+    return true;
+  } else {
+    return false;
+  }
+}
+
+class KlassInfoTableMergeClosure : public KlassInfoClosure {
+ private:
+  KlassInfoTable* _dest;
+  size_t _missed_count;
+ public:
+  KlassInfoTableMergeClosure(KlassInfoTable* table) : _dest(table), _missed_count(0) {}
+
+  void do_cinfo(KlassInfoEntry* cie) {
+    if (!_dest->merge_entry(cie)) {
+      _missed_count += cie->count();
+    }
+  }
+
+  size_t missed_count() { return _missed_count; }
+};
+
+// Add the entries of "table" to this table.  Returns the number of
+// instances that could not be recorded on account of running out of
+// space required to create new entries.
+size_t KlassInfoTable::merge(KlassInfoTable* table) {
+  KlassInfoTableMergeClosure closure(this);
+  table->iterate(&closure);
+  return closure.missed_count();
+}
+
 int KlassInfoHisto::sort_helper(KlassInfoEntry** e1, KlassInfoEntry** e2) {
   return (*e1)->compare(*e1,*e2);
 }
@@ -469,7 +511,8 @@ class RecordInstanceClosure : public ObjectClosure {
 
   void do_object(oop obj) {
     if (should_visit(obj)) {
-      if (!_cit->record_instance(obj)) {
+      // _cit is NULL if a parallel worker could not allocate its table.
+      if (_cit == NULL || !_cit->record_instance(obj)) {
         _missed_count++;
       }
     }
@@ -483,9 +526,56 @@ class RecordInstanceClosure : public ObjectClosure {
   }
 };
 
-size_t HeapInspection::populate_table(KlassInfoTable* cit, BoolObjectClosure *filter) {
+// Each worker counts the instances of the parts of the heap it claims
+// in a table of its own, and merges it into the shared table at the end.
+class ParHeapInspectTask : public AbstractGangTask {
+ private:
+  ParallelObjectIterator* _poi;
+  KlassInfoTable*         _shared_cit;
+  BoolObjectClosure*      _filter;
+  size_t                  _missed_count;
+  Mutex                   _mutex;
+
+ public:
+  ParHeapInspectTask(ParallelObjectIterator* poi,
+                     KlassInfoTable* shared_cit,
+                     BoolObjectClosure* filter) :
+      AbstractGangTask("Iterating heap"),
+      _poi(poi),
+      _shared_cit(shared_cit),
+      _filter(filter),
+      _missed_count(0),
+      _mutex(Mutex::leaf, "Parallel heap inspection merge lock") {}
+
+  size_t missed_count() const { return _missed_count; }
+
+  virtual void work(uint worker_id) {
+    KlassInfoTable cit(false);
+    RecordInstanceClosure ric(cit.allocation_failed() ? NULL : &cit, _filter);
+    _poi->object_iterate(&ric, worker_id);
+
+    MutexLockerEx ml(&_mutex, Mutex::_no_safepoint_check_flag);
+    _missed_count += ric.missed_count();
+    if (!cit.allocation_failed()) {
+      _missed_count += _shared_cit->merge(&cit);
+    }
+  }
+};
+
+size_t HeapInspection::populate_table(KlassInfoTable* cit, BoolObjectClosure *filter,
+                                      uint parallel_thread_num) {
   ResourceMark rm;
 
+  if (parallel_thread_num > 1) {
+    ParallelObjectIterator* poi = Universe::heap()->parallel_object_iterator(parallel_thread_num);
+    if (poi != NULL) {
+      ParHeapInspectTask task(poi, cit, filter);
+      Universe::heap()->run_task(&task);
+      delete poi;
+      return task.missed_count();
+    }
+  }
+
   RecordInstanceClosure ric(cit, filter);
   Universe::heap()->object_iterate(&ric);
   return ric.missed_count();
@@ -514,7 +604,11 @@ void HeapInspection::heap_inspection(outputStream* st) {
 
   KlassInfoTable cit(_print_class_stats);
   if (!cit.allocation_failed()) {
-    size_t missed_count = populate_table(&cit);
+    uint parallel_thread_num = 1;
+    if (ParallelHeapInspection) {
+      parallel_thread_num = MAX2(1U, Universe::heap()->safepoint_workers_count());
+    }
+    size_t missed_count = populate_table(&cit, NULL, parallel_thread_num);
     if (missed_count != 0) {
       st->print_cr("WARNING: Ran out of C-heap; undercounted " SIZE_FORMAT
                    " total instances in data below",
@@ -81,6 +81,7 @@
 #include "gc_implementation/g1/g1CollectedHeap.inline.hpp"
 #include "gc_implementation/g1/g1CollectorPolicy_ext.hpp"
 #include "gc_implementation/parallelScavenge/parallelScavengeHeap.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #endif // INCLUDE_ALL_GCS
 
 PRAGMA_FORMAT_MUTE_WARNINGS_FOR_GCC
@@ -841,6 +842,11 @@ jint Universe::initialize_heap() {
     return status;
   }
 
+#if INCLUDE_ALL_GCS
+  // String deduplication is shared by all collectors.
+  StringDedup::initialize();
+#endif // INCLUDE_ALL_GCS
+
 #ifdef _LP64
   if (UseCompressedOops) {
     // Subtract a page because something can get allocated at heap base.
@@ -28,6 +28,7 @@
 #include "classfile/verifier.hpp"
 #include "classfile/vmSymbols.hpp"
 #include "compiler/compileBroker.hpp"
+#include "compiler/compileCache.hpp"
 #include "gc_implementation/shared/markSweep.inline.hpp"
 #include "gc_interface/collectedHeap.inline.hpp"
 #include "interpreter/oopMapCache.hpp"
@@ -196,9 +197,65 @@ InstanceKlass* InstanceKlass::clone_instance_klass(InstanceKlass* klass, TRAPS)
   Klass* new_next = newik->next_link();
   memcpy(newik, klass, klass->size() * (HeapWordSize));
   newik->set_next_link(new_next);
+  // the clone must not share the DSU info with its source
+  if (klass->_dsu_info != NULL) {
+    newik->_dsu_info = new DSUKlassInfo(*klass->_dsu_info);
+    newik->_dsu_info->_copy_plan = NULL;
+  }
   return newik;
 }
 
+// Classes defined by class loaders are born at revision 0,
+// see SystemDictionary::update_dictionary.
+DSUKlassInfo::DSUKlassInfo()
+: _born_rn(0),
+  _dead_rn(Javelus::MAX_REVISION_NUMBER),
+  _copy_to_size(0),
+  _dsu_state(DSUState::dsu_none),
+  _transformation_level(0),
+  _previous_version(NULL),
+  _next_version(NULL),
+  _new_inplace_new_class(NULL),
+  _stale_new_class(NULL),
+  _class_transformer(NULL),
+  _class_transformer_args(NULL),
+  _object_transformer(NULL),
+  _object_transformer_args(NULL),
+  _matched_fields(NULL),
+  _inplace_fields(NULL),
+  _copy_plan(NULL),
+  _class_file_fingerprint(0) {}
+
+const DSUKlassInfo DSUKlassInfo::_empty;
+
+DSUKlassInfo* InstanceKlass::create_dsu_info() {
+  if (_dsu_info == NULL) {
+    // Copy plans are installed by Java threads, so the info may be
+    // created concurrently.
+    DSUKlassInfo* info = new DSUKlassInfo();
+    if (Atomic::cmpxchg_ptr(info, &_dsu_info, NULL) != NULL) {
+      delete info;
+    }
+  }
+  return _dsu_info;
+}
+
+DSUCopyPlan* InstanceKlass::install_copy_plan(DSUCopyPlan* plan) {
+  DSUKlassInfo* info = create_dsu_info();
+  DSUCopyPlan* old = (DSUCopyPlan*)Atomic::cmpxchg_ptr(plan, &info->_copy_plan, NULL);
+  return old == NULL ? plan : old;
+}
+
+void InstanceKlass::release_dsu_info() {
+  if (_dsu_info != NULL) {
+    if (_dsu_info->_copy_plan != NULL) {
+      delete _dsu_info->_copy_plan;
+    }
+    delete _dsu_info;
+    _dsu_info = NULL;
+  }
+}
+
 
 InstanceKlass* InstanceKlass::allocate_instance_klass(
                                               ClassLoaderData* loader_data,
@@ -342,21 +399,7 @@ InstanceKlass::InstanceKlass(int vtable_len,
   NOT_PRODUCT(_verify_count = 0;)
 
   // DSU support
-  set_born_rn(Javelus::MIN_REVISION_NUMBER);
-  set_dead_rn(Javelus::MAX_REVISION_NUMBER);
-  set_copy_to_size(0);
-  set_dsu_state(0);
-  set_previous_version(NULL);
-  set_next_version(NULL);
-  set_new_inplace_new_class(NULL);
-  set_stale_new_class(NULL);
-  set_class_transformer(NULL);
-  set_class_transformer_args(NULL);
-  set_object_transformer(NULL);
-  set_object_transformer_args(NULL);
-  set_matched_fields(NULL);
-  set_inplace_fields(NULL);
-  set_transformation_level(0);
+  _dsu_info = NULL;
 
   // initialize the non-header words to zero
   intptr_t* p = (intptr_t*)this;
@@ -976,6 +1019,9 @@ void InstanceKlass::initialize_impl(instanceKlassHandle this_oop, TRAPS) {
     { ResourceMark rm(THREAD);
       debug_only(this_oop->vtable()->verify(tty, true);)
     }
+    if (CompileCache::is_enabled()) {
+      CompileCache::class_initialized(this_oop(), CHECK);
+    }
   }
   else {
     // Step 10 and 11
@@ -2630,6 +2676,9 @@ void InstanceKlass::release_C_heap_structures() {
     _previous_versions = NULL;
   }
 
+  // deallocate the DSU info
+  release_dsu_info();
+
   // deallocate the cached class file
   if (_cached_class_file != NULL) {
     os::free(_cached_class_file, mtClass);
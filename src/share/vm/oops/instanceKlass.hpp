@@ -92,6 +92,7 @@ class nmethodBucket;
 class PreviousVersionNode;
 class JvmtiCachedClassFieldMap;
 class MemberNameTable;
+class DSUCopyPlan;
 
 // This is used in iterators below.
 class FieldClosure: public StackObj {
@@ -134,6 +135,54 @@ class OopMapBlock VALUE_OBJ_CLASS_SPEC {
   uint _count;
 };
 
+// DSU support
+// Per-class DSU metadata. Only classes involved in an update need it, so
+// it is allocated on demand when a field is first set to a non-default
+// value, see InstanceKlass::create_dsu_info. Classes without one read the
+// defaults from _empty.
+class DSUKlassInfo : public CHeapObj<mtClass> {
+  friend class InstanceKlass;
+  friend class DSUCopyPlan;
+ private:
+  // the revision number when the ik is installed by a DSU, classes
+  // defined by class loaders are born at 0 whenever they are loaded
+  int             _born_rn;
+  // the revision number when the ik is redefined by another
+  int             _dead_rn;
+  int             _copy_to_size;
+  int             _dsu_state;
+  // currently
+  // 0 indicates nothing
+  // 1 indicates only replace klass
+  // >1 indicates full..
+  int             _transformation_level;
+
+  // previous version
+  InstanceKlass*  _previous_version;
+  InstanceKlass*  _next_version;
+  InstanceKlass*  _new_inplace_new_class;
+  InstanceKlass*  _stale_new_class;
+  // custom transformer
+  Method*         _class_transformer;
+  Array<u1>*      _class_transformer_args;
+  Method*         _object_transformer;
+  Array<u1>*      _object_transformer_args;
+  // defaut transformer
+  Array<u1>*      _matched_fields;
+  // merge inplace object to phantom object
+  // see sharedRuntime::merge_mixed_object
+  Array<u1>*      _inplace_fields;
+  // see ReplaceObject
+  DSUCopyPlan*    _copy_plan;
+  // matches the class across VMs, 0 until computed by DSUPlan::fingerprint
+  julong          _class_file_fingerprint;
+
+  static const DSUKlassInfo _empty;
+
+ public:
+  DSUKlassInfo();
+};
+
 struct JvmtiCachedClassFileData;
 
 class InstanceKlass: public Klass {
@@ -144,6 +193,8 @@ class InstanceKlass: public Klass {
   friend class DSUClass;
   friend class DSUClassLoader;
   friend class DSUJvmtiBuilder;
+  friend class DSUReclaim;
+  friend class DSUCopyPlan;
 
  protected:
   // Constructor
@@ -303,34 +354,9 @@ class InstanceKlass: public Klass {
   //     ...
   Array<u2>*      _fields;
 
-  //DSU support
-  // the revision number when the ik is loaded to VM
-  int             _born_rn;
-  // the revision number when the ik is redefined by another
-  int             _dead_rn;
-  int             _copy_to_size;
-  int             _dsu_state;
-  // currently 
-  // 0 indicates nothing
-  // 1 indicates only replace klass
-  // >1 indicates full..
-  int             _transformation_level;
-
-    // previous version
-  InstanceKlass*  _previous_version;
-  InstanceKlass*  _next_version;
-  InstanceKlass*  _new_inplace_new_class;
-  InstanceKlass*  _stale_new_class;
-  // custom transformer
-  Method*         _class_transformer;
-  Array<u1>*      _class_transformer_args;
-  Method*         _object_transformer;
-  Array<u1>*      _object_transformer_args;
-  // defaut transformer
-  Array<u1>*      _matched_fields;
-  // merge inplace object to phantom object
-  // see sharedRuntime::merge_mixed_object
-  Array<u1>*      _inplace_fields;
+  // DSU support
+  // NULL unless the class is involved in an update
+  DSUKlassInfo*   _dsu_info;
 
   // embedded Java vtable follows here
   // embedded Java itables follows here
@@ -762,60 +788,73 @@ class InstanceKlass: public Klass {
                                     u2 method_index);
 
   // DSU support
-  int dsu_state()               const { return _dsu_state; }
-  void set_dsu_state(int state)       { _dsu_state = state; }
-
-  bool dsu_will_be_deleted()    const { return _dsu_state == DSUState::dsu_will_be_deleted; }
-  bool dsu_has_been_deleted()   const { return _dsu_state == DSUState::dsu_has_been_deleted; }
-  bool dsu_will_be_added()      const { return _dsu_state == DSUState::dsu_will_be_added; }
-  bool dsu_has_been_added()     const { return _dsu_state == DSUState::dsu_has_been_added; }
-  bool dsu_will_be_updated()    const { return _dsu_state >= DSUState::dsu_will_be_recompiled 
-                                                  && _dsu_state <= DSUState::dsu_will_be_deleted; }
-  bool dsu_is_affected()        const { return _dsu_state == DSUState::dsu_is_affected; }
-
-  bool dsu_will_be_swapped()    const { return _dsu_state == DSUState::dsu_will_be_swapped; }
-  bool dsu_has_been_swapped()   const { return _dsu_state == DSUState::dsu_has_been_swapped; }
-  bool dsu_will_be_redefined()  const { return _dsu_state == DSUState::dsu_will_be_redefined; }
+ private:
+  const DSUKlassInfo* dsu_info() const { return _dsu_info != NULL ? _dsu_info : &DSUKlassInfo::_empty; }
+  DSUKlassInfo* create_dsu_info();
+ public:
+  bool has_dsu_info()           const { return _dsu_info != NULL; }
+  julong class_file_fingerprint() const      { return dsu_info()->_class_file_fingerprint; }
+  void set_class_file_fingerprint(julong fp) { if (fp != class_file_fingerprint()) create_dsu_info()->_class_file_fingerprint = fp; }
+  void release_dsu_info();
+
+  int dsu_state()               const { return dsu_info()->_dsu_state; }
+  void set_dsu_state(int state)       { if (state != dsu_state()) create_dsu_info()->_dsu_state = state; }
+
+  bool dsu_will_be_deleted()    const { return dsu_state() == DSUState::dsu_will_be_deleted; }
+  bool dsu_has_been_deleted()   const { return dsu_state() == DSUState::dsu_has_been_deleted; }
+  bool dsu_will_be_added()      const { return dsu_state() == DSUState::dsu_will_be_added; }
+  bool dsu_has_been_added()     const { return dsu_state() == DSUState::dsu_has_been_added; }
+  bool dsu_will_be_updated()    const { return dsu_state() >= DSUState::dsu_will_be_recompiled
+                                                  && dsu_state() <= DSUState::dsu_will_be_deleted; }
+  bool dsu_is_affected()        const { return dsu_state() == DSUState::dsu_is_affected; }
+
+  bool dsu_will_be_swapped()    const { return dsu_state() == DSUState::dsu_will_be_swapped; }
+  bool dsu_has_been_swapped()   const { return dsu_state() == DSUState::dsu_has_been_swapped; }
+  bool dsu_will_be_redefined()  const { return dsu_state() == DSUState::dsu_will_be_redefined; }
   // Note there is alread a method in the original HotSpot implementation.
-  bool dsu_has_been_redefined() const { return _dsu_state == DSUState::dsu_has_been_redefined; }
+  bool dsu_has_been_redefined() const { return dsu_state() == DSUState::dsu_has_been_redefined; }
 
   virtual bool instances_require_update(int v) { return force_update() || is_dead_at(v); }
   bool force_update()            const { return object_transformer() != NULL; }
-  bool is_dead_at(int y)         const { return _dead_rn <= y; }
-  int  born_rn()                 const { return _born_rn; }
-  int  dead_rn()                 const { return _dead_rn; }
-  int  copy_to_size()            const { return _copy_to_size; }
-  int  transformation_level()    const { return _transformation_level; }
-  void set_born_rn(int born_rn)        { _born_rn = born_rn; }
-  void set_dead_rn(int dead_rn)        { _dead_rn = dead_rn; }
-  void set_copy_to_size(int size )     { _copy_to_size = size; }
-  void set_transformation_level(int l) { _transformation_level = l; }
+  bool is_dead_at(int y)         const { return dead_rn() <= y; }
+  int  born_rn()                 const { return dsu_info()->_born_rn; }
+  int  dead_rn()                 const { return dsu_info()->_dead_rn; }
+  int  copy_to_size()            const { return dsu_info()->_copy_to_size; }
+  int  transformation_level()    const { return dsu_info()->_transformation_level; }
+  void set_born_rn(int born_rn)        { if (born_rn != this->born_rn()) create_dsu_info()->_born_rn = born_rn; }
+  void set_dead_rn(int dead_rn)        { if (dead_rn != this->dead_rn()) create_dsu_info()->_dead_rn = dead_rn; }
+  void set_copy_to_size(int size )     { if (size != copy_to_size()) create_dsu_info()->_copy_to_size = size; }
+  void set_transformation_level(int l) { if (l != transformation_level()) create_dsu_info()->_transformation_level = l; }
 
   bool should_only_replace_klass () const {
-    return _transformation_level == TransfomationLevel::replace_klass;
-  }
-
-  void set_previous_version(InstanceKlass* k)       { _previous_version = k; }
-  void set_next_version(InstanceKlass* k)           { _next_version = k; }
-  void set_new_inplace_new_class(InstanceKlass* k)  { _new_inplace_new_class = k; }
-  void set_stale_new_class(InstanceKlass* k)        { _stale_new_class = k; }
-  void set_class_transformer(Method* m)             { _class_transformer = m; }
-  void set_class_transformer_args(Array<u1>* a)     { _class_transformer_args = a; }
-  void set_object_transformer(Method* m)            { _object_transformer = m; }
-  void set_object_transformer_args(Array<u1>* a)    { _object_transformer_args = a; }
-  void set_matched_fields(Array<u1>* f)             { _matched_fields = f; }
-  void set_inplace_fields(Array<u1>* f)             { _inplace_fields = f; }
-
-  InstanceKlass* previous_version()        const { return _previous_version; }
-  InstanceKlass* next_version()            const { return _next_version; }
-  InstanceKlass* new_inplace_new_class()   const { return _new_inplace_new_class; }
-  InstanceKlass* stale_new_class()         const { return _stale_new_class; }
-  Method*        class_transformer()       const { return _class_transformer; }
-  Array<u1>*     class_transformer_args()  const { return _class_transformer_args; }
-  Method*        object_transformer()      const { return _object_transformer; }
-  Array<u1>*     object_transformer_args() const { return _object_transformer_args; }
-  Array<u1>*     matched_fields()          const { return _matched_fields; }
-  Array<u1>*     inplace_fields()          const { return _inplace_fields; }
+    return transformation_level() == TransfomationLevel::replace_klass;
+  }
+
+  void set_previous_version(InstanceKlass* k)       { if (k != previous_version()) create_dsu_info()->_previous_version = k; }
+  void set_next_version(InstanceKlass* k)           { if (k != next_version()) create_dsu_info()->_next_version = k; }
+  void set_new_inplace_new_class(InstanceKlass* k)  { if (k != new_inplace_new_class()) create_dsu_info()->_new_inplace_new_class = k; }
+  void set_stale_new_class(InstanceKlass* k)        { if (k != stale_new_class()) create_dsu_info()->_stale_new_class = k; }
+  void set_class_transformer(Method* m)             { if (m != class_transformer()) create_dsu_info()->_class_transformer = m; }
+  void set_class_transformer_args(Array<u1>* a)     { if (a != class_transformer_args()) create_dsu_info()->_class_transformer_args = a; }
+  void set_object_transformer(Method* m)            { if (m != object_transformer()) create_dsu_info()->_object_transformer = m; }
+  void set_object_transformer_args(Array<u1>* a)    { if (a != object_transformer_args()) create_dsu_info()->_object_transformer_args = a; }
+  void set_matched_fields(Array<u1>* f)             { if (f != matched_fields()) create_dsu_info()->_matched_fields = f; }
+  void set_inplace_fields(Array<u1>* f)             { if (f != inplace_fields()) create_dsu_info()->_inplace_fields = f; }
+
+  InstanceKlass* previous_version()        const { return dsu_info()->_previous_version; }
+  InstanceKlass* next_version()            const { return dsu_info()->_next_version; }
+  InstanceKlass* new_inplace_new_class()   const { return dsu_info()->_new_inplace_new_class; }
+  InstanceKlass* stale_new_class()         const { return dsu_info()->_stale_new_class; }
+  Method*        class_transformer()       const { return dsu_info()->_class_transformer; }
+  Array<u1>*     class_transformer_args()  const { return dsu_info()->_class_transformer_args; }
+  Method*        object_transformer()      const { return dsu_info()->_object_transformer; }
+  Array<u1>*     object_transformer_args() const { return dsu_info()->_object_transformer_args; }
+  Array<u1>*     matched_fields()          const { return dsu_info()->_matched_fields; }
+  Array<u1>*     inplace_fields()          const { return dsu_info()->_inplace_fields; }
+
+  DSUCopyPlan*   copy_plan()               const { return dsu_info()->_copy_plan; }
+  // install plan unless another thread has installed one, returns the installed plan
+  DSUCopyPlan*   install_copy_plan(DSUCopyPlan* plan);
 
   static InstanceKlass* clone_instance_klass(InstanceKlass* klass, TRAPS);
 
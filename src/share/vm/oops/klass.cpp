@@ -393,6 +393,24 @@ void Klass::append_to_sibling_list() {
   debug_only(verify();)
 }
 
+void Klass::remove_from_sibling_list() {
+  // remove ourselves from superklass' subklass list
+  InstanceKlass* super = superklass();
+  if (super == NULL) return;        // special case: class Object
+  Klass* prev = super->subklass_oop();
+  if (prev == this) {
+    super->set_subklass(next_sibling_oop());
+  } else {
+    while (prev != NULL && prev->next_sibling_oop() != this) {
+      prev = prev->next_sibling_oop();
+    }
+    if (prev != NULL) {
+      prev->set_next_sibling(next_sibling_oop());
+    }
+  }
+  set_next_sibling(NULL);
+}
+
 bool Klass::is_loader_alive(BoolObjectClosure* is_alive) {
 #ifdef ASSERT
   // The class is alive iff the class loader is alive.
@@ -187,7 +187,7 @@ class Method : public Metadata {
   void set_needs_mixed_object_check()            { _dsu_flags.set_needs_mixed_object_check(); }
   void clear_needs_mixed_object_check()          { _dsu_flags.clear_needs_mixed_object_check(); }
 
-  bool needs_type_narrow_check () const          { return dsu_flags().needs_stale_object_check(); }
+  bool needs_type_narrow_check () const          { return dsu_flags().needs_type_narrow_check(); }
   void set_needs_type_narrow_check()             { _dsu_flags.set_needs_type_narrow_check(); }
   void clear_needs_type_narrow_check()           { _dsu_flags.clear_needs_type_narrow_check(); }
 
@@ -23,12 +23,25 @@
  */
 #include "precompiled.hpp"
 #include "oops/methodCounters.hpp"
+#include "runtime/atomic.inline.hpp"
+#include "runtime/dsu.hpp"
 #include "runtime/thread.inline.hpp"
 
 MethodCounters* MethodCounters::allocate(ClassLoaderData* loader_data, TRAPS) {
   return new(loader_data, size(), false, MetaspaceObj::MethodCountersType, THREAD) MethodCounters();
 }
 
+void MethodCounters::deallocate_contents(ClassLoaderData* loader_data) {
+  if (_type_narrow_cache != NULL) {
+    DSUTypeNarrowCache::release(_type_narrow_cache);
+    _type_narrow_cache = NULL;
+  }
+}
+
+bool MethodCounters::install_type_narrow_cache(DSUTypeNarrowCache* cache) {
+  return Atomic::cmpxchg_ptr(cache, &_type_narrow_cache, (DSUTypeNarrowCache*) NULL) == NULL;
+}
+
 void MethodCounters::clear_counters() {
   invocation_counter()->reset();
   backedge_counter()->reset();
@@ -28,6 +28,8 @@
 #include "oops/metadata.hpp"
 #include "interpreter/invocationCounter.hpp"
 
+class DSUTypeNarrowCache;
+
 class MethodCounters: public MetaspaceObj {
  friend class VMStructs;
  private:
@@ -43,6 +45,8 @@ class MethodCounters: public MetaspaceObj {
   u1                _highest_osr_comp_level;      // Same for OSR level
   jlong             _prev_time;                   // Previous time the rate was acquired
 #endif
+  // Javelus
+  DSUTypeNarrowCache* volatile _type_narrow_cache;
 
   MethodCounters() : _interpreter_invocation_count(0),
                      _interpreter_throwout_count(0),
@@ -53,6 +57,7 @@ class MethodCounters: public MetaspaceObj {
                      _highest_osr_comp_level(0),
                      _prev_time(0)
 #endif
+                   , _type_narrow_cache(NULL)
   {
     invocation_counter()->init();
     backedge_counter()->init();
@@ -61,7 +66,7 @@ class MethodCounters: public MetaspaceObj {
  public:
   static MethodCounters* allocate(ClassLoaderData* loader_data, TRAPS);
 
-  void deallocate_contents(ClassLoaderData* loader_data) {}
+  void deallocate_contents(ClassLoaderData* loader_data);
   DEBUG_ONLY(bool on_stack() { return false; })  // for template
 
   static int size() { return sizeof(MethodCounters) / wordSize; }
@@ -109,6 +114,11 @@ class MethodCounters: public MetaspaceObj {
   int highest_osr_comp_level() const;
   void set_highest_osr_comp_level(int level);
 
+  // Javelus
+  DSUTypeNarrowCache* type_narrow_cache() const { return _type_narrow_cache; }
+  // returns false if another thread has installed a cache
+  bool install_type_narrow_cache(DSUTypeNarrowCache* cache);
+
   // invocation counter
   InvocationCounter* invocation_counter() { return &_invocation_counter; }
   InvocationCounter* backedge_counter()   { return &_backedge_counter; }
@@ -125,6 +135,10 @@ class MethodCounters: public MetaspaceObj {
     return byte_offset_of(MethodCounters, _backedge_counter);
   }
 
+  static ByteSize type_narrow_cache_offset()     {
+    return byte_offset_of(MethodCounters, _type_narrow_cache);
+  }
+
   static int interpreter_invocation_counter_offset_in_bytes() {
     return offset_of(MethodCounters, _interpreter_invocation_count);
   }
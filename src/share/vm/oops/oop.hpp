@@ -77,6 +77,10 @@ class oopDesc {
   void    release_set_mark(markOop m);
   markOop cas_set_mark(markOop new_mark, markOop old_mark);
 
+  // The object whose mark word holds the lock state: the phantom object
+  // of a mixed object, otherwise this object.
+  oop     mark_holder() const;
+
   // Used only to re-initialize the mark word (e.g., of promoted
   // objects during a GC) -- requires a valid klass pointer
   void init_mark();
@@ -65,6 +65,14 @@ inline void oopDesc::release_set_mark(markOop m) {
   OrderAccess::release_store_ptr(&_mark, m);
 }
 
+inline oop oopDesc::mark_holder() const {
+  markOop m = mark();
+  if (m->is_mixed_object()) {
+    return (oop) m->decode_phantom_object_pointer();
+  }
+  return (oop) this;
+}
+
 inline markOop oopDesc::cas_set_mark(markOop new_mark, markOop old_mark) {
   return (markOop) Atomic::cmpxchg_ptr(new_mark, &_mark, old_mark);
 }
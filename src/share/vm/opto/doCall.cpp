@@ -530,6 +530,9 @@ void Parse::do_call() {
 
   if (cg->method()->needs_stale_object_check()) {
     receiver = do_stale_object_check(receiver, false);
+    if (receiver != NULL && cg->method()->needs_type_narrow_check()) {
+      do_type_narrow_check(receiver, cg->method()->holder());
+    }
   }
 
   JVMState* new_jvms = cg->generate(jvms);
@@ -310,6 +310,7 @@ class GraphKit : public Phase {
   // DSU 
   Node* do_stale_object_check(Node* receiver, bool check_mixed_object = false);
   Node* do_mixed_object_check(Node* receiver);
+  void  do_type_narrow_check(Node* obj, ciKlass* target_klass);
 
   // Some convenient shortcuts for common nodes
   Node* IfTrue(IfNode* iff)                   { return _gvn.transform(new (C) IfTrueNode(iff));      }
@@ -123,6 +123,9 @@ void Parse::do_field_access(bool is_get, bool is_field) {
     if (check_stale_object) {
       obj = do_stale_object_check(obj, check_mixed_object);
     }
+    if (field->needs_type_narrow_check()) {
+      do_type_narrow_check(obj, field->holder());
+    }
     // Compile-time detect of null-exception?
     if (stopped())  return;
 
@@ -774,6 +774,59 @@ Node* GraphKit::do_stale_object_check(Node* recv, bool check_mixed_object) {
 
 }
 
+// The interpreter caches the klass validated by the last type-narrowing
+// check at each bci. Objects of that klass pass the compiled check inline,
+// other type narrowed objects trap and get validated by the interpreter.
+// A site that traps too often calls into the runtime instead.
+void GraphKit::do_type_narrow_check(Node* obj, ciKlass* target_klass) {
+  if (_gvn.type(obj)->isa_instptr() == NULL) {
+    return;
+  }
+
+  if (!UseDSUTypeNarrowCache || too_many_traps(Deoptimization::Reason_class_check)) {
+    kill_dead_locals();
+    Node* call = make_runtime_call(RC_NO_LEAF,
+      OptoRuntime::type_narrow_check_Type(),
+      OptoRuntime::type_narrow_check_Java(),
+      NULL, // "type narrow check",
+      TypePtr::BOTTOM,
+      obj, makecon(TypeKlassPtr::make(target_klass)));
+    make_slow_call_ex(call, env()->Throwable_klass(), true);
+    return;
+  }
+
+  Node* klass = load_object_klass(obj);
+  Node* dsu_flags_addr = basic_plus_adr(klass, klass, in_bytes(Klass::dsu_flags_offset()));
+  Node* dsu_flags = make_load(NULL, dsu_flags_addr, TypeInt::INT, T_INT, MemNode::unordered);
+  Node* narrowed = _gvn.transform(new (C) AndINode(dsu_flags, intcon(DSU_FLAGS_CLASS_IS_TYPE_NARROWED_CLASS)));
+  Node* chk_narrowed = _gvn.transform(new (C) CmpINode(narrowed, intcon(0)));
+  Node* not_narrowed = _gvn.transform(new (C) BoolNode(chk_narrowed, BoolTest::eq));
+
+  ciKlass* validated = method()->type_narrow_validated_klass(bci());
+  if (validated == NULL) {
+    BuildCutout unless(this, not_narrowed, PROB_MAX);
+    uncommon_trap(Deoptimization::Reason_class_check,
+                  Deoptimization::Action_maybe_recompile);
+    return;
+  }
+
+  RegionNode* region = new (C) RegionNode(3);
+  IfNode* iff = create_and_map_if(control(), not_narrowed, PROB_MAX, COUNT_UNKNOWN);
+  region->init_req(1, _gvn.transform(new (C) IfTrueNode(iff)));
+  set_control(_gvn.transform(new (C) IfFalseNode(iff)));
+
+  Node* chk_validated = _gvn.transform(new (C) CmpPNode(klass, makecon(TypeKlassPtr::make(validated))));
+  Node* is_validated = _gvn.transform(new (C) BoolNode(chk_validated, BoolTest::eq));
+  {
+    BuildCutout unless(this, is_validated, PROB_MAX);
+    uncommon_trap(Deoptimization::Reason_class_check,
+                  Deoptimization::Action_maybe_recompile);
+  }
+  region->init_req(2, control());
+  set_control(_gvn.transform(region));
+  record_for_igvn(region);
+}
+
 Node* GraphKit::do_mixed_object_check(Node* obj) {
   if (PrintCheckPoint) {
     ResourceMark rm;
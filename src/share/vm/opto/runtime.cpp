@@ -98,6 +98,7 @@
 // Compiled code entry points
 address OptoRuntime::_new_instance_Java                           = NULL;
 address OptoRuntime::_update_stale_object_Java                    = NULL;
+address OptoRuntime::_type_narrow_check_Java                      = NULL;
 address OptoRuntime::_new_array_Java                              = NULL;
 address OptoRuntime::_new_array_nozero_Java                       = NULL;
 address OptoRuntime::_multianewarray2_Java                        = NULL;
@@ -148,6 +149,7 @@ bool OptoRuntime::generate(ciEnv* env) {
   // -------------------------------------------------------------------------------------------------------------------------------
   gen(env, _new_instance_Java              , new_instance_Type            , new_instance_C                  ,    0 , true , false, false);
   gen(env, _update_stale_object_Java       , update_stale_object_Type     , update_stale_object_C           ,    0 , true , false, false);
+  gen(env, _type_narrow_check_Java         , type_narrow_check_Type       , type_narrow_check_C             ,    0 , false, false, false);
   gen(env, _new_array_Java                 , new_array_Type               , new_array_C                     ,    0 , true , false, false);
   gen(env, _new_array_nozero_Java          , new_array_Type               , new_array_nozero_C              ,    0 , true , false, false);
   gen(env, _multianewarray2_Java           , multianewarray2_Type         , multianewarray2_C               ,    0 , true , false, false);
@@ -484,6 +486,26 @@ const TypeFunc *OptoRuntime::update_stale_object_Type() {
 }
 
 
+JRT_ENTRY(void, OptoRuntime::type_narrow_check_C(oopDesc* obj, Klass* target_klass, JavaThread* thread))
+  Handle h (thread, obj);
+  Javelus::type_narrow_check(h, target_klass, thread);
+JRT_END
+
+const TypeFunc *OptoRuntime::type_narrow_check_Type() {
+  // create input type (domain)
+  const Type **fields = TypeTuple::fields(2);
+  fields[TypeFunc::Parms+0] = TypeInstPtr::NOTNULL; // object to be checked
+  fields[TypeFunc::Parms+1] = TypeInstPtr::NOTNULL; // holder of the member
+  const TypeTuple *domain = TypeTuple::make(TypeFunc::Parms+2, fields);
+
+  // create result type (range)
+  fields = TypeTuple::fields(0);
+  const TypeTuple *range = TypeTuple::make(TypeFunc::Parms+0, fields);
+
+  return TypeFunc::make(domain, range);
+}
+
+
 const TypeFunc *OptoRuntime::athrow_Type() {
   // create input type (domain)
   const Type **fields = TypeTuple::fields(1);
@@ -128,6 +128,7 @@ class OptoRuntime : public AllStatic {
   // References to generated stubs
   static address _new_instance_Java;
   static address _update_stale_object_Java;
+  static address _type_narrow_check_Java;
   static address _new_array_Java;
   static address _new_array_nozero_Java;
   static address _multianewarray2_Java;
@@ -159,6 +160,8 @@ class OptoRuntime : public AllStatic {
  
   // Update stale object
   static void update_stale_object_C(oopDesc* stale_object, JavaThread *thread);
+  // Check an object against the holder of a member after type narrowing
+  static void type_narrow_check_C(oopDesc* obj, Klass* target_klass, JavaThread *thread);
 
   // Allocate storage for a objArray or typeArray
   static void new_array_C(Klass* array_klass, int len, JavaThread *thread);
@@ -232,6 +235,7 @@ private:
   // access to runtime stubs entry points for java code
   static address new_instance_Java()                     { return _new_instance_Java; }
   static address update_stale_object_Java()              { return _update_stale_object_Java; }
+  static address type_narrow_check_Java()                { return _type_narrow_check_Java; }
   static address new_array_Java()                        { return _new_array_Java; }
   static address new_array_nozero_Java()                 { return _new_array_nozero_Java; }
   static address multianewarray2_Java()                  { return _multianewarray2_Java; }
@@ -273,6 +277,7 @@ private:
 
   static const TypeFunc* new_instance_Type(); // object allocation (slow case)
   static const TypeFunc* update_stale_object_Type(); // update stale object
+  static const TypeFunc* type_narrow_check_Type();   // type narrowing check
   static const TypeFunc* new_array_Type ();   // [a]newarray (slow case)
   static const TypeFunc* multianewarray_Type(int ndim); // multianewarray
   static const TypeFunc* multianewarray2_Type(); // multianewarray
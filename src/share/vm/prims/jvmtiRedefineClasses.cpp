@@ -28,6 +28,7 @@
 #include "classfile/verifier.hpp"
 #include "code/codeCache.hpp"
 #include "compiler/compileBroker.hpp"
+#include "compiler/compileCache.hpp"
 #include "interpreter/oopMapCache.hpp"
 #include "interpreter/rewriter.hpp"
 #include "memory/gcLocker.hpp"
@@ -3860,6 +3861,7 @@ void VM_RedefineClasses::redefine_single_class(jclass the_jclass,
 
   // Deoptimize all compiled code that depends on this class
   flush_dependent_code(the_class, THREAD);
+  CompileCache::invalidate(the_class->name());
 
   _old_methods = the_class->methods();
   _new_methods = scratch_class->methods();
@@ -3993,6 +3995,11 @@ void VM_RedefineClasses::redefine_single_class(jclass the_jclass,
   the_class->set_inner_classes(scratch_class->inner_classes());
   scratch_class->set_inner_classes(old_inner_classes);
 
+  // Swap the fingerprints of the class files
+  julong old_fingerprint = the_class->class_file_fingerprint();
+  the_class->set_class_file_fingerprint(scratch_class->class_file_fingerprint());
+  scratch_class->set_class_file_fingerprint(old_fingerprint);
+
   // Initialize the vtable and interface table after
   // methods have been rewritten
   {
@@ -2186,6 +2186,11 @@ bool Arguments::check_vm_args_consistency() {
   status = status && verify_interval(SymbolTableSize, minimumSymbolTableSize,
     (max_uintx / SymbolTable::bucket_size()), "SymbolTable size");
 
+  status = status && verify_interval(HeapDumpGzipLevel, 0, 9, "HeapDumpGzipLevel");
+  status = status && verify_interval(MonitorUsedDeflationThreshold, 0, 100,
+                                     "MonitorUsedDeflationThreshold");
+  status = status && verify_min_value(AsyncDeflationInterval, 1, "AsyncDeflationInterval");
+
   {
     // Using "else if" below to avoid printing two error messages if min > max.
     // This will also prevent us from reporting both min>100 and max>100 at the
@@ -4120,6 +4125,11 @@ jint Arguments::apply_ergo() {
   }
 #endif // PRODUCT
 
+  // MonitorBound induces safepoints that scavenge idle monitors synchronously.
+  if (AsyncDeflateIdleMonitors && (MonitorInUseLists || MonitorBound > 0)) {
+    FLAG_SET_DEFAULT(AsyncDeflateIdleMonitors, false);
+  }
+
   if (PrintCommandLineFlags) {
     CommandLineFlags::printSetFlags(tty);
   }
@@ -25,6 +25,7 @@
 #include "precompiled.hpp"
 #include "oops/klass.inline.hpp"
 #include "oops/markOop.hpp"
+#include "oops/oop.inline.hpp"
 #include "runtime/basicLock.hpp"
 #include "runtime/biasedLocking.hpp"
 #include "runtime/task.hpp"
@@ -143,13 +144,16 @@ static GrowableArray<MonitorInfo*>* get_or_compute_monitor_info(JavaThread* thre
 }
 
 
+// The bias of a mixed object lives in the mark word of its phantom object,
+// while the monitors on the stacks refer to the object itself.
 static BiasedLocking::Condition revoke_bias(oop obj, bool allow_rebias, bool is_bulk, JavaThread* requesting_thread) {
-  markOop mark = obj->mark();
+  oop holder = obj->mark_holder();
+  markOop mark = holder->mark();
   if (!mark->has_bias_pattern()) {
     if (TraceBiasedLocking) {
       ResourceMark rm;
       tty->print_cr("  (Skipping revocation of object of type %s because it's no longer biased)",
-                    obj->klass()->external_name());
+                    holder->klass()->external_name());
     }
     return BiasedLocking::NOT_BIASED;
   }
@@ -161,7 +165,7 @@ static BiasedLocking::Condition revoke_bias(oop obj, bool allow_rebias, bool is_
   if (TraceBiasedLocking && (Verbose || !is_bulk)) {
     ResourceMark rm;
     tty->print_cr("Revoking bias of object " INTPTR_FORMAT " , mark " INTPTR_FORMAT " , type %s , prototype header " INTPTR_FORMAT " , allow rebias %d , requesting thread " INTPTR_FORMAT,
-                  p2i((void *)obj), (intptr_t) mark, obj->klass()->external_name(), (intptr_t) obj->klass()->prototype_header(), (allow_rebias ? 1 : 0), (intptr_t) requesting_thread);
+                  p2i((void *)obj), (intptr_t) mark, holder->klass()->external_name(), (intptr_t) holder->klass()->prototype_header(), (allow_rebias ? 1 : 0), (intptr_t) requesting_thread);
   }
 
   JavaThread* biased_thread = mark->biased_locker();
@@ -170,7 +174,7 @@ static BiasedLocking::Condition revoke_bias(oop obj, bool allow_rebias, bool is_
     // example, we revoke the bias due to an identity hash code
     // being computed for an object.
     if (!allow_rebias) {
-      obj->set_mark(unbiased_prototype);
+      holder->set_mark(unbiased_prototype);
     }
     if (TraceBiasedLocking && (Verbose || !is_bulk)) {
       tty->print_cr("  Revoked bias of anonymously-biased object");
@@ -192,9 +196,9 @@ static BiasedLocking::Condition revoke_bias(oop obj, bool allow_rebias, bool is_
   }
   if (!thread_is_alive) {
     if (allow_rebias) {
-      obj->set_mark(biased_prototype);
+      holder->set_mark(biased_prototype);
     } else {
-      obj->set_mark(unbiased_prototype);
+      holder->set_mark(unbiased_prototype);
     }
     if (TraceBiasedLocking && (Verbose || !is_bulk)) {
       tty->print_cr("  Revoked bias of object biased toward dead thread");
@@ -236,8 +240,8 @@ static BiasedLocking::Condition revoke_bias(oop obj, bool allow_rebias, bool is_
     // Reset object header to point to displaced mark.
     // Must release storing the lock address for platforms without TSO
     // ordering (e.g. ppc).
-    obj->release_set_mark(markOopDesc::encode(highest_lock));
-    assert(!obj->mark()->has_bias_pattern(), "illegal mark state: stack lock used bias bit");
+    holder->release_set_mark(markOopDesc::encode(highest_lock));
+    assert(!holder->mark()->has_bias_pattern(), "illegal mark state: stack lock used bias bit");
     if (TraceBiasedLocking && (Verbose || !is_bulk)) {
       tty->print_cr("  Revoked bias of currently-locked object");
     }
@@ -246,10 +250,10 @@ static BiasedLocking::Condition revoke_bias(oop obj, bool allow_rebias, bool is_
       tty->print_cr("  Revoked bias of currently-unlocked object");
     }
     if (allow_rebias) {
-      obj->set_mark(biased_prototype);
+      holder->set_mark(biased_prototype);
     } else {
       // Store the unlocked value into the object's header.
-      obj->set_mark(unbiased_prototype);
+      holder->set_mark(unbiased_prototype);
     }
   }
 
@@ -266,6 +270,7 @@ enum HeuristicsResult {
 
 
 static HeuristicsResult update_heuristics(oop o, bool allow_rebias) {
+  o = o->mark_holder();
   markOop mark = o->mark();
   if (!mark->has_bias_pattern()) {
     return HR_NOT_BIASED;
@@ -328,14 +333,14 @@ static BiasedLocking::Condition bulk_revoke_or_rebias_at_safepoint(oop o,
     tty->print_cr("* Beginning bulk revocation (kind == %s) because of object "
                   INTPTR_FORMAT " , mark " INTPTR_FORMAT " , type %s",
                   (bulk_rebias ? "rebias" : "revoke"),
-                  p2i((void *) o), (intptr_t) o->mark(), o->klass()->external_name());
+                  p2i((void *) o), (intptr_t) o->mark_holder()->mark(), o->mark_holder()->klass()->external_name());
   }
 
   jlong cur_time = os::javaTimeMillis();
-  o->klass()->set_last_biased_lock_bulk_revocation_time(cur_time);
+  o->mark_holder()->klass()->set_last_biased_lock_bulk_revocation_time(cur_time);
 
 
-  Klass* k_o = o->klass();
+  Klass* k_o = o->mark_holder()->klass();
   Klass* klass = k_o;
 
   if (bulk_rebias) {
@@ -360,7 +365,7 @@ static BiasedLocking::Condition bulk_revoke_or_rebias_at_safepoint(oop o,
         GrowableArray<MonitorInfo*>* cached_monitor_info = get_or_compute_monitor_info(thr);
         for (int i = 0; i < cached_monitor_info->length(); i++) {
           MonitorInfo* mon_info = cached_monitor_info->at(i);
-          oop owner = mon_info->owner();
+          oop owner = mon_info->owner()->mark_holder();
           markOop mark = owner->mark();
           if ((owner->klass() == k_o) && mark->has_bias_pattern()) {
             // We might have encountered this object already in the case of recursive locking
@@ -393,8 +398,8 @@ static BiasedLocking::Condition bulk_revoke_or_rebias_at_safepoint(oop o,
       for (int i = 0; i < cached_monitor_info->length(); i++) {
         MonitorInfo* mon_info = cached_monitor_info->at(i);
         oop owner = mon_info->owner();
-        markOop mark = owner->mark();
-        if ((owner->klass() == k_o) && mark->has_bias_pattern()) {
+        markOop mark = owner->mark_holder()->mark();
+        if ((owner->mark_holder()->klass() == k_o) && mark->has_bias_pattern()) {
           revoke_bias(owner, false, true, requesting_thread);
         }
       }
@@ -411,20 +416,21 @@ static BiasedLocking::Condition bulk_revoke_or_rebias_at_safepoint(oop o,
 
   BiasedLocking::Condition status_code = BiasedLocking::BIAS_REVOKED;
 
+  oop holder = o->mark_holder();
   if (attempt_rebias_of_object &&
-      o->mark()->has_bias_pattern() &&
+      holder->mark()->has_bias_pattern() &&
       klass->prototype_header()->has_bias_pattern()) {
-    markOop new_mark = markOopDesc::encode(requesting_thread, o->mark()->age(),
+    markOop new_mark = markOopDesc::encode(requesting_thread, holder->mark()->age(),
                                            klass->prototype_header()->bias_epoch());
-    o->set_mark(new_mark);
+    holder->set_mark(new_mark);
     status_code = BiasedLocking::BIAS_REVOKED_AND_REBIASED;
     if (TraceBiasedLocking) {
       tty->print_cr("  Rebiased object toward thread " INTPTR_FORMAT, (intptr_t) requesting_thread);
     }
   }
 
-  assert(!o->mark()->has_bias_pattern() ||
-         (attempt_rebias_of_object && (o->mark()->biased_locker() == requesting_thread)),
+  assert(!holder->mark()->has_bias_pattern() ||
+         (attempt_rebias_of_object && (holder->mark()->biased_locker() == requesting_thread)),
          "bug in bulk bias revocation");
 
   return status_code;
@@ -466,13 +472,13 @@ public:
     // give us locked object(s). If we don't find any biased objects
     // there is nothing to do and we avoid a safepoint.
     if (_obj != NULL) {
-      markOop mark = (*_obj)()->mark();
+      markOop mark = (*_obj)()->mark_holder()->mark();
       if (mark->has_bias_pattern()) {
         return true;
       }
     } else {
       for ( int i = 0 ; i < _objs->length(); i++ ) {
-        markOop mark = (_objs->at(i))()->mark();
+        markOop mark = (_objs->at(i))()->mark_holder()->mark();
         if (mark->has_bias_pattern()) {
           return true;
         }
@@ -533,8 +539,8 @@ BiasedLocking::Condition BiasedLocking::revoke_and_rebias(Handle obj, bool attem
   // efficiently enough that we should not cause these revocations to
   // update the heuristics because doing so may cause unwanted bulk
   // revocations (which are expensive) to occur.
-  markOop mark = obj->mark();
-  assert(!mark->is_mixed_object(), "not supported");
+  oop holder = obj->mark_holder();
+  markOop mark = holder->mark();
   if (mark->is_biased_anonymously() && !attempt_rebias) {
     // We are probably trying to revoke the bias of this object due to
     // an identity hash code computation. Try to revoke the bias
@@ -544,12 +550,12 @@ BiasedLocking::Condition BiasedLocking::revoke_and_rebias(Handle obj, bool attem
     // the bias of the object.
     markOop biased_value       = mark;
     markOop unbiased_prototype = markOopDesc::prototype()->set_age(mark->age());
-    markOop res_mark = (markOop) Atomic::cmpxchg_ptr(unbiased_prototype, obj->mark_addr(), mark);
+    markOop res_mark = (markOop) Atomic::cmpxchg_ptr(unbiased_prototype, holder->mark_addr(), mark);
     if (res_mark == biased_value) {
       return BIAS_REVOKED;
     }
   } else if (mark->has_bias_pattern()) {
-    Klass* k = obj->klass();
+    Klass* k = holder->klass();
     markOop prototype_header = k->prototype_header();
     if (!prototype_header->has_bias_pattern()) {
       // This object has a stale bias from before the bulk revocation
@@ -559,8 +565,8 @@ BiasedLocking::Condition BiasedLocking::revoke_and_rebias(Handle obj, bool attem
       // by another thread so we simply return and let the caller deal
       // with it.
       markOop biased_value       = mark;
-      markOop res_mark = (markOop) Atomic::cmpxchg_ptr(prototype_header, obj->mark_addr(), mark);
-      assert(!(*(obj->mark_addr()))->has_bias_pattern(), "even if we raced, should still be revoked");
+      markOop res_mark = (markOop) Atomic::cmpxchg_ptr(prototype_header, holder->mark_addr(), mark);
+      assert(!(*(holder->mark_addr()))->has_bias_pattern(), "even if we raced, should still be revoked");
       return BIAS_REVOKED;
     } else if (prototype_header->bias_epoch() != mark->bias_epoch()) {
       // The epoch of this biasing has expired indicating that the
@@ -574,14 +580,14 @@ BiasedLocking::Condition BiasedLocking::revoke_and_rebias(Handle obj, bool attem
         assert(THREAD->is_Java_thread(), "");
         markOop biased_value       = mark;
         markOop rebiased_prototype = markOopDesc::encode((JavaThread*) THREAD, mark->age(), prototype_header->bias_epoch());
-        markOop res_mark = (markOop) Atomic::cmpxchg_ptr(rebiased_prototype, obj->mark_addr(), mark);
+        markOop res_mark = (markOop) Atomic::cmpxchg_ptr(rebiased_prototype, holder->mark_addr(), mark);
         if (res_mark == biased_value) {
           return BIAS_REVOKED_AND_REBIASED;
         }
       } else {
         markOop biased_value       = mark;
         markOop unbiased_prototype = markOopDesc::prototype()->set_age(mark->age());
-        markOop res_mark = (markOop) Atomic::cmpxchg_ptr(unbiased_prototype, obj->mark_addr(), mark);
+        markOop res_mark = (markOop) Atomic::cmpxchg_ptr(unbiased_prototype, holder->mark_addr(), mark);
         if (res_mark == biased_value) {
           return BIAS_REVOKED;
         }
@@ -593,7 +599,7 @@ BiasedLocking::Condition BiasedLocking::revoke_and_rebias(Handle obj, bool attem
   if (heuristics == HR_NOT_BIASED) {
     return NOT_BIASED;
   } else if (heuristics == HR_SINGLE_REVOKE) {
-    Klass *k = obj->klass();
+    Klass *k = holder->klass();
     markOop prototype_header = k->prototype_header();
     if (mark->biased_locker() == THREAD &&
         prototype_header->bias_epoch() == mark->bias_epoch()) {
@@ -644,7 +650,6 @@ void BiasedLocking::revoke(GrowableArray<Handle>* objs) {
 void BiasedLocking::revoke_at_safepoint(Handle h_obj) {
   assert(SafepointSynchronize::is_at_safepoint(), "must only be called while at safepoint");
   oop obj = h_obj();
-  assert(!obj->mark()->is_mixed_object(), "not supported");
   HeuristicsResult heuristics = update_heuristics(obj, false);
   if (heuristics == HR_SINGLE_REVOKE) {
     revoke_bias(obj, false, false, NULL);
@@ -709,6 +714,7 @@ void BiasedLocking::preserve_marks() {
             if (mon_info->owner_is_scalar_replaced()) continue;
             oop owner = mon_info->owner();
             if (owner != NULL) {
+              owner = owner->mark_holder();
               markOop mark = owner->mark();
               if (mark->has_bias_pattern()) {
                 _preserved_oop_stack->push(Handle(cur, owner));
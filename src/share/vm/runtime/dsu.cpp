@@ -34,8 +34,10 @@
 #include "prims/methodComparator.hpp"
 #include "runtime/vm_operations.hpp"
 #include "interpreter/bytecodes.hpp"
+#include "interpreter/bytecodeStream.hpp"
 #include "interpreter/oopMapCache.hpp"
 #include "interpreter/rewriter.hpp"
+#include "interpreter/templateTable.hpp"
 #include "classfile/javaClasses.hpp"
 #include "classfile/dictionary.hpp"
 #include "classfile/classLoaderData.inline.hpp"
@@ -48,11 +50,29 @@
 #include "runtime/sharedRuntime.hpp"
 #include "ci/ciEnv.hpp"
 #include "compiler/compileBroker.hpp"
+#include "compiler/compileCache.hpp"
 #include "gc_interface/collectedHeap.hpp"
+#include "memory/heapInspection.hpp"
+#include "memory/sharedHeap.hpp"
 #include "utilities/hashtable.hpp"
+#include "utilities/workgroup.hpp"
+#include "oops/fieldStreams.hpp"
 #include "oops/klass.inline.hpp"
 
 #include "memory/metadataFactory.hpp"
+#include "memory/universe.hpp"
+#include "classfile/loaderConstraints.hpp"
+#include "code/codeCache.hpp"
+#include "code/nmethod.hpp"
+#include "oops/methodData.hpp"
+#include "oops/objArrayKlass.hpp"
+#include "prims/jvmtiClassFileReconstituter.hpp"
+#include "prims/jvmtiExport.hpp"
+#include "prims/jvmtiImpl.hpp"
+#include "runtime/synchronizer.hpp"
+#include "runtime/threadCritical.hpp"
+#include "services/management.hpp"
+#include "services/threadService.hpp"
 // -------------------- DSUObject -----------------------------------------
 
 DSUObject::DSUObject()
@@ -81,13 +101,17 @@ void DSUMethod::print() {
 DSU::DSU()
 : _system_dictionary_modification_number_at_prepare(0),
   _weak_reflection_number_at_prepare(0),
+  _class_unloading_epoch_at_prepare(0),
   _from_rn(0),
   _to_rn(0),
   _first_class_loader(NULL),
   _last_class_loader(NULL),
   _request_state(DSU_REQUEST_INIT),
   _dynamic_patch(NULL),
+  _dry_run(false),
+  _body_only(false),
   _next(NULL),
+  _coalesced(NULL),
   _shared_stream_provider(NULL),
   _classes_in_order(NULL) {
   _classes_in_order = new (ResourceObj::C_HEAP, mtInternal) GrowableArray<DSUClass*>(20, true);
@@ -98,6 +122,9 @@ DSUError DSU::prepare(TRAPS) {
   DSUClass* dsu_class = NULL;
   const int length = _classes_in_order->length();
   int num_of_prepared_class = 0;
+  if (DSUPlan::is_enabled()) {
+    DSUPlan::load(CHECK_(DSU_ERROR_PREPARE_DSU));
+  }
   for (int i = 0; i < length; i++) {
     dsu_class = _classes_in_order->at(i);
     DSUError ret = dsu_class->prepare(THREAD);
@@ -112,6 +139,10 @@ DSUError DSU::prepare(TRAPS) {
     }
   }
 
+  if (DSUPlan::is_enabled()) {
+    DSUPlan::save();
+  }
+
   if (num_of_prepared_class == 0) {
     return DSU_ERROR_NO_UPDATED_CLASS;
   }
@@ -120,19 +151,57 @@ DSUError DSU::prepare(TRAPS) {
     // Acquire the lock in case the system dictionary is modified.
     MutexLocker mu_r(Compile_lock, THREAD);
     this->_system_dictionary_modification_number_at_prepare = SystemDictionary::number_of_modifications();
+    this->_class_unloading_epoch_at_prepare = ClassLoaderDataGraph::unloading_epoch();
     this->collect_classes_to_relink(CHECK_(DSU_ERROR_COLLECT_CLASSES_TO_RELINK));
+
+    // The DSU is prepared again if a class is loaded before the safepoint,
+    // so the sub-classes seen here are the ones seen by swap_class.
+    if (UseDSUShadowDispatchTables) {
+      for (int i = 0; i < length; i++) {
+        dsu_class = _classes_in_order->at(i);
+        if (dsu_class->prepared() && dsu_class->updating_type() == DSU_CLASS_BC) {
+          dsu_class->compute_shadow_dispatch_tables(CHECK_(DSU_ERROR_PREPARE_DSU));
+        }
+      }
+    }
   }
 
   this->collect_changed_reflections(CHECK_(DSU_ERROR_TO_BE_ADDED));
+
+  _body_only = UseDSUBodyOnlyFastPath && compute_body_only();
   return DSU_ERROR_NONE;
 }
 
+// A DSU is body-only if every changed class is DSU_CLASS_BC, i.e.,
+// all methods and fields match and only some method bodies are changed.
+// Such classes are swapped in place, so no instance is transformed and
+// no reflection object refers to a changed member.
+bool DSU::compute_body_only() const {
+  for (int i = 0; i < _classes_in_order->length(); i++) {
+    DSUClass* dsu_class = _classes_in_order->at(i);
+    if (!dsu_class->prepared() || dsu_class->updating_type() == DSU_CLASS_NONE) {
+      continue;
+    }
+    if (dsu_class->updating_type() != DSU_CLASS_BC) {
+      return false;
+    }
+    if (dsu_class->has_resolved_reflection()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 
 
 bool DSU::system_modified() const {
   return _system_dictionary_modification_number_at_prepare != SystemDictionary::number_of_modifications();
 }
 
+bool DSU::classes_unloaded() const {
+  return _class_unloading_epoch_at_prepare != ClassLoaderDataGraph::unloading_epoch();
+}
+
 bool DSU::reflection_modified() const {
   return _weak_reflection_number_at_prepare != JNIHandles::weak_reflection_modification_number();
 }
@@ -152,6 +221,8 @@ void DSU::update_ordered_classes(TRAPS) {
 
 DSUError DSU::update(TRAPS) {
   elapsedTimer dsu_timer;
+  // timer for each phase of the update
+  elapsedTimer phase_timer;
   // start timer
   DSU_TIMER_START(dsu_timer);
 
@@ -173,14 +244,14 @@ DSUError DSU::update(TRAPS) {
   }
 
   {
+    DSU_TIMER_START(phase_timer);
     bool sys_safe = Javelus::check_application_threads();
+    DSU_TIMER_STOP(phase_timer);
+    DSU_INFO(("DSU phase check application threads time: %3.7f (s).", phase_timer.seconds()));
     if (sys_safe) {
       DSU_INFO(("At safe point, the update will be performed."));
     } else {
-      // TODO, here we thinks it needs a flag to control whether install return barrier.
-      //If not safe, we perform return barrier installation.
-      Javelus::install_return_barrier_all_threads();
-
+      // Return barriers have been installed by check_application_threads.
       DSU_WARN(("Not at DSU safe point, the DSU is interrupted.."));
       set_request_state(DSU_REQUEST_INTERRUPTED);
       return DSU_ERROR_NONE;
@@ -191,30 +262,63 @@ DSUError DSU::update(TRAPS) {
   // 2). perform the dynamic update once we are reaching a DSU safe point
   //----------------------------------------------------------------------
 
-  // 2.1). unlink compiled code
-  flush_dependent_code(CHECK_(DSU_ERROR_UPDATE_DSU));
+  if (is_body_only()) {
+    DSU_INFO(("Only method bodies are changed, take the body-only fast path."));
+  } else {
+#if defined(TARGET_ARCH_MODEL_x86_64) && !defined(CC_INTERP)
+    // Interpreted code runs without DSU checks until the first DSU
+    // that leaves stale, type narrowed or mixed objects.
+    TemplateTable::enable_dsu_checks();
+#endif
+  }
 
+  // 2.1). unlink compiled code
   {
+    phase_timer.reset();
+    DSU_TIMER_START(phase_timer);
+    if (is_body_only()) {
+      flush_swapped_dependent_code(CHECK_(DSU_ERROR_UPDATE_DSU));
+    } else {
+      flush_dependent_code(CHECK_(DSU_ERROR_UPDATE_DSU));
+    }
+    DSU_TIMER_STOP(phase_timer);
+    DSU_INFO(("DSU phase flush dependent code time: %3.7f (s).", phase_timer.seconds()));
+  }
+
+  // No reflection object refers to a member of a body-only changed class.
+  if (!is_body_only()) {
     // TODO class updating may swap contents of java.lang.Class
     // we have to perform the update ahead of that.
-    // TraceTime t("Update changed reflection.");
+    phase_timer.reset();
+    DSU_TIMER_START(phase_timer);
     update_changed_reflection(CHECK_(DSU_ERROR_TO_BE_ADDED));
+    DSU_TIMER_STOP(phase_timer);
+    DSU_INFO(("DSU phase update changed reflection time: %3.7f (s).", phase_timer.seconds()));
   }
   // 2.2). update each class contained in this DSU
   {
-    // TraceTime t("Update changed classes.");
+    phase_timer.reset();
+    DSU_TIMER_START(phase_timer);
     update_ordered_classes(CHECK_(DSU_ERROR_UPDATE_DSUCLASSLOADER));
+    DSU_TIMER_STOP(phase_timer);
+    DSU_INFO(("DSU phase update changed classes time: %3.7f (s).", phase_timer.seconds()));
   }
 
   {
-    // TraceTime t("Relink classes.");
+    phase_timer.reset();
+    DSU_TIMER_START(phase_timer);
     relink_collected_classes(CHECK_(DSU_ERROR_COLLECT_CLASSES_TO_RELINK));
+    DSU_TIMER_STOP(phase_timer);
+    DSU_INFO(("DSU phase relink classes time: %3.7f (s).", phase_timer.seconds()));
   }
 
   // 2.3). update bytecode unchanged methods
   {
-    // TraceTime t("Repair application threads");
+    phase_timer.reset();
+    DSU_TIMER_START(phase_timer);
     Javelus::repair_application_threads();
+    DSU_TIMER_STOP(phase_timer);
+    DSU_INFO(("DSU phase repair application threads time: %3.7f (s).", phase_timer.seconds()));
   }
 
   // 2.4). update objects
@@ -275,6 +379,155 @@ DSUError DSU::update(TRAPS) {
   return DSU_ERROR_NONE;
 }
 
+#if INCLUDE_SERVICES
+// Count live instances of classes that will be redefined.
+// Only instances of old versions need to be transformed after the update.
+class DSUStaleInstanceFilter : public BoolObjectClosure {
+public:
+  bool do_object_b(oop obj) {
+    Klass* k = obj->klass();
+    return k->oop_is_instance() && InstanceKlass::cast(k)->dsu_will_be_redefined();
+  }
+};
+
+// Collect the census of stale instances from the class histogram.
+class DSUHeapCensusClosure : public KlassInfoClosure {
+private:
+  GrowableArray<DSUClass*>* _classes;
+  GrowableArray<jlong>*     _counts;
+  GrowableArray<jlong>*     _bytes;
+public:
+  DSUHeapCensusClosure(GrowableArray<DSUClass*>* classes,
+                       GrowableArray<jlong>* counts,
+                       GrowableArray<jlong>* bytes)
+    : _classes(classes), _counts(counts), _bytes(bytes) {}
+
+  void do_cinfo(KlassInfoEntry* cie) {
+    const int length = _classes->length();
+    for (int i = 0; i < length; i++) {
+      if (_classes->at(i)->old_version_raw() == cie->klass()) {
+        _counts->at_put(i, (jlong) cie->count());
+        _bytes->at_put(i, (jlong) cie->words() * HeapWordSize);
+        return;
+      }
+    }
+  }
+};
+#endif // INCLUDE_SERVICES
+
+// Estimate the cost of a prepared DSU at VM safe point.
+// Nothing is installed; all states set by prepare are rolled back.
+DSUError DSU::estimate(TRAPS) {
+  assert(SafepointSynchronize::is_at_safepoint(), "sanity");
+  assert(is_dry_run(), "only a dry-run DSU can be estimated");
+  ResourceMark rm(THREAD);
+
+  const int length = _classes_in_order->length();
+  GrowableArray<jlong>* counts = new GrowableArray<jlong>(length, length, 0);
+  GrowableArray<jlong>* bytes  = new GrowableArray<jlong>(length, length, 0);
+
+  elapsedTimer census_timer;
+  census_timer.start();
+  {
+    // Ensure that the heap is parsable
+    Universe::heap()->ensure_parsability(false);  // no need to retire TALBs
+
+#if INCLUDE_SERVICES
+    // The census is a filtered class histogram, so it is counted on the
+    // GC worker threads like one.
+    KlassInfoTable cit(false);
+    if (!cit.allocation_failed()) {
+      uint parallel_thread_num = 1;
+      if (ParallelHeapInspection) {
+        parallel_thread_num = MAX2(1U, Universe::heap()->safepoint_workers_count());
+      }
+      DSUStaleInstanceFilter filter;
+      HeapInspection inspect(false, false, false, NULL);
+      size_t missed_count = inspect.populate_table(&cit, &filter, parallel_thread_num);
+      if (missed_count != 0) {
+        DSU_WARN(("Ran out of C-heap; undercounted " SIZE_FORMAT " stale instances.", missed_count));
+      }
+
+      DSUHeapCensusClosure census(_classes_in_order, counts, bytes);
+      cit.iterate(&census);
+    } else {
+      DSU_WARN(("Ran out of C-heap; stale instances are not counted."));
+    }
+#endif // INCLUDE_SERVICES
+  }
+  census_timer.stop();
+
+  int changed_reflections = 0;
+  for (int i = 0; i < length; i++) {
+    DSUClass* dsu_class = _classes_in_order->at(i);
+    if (dsu_class->prepared()) {
+      changed_reflections += dsu_class->resolved_reflections_count();
+    }
+  }
+
+  const int relink_classes   = _classes_to_relink == NULL ? 0 : _classes_to_relink->length();
+  // flush_dependent_code deoptimizes all nmethods,
+  // while a body-only DSU only deoptimizes nmethods depending on swapped classes.
+  int flushed_nmethods = CodeCache::nof_nmethods();
+  if (is_body_only()) {
+    flushed_nmethods = 0;
+    for (nmethod* nm = CodeCache::first_nmethod(); nm != NULL; nm = CodeCache::next_nmethod(nm)) {
+      if (nm->is_alive() && nm->is_dsu_dependent_on_swapped_class()) {
+        flushed_nmethods++;
+      }
+    }
+  }
+  const int blocked_threads  = Javelus::count_blocked_application_threads();
+
+  jlong total_count = 0;
+  jlong total_bytes = 0;
+  tty->print_cr("[DSU]-[Estimate]: DSU request from revision %d to %d%s.", from_rn(), to_rn(),
+      is_body_only() ? " (body-only)" : "");
+  for (int i = 0; i < length; i++) {
+    DSUClass* dsu_class = _classes_in_order->at(i);
+    if (!dsu_class->prepared() || dsu_class->updating_type() == DSU_CLASS_NONE) {
+      continue;
+    }
+    tty->print_cr("[DSU]-[Estimate]:   %s (%s) " JLONG_FORMAT " instances, " JLONG_FORMAT " bytes.",
+        dsu_class->name()->as_C_string(),
+        Javelus::class_updating_type_name(dsu_class->updating_type()),
+        counts->at(i), bytes->at(i));
+    total_count += counts->at(i);
+    total_bytes += bytes->at(i);
+  }
+  tty->print_cr("[DSU]-[Estimate]: stale instances: " JLONG_FORMAT ", " JLONG_FORMAT " bytes.", total_count, total_bytes);
+  tty->print_cr("[DSU]-[Estimate]: nmethods to be invalidated: %d.", flushed_nmethods);
+  tty->print_cr("[DSU]-[Estimate]: threads blocked by restricted methods: %d.", blocked_threads);
+  tty->print_cr("[DSU]-[Estimate]: classes to relink: %d.", relink_classes);
+  tty->print_cr("[DSU]-[Estimate]: changed reflection objects: %d.", changed_reflections);
+  tty->print_cr("[DSU]-[Estimate]: heap walk time: %3.7f (s).", census_timer.seconds());
+
+  rollback_prepare();
+
+  set_request_state(DSU_REQUEST_ESTIMATED);
+  return DSU_ERROR_NONE;
+}
+
+// Undo the side effects of prepare on shared metadata so that
+// the dry-run DSU can be discarded safely.
+void DSU::rollback_prepare() {
+  assert(SafepointSynchronize::is_at_safepoint(), "sanity");
+  for (int i = 0; i < _classes_in_order->length(); i++) {
+    _classes_in_order->at(i)->rollback_prepare();
+  }
+
+  if (_classes_to_relink != NULL) {
+    const int length = _classes_to_relink->length();
+    for (int i = 0; i < length; i++) {
+      InstanceKlass* ik = _classes_to_relink->adr_at(i)->old_version_raw();
+      if (ik != NULL && ik->dsu_state() == DSUState::dsu_will_be_recompiled) {
+        ik->set_dsu_state(DSUState::dsu_none);
+      }
+    }
+    _classes_to_relink->clear();
+  }
+}
+
 void DSU::set_up_new_classpath(TRAPS) {
   ResourceMark rm(THREAD);
   bool has_not_loaded_new_version = false;
@@ -464,7 +717,15 @@ DSUError DSUClass::resolve_new_version_by_dsu_thread(InstanceKlass* &new_version
 
   Symbol* class_name = name();
 
-  DSUError ret = dsu_class_loader()->load_new_version(class_name, new_version, stream_provider(), CHECK_(DSU_ERROR_RESOLVE_NEW_CLASS));
+  // let the class file parser lay out the new version like the old one
+  DSUThread* dsu_thread = ((JavaThread*)THREAD)->as_DSUThread();
+  dsu_thread->set_class_being_updated(old_version_class());
+  DSUError ret = dsu_class_loader()->load_new_version(class_name, new_version, stream_provider(), THREAD);
+  dsu_thread->set_class_being_updated(NULL);
+
+  if (HAS_PENDING_EXCEPTION) {
+    return DSU_ERROR_RESOLVE_NEW_CLASS;
+  }
 
   if (ret != DSU_ERROR_NONE) {
     return ret;
@@ -588,6 +849,28 @@ void DSUClass::set_check_flags_for_fields(InstanceKlass* new_version, int min_ob
   }
 }
 
+// Objects of a type narrowed class may still be referenced as instances of
+// old_supertype, so accessing its instance members has to check the type.
+void DSUClass::set_type_narrow_check_flags(InstanceKlass* old_supertype) {
+  Array<Method*>* methods = old_supertype->methods();
+  for (int i = 0; i < methods->length(); i++) {
+    Method* m = methods->at(i);
+    if (m->is_static() || m->name() == vmSymbols::class_initializer_name()
+      || m->name() == vmSymbols::object_initializer_name()) {
+      continue;
+    }
+    m->set_needs_type_narrow_check();
+  }
+
+  const int fields_count = old_supertype->java_fields_count();
+  for (int i = 0; i < fields_count; i++) {
+    FieldInfo* field = old_supertype->field(i);
+    if ((field->access_flags() & JVM_ACC_STATIC) == 0) {
+      field->set_dsu_flags((u2)(field->dsu_flags() | DSU_FLAGS_MEMBER_NEEDS_TYPE_NARROW_CHECK));
+    }
+  }
+}
+
 // lookup along the hierarchy,
 // find the youngest match (may be changed) super class
 // if no super class has been redefined.
@@ -1374,6 +1657,22 @@ DSUError DSUClass::compare_and_normalize_class(InstanceKlass* old_version,
   assert(old_version->super() != NULL , "javelus does not updating library classes");
   assert(new_version->super() != NULL , "javelus does not updating library classes");
 
+  // Reuse the bytecode comparison results of a previous run if both versions match.
+  DSUMethod* last_method = _last_method;
+  julong old_fingerprint = 0;
+  julong new_fingerprint = 0;
+  DSUPlanEntry* plan_entry = NULL;
+  GrowableArray<Method*>* changed_methods = NULL;
+  if (DSUPlan::is_enabled()) {
+    old_fingerprint = DSUPlan::fingerprint(old_version, THREAD);
+    new_fingerprint = DSUPlan::fingerprint(new_version, THREAD);
+    plan_entry = DSUPlan::lookup(name(), old_fingerprint, new_fingerprint);
+    if (plan_entry != NULL) {
+      DSU_INFO(("Reuse DSU plan of class %s.", name()->as_C_string()));
+    } else {
+      changed_methods = new GrowableArray<Method*>();
+    }
+  }
 
   {
     InstanceKlass* old_super = old_version->superklass();
@@ -1596,7 +1895,17 @@ DSUError DSUClass::compare_and_normalize_class(InstanceKlass* old_version,
             new_updating_type = Javelus::join(new_updating_type, DSU_CLASS_METHOD);
           }
 
-          if (!MethodComparator::methods_EMCP(k_old_method, k_new_method)) {
+          bool is_changed;
+          if (plan_entry != NULL) {
+            is_changed = plan_entry->is_changed_method(k_old_method->name(), k_old_method->signature());
+          } else {
+            is_changed = !MethodComparator::methods_EMCP(k_old_method, k_new_method);
+          }
+
+          if (is_changed) {
+            if (changed_methods != NULL) {
+              changed_methods->append(k_old_method);
+            }
             dsu_method->set_updating_type(DSU_METHOD_BC);
             DSU_TRACE(0x00000008, ("byte code of method %s::%s.%s is changed.",
                   this->name()->as_C_string(),
@@ -1650,6 +1959,34 @@ DSUError DSUClass::compare_and_normalize_class(InstanceKlass* old_version,
     }
   }
 
+  if (plan_entry != NULL && plan_entry->updating_type() != new_updating_type) {
+    DSU_WARN(("DSU plan of class %s expects %s but computes %s, discard it.",
+        name()->as_C_string(),
+        Javelus::class_updating_type_name(plan_entry->updating_type()),
+        Javelus::class_updating_type_name(new_updating_type)));
+    // the plan is stale, drop what it produced and compare without it
+    DSUPlan::discard(plan_entry);
+    DSUMethod* p = last_method == NULL ? first_method() : last_method->next();
+    while (p != NULL) {
+      DSUMethod* q = p;
+      p = p->next();
+      delete q;
+    }
+    if (last_method == NULL) {
+      _first_method = NULL;
+    } else {
+      last_method->set_next(NULL);
+    }
+    _last_method = last_method;
+    return compare_and_normalize_class(old_version, new_version, THREAD);
+  } else if (changed_methods != NULL) {
+    plan_entry = DSUPlan::record(name(), old_fingerprint, new_fingerprint, new_updating_type);
+    for (int i = 0; i < changed_methods->length(); i++) {
+      Method* m = changed_methods->at(i);
+      plan_entry->add_changed_method(m->name(), m->signature());
+    }
+  }
+
   if (old_updating_type == new_updating_type) {
     // warn here
     //ShouldNotReachHere();
@@ -1767,6 +2104,10 @@ void DSUClass::swap_class(TRAPS) {
   old_version->set_inner_classes(new_version->inner_classes());
   new_version->set_inner_classes(old_inner_classes);
 
+  julong old_fingerprint = old_version->class_file_fingerprint();
+  old_version->set_class_file_fingerprint(new_version->class_file_fingerprint());
+  new_version->set_class_file_fingerprint(old_fingerprint);
+
   // The class file bytes from before any retransformable agents mucked
   // with them was cached on the scratch class, move to the_class.
   // Note: we still want to do this if nothing needed caching since it
@@ -1871,6 +2212,7 @@ void DSUClass::swap_class(TRAPS) {
   new_version->set_is_stale_class();
   new_version->set_copy_to_size(new_version->size_helper());
   new_version->set_dsu_state(DSUState::dsu_has_been_swapped);
+  DSUReclaim::record_dead_version();
   // the class now is new and clear the DSU state of it.
   old_version->set_dsu_state(DSUState::dsu_none);
 
@@ -1888,7 +2230,10 @@ void DSUClass::swap_class(TRAPS) {
   }
 
   // as we swap the methods, we should update the vtable and itable accordingly
-  update_subklass_vtable_and_itable(old_version, THREAD);
+  if (!install_shadow_dispatch_tables()) {
+    update_subklass_vtable_and_itable(old_version, THREAD);
+  }
+  free_shadow_dispatch_tables();
 
   {// update java mirror
     oop old_java_mirror = old_version->java_mirror();
@@ -1967,6 +2312,93 @@ void DSUClass::update_subklass_vtable_and_itable(InstanceKlass* this_class, TRAP
   }
 }
 
+void DSUClass::compute_shadow_dispatch_tables(TRAPS) {
+  ResourceMark rm(THREAD);
+  free_shadow_dispatch_tables();
+  _shadow_dispatch_entries = new (ResourceObj::C_HEAP, mtInternal) GrowableArray<DSUDispatchEntry>(16, true);
+  collect_shadow_dispatch_entries(old_version_class());
+
+  DSU_TRACE(0x00000400, ("Prepare %d dispatch table entries of sub-classes of %s",
+    _shadow_dispatch_entries->length(), name()->as_C_string()));
+}
+
+// Collect the entries of the sub-classes that update_subklass_vtable_and_itable
+// would change. As the methods of a swapped class only differ in their bodies,
+// re-initializing a vtable or itable only replaces the old methods of swapped
+// classes with their new methods.
+void DSUClass::collect_shadow_dispatch_entries(InstanceKlass* this_class) {
+  DSU* dsu = dsu_class_loader()->dsu();
+  InstanceKlass* subklass = (InstanceKlass*)(this_class->subklass());
+  while(subklass != NULL) {
+    if (!(subklass->dsu_will_be_redefined() || subklass->dsu_will_be_swapped())) {
+      ResourceMark rm;
+
+      klassVtable* vt = subklass->vtable();
+      for (int i = 0; i < vt->length(); i++) {
+        Method* old_method = vt->unchecked_method_at(i);
+        Method* new_method = old_method == NULL ? NULL : dsu->find_swapped_method(old_method);
+        if (new_method != NULL) {
+          _shadow_dispatch_entries->append(DSUDispatchEntry(vt->adr_method_at(i), old_method, new_method));
+        }
+      }
+
+      klassItable* it = subklass->itable();
+      for (int i = 0; i < it->size_offset_table(); i++) {
+        Klass* itfc = it->offset_entry(i)->interface_klass();
+        if (itfc == NULL) {
+          break;
+        }
+        itableMethodEntry* ie = it->offset_entry(i)->first_method_entry(subklass);
+        int count = klassItable::method_count_for_interface(itfc);
+        for (int k = 0; k < count; k++, ie++) {
+          Method* old_method = ie->method();
+          Method* new_method = old_method == NULL ? NULL : dsu->find_swapped_method(old_method);
+          if (new_method != NULL) {
+            Method** adr = (Method**)((address)ie + itableMethodEntry::method_offset_in_bytes());
+            _shadow_dispatch_entries->append(DSUDispatchEntry(adr, old_method, new_method));
+          }
+        }
+      }
+
+      collect_shadow_dispatch_entries(subklass);
+    }
+    subklass = (InstanceKlass*)subklass->next_sibling();
+  }
+}
+
+bool DSUClass::install_shadow_dispatch_tables() {
+  if (_shadow_dispatch_entries == NULL) {
+    return false;
+  }
+
+  // The entries point into the tables of sub-classes, which may have
+  // been freed since.
+  if (dsu_class_loader()->dsu()->classes_unloaded()) {
+    DSU_WARN(("Classes have been unloaded after we prepared the DSU."));
+    return false;
+  }
+
+  const int length = _shadow_dispatch_entries->length();
+  for (int i = 0; i < length; i++) {
+    if (!_shadow_dispatch_entries->at(i).is_unchanged()) {
+      DSU_WARN(("Dispatch tables of sub-classes have been changed after we prepared the DSU."));
+      return false;
+    }
+  }
+
+  for (int i = 0; i < length; i++) {
+    _shadow_dispatch_entries->at(i).install();
+  }
+  return true;
+}
+
+void DSUClass::free_shadow_dispatch_tables() {
+  if (_shadow_dispatch_entries != NULL) {
+    delete _shadow_dispatch_entries;
+    _shadow_dispatch_entries = NULL;
+  }
+}
+
 void DSUClass::undefine_class(TRAPS) {
   //TODO do nothing for CV(Concurrent Version)
   //Here, we only mark methods as invalid members.
@@ -2165,6 +2597,7 @@ void DSUClass::check_and_set_flags_for_type_narrowing_check(InstanceKlass* old_v
       DSU_DEBUG(("Set a type narrowing relevant class %s", old_supertype->name()->as_C_string()));
       old_supertype->set_is_super_type_of_stale_class();
       old_supertype->set_is_type_narrowing_relevant_type();
+      set_type_narrow_check_flags(old_supertype);
       set_check_flags_for_methods(old_supertype, min_vtable_length, CHECK);
       set_check_flags_for_fields(old_supertype, min_object_size_in_bytes, CHECK);
     }
@@ -2284,6 +2717,8 @@ void DSUClass::install_new_version(InstanceKlass* old_version, InstanceKlass* ne
   // we need set here.
   old_version->set_next_version(new_version);
   new_version->set_previous_version(old_version);
+  // compiled methods of the old version are not saved for the next VM
+  CompileCache::invalidate(old_version->name());
 }
 
 void DSUClass::apply_default_class_transformer(InstanceKlass* old_version, InstanceKlass* new_version, TRAPS) {
@@ -2404,6 +2839,7 @@ void DSUClass::post_fix_old_version(InstanceKlass* old_version,
 
   old_version->set_dead_rn(this->to_rn());
   old_version->set_dsu_state(DSUState::dsu_has_been_redefined);
+  DSUReclaim::record_dead_version();
 
   // Continuous Update Support
   if (old_version->new_inplace_new_class() != NULL) {
@@ -2683,6 +3119,92 @@ void DSU::add_class(DSUClass* dsu_class) {
   _classes_in_order->append(dsu_class);
 }
 
+// Two DSUs can be coalesced if neither has been prepared or is a dry-run,
+// they update disjoint classes and their class loaders with the same id
+// refer to the same loader without conflicting transformers.
+bool DSU::can_coalesce(DSU* other) {
+  if (other == this || !is_init() || !other->is_init()
+      || is_dry_run() || other->is_dry_run()) {
+    return false;
+  }
+
+  for (DSUClassLoader* loader = other->first_class_loader(); loader != NULL; loader = loader->next()) {
+    DSUClassLoader* mine = find_class_loader_by_id(loader->id());
+    if (mine != NULL) {
+      if (mine->lid() != loader->lid()) {
+        return false;
+      }
+      if (mine->class_loader_data() != NULL && loader->class_loader_data() != NULL
+          && mine->class_loader_data() != loader->class_loader_data()) {
+        return false;
+      }
+      if (mine->transformer_class() != NULL && loader->transformer_class() != NULL) {
+        return false;
+      }
+      if (mine->helper_class() != NULL && loader->helper_class() != NULL) {
+        return false;
+      }
+    }
+    for (DSUClass* dsu_class = loader->first_class(); dsu_class != NULL; dsu_class = dsu_class->next()) {
+      if (find_class_by_name(dsu_class->name()) != NULL) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Move all class loaders and classes of other to this DSU.
+// The emptied other DSU is freed together with this DSU.
+bool DSU::coalesce(DSU* other) {
+  if (!can_coalesce(other)) {
+    return false;
+  }
+
+  DSUClassLoader* loader = other->first_class_loader();
+  other->_first_class_loader = other->_last_class_loader = NULL;
+  while (loader != NULL) {
+    DSUClassLoader* next = loader->next();
+    loader->set_next(NULL);
+    DSUClassLoader* mine = find_class_loader_by_id(loader->id());
+    if (mine == NULL) {
+      loader->set_dsu(this);
+      add_class_loader(loader);
+    } else {
+      loader->move_classes_to(mine);
+      if (mine->transformer_class() == NULL) {
+        mine->set_transformer_class(loader->transformer_class());
+      }
+      if (mine->helper_class() == NULL) {
+        mine->set_helper_class(loader->helper_class());
+      }
+      if (mine->class_loader_data() == NULL) {
+        mine->set_class_loader_data(loader->class_loader_data());
+      }
+      // keep the emptied class loader in other
+      other->add_class_loader(loader);
+    }
+    loader = next;
+  }
+
+  // loaded loaders must be loaders of this DSU
+  for (loader = first_class_loader(); loader != NULL; loader = loader->next()) {
+    DSUClassLoader* loaded = loader->loaded_loader();
+    if (loaded != NULL && loaded->dsu() != this) {
+      loader->set_loaded_loader(find_class_loader_by_id(loaded->id()));
+    }
+  }
+
+  for (int i = 0; i < other->_classes_in_order->length(); i++) {
+    add_class(other->_classes_in_order->at(i));
+  }
+  other->_classes_in_order->clear();
+
+  other->_coalesced = _coalesced;
+  _coalesced = other;
+  return true;
+}
+
 DSU::~DSU() {
   DSUClassLoader* p = _first_class_loader;
   while (p != NULL) {
@@ -2703,6 +3225,12 @@ DSU::~DSU() {
     _classes_in_order = NULL;
   }
 
+  // coalesced DSUs own the stream providers of classes moved to this DSU
+  if (_coalesced != NULL) {
+    delete _coalesced;
+    _coalesced = NULL;
+  }
+
   free_classes_to_relink();
 }
 
@@ -3354,6 +3882,25 @@ void DSU::flush_dependent_code(TRAPS) {
   CodeCache::make_marked_nmethods_not_entrant();
 }
 
+// Only deoptimize nmethods compiled from or inlining methods of classes
+// that will be swapped. Other nmethods stay valid, but their inline caches
+// are cleared as they may still call the old methods directly.
+void DSU::flush_swapped_dependent_code(TRAPS) {
+  int marked = CodeCache::mark_for_dsu_deoptimization();
+  DSU_DEBUG(("Mark %d of %d nmethods for deoptimization.", marked, CodeCache::nof_nmethods()));
+
+  if (marked > 0) {
+    ResourceMark rm(THREAD);
+    DeoptimizationMarker dm;
+
+    // Deoptimize all activations depending on marked nmethods
+    Deoptimization::deoptimize_dependents();
+
+    // Make the dependent methods not entrant (in VM_Deoptimize they are made zombies)
+    CodeCache::make_marked_nmethods_not_entrant();
+  }
+}
+
 
 DSUClassLoader * DSU::find_class_loader_by_id(Symbol* id) {
   for (DSUClassLoader* dsu_loader = first_class_loader(); dsu_loader!=NULL; dsu_loader=dsu_loader->next()) {
@@ -3417,6 +3964,21 @@ DSUClass* DSU::find_class_by_name_and_loader(Symbol* name, Handle loader) {
   return NULL;
 }
 
+Method* DSU::find_swapped_method(Method* m) const {
+  InstanceKlass* holder = m->method_holder();
+  if (!holder->dsu_will_be_swapped()) {
+    return NULL;
+  }
+  for (int i = 0; i < _classes_in_order->length(); i++) {
+    DSUClass* dsu_class = _classes_in_order->at(i);
+    if (dsu_class->old_version_raw() == holder &&
+        dsu_class->prepared() && dsu_class->updating_type() == DSU_CLASS_BC) {
+      return dsu_class->new_version_class()->find_method(m->name(), m->signature());
+    }
+  }
+  return NULL;
+}
+
 
 // -------------------- DSUStreamProvider -----------------------
 
@@ -3498,6 +4060,7 @@ DSU* DSUBuilder::dsu() const {
 bool DSUBuilder::build(TRAPS) {
   // XXX allocate DSU here.
   _dsu = new DSU();
+  _dsu->set_dry_run(DSUDryRun);
 
   _succ = build_all(THREAD);
 
@@ -3966,6 +4529,7 @@ void DSUJvmtiBuilder::build_deleted_class(DSUClassUpdatingType type, const jvmti
   dsu_class->set_updating_type(type);
   DSUDirectStreamProvider *stream_provider = new DSUDirectStreamProvider(def->class_byte_count, def->class_bytes);
   dsu_class->set_stream_provider(stream_provider);
+  dsu()->add_class(dsu_class);
 }
 
 
@@ -3981,6 +4545,7 @@ void DSUJvmtiBuilder::build_modified_class(DSUClassUpdatingType type, const jvmt
   dsu_class->set_updating_type(type);
   DSUDirectStreamProvider *stream_provider = new DSUDirectStreamProvider(def->class_byte_count, def->class_bytes);
   dsu_class->set_stream_provider(stream_provider);
+  dsu()->add_class(dsu_class);
 }
 
 void DSUJvmtiBuilder::build_transformers(TRAPS) {
@@ -4408,6 +4973,20 @@ void DSUClassLoader::add_class(DSUClass * klass) {
   }
 }
 
+void DSUClassLoader::move_classes_to(DSUClassLoader* to) {
+  assert(to->id() == id(), "sanity check");
+  DSUClass* p = _first_class;
+  while (p != NULL) {
+    DSUClass* q = p;
+    p = p->next();
+    q->set_next(NULL);
+    q->set_dsu_class_loader(to);
+    to->add_class(q);
+  }
+  _first_class = NULL;
+  _last_class = NULL;
+}
+
 void DSUClassLoader::remove_class(DSUClass * klass) {
   assert(find_class_by_name(klass->name()) == klass, "sanity check");
   if (_first_class == klass) {
@@ -4459,7 +5038,8 @@ DSUClass::DSUClass()
   _resolved_reflections_name_and_sig(NULL),
   _resolved_reflections(NULL),
   _type_narrowing_relevant_classes(NULL),
-  _super_classes_of_stale_class(NULL) {}
+  _super_classes_of_stale_class(NULL),
+  _shadow_dispatch_entries(NULL) {}
 
 void DSUClass::print() {
 
@@ -4581,6 +5161,44 @@ void DSUClass::collect_affected_types(InstanceKlass* old_version, InstanceKlass*
   }
 }
 
+void DSUClass::rollback_prepare() {
+  free_shadow_dispatch_tables();
+
+  for (DSUMethod* p = first_method(); p != NULL; p = p->next()) {
+    if (p->method() != NULL) {
+      p->method()->clear_is_restricted_method();
+    }
+  }
+
+  if (_type_narrowing_relevant_classes != NULL) {
+    for (int i = 0; i < _type_narrowing_relevant_classes->length(); i++) {
+      _type_narrowing_relevant_classes->at(i)->set_dsu_state(DSUState::dsu_none);
+    }
+  }
+
+  if (_super_classes_of_stale_class != NULL) {
+    for (int i = 0; i < _super_classes_of_stale_class->length(); i++) {
+      _super_classes_of_stale_class->at(i)->set_dsu_state(DSUState::dsu_none);
+    }
+  }
+
+  InstanceKlass* old_version = old_version_raw();
+  if (old_version != NULL && old_version->dsu_will_be_updated()) {
+    old_version->set_dsu_state(DSUState::dsu_none);
+  }
+
+  InstanceKlass* new_version = new_version_class();
+  if (new_version != NULL) {
+    Javelus::remove_dsu_klass(new_version);
+    // Free the new version at class unloading time like a scratch class
+    // of a failed redefinition, not before because CMS might think it is
+    // still live.
+    SystemDictionary::delete_resolution_error(new_version->constants());
+    new_version->class_loader_data()->add_to_deallocate_list(new_version);
+    set_new_version(NULL);
+  }
+}
+
 void DSUClass::append_match_reflection(Symbol* old_name, Symbol* old_sig,
     Symbol* new_name, Symbol* new_sig, Symbol* new_class_name) {
   if (_match_reflections == NULL) {
@@ -4717,6 +5335,8 @@ DSUClass::~DSUClass() {
     }
     delete _match_reflections;
   }
+
+  free_shadow_dispatch_tables();
 }
 
 DSUMethod* DSUClass::allocate_method(Method* method, TRAPS) {
@@ -4807,36 +5427,69 @@ JVM_ENTRY(jobject, GetMixThat(JNIEnv *env,jclass cls,jobject o))
   return o;
 JVM_END
 
-JVM_ENTRY(jobject, ReplaceObject(JNIEnv *env, jclass clas, jobject old_o, jobject new_o))
-  oop old_obj = JNIHandles::resolve_non_null(old_o);
-  oop new_obj = JNIHandles::resolve_non_null(new_o);
-
-  Handle o_h (THREAD, old_obj);
-  Handle n_h (THREAD, new_obj);
-  Javelus::transform_object_common(o_h, CHECK_NULL);
-  Javelus::transform_object_common(n_h, CHECK_NULL);
+// Copy all fields of the new object n_h into the old object o_h.
+// Returns false if the new object is a mixed object.
+static bool replace_object_common(Handle o_h, Handle n_h, TRAPS) {
+  Javelus::transform_object_common(o_h, CHECK_false);
+  Javelus::transform_object_common(n_h, CHECK_false);
 
-  if (new_obj->mark()->is_mixed_object()) {
-    return NULL;
+  if (n_h->mark()->is_mixed_object()) {
+    return false;
   }
 
   InstanceKlass* ik = InstanceKlass::cast(n_h->klass());
 
   assert(!(ik->is_stale_class() || ik->is_inplace_new_class()),  "only mix new or new here");
 
-  Handle o_phantom (THREAD, o_h());
+  oop o_phantom = o_h();
   if (o_h->mark()->is_mixed_object()) {
-    o_phantom = Handle(THREAD, (oop) o_h->mark()->decode_phantom_object_pointer());
+    o_phantom = (oop) o_h->mark()->decode_phantom_object_pointer();
   }
-  while (ik != NULL) {
-    Javelus::copy_fields(n_h(), o_h(), o_phantom(), ik);
-    ik = ik->superklass();
+  DSUCopyPlan::plan_for(ik)->copy(n_h(), o_h(), o_phantom);
+  return true;
+}
+
+JVM_ENTRY(jobject, ReplaceObject(JNIEnv *env, jclass clas, jobject old_o, jobject new_o))
+  oop old_obj = JNIHandles::resolve_non_null(old_o);
+  oop new_obj = JNIHandles::resolve_non_null(new_o);
+
+  Handle o_h (THREAD, old_obj);
+  Handle n_h (THREAD, new_obj);
+  bool replaced = replace_object_common(o_h, n_h, CHECK_NULL);
+  if (!replaced) {
+    return NULL;
+  }
+  return JNIHandles::make_local(env, o_h());
+
+JVM_END
+
+// ReplaceObjects:
+// replace old_objs[i] with new_objs[i] for each i, mixed new objects are skipped.
+JVM_ENTRY(void, ReplaceObjects(JNIEnv *env, jclass clas, jobjectArray old_objs, jobjectArray new_objs))
+  if (old_objs == NULL || new_objs == NULL) {
+    THROW(vmSymbols::java_lang_NullPointerException());
+  }
+  objArrayHandle olds (THREAD, objArrayOop(JNIHandles::resolve_non_null(old_objs)));
+  objArrayHandle news (THREAD, objArrayOop(JNIHandles::resolve_non_null(new_objs)));
+  if (olds->length() != news->length()) {
+    THROW_MSG(vmSymbols::java_lang_IllegalArgumentException(), "arrays have different lengths");
   }
-  return JNIHandles::make_local(env, old_obj);
 
+  int length = olds->length();
+  for (int i = 0; i < length; i++) {
+    HandleMark hm(THREAD);
+    oop old_obj = olds->obj_at(i);
+    oop new_obj = news->obj_at(i);
+    if (old_obj == NULL || new_obj == NULL) {
+      THROW(vmSymbols::java_lang_NullPointerException());
+    }
+    Handle o_h (THREAD, old_obj);
+    Handle n_h (THREAD, new_obj);
+    replace_object_common(o_h, n_h, CHECK);
+  }
 JVM_END
 
-void invoke_dsu_common(const char *dynamic_patch, jboolean sync, TRAPS) {
+void invoke_dsu_common(const char *dynamic_patch, jboolean sync, bool dry_run, TRAPS) {
   HandleMark hm(THREAD);
   ResourceMark rm(THREAD);
   DSUDynamicPatchBuilder patch_builder(dynamic_patch);
@@ -4860,17 +5513,22 @@ void invoke_dsu_common(const char *dynamic_patch, jboolean sync, TRAPS) {
 
   DSU* dsu = patch_builder.dsu();
 
+  if (dry_run) {
+    dsu->set_dry_run(true);
+  }
+
   dsu->validate(CHECK);
 
   VM_DSUOperation * op = new VM_DSUOperation(dsu);
-  DSUTask* task = new DSUTask(op);
+  DSUTask* task = new DSUTask(op, sync);
 
   Javelus::get_dsu_thread()->add_task(task);
 
   if (sync) {
-    MutexLocker locker(DSURequest_lock);
-    //tty->print_cr("wait until DSU finish try");
-    DSURequest_lock->wait();
+    // wait until our own request is complete
+    task->wait_for_completion();
+    DSU_DEBUG(("DSU request %s is complete with state %d", dynamic_patch, task->result()));
+    delete task;
   }
 
 }
@@ -4901,7 +5559,7 @@ void invoke_dsu_default(jboolean sync, TRAPS) {
   // convert Java String to utf8 string
   const char* value = java_lang_String::as_utf8_string(value_oop);
 
-  invoke_dsu_common(value, sync, CHECK);
+  invoke_dsu_common(value, sync, false, CHECK);
 }
 
 JVM_ENTRY(void, InvokeDSU(JNIEnv *env,jclass cls, jstring dynamic_patch, jboolean sync))
@@ -4909,7 +5567,17 @@ JVM_ENTRY(void, InvokeDSU(JNIEnv *env,jclass cls, jstring dynamic_patch, jboolea
   ResourceMark rm(THREAD);
   Handle h_patch (THREAD, JNIHandles::resolve_non_null(dynamic_patch));
   const char* dynamic_patch_str   = java_lang_String::as_utf8_string(h_patch());
-  invoke_dsu_common(dynamic_patch_str, sync, CHECK);
+  invoke_dsu_common(dynamic_patch_str, sync, false, CHECK);
+JVM_END
+
+// EstimateDSU:
+// prepare the dynamic patch and report its update cost without installing it.
+JVM_ENTRY(void, EstimateDSU(JNIEnv *env,jclass cls, jstring dynamic_patch))
+  HandleMark hm(THREAD);
+  ResourceMark rm(THREAD);
+  Handle h_patch (THREAD, JNIHandles::resolve_non_null(dynamic_patch));
+  const char* dynamic_patch_str   = java_lang_String::as_utf8_string(h_patch());
+  invoke_dsu_common(dynamic_patch_str, true, true, CHECK);
 JVM_END
 
 JVM_ENTRY(void, InvokeDSU2(JNIEnv *env, jclass cls))
@@ -5001,6 +5669,7 @@ JVM_END
 
 Dictionary*     Javelus::_dsu_dictionary = NULL;
 DSUThread*      Javelus::_dsu_thread = NULL;
+DSUTransformerThread* Javelus::_transformer_thread = NULL;
 Method*         Javelus::_implicit_update_method = NULL;
 InstanceKlass*  Javelus::_developer_interface_klass = NULL;
 
@@ -5031,10 +5700,16 @@ void Javelus::finish_active_dsu() {
   assert(SafepointSynchronize::is_at_safepoint(), "sanity" );
   assert(_active_dsu != NULL, "sanity");
 
-  install_dsu(active_dsu());
+  DSU* dsu = active_dsu();
+  install_dsu(dsu);
 
   _active_dsu = NULL;
 
+  // the update may change fields that need the mixed object check
+  DSUCopyPlan::flush_updated(dsu);
+  // the update may change the supertypes of validated classes
+  DSUTypeNarrowCache::clear_all();
+
   increment_system_rn();
 }
 
@@ -5079,6 +5754,8 @@ void Javelus::create_DevelopInterface_klass(TRAPS) {
     getmixthat_index = 5,
     replaceObject_index = 6,
     crn_index = 7,
+    estimateDSU_index = 8,
+    replaceObjects_index = 9,
     total_methods
   };
 
@@ -5136,6 +5813,16 @@ void Javelus::create_DevelopInterface_klass(TRAPS) {
       accessFlags_from( JVM_ACC_PUBLIC | JVM_ACC_STATIC | JVM_ACC_NATIVE),
       &sizes, ConstMethod::NORMAL, CHECK);
 
+  Method* m_estimateDSU = Method::allocate(ClassLoaderData::the_null_class_loader_data(),
+      0,
+      accessFlags_from( JVM_ACC_PUBLIC | JVM_ACC_STATIC | JVM_ACC_NATIVE),
+      &sizes, ConstMethod::NORMAL, CHECK);
+
+  Method* m_replaceObjects = Method::allocate(ClassLoaderData::the_null_class_loader_data(),
+      0,
+      accessFlags_from( JVM_ACC_PUBLIC | JVM_ACC_STATIC | JVM_ACC_NATIVE),
+      &sizes, ConstMethod::NORMAL, CHECK);
+
 
   enum {
     MethodRef_Object_init_index = 1,
@@ -5156,6 +5843,10 @@ void Javelus::create_DevelopInterface_klass(TRAPS) {
     Symbol_replaceObject_sig_index,
     Symbol_crn_name_index,
     Symbol_crn_sig_index,
+    Symbol_estimateDSU_name_index,
+    Symbol_estimateDSU_sig_index,
+    Symbol_replaceObjects_name_index,
+    Symbol_replaceObjects_sig_index,
     Limit
     //    Symbol_invokeDSU_signature_index = Symbol_init_sig_index,
   };
@@ -5196,6 +5887,15 @@ void Javelus::create_DevelopInterface_klass(TRAPS) {
   const char * c_crn_name = "currentRevisionNumber";
   Symbol* crn_name = SymbolTable::lookup(c_crn_name, (int)strlen(c_crn_name), CHECK);
 
+  const char * c_estimateDSU_name = "estimateDSU";
+  Symbol* estimateDSU_name = SymbolTable::lookup(c_estimateDSU_name, (int)strlen(c_estimateDSU_name), CHECK);
+
+  const char * c_replaceObjects_name = "replaceObjects";
+  Symbol* replaceObjects_name = SymbolTable::lookup(c_replaceObjects_name, (int)strlen(c_replaceObjects_name), CHECK);
+
+  const char * c_object_array_object_array_void_signature = "([Ljava/lang/Object;[Ljava/lang/Object;)V";
+  Symbol* object_array_object_array_void_signature = SymbolTable::lookup(c_object_array_object_array_void_signature, (int)strlen(c_object_array_object_array_void_signature), CHECK);
+
   cp->method_at_put(MethodRef_Object_init_index,Class_Object_index,NameAndType_init_index);
   //cp->klass_at_put(Class_DeveloperInterface_index,NULL);
   cp->klass_at_put(Class_Object_index, SystemDictionary::Object_klass());
@@ -5214,6 +5914,10 @@ void Javelus::create_DevelopInterface_klass(TRAPS) {
   cp->symbol_at_put(Symbol_replaceObject_sig_index, object_object_object_signature);
   cp->symbol_at_put(Symbol_crn_name_index, crn_name);
   cp->symbol_at_put(Symbol_crn_sig_index, vmSymbols::void_int_signature());
+  cp->symbol_at_put(Symbol_estimateDSU_name_index, estimateDSU_name);
+  cp->symbol_at_put(Symbol_estimateDSU_sig_index, vmSymbols::string_void_signature());
+  cp->symbol_at_put(Symbol_replaceObjects_name_index, replaceObjects_name);
+  cp->symbol_at_put(Symbol_replaceObjects_sig_index, object_array_object_array_void_signature);
 
   m_init->set_constants(cp);
   m_init->set_name_index(Symbol_init_name_index);
@@ -5265,6 +5969,16 @@ void Javelus::create_DevelopInterface_klass(TRAPS) {
   m_crn->set_signature_index(Symbol_crn_sig_index);
   m_crn->compute_size_of_parameters(THREAD);
 
+  m_estimateDSU->set_constants(cp);
+  m_estimateDSU->set_name_index(Symbol_estimateDSU_name_index);
+  m_estimateDSU->set_signature_index(Symbol_estimateDSU_sig_index);
+  m_estimateDSU->compute_size_of_parameters(THREAD);
+
+  m_replaceObjects->set_constants(cp);
+  m_replaceObjects->set_name_index(Symbol_replaceObjects_name_index);
+  m_replaceObjects->set_signature_index(Symbol_replaceObjects_sig_index);
+  m_replaceObjects->compute_size_of_parameters(THREAD);
+
 
   methods->at_put(init_index, m_init);
   methods->at_put(invokeDSU_index, m_invokeDSU);
@@ -5274,6 +5988,8 @@ void Javelus::create_DevelopInterface_klass(TRAPS) {
   methods->at_put(getmixthat_index, m_getmixthat);
   methods->at_put(replaceObject_index, m_replaceObject);
   methods->at_put(crn_index, m_crn);
+  methods->at_put(estimateDSU_index, m_estimateDSU);
+  methods->at_put(replaceObjects_index, m_replaceObjects);
 
   //set up entry
   //m_invokeDSU->link_method(m_invokeDSU,CHECK);
@@ -5387,6 +6103,14 @@ void Javelus::create_DevelopInterface_klass(TRAPS) {
     CAST_FROM_FN_PTR(address, &CurrentRevisionNumber),
     Method::native_bind_event_is_interesting);
 
+  m_estimateDSU->set_native_function(
+    CAST_FROM_FN_PTR(address, &EstimateDSU),
+    Method::native_bind_event_is_interesting);
+
+  m_replaceObjects->set_native_function(
+    CAST_FROM_FN_PTR(address, &ReplaceObjects),
+    Method::native_bind_event_is_interesting);
+
   _developer_interface_klass = ikh;
 }
 
@@ -5401,6 +6125,10 @@ void Javelus::initialize(TRAPS) {
 
 void Javelus::dsu_thread_init() {
   _dsu_thread            = make_dsu_thread("DSU Thread");
+  if (DSUBackgroundTransform) {
+    DSUStaleInstances::initialize();
+    _transformer_thread  = make_transformer_thread("DSU Transformer Thread");
+  }
   _dsu_dictionary        = new Dictionary(100);
 }
 
@@ -5697,22 +6425,6 @@ void Javelus::invoke_return_barrier(JavaThread* thread) {
 
 
 
-void Javelus::install_return_barrier_all_threads() {
-  for (JavaThread* thr = Threads::first(); thr != NULL; thr = thr->next()) {
-    if (thr->is_Compiler_thread()) {
-      continue;
-    }
-    //thread is walkable
-    intptr_t * barrier = thr->return_barrier_id();
-    if (barrier == NULL) {
-      continue;
-    }
-    if (thr->has_last_Java_frame()) {
-      install_return_barrier_single_thread(thr,barrier);
-    }
-  }
-}
-
 // the barrier is the id of the rm.
 // We should replace its caller's pc.
 void Javelus::install_return_barrier_single_thread(JavaThread * thread, intptr_t * barrier) {
@@ -5757,94 +6469,204 @@ void Javelus::install_return_barrier_single_thread(JavaThread * thread, intptr_t
 }
 
 
+// Walk the stacks of application threads at a DSU safe point, serially on
+// the VM thread or claimed one by one by idle GC worker threads.
+class DSUStackWalkTask : public AbstractGangTask {
+private:
+  GrowableArray<JavaThread*>* _threads;
+  bool                        _repair;
+  volatile jint               _next;
+  volatile jint               _unsafe_threads;
+public:
+  DSUStackWalkTask(GrowableArray<JavaThread*>* threads, bool repair)
+    : AbstractGangTask("DSU stack walk"), _threads(threads), _repair(repair),
+      _next(0), _unsafe_threads(0) {}
+
+  int unsafe_threads() const { return _unsafe_threads; }
+
+  void work(uint worker_id) {
+    ResourceMark rm;
+    HandleMark hm;
+    const jint length = _threads->length();
+    while (true) {
+      jint index = Atomic::add(1, &_next) - 1;
+      if (index >= length) {
+        break;
+      }
+      JavaThread* thr = _threads->at(index);
+      if (_repair) {
+        Javelus::repair_application_thread(thr);
+      } else if (!Javelus::check_application_thread(thr)) {
+        Atomic::inc(&_unsafe_threads);
+      }
+    }
+  }
+};
+
+FlexibleWorkGang* Javelus::safepoint_workers() {
+  CollectedHeap* heap = Universe::heap();
+  if (heap->kind() == CollectedHeap::GenCollectedHeap ||
+      heap->kind() == CollectedHeap::G1CollectedHeap) {
+    // NULL if the heap is not collected in parallel
+    return ((SharedHeap*) heap)->workers();
+  }
+  return NULL;
+}
+
+// Returns the number of threads that are not safe to update.
+static int walk_application_threads(GrowableArray<JavaThread*>* threads, bool repair) {
+  FlexibleWorkGang* workers = NULL;
+  if (UseParallelDSUStackWalk && threads->length() >= (int) ParallelDSUStackWalkThreshold) {
+    workers = Javelus::safepoint_workers();
+  }
+
+  DSUStackWalkTask task(threads, repair);
+  if (workers != NULL && workers->active_workers() > 1) {
+    workers->run_task(&task);
+  } else {
+    task.work(0);
+  }
+  return task.unsafe_threads();
+}
+
+static void collect_application_threads(GrowableArray<JavaThread*>* threads) {
+  for (JavaThread* thr = Threads::first(); thr != NULL; thr = thr->next()) {
+    if (thr->has_last_Java_frame()) {
+      threads->append(thr);
+    }
+  }
+}
+
 // This method will check all application threads.
 // If there exists restricted method on stack
 // XXX remember!!
 // Return true if it is system-wide safe.
 // System-wide safe <==> all threads are safe to update to system revision number.
+// Return barriers are installed in unsafe threads at once, so an interrupted
+// DSU does not walk the stacks again.
 bool Javelus::check_application_threads() {
   assert(SafepointSynchronize::is_at_safepoint(),
     "DSU safepoint must be in VM safepoint");
 
+  ResourceMark rm;
+  GrowableArray<JavaThread*>* threads = new GrowableArray<JavaThread*>(Threads::number_of_threads());
+  collect_application_threads(threads);
+
+  if (walk_application_threads(threads, false) == 0) {
+    return true;
+  }
+
+  // Deoptimization is not MT-safe, install barriers on the VM thread.
+  for (int i = 0; i < threads->length(); i++) {
+    JavaThread* thr = threads->at(i);
+    intptr_t * barrier = thr->return_barrier_id();
+    if (barrier != NULL) {
+      install_return_barrier_single_thread(thr, barrier);
+    }
+  }
+  return false;
+}
+
+// Check a single application thread and set its return barrier id
+// if any restricted method is on its stack.
+bool Javelus::check_application_thread(JavaThread* thr) {
   bool do_print = DSU_TRACE_ENABLED(0x00000080);
 
   // In default, to revision number is current system revision number plus one.
   int sys_from_rn = Javelus::system_revision_number();
   int sys_to_rn = sys_from_rn + 1;
-  bool sys_safe = true;
 
-  ResourceMark rm;
+  bool thread_safe = true;
+  int t_from_rn = thr->current_revision();
 
-  for (JavaThread* thr = Threads::first(); thr != NULL; thr = thr->next()) {
+  // In default, the target rn will be increment by one.
+  int t_to_rn   = t_from_rn + 1;
 
-    if (!thr->has_last_Java_frame()) {
+  if (do_print) {
+    tty->print_cr("[DSU] Check thread %s.",thr->get_thread_name());
+  }
+
+  bool do_set_barrier = false;
+  for(vframeStream vfst(thr); !vfst.at_end(); vfst.next()) {
+    Method* method = vfst.method();
+    InstanceKlass* ik = method->method_holder();
+    if (!ik->oop_is_instance() ) {
+      //We only check instanceKlass
       continue;
-    }/*else {
-     tty->print_cr("JavaThread::");
-     }*/
+    }
+    if (t_from_rn == sys_from_rn) {
+      // The thread is in the youngest version and will updated to a new version
+      assert(ik->dead_rn() >= sys_to_rn, "the method must be alive here");
+
+      // If the method is changed, it is restricted for any updating
+      if (method->is_restricted_method()) {
+        thread_safe = false;
+        // Here we install return barrier
+        // TODO Here we just set the id and will install it at repair_thread
+        if (do_print) {
+          tty->print_cr(" * [%s] - [%d,%d) id=" PTR_FORMAT, method->name_and_sig_as_C_string(), ik->born_rn(), ik->dead_rn(), p2i(vfst.frame_id()));
+        }
+        do_set_barrier = true;
+      } else if (do_set_barrier) {
+        // Return barrier can only be put after the caller of the oldest restricted method.
+        if (do_print) {
+          tty->print_cr(" + [%s] - [%d,%d) id="PTR_FORMAT, method->name_and_sig_as_C_string(),ik->born_rn(),ik->dead_rn(), p2i(vfst.frame_id()));
+        }
+        thr->set_return_barrier_id(vfst.frame_id());
+        do_set_barrier = false;
+      } else {
+        if (do_print) {
+          tty->print_cr(" - [%s] - [%d,%d) I[%d] id="PTR_FORMAT, method->name_and_sig_as_C_string(),ik->born_rn(),ik->dead_rn(),vfst.is_interpreted_frame(), p2i(vfst.frame_id()));
+        }
+      }
+    } else if (t_from_rn < sys_from_rn) {
+      //assert(thr->return_barrier_id() != NULL, "If it is old and it must have return barrier");
+      if (do_print) {
+        tty->print_cr(" # [%s] - [%d,%d) I[%d] id="PTR_FORMAT,method->name_and_sig_as_C_string(),ik->born_rn(),ik->dead_rn(),vfst.is_interpreted_frame(), p2i(vfst.frame_id()));
+      }
+      thread_safe = false;
+      break;
+    } else {
+      // t_from_rn must <= sys_from_rn
+      ShouldNotReachHere();
+    }
+  }// end of thread walking
+  return thread_safe;
+}
+
+// Count threads that would interrupt the DSU at this safe point.
+// Unlike check_application_threads, no return barrier id is set.
+int Javelus::count_blocked_application_threads() {
+  assert(SafepointSynchronize::is_at_safepoint(),
+    "DSU safepoint must be in VM safepoint");
+
+  int sys_from_rn = Javelus::system_revision_number();
+  int blocked = 0;
 
-    bool thread_safe = true;
-    int t_from_rn = thr->current_revision();
+  ResourceMark rm;
 
-    // In default, the target rn will be increment by one.
-    int t_to_rn   = t_from_rn + 1;
+  for (JavaThread* thr = Threads::first(); thr != NULL; thr = thr->next()) {
+    if (!thr->has_last_Java_frame()) {
+      continue;
+    }
 
-    if (do_print) {
-      tty->print_cr("[DSU] Check thread %s.",thr->get_thread_name());
+    if (thr->current_revision() < sys_from_rn) {
+      // still blocked by a previous DSU
+      blocked++;
+      continue;
     }
 
-    bool do_set_barrier = false;
     for(vframeStream vfst(thr); !vfst.at_end(); vfst.next()) {
       Method* method = vfst.method();
-      InstanceKlass* ik = method->method_holder();
-      if (!ik->oop_is_instance() ) {
-        //We only check instanceKlass
-        continue;
-      }
-      if (t_from_rn == sys_from_rn) {
-        // The thread is in the youngest version and will updated to a new version
-        assert(ik->dead_rn() >= sys_to_rn, "the method must be alive here");
-
-        // If the method is changed, it is restricted for any updating
-        if (method->is_restricted_method()) {
-          thread_safe = false;
-          // Here we install return barrier
-          // TODO Here we just set the id and will install it at repair_thread
-          if (do_print) {
-            tty->print_cr(" * [%s] - [%d,%d) id=" PTR_FORMAT, method->name_and_sig_as_C_string(), ik->born_rn(), ik->dead_rn(), p2i(vfst.frame_id()));
-          }
-          do_set_barrier = true;
-        } else if (do_set_barrier) {
-          // Return barrier can only be put after the caller of the oldest restricted method.
-          if (do_print) {
-            tty->print_cr(" + [%s] - [%d,%d) id="PTR_FORMAT, method->name_and_sig_as_C_string(),ik->born_rn(),ik->dead_rn(), p2i(vfst.frame_id()));
-          }
-          thr->set_return_barrier_id(vfst.frame_id());
-          do_set_barrier = false;
-        } else {
-          if (do_print) {
-            tty->print_cr(" - [%s] - [%d,%d) I[%d] id="PTR_FORMAT, method->name_and_sig_as_C_string(),ik->born_rn(),ik->dead_rn(),vfst.is_interpreted_frame(), p2i(vfst.frame_id()));
-          }
-        }
-      } else if (t_from_rn < sys_from_rn) {
-        //assert(thr->return_barrier_id() != NULL, "If it is old and it must have return barrier");
-        if (do_print) {
-          tty->print_cr(" # [%s] - [%d,%d) I[%d] id="PTR_FORMAT,method->name_and_sig_as_C_string(),ik->born_rn(),ik->dead_rn(),vfst.is_interpreted_frame(), p2i(vfst.frame_id()));
-        }
-        thread_safe = false;
+      if (method->is_restricted_method()) {
+        DSU_TRACE(0x00000080, ("Thread %s is blocked by [%s].",
+            thr->get_thread_name(), method->name_and_sig_as_C_string()));
+        blocked++;
         break;
-      } else {
-        // t_from_rn must <= sys_from_rn
-        ShouldNotReachHere();
       }
-    }// end of thread walking
-    if ( !thread_safe
-      /*t_to_rn != sys_to_rn*/) {
-      // We can not update all thread to the system to rn
-      sys_safe = false;
     }
-  }// end of all thread walking
-  return sys_safe;
+  }
+  return blocked;
 }
 
 InstanceKlass* Javelus::resolve_dsu_klass_or_null(Symbol* class_name, ClassLoaderData* loader_data, Handle protection_domain, TRAPS) {
@@ -5993,142 +6815,169 @@ void Javelus::add_dsu_klass(InstanceKlass* k, TRAPS) {
   }
 }
 
+// Remove a class loaded by a discarded DSU, such as a dry-run DSU,
+// so that a later DSU will load its own new version.
+void Javelus::remove_dsu_klass(InstanceKlass* k) {
+  assert_locked_or_safepoint(SystemDictionary_lock);
+  Dictionary* dict = dictionary();
+  // classes are added under their own name and loader, see add_dsu_klass
+  unsigned int d_hash = dict->compute_hash(k->name(), k->class_loader_data());
+  int d_index = dict->hash_to_index(d_hash);
+  for (DictionaryEntry** p = dict->bucket_addr(d_index); *p != NULL; ) {
+    DictionaryEntry* probe = *p;
+    if (probe->klass() == k) {
+      *p = probe->next();
+      if (probe == Dictionary::_current_class_entry) {
+        Dictionary::_current_class_entry = NULL;
+      }
+      dict->free_entry(probe);
+      return;
+    }
+    p = probe->next_addr();
+  }
+}
+
 // After install new classes, we can repair the stack to conform to the new world.
 // XXX This method must be called at the end of redefining all classes.
 // * We will increment the rn of safe thread
 // * All replaced classes have been marked as dead.
 void Javelus::repair_application_threads() {
-  StackRepairClosure src;
-  DoNothinCodeBlobClosure dcbc;
+  assert(SafepointSynchronize::is_at_safepoint(),
+    "DSU safepoint must be in VM safepoint");
+
+  ResourceMark rm;
+  GrowableArray<JavaThread*>* threads = new GrowableArray<JavaThread*>(Threads::number_of_threads());
+  collect_application_threads(threads);
+  walk_application_threads(threads, true);
+}
 
+void Javelus::repair_application_thread(JavaThread* thr) {
   int sys_from_rn = Javelus::system_revision_number();
   int sys_to_rn = sys_from_rn + 1;
 
-  //bool do_print = true;
-  Thread* thread = Thread::current();
-
-  for (JavaThread* thr = Threads::first(); thr != NULL; thr = thr->next()) {
-    //fetch the barrier
-    intptr_t * barrier = thr->return_barrier_id();
-    bool do_update_thread = barrier == NULL;
-    int t_from_rn = thr->current_revision();
-    // Each time, we can only do one step update.
-    int t_to_rn   = t_from_rn + 1;
+  //fetch the barrier
+  intptr_t * barrier = thr->return_barrier_id();
+  bool do_update_thread = barrier == NULL;
+  int t_from_rn = thr->current_revision();
+  // Each time, we can only do one step update.
+  int t_to_rn   = t_from_rn + 1;
 
-    if (t_to_rn != sys_to_rn) {
-      continue;
-    }
+  if (t_to_rn != sys_to_rn) {
+    return;
+  }
 
-    if (thr->has_last_Java_frame()) {
-      DSU_TRACE(0x00000080,("Repair thread %s.",thr->get_thread_name()));
-      frame * callee = NULL;
-      StackFrameStream callee_fst(thr);
-      int count = 0;
-      for(StackFrameStream fst(thr); !fst.is_done(); fst.next()) {
-        frame *current = fst.current();
-        if (count > 0) {
-          callee = callee_fst.current();
-          callee_fst.next();
-        }
-        count++;
-        if (current->is_interpreted_frame()) {
-          // update method and constantpoolcache
-          Method* method = current->interpreter_frame_method();
-          InstanceKlass *ik = method->method_holder();
+  if (thr->has_last_Java_frame()) {
+    DSU_TRACE(0x00000080,("Repair thread %s.",thr->get_thread_name()));
+    frame * callee = NULL;
+    StackFrameStream callee_fst(thr);
+    int count = 0;
+    for(StackFrameStream fst(thr); !fst.is_done(); fst.next()) {
+      frame *current = fst.current();
+      if (count > 0) {
+        callee = callee_fst.current();
+        callee_fst.next();
+      }
+      count++;
+      if (current->is_interpreted_frame()) {
+        // update method and constantpoolcache
+        Method* method = current->interpreter_frame_method();
+        InstanceKlass *ik = method->method_holder();
 
-          DSU_TRACE(0x00000080,(" -j [%s] - [%d,%d)%s%s", method->name_and_sig_as_C_string(), ik->born_rn(), ik->dead_rn(),
-                (method->is_native() ? " native" : ""), (method->is_old() ? " old" : "")));
+        DSU_TRACE(0x00000080,(" -j [%s] - [%d,%d)%s%s", method->name_and_sig_as_C_string(), ik->born_rn(), ik->dead_rn(),
+              (method->is_native() ? " native" : ""), (method->is_old() ? " old" : "")));
 
-          if (method->is_old()) {
-            assert(ik->dead_rn() == sys_to_rn, "sanity check");
-          }
+        if (method->is_old()) {
+          assert(ik->dead_rn() == sys_to_rn, "sanity check");
+        }
 
-          if (ik->dead_rn() == sys_to_rn) {
-            // TODO replace loosely restricted method
-            assert(!method->is_restricted_method(), "No restricted method here !!");
-            assert(method->is_old(), "must be old");
+        if (ik->dead_rn() == sys_to_rn) {
+          // TODO replace loosely restricted method
+          assert(!method->is_restricted_method(), "No restricted method here !!");
+          assert(method->is_old(), "must be old");
 
-            // XXX We do not know
-            Method* new_method = NULL;
+          // XXX We do not know
+          Method* new_method = NULL;
 
-            //TODO Currently We on-stack-replace the loosely-stricted method with next matched version.
-            InstanceKlass* new_ik = ik->next_version();
-            new_method = new_ik->find_method(method->name(), method->signature());
+          //TODO Currently We on-stack-replace the loosely-stricted method with next matched version.
+          InstanceKlass* new_ik = ik->next_version();
+          new_method = new_ik->find_method(method->name(), method->signature());
 
-            assert(new_method != NULL,"loosely restricted method must have a new version");
-            assert(new_method->is_method(),"must be a method");
-            assert(!new_method->is_old(),"new method must not be old");
+          assert(new_method != NULL,"loosely restricted method must have a new version");
+          assert(new_method->is_method(),"must be a method");
+          assert(!new_method->is_old(),"new method must not be old");
 
-            assert(!method->is_native(), "should not be native");
-            assert(!new_method->is_native(), "should not be native");
+          assert(!method->is_native(), "should not be native");
+          assert(!new_method->is_native(), "should not be native");
 
-            int bci = current->interpreter_frame_bci();
-            current->interpreter_frame_set_method(new_method);
-            current->interpreter_frame_set_bcp(new_method->bcp_from(bci));
-            *(current->interpreter_frame_cache_addr()) = new_method->constants()->cache();
+          int bci = current->interpreter_frame_bci();
+          current->interpreter_frame_set_method(new_method);
+          current->interpreter_frame_set_bcp(new_method->bcp_from(bci));
+          *(current->interpreter_frame_cache_addr()) = new_method->constants()->cache();
 
-            if (callee != NULL && !method->is_native()) {
-              Bytecodes::Code code  = Bytecodes::code_at(method, method->bcp_from(bci));
-              // in fact bci may be monitor entry
-              assert(bci >= 0, "can invokestatic be the first stmt.");
+          if (callee != NULL && !method->is_native()) {
+            Bytecodes::Code code  = Bytecodes::code_at(method, method->bcp_from(bci));
+            // in fact bci may be monitor entry
+            assert(bci >= 0, "can invokestatic be the first stmt.");
 
-              if (!(code >= Bytecodes::_invokevirtual && code <= Bytecodes::_invokedynamic)) {
-                tty->print_cr("code is %d, bci is  %d", code, bci);
-                current->print_value();
-                method->print_codes();
-              }
+            if (!(code >= Bytecodes::_invokevirtual && code <= Bytecodes::_invokedynamic)) {
+              tty->print_cr("code is %d, bci is  %d", code, bci);
+              current->print_value();
+              method->print_codes();
+            }
 
-              assert(code >= Bytecodes::_invokevirtual && code <= Bytecodes::_invokedynamic, "must be an invoke"  );
-              int old_entry_index = Bytes::get_native_u2((address)method->bcp_from(bci) +1);
-              int new_entry_index = Bytes::get_native_u2((address)new_method->bcp_from(bci) +1);
+            assert(code >= Bytecodes::_invokevirtual && code <= Bytecodes::_invokedynamic, "must be an invoke"  );
+            int old_entry_index = Bytes::get_native_u2((address)method->bcp_from(bci) +1);
+            int new_entry_index = Bytes::get_native_u2((address)new_method->bcp_from(bci) +1);
 
-              assert(old_entry_index >= 0, "old entry index must be greater than 0");
-              assert(new_entry_index >= 0, "new entry index must be greater than 0");
+            assert(old_entry_index >= 0, "old entry index must be greater than 0");
+            assert(new_entry_index >= 0, "new entry index must be greater than 0");
 
 #ifdef ASSERT
-              Bytecodes::Code new_code  = Bytecodes::code_at(new_method, new_method->bcp_from(bci));
-
-              if (code != new_code) {
-                tty->print_cr("Old code is: %s @%d", Bytecodes::name(code), code);
-                tty->print_cr("New code is: %s @%d", Bytecodes::name(new_code), new_code);
-                tty->print_cr("bci is: %d", bci);
-                method->print();
-                new_method->print();
-              }
+            Bytecodes::Code new_code  = Bytecodes::code_at(new_method, new_method->bcp_from(bci));
 
-              assert(code == new_code, "new code must be old code");
-              if (new_entry_index > new_method->constants()->cache()->length()) {
-                tty->print_cr("%d %d", old_entry_index, new_entry_index);
-                new_method->print();
-                tty->print_cr("end print method");
-              }
+            if (code != new_code) {
+              tty->print_cr("Old code is: %s @%d", Bytecodes::name(code), code);
+              tty->print_cr("New code is: %s @%d", Bytecodes::name(new_code), new_code);
+              tty->print_cr("bci is: %d", bci);
+              method->print();
+              new_method->print();
+            }
+
+            assert(code == new_code, "new code must be old code");
+            if (new_entry_index > new_method->constants()->cache()->length()) {
+              tty->print_cr("%d %d", old_entry_index, new_entry_index);
+              new_method->print();
+              tty->print_cr("end print method");
+            }
 #endif
 
-              // update callee entry, we only do a partial initialize of the new entry
-              assert(new_entry_index < new_method->constants()->cache()->length(), "new entry index must be smaller than cache length");
-              ConstantPoolCacheEntry * new_entry = new_method->constants()->cache()->entry_at(new_entry_index);
-              if (UseInterpreter && !new_entry->is_resolved(code)) {
-                ConstantPoolCache::copy_method_entry(method->constants()->cache(), old_entry_index,
-                  new_method->constants()->cache(), new_entry_index);
-              }
+            // update callee entry, we only do a partial initialize of the new entry
+            assert(new_entry_index < new_method->constants()->cache()->length(), "new entry index must be smaller than cache length");
+            // Stacks may be repaired in parallel and share the entries,
+            // so the entries are checked and copied one thread at a time.
+            ThreadCritical tc;
+            ConstantPoolCacheEntry * new_entry = new_method->constants()->cache()->entry_at(new_entry_index);
+            if (UseInterpreter && !new_entry->is_resolved(code)) {
+              ConstantPoolCache::copy_method_entry(method->constants()->cache(), old_entry_index,
+                new_method->constants()->cache(), new_entry_index);
             }
           }
-        } else if (current->is_compiled_frame()) {
-          CodeBlob * cb = current->cb();
-          if (cb->is_nmethod()) {
-            nmethod* nm = (nmethod*)cb;
-            Method*  m = nm->method();
-            DSU_TRACE(0x00000080,(" -c [%s] )", m->name_and_sig_as_C_string()));
-          }
         }
-      } // end for frame walk loop
-
-      // At last we can set the rn of the thread to sys_to_rn
-      // TODO
-      if (do_update_thread) {
-        thr->increment_revision();
-        assert(thr->current_revision() == sys_to_rn, "Thread must be updated after update stack");
+      } else if (current->is_compiled_frame()) {
+        CodeBlob * cb = current->cb();
+        if (cb->is_nmethod()) {
+          nmethod* nm = (nmethod*)cb;
+          Method*  m = nm->method();
+          DSU_TRACE(0x00000080,(" -c [%s] )", m->name_and_sig_as_C_string()));
+        }
       }
+    } // end for frame walk loop
+
+    // At last we can set the rn of the thread to sys_to_rn
+    // TODO
+    if (do_update_thread) {
+      thr->increment_revision();
+      assert(thr->current_revision() == sys_to_rn, "Thread must be updated after update stack");
     }
   }
 }
@@ -6137,6 +6986,28 @@ void Javelus::transform_object(Handle h, TRAPS) {
   Javelus::transform_object_common(h, CHECK);
 }
 
+void Javelus::type_narrow_check(Handle obj, Klass* target_class, TRAPS) {
+  InstanceKlass* obj_klass = InstanceKlass::cast(obj->klass());
+  if (obj_klass->is_stale_class()) {
+    Javelus::transform_object_common(obj, CHECK);
+    obj_klass = InstanceKlass::cast(obj->klass());
+  }
+
+  assert(!obj_klass->is_stale_class(), "sanity check");
+  if (obj_klass->is_inplace_new_class()) {
+    obj_klass = obj_klass->next_version();
+  }
+
+  if (!obj_klass->is_subtype_of(target_class)) {
+    ResourceMark rm(THREAD);
+    char* message = SharedRuntime::generate_class_cast_message(
+        (JavaThread*)THREAD, obj->klass()->external_name());
+
+    // create exception
+    THROW_MSG(vmSymbols::java_lang_ClassCastException(), message);
+  }
+}
+
 
 
 bool Javelus::transform_object_common_no_lock(Handle stale_object, TRAPS){
@@ -6249,7 +7120,7 @@ bool Javelus::transform_object_common_no_lock(Handle stale_object, TRAPS){
 
               // we could re-allocate new MixNewObject in the old MixNewObject.
               // We need create an MixObject Here.
-              oop new_object = new_phantom_klass->allocate_instance(CHECK_false);
+              oop new_object = Javelus::allocate_phantom_object(new_phantom_klass, CHECK_false);
               Handle new_phantom_object (THREAD, new_object);
 
               assert(((intptr_t)((address)new_phantom_object()) & 0x07) == 0, "must be 8 byte alignment");
@@ -6294,7 +7165,7 @@ bool Javelus::transform_object_common_no_lock(Handle stale_object, TRAPS){
             DSU_TRACE(0x00001000,("Transforming Object: [simple2mixed] [%s]  [%d : %d]", stale_klass->name()->as_C_string(), c_dead_rn, t_crn));
 
             // We need create a phantom object here.
-            oop new_object = new_phantom_klass->allocate_instance(CHECK_false);
+            oop new_object = Javelus::allocate_phantom_object(new_phantom_klass, CHECK_false);
             assert(((intptr_t)((address)new_object) & 0x07) == 0, "must be 8 byte alignment");
             Handle new_phantom_object(THREAD, new_object);
 
@@ -6331,6 +7202,14 @@ bool Javelus::transform_object_common_no_lock(Handle stale_object, TRAPS){
   return transformed;
 }
 
+// Phantom objects are only reachable from the mark of their inplace objects,
+// so we skip the checks of allocate_instance and never register finalizers.
+oop Javelus::allocate_phantom_object(InstanceKlass* phantom_klass, TRAPS) {
+  KlassHandle h_k(THREAD, phantom_klass);
+  int size = phantom_klass->size_helper();
+  return CollectedHeap::phantom_obj_allocate(h_k, size, THREAD);
+}
+
 bool Javelus::transform_object_common(Handle obj, TRAPS) {
   HandleMark hm(THREAD);
   ResourceMark rm(THREAD);
@@ -6375,21 +7254,52 @@ bool Javelus::transform_object_common(Handle obj, TRAPS) {
   return transformed;
 }
 
+// The phantom object takes over the lock word of the inplace object as it
+// is, so a biased, stack-locked or inflated object stays that way and its
+// owner keeps using the fast paths, which lock the phantom object of a
+// mixed object.
 void Javelus::link_mixed_object(Handle inplace_object, Handle phantom_object, TRAPS){
   markOop new_mark = markOopDesc::encode_phantom_object_pointer_as_mark(phantom_object());
-  markOop old_mark = inplace_object->mark();
+  markOop old_mark;
+  int retries = 0;
+
+  for (;;) {
+    old_mark = inplace_object->mark();
+    if (old_mark == markOopDesc::INFLATING()) {
+      // wait for the inflating thread to publish the monitor
+      SpinPause();
+      continue;
+    }
+    markOop phantom_mark = lock_word_for(old_mark, phantom_object());
+    if (phantom_mark == NULL) {
+      BiasedLocking::revoke_and_rebias(inplace_object, false, CHECK);
+      continue;
+    }
+    phantom_object->set_mark(phantom_mark);
+    // The CAS publishes the phantom's mark before the mixed mark.
+    if (Atomic::cmpxchg_ptr(new_mark, inplace_object->mark_addr(), old_mark) == old_mark) {
+      break;
+    }
+    // Another thread locked, unlocked, hashed or inflated the object.
+    retries++;
+  }
 
-  phantom_object->set_mark(old_mark);
+  DSU_TRACE(0x00001000,("Link mixed object after %d retries, object=" PTR_FORMAT", phantom="PTR_FORMAT", old mark="PTR_FORMAT", new mark="PTR_FORMAT,
+      retries, p2i(inplace_object()), p2i(phantom_object()), p2i(old_mark), p2i(new_mark)));
+}
 
-  // A CAS op to install old mark with Mix
-  if (Atomic::cmpxchg_ptr(new_mark, inplace_object->mark_addr(), old_mark) != old_mark) {
-    link_mixed_object_slow(inplace_object, phantom_object, THREAD);
-    DSU_TRACE(0x00001000,("Link mixed object in slow path, object=" PTR_FORMAT", phantom="PTR_FORMAT", old mark="PTR_FORMAT", new mark="PTR_FORMAT,
-        p2i(inplace_object()), p2i(phantom_object()), p2i(old_mark), p2i(new_mark)));
-  } else {
-    DSU_TRACE(0x00001000,("Link mixed object in fast path, object=" PTR_FORMAT", phantom="PTR_FORMAT", old mark="PTR_FORMAT", new mark="PTR_FORMAT,
-        p2i(inplace_object()), p2i(phantom_object()), p2i(old_mark), p2i(new_mark)));
+// Returns the lock word to install when moving mark into new_holder, or
+// NULL if mark is a bias that must be revoked first.  A bias is only valid
+// with the epoch of the class of the object that holds it.
+markOop Javelus::lock_word_for(markOop mark, oop new_holder) {
+  if (!mark->has_bias_pattern()) {
+    return mark;
+  }
+  markOop prototype_header = new_holder->klass()->prototype_header();
+  if (!prototype_header->has_bias_pattern()) {
+    return NULL;
   }
+  return mark->set_bias_epoch(prototype_header->bias_epoch());
 }
 
 void Javelus::unlink_mixed_object(Handle inplace_object, Handle old_phantom_object, TRAPS){
@@ -6403,37 +7313,6 @@ void Javelus::relink_mixed_object(Handle inplace_object, Handle old_phantom_obje
   VMThread::execute(&rm);
 }
 
-void Javelus::link_mixed_object_slow(Handle inplace_object, Handle new_phantom_object, TRAPS){
-  markOop new_mark = markOopDesc::encode_phantom_object_pointer_as_mark(new_phantom_object());
-  markOop old_mark = inplace_object->mark();
-
-  if (UseBiasedLocking) {
-    assert((!SafepointSynchronize::is_at_safepoint()), "no safepoint");
-    if(old_mark->has_bias_pattern()){
-      BiasedLocking::revoke_and_rebias(inplace_object, false, THREAD);
-    }
-  }
-
-  // XXX
-  // Mixed-object is a stable state of head
-  // Only install Mixed-Objects from another stable state INFLATED to MIXED-OBJECTS
-  // Now Object is in INFLATED
-  ObjectSynchronizer::inflate(THREAD, inplace_object());
-
-  int retry_count = 10;
-  old_mark = inplace_object->mark();
-  new_phantom_object->set_mark(old_mark);
-  while (Atomic::cmpxchg_ptr(new_mark, inplace_object->mark_addr(), old_mark) != old_mark) {
-    old_mark = inplace_object->mark();
-    new_phantom_object->set_mark(old_mark);
-    retry_count--;
-    if(retry_count <= 0){
-      DSU_WARN(("Linking mixed object failed."));
-      break;
-    }
-  }
-}
-
 void collect_transformer_arguments(JavaCallArguments &args, Handle inplace_object, Handle phantom_object, Array<u1>* transformer_args, TRAPS) {
   args.push_oop(inplace_object);
   if (transformer_args != NULL) {
@@ -6716,13 +7595,30 @@ void Javelus::dsu_thread_loop() {
 
   while(true) {
     ResourceMark rm;
-    DSUTask * task = thread->next_task();
+    DSUTask * task = NULL;
+    if (DSUReclaimDeadVersions && DSUReclaim::has_dead_versions()) {
+      // The system has converged if no request arrives within the interval.
+      task = thread->next_task(DSUReclaim::interval());
+      if (task == NULL) {
+        DSUReclaim::reclaim_dead_versions(thread);
+        continue;
+      }
+    } else {
+      task = thread->next_task();
+    }
 
     if (task == NULL) {
       DSU_WARN(("Error in fetching task!!"));
       continue;
     }
 
+    task->mark_started();
+    if (DSUCoalesceRequests) {
+      // apply compatible requests queued during a rollout burst at once
+      thread->coalesce_queued_tasks(task);
+    }
+
+    DSURequestState result = DSU_REQUEST_INIT;
     while(true) {
 
       // any time ,there is only one VM_DSUOperation in processing.
@@ -6731,21 +7627,29 @@ void Javelus::dsu_thread_loop() {
 
       VM_DSUOperation * op = task->operation();
       VMThread::execute(op);
+      // the DSU is freed if it is discarded
+      result = op->dsu()->request_state();
 
       if (op->is_finished()) {
         // Request is finished..
         DSU_INFO(("DSU Request is finished"));
-        Javelus::notifyRequest();
+        if (DSUBackgroundTransform && op->dsu()->is_lazy_update()) {
+          // stale instances are left to lazy checks, converge them in the background
+          Javelus::wakeup_transformer_thread(Javelus::system_revision_number());
+        }
+        break;
+      } else if (op->is_estimated()) {
+        // A dry-run request is never installed.
+        DSU_INFO(("DSU Request is estimated"));
+        Javelus::discard_active_dsu();
         break;
       } else if (op->is_empty()) {
         DSU_WARN(("DSU Request has no updated class"));
-        Javelus::notifyRequest();
         break;
        } else if (op->is_discarded()) {
         // Request is discarded..
         DSU_WARN(("DSU Request is discarded"));
         Javelus::discard_active_dsu();
-        Javelus::notifyRequest();
         break;
       } else if (op->is_system_modified()) {
         // make a retry
@@ -6759,24 +7663,111 @@ void Javelus::dsu_thread_loop() {
       } else {
         DSU_WARN(("Unexpected result for DSU Request."));
         Javelus::discard_active_dsu();
-        Javelus::notifyRequest();
+        result = DSU_REQUEST_FAILED;
         break;
       }
 
    }
 
-    delete task;
+    // notify the requesting threads, non-blocking tasks are freed here
+    DSUTask::complete(task, result);
   }
 }
 
+void Javelus::transformer_thread_loop() {
+  DSUTransformerThread* thread = (DSUTransformerThread*) JavaThread::current();
+  int done_rn = thread->requested_rn();
 
-// --------------------------- Synchronization Support -----------------------------
+  while(true) {
+    int rn = thread->next_request(done_rn);
+
+    // This thread has no Java frames while waiting, so it is never repaired
+    // by a DSU. Catch up with the system before transforming any object.
+    while (thread->current_revision() < Javelus::system_revision_number()) {
+      thread->increment_revision();
+    }
+
+    // An interrupted pass is resumed by the request of the newer DSU.
+    transform_stale_instances(thread, rn);
+    done_rn = rn;
+  }
+}
+
+bool Javelus::transform_stale_instances(DSUTransformerThread* thread, int rn) {
+  ResourceMark rm(thread);
+  elapsedTimer dsu_timer;
+  DSU_TIMER_START(dsu_timer);
+
+  // Stale instances are found by collectors, see DSUStaleInstances.
+  // Every live object is marked by a full collection, so the pass is
+  // completed once a full collection has found no more stale instance.
+  CollectedHeap* heap = Universe::heap();
+  DSUStaleInstances::enable();
+  unsigned int full_collections = heap->total_full_collections();
+  jint found = DSUStaleInstances::found();
+
+  const int batch = 64;
+  GrowableArray<Handle>* candidates = new GrowableArray<Handle>(batch);
+  int transformed = 0;
+  bool completed = false;
+  while (rn == Javelus::system_revision_number()) {
+    {
+      HandleMark hm(thread);
+      candidates->clear();
+      DSUStaleInstances::drain(candidates, batch);
+      for (int i = 0; i < candidates->length(); i++) {
+        // The object may have been updated by a request thread.
+        if (Javelus::transform_object_common(candidates->at(i), thread)) {
+          transformed++;
+        }
+        if (thread->has_pending_exception()) {
+          DSU_WARN(("Transforming objects in the background meets exceptions!"));
+          thread->clear_pending_exception();
+        }
+      }
+    }
+
+    if (!candidates->is_empty()) {
+      // let safepoints and application threads proceed
+      ThreadBlockInVM tbivm(thread);
+      os::yield();
+      continue;
+    }
+
+    if (DSUStaleInstances::found() != found) {
+      found = DSUStaleInstances::found();
+      full_collections = heap->total_full_collections();
+    } else if (heap->total_full_collections() != full_collections) {
+      completed = true;
+      break;
+    }
+    // wait for collections or a newer DSU
+    thread->wait_for_request(rn, 100);
+  }
+  DSUStaleInstances::disable();
+
+  DSU_TIMER_STOP(dsu_timer);
+  DSU_INFO(("DSU background transforms %d objects time: %3.7f (s).", transformed, dsu_timer.seconds()));
+  if (!completed) {
+    DSU_INFO(("DSU background transforming is interrupted by a newer DSU."));
+  }
+  return completed;
+}
+
+
+// --------------------------- Synchronization Support -----------------------------
 
 
 void Javelus::wakeup_DSU_thread() {
   Javelus::get_dsu_thread()->wakeup();
 }
 
+void Javelus::wakeup_transformer_thread(int rn) {
+  if (Javelus::get_transformer_thread() != NULL) {
+    Javelus::get_transformer_thread()->request(rn);
+  }
+}
+
 
 void Javelus::waitRequest() {
   MutexLocker locker(DSURequest_lock);
@@ -6874,6 +7865,52 @@ DSUThread* Javelus::make_dsu_thread(const char * name) {
   return dsu_thread;
 }
 
+DSUTransformerThread* Javelus::make_transformer_thread(const char * name) {
+  EXCEPTION_MARK;
+  DSUTransformerThread* transformer_thread = NULL;
+
+  Klass* k = SystemDictionary::resolve_or_fail(vmSymbols::java_lang_Thread(), true, CHECK_0);
+  InstanceKlass* klass = InstanceKlass::cast(k);
+  instanceHandle thread_oop = klass->allocate_instance_handle(CHECK_0);
+  Handle string = java_lang_String::create_from_str(name, CHECK_0);
+
+  // Initialize thread_oop to put it into the system threadGroup
+  Handle thread_group (THREAD,  Universe::system_thread_group());
+  JavaValue result(T_VOID);
+  JavaCalls::call_special(&result, thread_oop,
+    klass,
+    vmSymbols::object_initializer_name(),
+    vmSymbols::threadgroup_string_void_signature(),
+    thread_group,
+    string,
+    CHECK_0);
+
+  {
+    MutexLocker mu(Threads_lock, THREAD);
+    transformer_thread = new DSUTransformerThread();
+
+    if (transformer_thread == NULL || transformer_thread->osthread() == NULL) {
+      vm_exit_during_initialization("java.lang.OutOfMemoryError",
+        "unable to create new native thread");
+    }
+
+    java_lang_Thread::set_thread(thread_oop(), transformer_thread);
+
+    // The transformer thread competes with application threads only when
+    // they are idle, request threads transform objects they touch themselves.
+    java_lang_Thread::set_priority(thread_oop(), MinPriority);
+    os::set_native_priority(transformer_thread, os::java_to_os_priority[MinPriority]);
+
+    java_lang_Thread::set_daemon(thread_oop());
+
+    transformer_thread->set_threadObj(thread_oop());
+    Threads::add(transformer_thread);
+    Thread::start(transformer_thread);
+  }
+
+  return transformer_thread;
+}
+
 
 void Javelus::copy_fields(oop src, oop dst, InstanceKlass* ik) {
   FieldInfo* field_info = NULL;
@@ -7395,22 +8432,25 @@ void Javelus::invoke_dsu_in_jvmti(jint class_count, const jvmtiClassDefinition*
   Thread* THREAD = Thread::current();
 
   DSUJvmtiBuilder builder(class_count, class_definitions);
-  builder.build(CHECK);
+
+  if (!builder.build(THREAD) || HAS_PENDING_EXCEPTION) {
+    // the builder frees the DSU if it fails.
+    DSU_WARN(("Building DSU from JVMTI class definitions met errors, clear DSU"));
+    CLEAR_PENDING_EXCEPTION;
+    return;
+  }
 
   DSU* dsu = builder.dsu();
 
   dsu->validate(CHECK);
 
   VM_DSUOperation * op = new VM_DSUOperation(dsu);
-  DSUTask* task = new DSUTask(op);
+  DSUTask* task = new DSUTask(op, true);
 
   Javelus::get_dsu_thread()->add_task(task);
 
-  {
-    MutexLocker locker(DSURequest_lock);
-    DSURequest_lock->wait();
-  }
-
+  task->wait_for_completion();
+  delete task;
 }
 
 
@@ -7598,6 +8638,73 @@ void DSUEagerUpdate::collect_dead_instances_at_safepoint(int dead_time, Growable
   //Heap_lock->unlock();
 }
 
+oop*          DSUStaleInstances::_buffer   = NULL;
+int           DSUStaleInstances::_capacity = 0;
+volatile jint DSUStaleInstances::_length   = 0;
+volatile jint DSUStaleInstances::_found    = 0;
+volatile bool DSUStaleInstances::_enabled  = false;
+
+void DSUStaleInstances::initialize() {
+  _capacity = 32 * K;
+  _buffer = NEW_C_HEAP_ARRAY(oop, _capacity, mtInternal);
+}
+
+void DSUStaleInstances::enable() {
+  assert(_buffer != NULL, "not initialized");
+  _enabled = true;
+}
+
+void DSUStaleInstances::disable() {
+  assert(!SafepointSynchronize::is_at_safepoint(), "collectors may be enqueuing");
+  _enabled = false;
+  _length = 0;
+}
+
+void DSUStaleInstances::enqueue(oop obj) {
+  assert(SafepointSynchronize::is_at_safepoint(), "only collectors enqueue");
+  if (!obj->klass()->is_stale_class()) {
+    return;
+  }
+  Atomic::inc(&_found);
+  // Parallel workers claim slots, objects past the end are dropped and
+  // found again by a later collection.
+  jint index = Atomic::add(1, &_length) - 1;
+  if (index < _capacity) {
+    _buffer[index] = obj;
+  }
+}
+
+int DSUStaleInstances::drain(GrowableArray<Handle>* result, int max) {
+  assert(!SafepointSynchronize::is_at_safepoint(), "collectors may be enqueuing");
+  Thread* thread = Thread::current();
+  int length = MIN2((int)_length, _capacity);
+  int drained = 0;
+  while (length > 0 && drained < max) {
+    oop obj = _buffer[--length];
+    // cleared entries refer to dead objects
+    if (obj != NULL) {
+      result->append(Handle(thread, obj));
+      drained++;
+    }
+  }
+  _length = length;
+  return drained;
+}
+
+void DSUStaleInstances::weak_oops_do(BoolObjectClosure* is_alive, OopClosure* f) {
+  int length = MIN2((int)_length, _capacity);
+  for (int i = 0; i < length; i++) {
+    oop* p = &_buffer[i];
+    if (*p != NULL) {
+      if (is_alive->do_object_b(*p)) {
+        f->do_oop(p);
+      } else {
+        *p = NULL;
+      }
+    }
+  }
+}
+
 // Install a return barrier that waiting for the DSUEagerUpdate is finished.
 void DSUEagerUpdate::install_eager_update_return_barrier(TRAPS) {
 
@@ -7729,3 +8836,1207 @@ void DSUEagerUpdate::install_eager_update_return_barrier(TRAPS) {
   }
 }
 
+
+// --------------------- DSUPlan -------------------
+
+DSUPlanEntry* DSUPlan::_entries = NULL;
+bool DSUPlan::_loaded = false;
+bool DSUPlan::_dirty  = false;
+
+DSUPlanEntry::DSUPlanEntry(Symbol* class_name, julong old_fingerprint, julong new_fingerprint,
+                           DSUClassUpdatingType updating_type)
+: _class_name(class_name),
+  _old_fingerprint(old_fingerprint),
+  _new_fingerprint(new_fingerprint),
+  _updating_type(updating_type),
+  _changed_methods(NULL),
+  _next(NULL) {
+  _class_name->increment_refcount();
+  _changed_methods = new (ResourceObj::C_HEAP, mtInternal) GrowableArray<Symbol*>(8, true);
+}
+
+DSUPlanEntry::~DSUPlanEntry() {
+  _class_name->decrement_refcount();
+  for (int i = 0; i < _changed_methods->length(); i++) {
+    _changed_methods->at(i)->decrement_refcount();
+  }
+  delete _changed_methods;
+}
+
+void DSUPlanEntry::add_changed_method(Symbol* name, Symbol* signature) {
+  name->increment_refcount();
+  signature->increment_refcount();
+  _changed_methods->append(name);
+  _changed_methods->append(signature);
+}
+
+bool DSUPlanEntry::is_changed_method(Symbol* name, Symbol* signature) const {
+  const int length = changed_methods_count();
+  for (int i = 0; i < length; i++) {
+    if (changed_method_name_at(i) == name && changed_method_signature_at(i) == signature) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// 64-bit FNV-1a with the finalizer of MurmurHash3, so that every input
+// bit affects every output bit.
+static julong hash_class_file(const u1* bytes, size_t length) {
+  julong h = UCONST64(0xcbf29ce484222325);
+  for (size_t i = 0; i < length; i++) {
+    h ^= bytes[i];
+    h *= UCONST64(0x100000001b3);
+  }
+  h ^= h >> 33;
+  h *= UCONST64(0xff51afd7ed558ccd);
+  h ^= h >> 33;
+  h *= UCONST64(0xc4ceb9fe1a85ec53);
+  h ^= h >> 33;
+  return h;
+}
+
+// The class file is reconstituted from the metadata, which undoes the
+// rewriting done at link time, so the fingerprint does not depend on
+// whether the class has been linked. Only classes taking part in an
+// update or a compile cache pay for it, and only once.
+julong DSUPlan::fingerprint(InstanceKlass* ik, TRAPS) {
+  julong fp = ik->class_file_fingerprint();
+  if (fp != 0) {
+    return fp;
+  }
+  ResourceMark rm(THREAD);
+  HandleMark hm(THREAD);
+  instanceKlassHandle ikh(THREAD, ik);
+  {
+    constantPoolHandle constants(THREAD, ik->constants());
+    // lock the constant pool while it is queried, unless all threads are stopped
+    MonitorLockerEx ml(SafepointSynchronize::is_at_safepoint() ? NULL : constants->lock());
+    JvmtiClassFileReconstituter reconstituter(ikh);
+    if (reconstituter.get_error() != JVMTI_ERROR_NONE) {
+      return 0;
+    }
+    fp = hash_class_file(reconstituter.class_file_bytes(), reconstituter.class_file_size());
+  }
+  if (fp == 0) {
+    fp = 1;
+  }
+  ik->set_class_file_fingerprint(fp);
+  return fp;
+}
+
+DSUPlanEntry* DSUPlan::lookup(Symbol* class_name, julong old_fingerprint, julong new_fingerprint) {
+  if (old_fingerprint == 0 || new_fingerprint == 0) {
+    return NULL;
+  }
+  for (DSUPlanEntry* entry = _entries; entry != NULL; entry = entry->next()) {
+    if (entry->class_name() == class_name
+        && entry->old_fingerprint() == old_fingerprint
+        && entry->new_fingerprint() == new_fingerprint) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+void DSUPlan::discard(DSUPlanEntry* entry) {
+  DSUPlanEntry** p = &_entries;
+  while (*p != entry) {
+    assert(*p != NULL, "entry must be in the plan");
+    p = (*p)->next_addr();
+  }
+  *p = entry->next();
+  delete entry;
+  _dirty = true;
+}
+
+DSUPlanEntry* DSUPlan::record(Symbol* class_name, julong old_fingerprint, julong new_fingerprint,
+                              DSUClassUpdatingType updating_type) {
+  DSUPlanEntry* entry = new DSUPlanEntry(class_name, old_fingerprint, new_fingerprint, updating_type);
+  entry->set_next(_entries);
+  _entries = entry;
+  _dirty = true;
+  return entry;
+}
+
+// class <name> <old fingerprint> <new fingerprint> <updating type>
+// method <name> <signature>
+void DSUPlan::parse_line(char* line, DSUPlanEntry* &current, TRAPS) {
+  char name[1024];
+  char signature[1024];
+  julong old_fingerprint;
+  julong new_fingerprint;
+  int updating_type;
+  if (sscanf(line, "class %1023s " JULONG_FORMAT " " JULONG_FORMAT " %d",
+             name, &old_fingerprint, &new_fingerprint, &updating_type) == 4) {
+    Symbol* class_name = SymbolTable::new_symbol(name, (int) strlen(name), CHECK);
+    current = new DSUPlanEntry(class_name, old_fingerprint, new_fingerprint, (DSUClassUpdatingType) updating_type);
+    // the entry holds its own reference
+    class_name->decrement_refcount();
+    current->set_next(_entries);
+    _entries = current;
+  } else if (current != NULL && sscanf(line, "method %1023s %1023s", name, signature) == 2) {
+    TempNewSymbol method_name = SymbolTable::new_symbol(name, (int) strlen(name), CHECK);
+    TempNewSymbol method_signature = SymbolTable::new_symbol(signature, (int) strlen(signature), CHECK);
+    current->add_changed_method(method_name, method_signature);
+  } else if (line[0] != '#' && line[0] != '\0') {
+    DSU_WARN(("Ignore malformed line of DSU plan: %s", line));
+  }
+}
+
+void DSUPlan::load(TRAPS) {
+  if (_loaded) {
+    return;
+  }
+  _loaded = true;
+
+  struct stat st;
+  if (os::stat(DSUPlanFile, &st) != 0) {
+    DSU_INFO(("DSU plan %s does not exist, it will be created.", DSUPlanFile));
+    return;
+  }
+  int file_handle = os::open(DSUPlanFile, 0, 0);
+  if (file_handle == -1) {
+    DSU_WARN(("Cannot open DSU plan %s.", DSUPlanFile));
+    return;
+  }
+
+  ResourceMark rm(THREAD);
+  char* buffer = NEW_RESOURCE_ARRAY(char, st.st_size + 1);
+  size_t num_read = os::read(file_handle, buffer, st.st_size);
+  os::close(file_handle);
+  if (num_read != (size_t) st.st_size) {
+    DSU_WARN(("File size of DSU plan error!"));
+    return;
+  }
+  buffer[num_read] = '\0';
+
+  DSUPlanEntry* current = NULL;
+  char* line = buffer;
+  for (size_t pos = 0; pos < num_read; pos++) {
+    if (buffer[pos] == '\n') {
+      buffer[pos] = '\0';
+      parse_line(line, current, CHECK);
+      line = buffer + pos + 1;
+    }
+  }
+  parse_line(line, current, CHECK);
+}
+
+void DSUPlan::save() {
+  if (!_dirty) {
+    return;
+  }
+  // Write a temporary file and rename it, so that a concurrent reader or
+  // a crash never sees a truncated plan.
+  char tmp_name[JVM_MAXPATHLEN];
+  jio_snprintf(tmp_name, sizeof(tmp_name), "%s.%d.tmp", DSUPlanFile, os::current_process_id());
+  FILE* file = fopen(tmp_name, "w");
+  if (file == NULL) {
+    DSU_WARN(("Cannot write DSU plan %s.", tmp_name));
+    return;
+  }
+  ResourceMark rm;
+  fprintf(file, "# Javelus DSU plan\n");
+  for (DSUPlanEntry* entry = _entries; entry != NULL; entry = entry->next()) {
+    fprintf(file, "class %s " JULONG_FORMAT " " JULONG_FORMAT " %d\n",
+        entry->class_name()->as_C_string(),
+        entry->old_fingerprint(),
+        entry->new_fingerprint(),
+        (int) entry->updating_type());
+    for (int i = 0; i < entry->changed_methods_count(); i++) {
+      fprintf(file, "method %s %s\n",
+          entry->changed_method_name_at(i)->as_C_string(),
+          entry->changed_method_signature_at(i)->as_C_string());
+    }
+  }
+  if (fclose(file) != 0 || ::rename(tmp_name, DSUPlanFile) != 0) {
+    DSU_WARN(("Cannot write DSU plan %s.", DSUPlanFile));
+    remove(tmp_name);
+    return;
+  }
+  _dirty = false;
+}
+
+// --------------------- DSUReclaim -------------------
+
+volatile bool DSUReclaim::_has_dead_versions = false;
+jlong         DSUReclaim::_interval = 0;
+
+GrowableArray<DSUReclaimGroup>* DSUReclaim::_groups         = NULL;
+GrowableArray<DSUReclaimEntry>* DSUReclaim::_metadata       = NULL;
+GrowableArray<DSUReclaimEntry>* DSUReclaim::_mirrors        = NULL;
+GrowableArray<int>*             DSUReclaim::_worklist       = NULL;
+GrowableArray<objArrayOop>*     DSUReclaim::_loader_classes = NULL;
+GrowableArray<DSUReclaimRow>*   DSUReclaim::_rows           = NULL;
+
+// A fruitless attempt doubles the interval. We stop trying until the next
+// DSU once the interval exceeds DSUReclaimInterval by this factor.
+static const int dsu_reclaim_max_backoff = 64;
+
+class DSUReclaimOopClosure : public ExtendedOopClosure {
+private:
+  template <class T> void do_oop_work(T* p) {
+    oop obj = oopDesc::load_decode_heap_oop(p);
+    if (obj != NULL) {
+      DSUReclaim::mark_mirror(obj);
+    }
+  }
+public:
+  virtual void do_oop(oop* p)       { do_oop_work(p); }
+  virtual void do_oop(narrowOop* p) { do_oop_work(p); }
+};
+
+// Zombie nmethods are only checked for their methods in scan_nmethod.
+class DSUReclaimCodeBlobClosure : public CodeBlobToOopClosure {
+public:
+  DSUReclaimCodeBlobClosure(OopClosure* cl) : CodeBlobToOopClosure(cl, false) {}
+  virtual void do_code_blob(CodeBlob* cb) {
+    nmethod* nm = cb->as_nmethod_or_null();
+    if (nm != NULL && nm->is_alive()) {
+      CodeBlobToOopClosure::do_code_blob(cb);
+    }
+  }
+};
+
+class DSUReclaimKlassClosure : public KlassClosure {
+public:
+  void do_klass(Klass* k) {
+    if (k->oop_is_array()) {
+      DSUReclaim::fix_component_mirror(ArrayKlass::cast(k));
+    }
+    // a candidate refers to its own mirror
+    if (!DSUReclaim::is_candidate(k)) {
+      DSUReclaim::mark_mirror(k->java_mirror());
+    }
+  }
+};
+
+class DSUReclaimCLDClosure : public CLDClosure {
+private:
+  OopClosure*   _oops;
+  KlassClosure* _klasses;
+public:
+  DSUReclaimCLDClosure(OopClosure* oops, KlassClosure* klasses)
+    : _oops(oops), _klasses(klasses) {}
+  void do_cld(ClassLoaderData* cld) {
+    cld->oops_do(_oops, _klasses, false);
+  }
+};
+
+// Weak roots are treated as strong ones, a weakly reachable mirror
+// of a reclaimed class would be left without a klass.
+class DSUReclaimAlwaysTrueClosure : public BoolObjectClosure {
+public:
+  bool do_object_b(oop p) { return true; }
+};
+
+class DSUReclaimObjectClosure : public ObjectClosure {
+private:
+  DSUReclaimOopClosure _oops;
+public:
+  void do_object(oop obj) {
+    // instances and arrays of a dead version
+    DSUReclaim::mark_metadata(obj->klass());
+    if (java_lang_invoke_MemberName::is_instance(obj)) {
+      DSUReclaim::mark_metadata(java_lang_invoke_MemberName::vmtarget(obj));
+    }
+    if (DSUReclaim::is_candidate_mirror(obj) || DSUReclaim::is_loader_classes(obj)) {
+      return;
+    }
+    obj->oop_iterate(&_oops);
+  }
+};
+
+static int compare_reclaim_entry(DSUReclaimEntry* left, DSUReclaimEntry* right) {
+  if (left->_key == right->_key) {
+    return 0;
+  }
+  return left->_key < right->_key ? -1 : 1;
+}
+
+// Returns the offset of a non-static field declared in k or its super classes.
+static int reclaim_field_offset(Klass* k, const char* name) {
+  for (; k != NULL; k = k->super()) {
+    for (JavaFieldStream fs(InstanceKlass::cast(k)); !fs.done(); fs.next()) {
+      if (!fs.access_flags().is_static() && fs.name()->equals(name)) {
+        return fs.offset();
+      }
+    }
+  }
+  return -1;
+}
+
+void DSUReclaim::record_dead_version() {
+  assert(SafepointSynchronize::is_at_safepoint(), "sanity");
+  _has_dead_versions = true;
+  _interval = DSUReclaimInterval;
+}
+
+void DSUReclaim::reclaim_dead_versions(TRAPS) {
+  VM_DSUReclaim op;
+  VMThread::execute(&op);
+
+  if (op.remaining() == 0) {
+    _has_dead_versions = false;
+  } else if (op.reclaimed() == 0) {
+    // Dead versions may still be referenced by garbage,
+    // which will be collected by a later GC.
+    _interval <<= 1;
+    if (_interval > DSUReclaimInterval * dsu_reclaim_max_backoff) {
+      DSU_INFO(("Stop reclaiming %d referenced dead class versions until the next DSU.", op.remaining()));
+      _has_dead_versions = false;
+    }
+  }
+}
+
+void DSUReclaim::add_entry(GrowableArray<DSUReclaimEntry>* entries, address key, int group) {
+  DSUReclaimEntry entry;
+  entry._key   = key;
+  entry._group = group;
+  entries->append(entry);
+}
+
+int DSUReclaim::lookup(GrowableArray<DSUReclaimEntry>* entries, address key) {
+  if (entries == NULL) {
+    return -1;
+  }
+  int low  = 0;
+  int high = entries->length() - 1;
+  while (low <= high) {
+    int mid = (low + high) >> 1;
+    address k = entries->at(mid)._key;
+    if (k == key) {
+      return entries->at(mid)._group;
+    } else if (k < key) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return -1;
+}
+
+void DSUReclaim::add_candidate(Klass* k) {
+  if (!k->oop_is_instance()) {
+    return;
+  }
+  InstanceKlass* ik = InstanceKlass::cast(k);
+  bool swapped   = ik->dsu_has_been_swapped();
+  bool redefined = ik->dsu_has_been_redefined();
+  if (!swapped && !redefined) {
+    return;
+  }
+  // Clones are collected together with their dead version.
+  if (ik->is_inplace_new_class()
+      || (ik->previous_version() != NULL && ik->previous_version()->stale_new_class() == ik)) {
+    return;
+  }
+  InstanceKlass* next = ik->next_version();
+  // jfieldIDs of static fields and jmethodIDs cannot be revoked.
+  if (next == NULL || ik->is_shared() || ik->jni_ids() != NULL || has_jmethod_ids(ik)) {
+    return;
+  }
+  // Array classes of a swapped class are still used by the swapped class.
+  if (swapped && ik->array_klasses() != NULL) {
+    return;
+  }
+  // The class transformer of the next version reads static fields of this version.
+  if (redefined && !next->is_initialized()) {
+    return;
+  }
+  if (SystemDictionary::find_class(ik->name(), ik->class_loader_data()) == ik) {
+    return;
+  }
+
+  DSUReclaimGroup group;
+  group._klass         = ik;
+  group._inplace_class = redefined ? ik->new_inplace_new_class() : NULL;
+  group._stale_class   = redefined ? ik->stale_new_class() : NULL;
+  group._referenced    = false;
+  group._reclaimable   = false;
+  int index = _groups->append(group);
+
+  add_entry(_metadata, (address)ik, index);
+  if (group._inplace_class != NULL) {
+    add_entry(_metadata, (address)group._inplace_class, index);
+  }
+  if (group._stale_class != NULL) {
+    add_entry(_metadata, (address)group._stale_class, index);
+  }
+  Array<Method*>* methods = ik->methods();
+  for (int i = 0; i < methods->length(); i++) {
+    add_entry(_metadata, (address)methods->at(i), index);
+  }
+  // Clones share the mirror of the next version.
+  add_entry(_mirrors, (address)ik->java_mirror(), index);
+}
+
+void DSUReclaim::mark_group(int group) {
+  DSUReclaimGroup* g = _groups->adr_at(group);
+  if (!g->_referenced) {
+    g->_referenced = true;
+    _worklist->append(group);
+  }
+}
+
+void DSUReclaim::mark_klass(Klass* k) {
+  if (k == NULL) {
+    return;
+  }
+  int group = lookup(_metadata, (address)k);
+  if (group >= 0) {
+    mark_group(group);
+  }
+}
+
+void DSUReclaim::mark_metadata(Metadata* md) {
+  if (md == NULL) {
+    return;
+  }
+  int group = lookup(_metadata, (address)md);
+  if (group >= 0) {
+    mark_group(group);
+  } else if (md->is_method()) {
+    mark_klass(((Method*)md)->method_holder());
+  } else if (md->is_methodData()) {
+    mark_metadata(((MethodData*)md)->method());
+  } else if (md->is_klass() && ((Klass*)md)->oop_is_objArray()) {
+    mark_klass(ObjArrayKlass::cast((Klass*)md)->bottom_klass());
+  }
+}
+
+// Conservatively treat every word equal to a candidate as a reference.
+// Status bits are masked, as a type profile cell tags the klass pointer.
+void DSUReclaim::mark_words(intptr_t* start, int length) {
+  for (int i = 0; i < length; i++) {
+    mark_klass((Klass*)TypeEntries::klass_part(start[i]));
+  }
+}
+
+void DSUReclaim::mark_mirror(oop obj) {
+  int group = lookup(_mirrors, (address)obj);
+  if (group >= 0) {
+    mark_group(group);
+  }
+}
+
+bool DSUReclaim::is_loader_classes(oop obj) {
+  for (int i = 0; i < _loader_classes->length(); i++) {
+    if (_loader_classes->at(i) == obj) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// post_fix_old_version moves the array classes of a redefined class to
+// its next version, but the component mirror still is the old one.
+void DSUReclaim::fix_component_mirror(ArrayKlass* ak) {
+  oop mirror = ak->component_mirror();
+  if (mirror == NULL || !is_candidate_mirror(mirror)) {
+    return;
+  }
+  if (ak->oop_is_objArray()) {
+    Klass* element = ObjArrayKlass::cast(ak)->element_klass();
+    if (!is_candidate(element)) {
+      ak->set_component_mirror(element->java_mirror());
+      return;
+    }
+  }
+  mark_mirror(mirror);
+}
+
+// ClassLoader.classes keeps the mirrors of all classes defined by the
+// loader. These references are replaced with the mirrors of the next
+// versions instead of keeping dead versions alive.
+void DSUReclaim::collect_loader_classes() {
+  int classes_offset = reclaim_field_offset(SystemDictionary::ClassLoader_klass(), "classes");
+  if (classes_offset < 0) {
+    return;
+  }
+  for (int i = 0; i < _groups->length(); i++) {
+    oop loader = _groups->at(i)._klass->class_loader();
+    if (loader == NULL) {
+      continue;
+    }
+    oop classes = loader->obj_field(classes_offset);
+    if (classes == NULL) {
+      continue;
+    }
+    int data_offset = reclaim_field_offset(classes->klass(), "elementData");
+    if (data_offset < 0) {
+      continue;
+    }
+    oop data = classes->obj_field(data_offset);
+    if (data != NULL && data->is_objArray() && !is_loader_classes(data)) {
+      _loader_classes->append((objArrayOop)data);
+    }
+  }
+}
+
+void DSUReclaim::scan_roots() {
+  DSUReclaimOopClosure oops;
+  DSUReclaimAlwaysTrueClosure always_true;
+  DSUReclaimCodeBlobClosure code(&oops);
+  DSUReclaimKlassClosure klasses;
+  DSUReclaimCLDClosure clds(&oops, &klasses);
+
+  Universe::oops_do(&oops);
+  JNIHandles::oops_do(&oops);
+  JNIHandles::weak_oops_do(&always_true, &oops);
+  Threads::oops_do(&oops, NULL, &code);
+  ObjectSynchronizer::oops_do(&oops);
+  Management::oops_do(&oops);
+  JvmtiExport::oops_do(&oops);
+  JvmtiExport::weak_oops_do(&always_true, &oops);
+  SystemDictionary::oops_do(&oops);
+  Javelus::oops_do(&oops);
+  CodeCache::blobs_do(&code);
+  ClassLoaderDataGraph::cld_do(&clds);
+
+  // the same metadata as MetadataOnStackMark
+  Threads::metadata_do(mark_metadata);
+  CodeCache::nmethods_do(scan_nmethod);
+  CompileBroker::metadata_do(mark_metadata);
+  JvmtiCurrentBreakpoints::metadata_do(mark_metadata);
+  ThreadService::metadata_do(mark_metadata);
+}
+
+void DSUReclaim::scan_heap() {
+  // Ensure that the heap is parsable
+  Universe::heap()->ensure_parsability(false);  // no need to retire TALBs
+
+  DSUReclaimObjectClosure objects;
+  Universe::heap()->object_iterate(&objects);
+}
+
+void DSUReclaim::scan_nmethod(nmethod* nm) {
+  if (nm->is_alive()) {
+    nm->metadata_do(mark_metadata);
+  } else if (nm->method() != NULL) {
+    // the sweeper still accesses the method of a zombie
+    mark_metadata(nm->method());
+  }
+}
+
+void DSUReclaim::scan_method_data(MethodData* mdo) {
+  // Receivers are only profiles and do not keep a version alive.
+  // Hide them from mark_words, clear_rows restores or clears them.
+  for (ProfileData* data = mdo->first_data();
+      mdo->is_valid(data);
+      data = mdo->next_data(data)) {
+    if (data->is_ReceiverTypeData()) {
+      ReceiverTypeData* rtd = (ReceiverTypeData*)data;
+      for (uint row = 0; row < ReceiverTypeData::row_limit(); row++) {
+        Klass* recv = rtd->receiver(row);
+        if (recv != NULL && is_candidate(recv)) {
+          DSUReclaimRow r;
+          r._data     = (DataLayout*)data->dp();
+          r._row      = row;
+          r._receiver = recv;
+          _rows->append(r);
+          rtd->set_receiver(row, NULL);
+        }
+      }
+    }
+  }
+  // argument, return and parameter types and speculative traps
+  mark_words((intptr_t*)mdo, mdo->size());
+}
+
+void DSUReclaim::scan_klass_if_live(Klass* k) {
+  if (!is_candidate(k)) {
+    scan_klass(k);
+  }
+}
+
+// Mark dead versions referred by the metadata of k.
+// Receiver rows of profiles are cleared instead.
+void DSUReclaim::scan_klass(Klass* k) {
+  mark_klass(k->super());
+  Array<Klass*>* secondary_supers = k->secondary_supers();
+  if (secondary_supers != NULL) {
+    for (int i = 0; i < secondary_supers->length(); i++) {
+      mark_klass(secondary_supers->at(i));
+    }
+  }
+  Klass* cache = k->secondary_super_cache();
+  if (cache != NULL && is_candidate(cache)) {
+    k->set_secondary_super_cache(NULL);
+  }
+
+  if (k->oop_is_objArray()) {
+    mark_klass(ObjArrayKlass::cast(k)->element_klass());
+    mark_klass(ObjArrayKlass::cast(k)->bottom_klass());
+    return;
+  }
+  if (!k->oop_is_instance()) {
+    return;
+  }
+
+  InstanceKlass* ik = InstanceKlass::cast(k);
+  mark_klass(ik->host_klass());
+  Array<Klass*>* interfaces = ik->transitive_interfaces();
+  if (interfaces != NULL) {
+    for (int i = 0; i < interfaces->length(); i++) {
+      mark_klass(interfaces->at(i));
+    }
+  }
+  if (ik->is_interface()) {
+    Klass* implementor = ik->implementor();
+    if (implementor != NULL && is_candidate(implementor)) {
+      // more than one implementor
+      ik->set_implementor(ik);
+    }
+  }
+  Array<Method*>* default_methods = ik->default_methods();
+  if (default_methods != NULL) {
+    for (int i = 0; i < default_methods->length(); i++) {
+      mark_metadata(default_methods->at(i));
+    }
+  }
+
+  mark_words((intptr_t*)ik->start_of_vtable(), ik->vtable_length());
+  mark_words((intptr_t*)ik->start_of_itable(), ik->itable_length());
+
+  ConstantPool* constants = ik->constants();
+  if (constants != NULL) {
+    for (int index = 1; index < constants->length(); index++) {
+      // Index 0 is unused
+      jbyte tag = constants->tag_at(index).value();
+      switch (tag) {
+      case JVM_CONSTANT_Class :
+        // live code may use a resolved entry, so it keeps the version alive
+        mark_klass(constants->resolved_klass_at(index));
+        break;
+      case JVM_CONSTANT_Long :
+      case JVM_CONSTANT_Double :
+        index++;
+        break;
+      default:
+        break;
+      }
+    }
+    ConstantPoolCache* cache = constants->cache();
+    if (cache != NULL) {
+      mark_words((intptr_t*)cache, cache->size());
+    }
+  }
+
+  Array<Method*>* methods = ik->methods();
+  if (methods != NULL) {
+    for (int i = 0; i < methods->length(); i++) {
+      MethodData* mdo = methods->at(i)->method_data();
+      if (mdo != NULL) {
+        scan_method_data(mdo);
+      }
+    }
+  }
+}
+
+bool DSUReclaim::is_reclaimable(int group) {
+  DSUReclaimGroup* g = _groups->adr_at(group);
+  if (g->_referenced) {
+    return false;
+  }
+  if (g->_klass->dsu_has_been_swapped()) {
+    return true;
+  }
+  // Reclaim a chain of redefined versions from the oldest one.
+  InstanceKlass* previous = g->_klass->previous_version();
+  if (previous == NULL) {
+    return true;
+  }
+  int p = lookup(_metadata, (address)previous);
+  return p >= 0 && _groups->at(p)._klass == previous && _groups->at(p)._reclaimable;
+}
+
+// Clear receiver rows of reclaimed versions like relink_class,
+// rows of versions that are kept get their receiver back.
+void DSUReclaim::clear_rows() {
+  for (int i = 0; i < _rows->length(); i++) {
+    DSUReclaimRow r = _rows->at(i);
+    ReceiverTypeData rtd(r._data);
+    int group = lookup(_metadata, (address)r._receiver);
+    if (_groups->at(group)._reclaimable) {
+      rtd.clear_row(r._row);
+    } else {
+      rtd.set_receiver(r._row, r._receiver);
+    }
+  }
+}
+
+bool DSUReclaim::has_jmethod_ids(InstanceKlass* ik) {
+  // A jmethodID may be cached by this version or by the next version.
+  InstanceKlass* holders[] = { ik, ik->next_version() };
+  Array<Method*>* methods = ik->methods();
+  for (int i = 0; i < methods->length(); i++) {
+    Method* method = methods->at(i);
+    size_t idnum = (size_t)method->method_idnum();
+    for (int h = 0; h < 2; h++) {
+      if (holders[h] == NULL) {
+        continue;
+      }
+      jmethodID* jmeths = holders[h]->methods_jmethod_ids_acquire();
+      if (jmeths == NULL || (size_t)jmeths[0] <= idnum) {
+        continue;
+      }
+      jmethodID id = jmeths[idnum + 1];
+      if (id != NULL && Method::resolve_jmethod_id(id) == method) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void DSUReclaim::unlink_group(DSUReclaimGroup* group) {
+  InstanceKlass* ik   = group->_klass;
+  InstanceKlass* next = ik->next_version();
+  ClassLoaderData* loader_data = ik->class_loader_data();
+
+  LoaderConstraintTable* constraints = SystemDictionary::constraints();
+  for (int index = 0; index < constraints->table_size(); index++) {
+    for (LoaderConstraintEntry* probe = constraints->bucket(index);
+        probe != NULL;
+        probe = probe->next()) {
+      if (probe->klass() == ik) {
+        probe->set_klass(next);
+      }
+    }
+  }
+
+  for (int i = 0; i < _loader_classes->length(); i++) {
+    objArrayOop classes = _loader_classes->at(i);
+    for (int j = 0; j < classes->length(); j++) {
+      if (classes->obj_at(j) == ik->java_mirror()) {
+        classes->obj_at_put(j, next->java_mirror());
+      }
+    }
+  }
+
+  ik->remove_from_sibling_list();
+  Javelus::remove_dsu_klass(ik);
+
+  // Arrays used to transform instances of the previous version,
+  // which has been reclaimed before.
+  if (ik->matched_fields() != NULL && ik->matched_fields() != next->matched_fields()) {
+    MetadataFactory::free_array<u1>(loader_data, ik->matched_fields());
+  }
+  if (ik->inplace_fields() != NULL && ik->inplace_fields() != next->inplace_fields()) {
+    MetadataFactory::free_array<u1>(loader_data, ik->inplace_fields());
+  }
+  if (ik->object_transformer_args() != NULL
+      && ik->object_transformer_args() != next->object_transformer_args()) {
+    MetadataFactory::free_array<u1>(loader_data, ik->object_transformer_args());
+  }
+  if (ik->class_transformer_args() != NULL
+      && ik->class_transformer_args() != next->class_transformer_args()) {
+    MetadataFactory::free_array<u1>(loader_data, ik->class_transformer_args());
+  }
+  ik->set_matched_fields(NULL);
+  ik->set_inplace_fields(NULL);
+  ik->set_object_transformer_args(NULL);
+  ik->set_class_transformer_args(NULL);
+
+  if (next->previous_version() == ik) {
+    next->set_previous_version(NULL);
+  }
+}
+
+void DSUReclaim::free_klass(InstanceKlass* ik) {
+  ClassLoaderData* loader_data = ik->class_loader_data();
+  SystemDictionary::delete_resolution_error(ik->constants());
+  // array classes have been moved to the next version
+  ik->set_array_klasses(NULL);
+  ik->set_previous_version(NULL);
+  ik->set_next_version(NULL);
+  ik->set_new_inplace_new_class(NULL);
+  ik->set_stale_new_class(NULL);
+  MetadataFactory::free_metadata(loader_data, ik);
+}
+
+// A clone shares all metadata and C heap structures with its source, see
+// InstanceKlass::clone_instance_klass, except its DSU info and secondary
+// supers created by initialize_supers.
+void DSUReclaim::free_clone(InstanceKlass* ik, InstanceKlass* source) {
+  ClassLoaderData* loader_data = ik->class_loader_data();
+  loader_data->remove_class(ik);
+
+  Array<Klass*>* secondary_supers = ik->secondary_supers();
+  if (secondary_supers != NULL &&
+      secondary_supers != Universe::the_empty_klass_array() &&
+      secondary_supers != source->secondary_supers() &&
+      secondary_supers != source->transitive_interfaces() &&
+      !secondary_supers->is_shared()) {
+    MetadataFactory::free_array<Klass*>(loader_data, secondary_supers);
+  }
+
+  ik->release_dsu_info();
+
+  int size = ik->size();
+  assert(InstanceKlass::_total_instanceKlass_count >= 1, "Sanity check");
+  Atomic::dec(&InstanceKlass::_total_instanceKlass_count);
+  loader_data->metaspace_non_null()->deallocate((MetaWord*)ik, size, ik->is_klass());
+}
+
+static int compare_reclaim_depth(DSUReclaimGroup** left, DSUReclaimGroup** right) {
+  int left_depth = 0;
+  for (Klass* k = (*left)->_klass->super(); k != NULL; k = k->super()) {
+    left_depth++;
+  }
+  int right_depth = 0;
+  for (Klass* k = (*right)->_klass->super(); k != NULL; k = k->super()) {
+    right_depth++;
+  }
+  return right_depth - left_depth;
+}
+
+void DSUReclaim::reclaim_at_safepoint(int* reclaimed, int* remaining) {
+  assert(SafepointSynchronize::is_at_safepoint(), "sanity");
+  *reclaimed = 0;
+  *remaining = 0;
+
+  // never reclaim in the middle of an update
+  if (Javelus::active_dsu() != NULL) {
+    *remaining = -1;
+    return;
+  }
+
+  elapsedTimer reclaim_timer;
+  reclaim_timer.start();
+
+  _groups         = new GrowableArray<DSUReclaimGroup>();
+  _metadata       = new GrowableArray<DSUReclaimEntry>();
+  _mirrors        = new GrowableArray<DSUReclaimEntry>();
+  _worklist       = new GrowableArray<int>();
+  _loader_classes = new GrowableArray<objArrayOop>();
+  _rows           = new GrowableArray<DSUReclaimRow>();
+
+  ClassLoaderDataGraph::classes_do(add_candidate);
+
+  if (_groups->length() > 0) {
+    _metadata->sort(compare_reclaim_entry);
+    _mirrors->sort(compare_reclaim_entry);
+
+    collect_loader_classes();
+    scan_roots();
+    ClassLoaderDataGraph::classes_do(scan_klass_if_live);
+    scan_heap();
+
+    // A referenced dead version keeps alive all dead versions it refers to.
+    while (_worklist->length() > 0) {
+      DSUReclaimGroup group = _groups->at(_worklist->pop());
+      scan_klass(group._klass);
+      if (group._inplace_class != NULL) {
+        scan_klass(group._inplace_class);
+      }
+      if (group._stale_class != NULL) {
+        scan_klass(group._stale_class);
+      }
+    }
+
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (int i = 0; i < _groups->length(); i++) {
+        if (!_groups->at(i)._reclaimable && is_reclaimable(i)) {
+          _groups->adr_at(i)->_reclaimable = true;
+          changed = true;
+        }
+      }
+    }
+    clear_rows();
+
+    GrowableArray<DSUReclaimGroup*>* reclaimable = new GrowableArray<DSUReclaimGroup*>();
+    for (int i = 0; i < _groups->length(); i++) {
+      DSUReclaimGroup* group = _groups->adr_at(i);
+      if (group->_reclaimable) {
+        reclaimable->append(group);
+      } else {
+        (*remaining)++;
+      }
+    }
+
+    // Unlink all reclaimable versions before freeing any of them.
+    for (int i = 0; i < reclaimable->length(); i++) {
+      DSUReclaimGroup* group = reclaimable->at(i);
+      if (DSU_TRACE_ENABLED(0x00000002)) {
+        ResourceMark rm;
+        DSU_DEBUG(("Reclaim dead class version %s, born at %d, dead at %d.",
+            group->_klass->name()->as_C_string(),
+            group->_klass->born_rn(),
+            group->_klass->dead_rn()));
+      }
+      unlink_group(group);
+    }
+    for (int i = 0; i < reclaimable->length(); i++) {
+      DSUReclaimGroup* group = reclaimable->at(i);
+      if (group->_inplace_class != NULL) {
+        free_clone(group->_inplace_class, group->_klass->next_version());
+      }
+      if (group->_stale_class != NULL) {
+        free_clone(group->_stale_class, group->_klass->next_version());
+      }
+    }
+    // Free sub classes before their super classes,
+    // deallocate_interfaces reads interfaces of the super class.
+    reclaimable->sort(compare_reclaim_depth);
+    for (int i = 0; i < reclaimable->length(); i++) {
+      free_klass(reclaimable->at(i)->_klass);
+    }
+    *reclaimed = reclaimable->length();
+  }
+
+  _groups         = NULL;
+  _metadata       = NULL;
+  _mirrors        = NULL;
+  _worklist       = NULL;
+  _loader_classes = NULL;
+  _rows           = NULL;
+
+  reclaim_timer.stop();
+  if (*reclaimed > 0 || *remaining > 0) {
+    DSU_INFO(("Reclaimed %d dead class versions, %d dead class versions are still referenced.",
+        *reclaimed, *remaining));
+    DSU_INFO(("DSU reclaim time: %3.7f (s).", reclaim_timer.seconds()));
+  }
+}
+
+// --------------------- DSUCopyPlan -------------------
+
+static int compare_copy_step(DSUCopyStep* left, DSUCopyStep* right) {
+  return left->_offset - right->_offset;
+}
+
+DSUCopyPlan::~DSUCopyPlan() {
+  if (_steps != NULL) {
+    FREE_C_HEAP_ARRAY(DSUCopyStep, _steps, mtClass);
+  }
+}
+
+DSUCopyPlan* DSUCopyPlan::build(InstanceKlass* ik) {
+  ResourceMark rm;
+  GrowableArray<DSUCopyStep>* fields = new GrowableArray<DSUCopyStep>();
+  for (InstanceKlass* k = ik; k != NULL; k = k->superklass()) {
+    int field_count = k->java_fields_count();
+    for (int i = 0; i < field_count; i++) {
+      FieldInfo* field_info = k->field(i);
+      if ((field_info->access_flags() & JVM_ACC_STATIC) != 0) {
+        // skip static field
+        continue;
+      }
+      BasicType type = FieldType::basic_type(field_info->signature(k->constants()));
+      DSUCopyStep step;
+      step._offset     = field_info->offset();
+      step._length     = type2aelembytes(type);
+      step._is_oop     = (type == T_OBJECT || type == T_ARRAY);
+      step._to_phantom = (field_info->dsu_flags() & DSU_FLAGS_MEMBER_NEEDS_MIXED_OBJECT_CHECK) != 0;
+      fields->append(step);
+    }
+  }
+  fields->sort(compare_copy_step);
+
+  // merge adjacent fields of the same kind and destination
+  GrowableArray<DSUCopyStep>* steps = new GrowableArray<DSUCopyStep>(fields->length());
+  for (int i = 0; i < fields->length(); i++) {
+    DSUCopyStep field = fields->at(i);
+    if (steps->length() > 0) {
+      DSUCopyStep* last = steps->adr_at(steps->length() - 1);
+      if (last->_is_oop == field._is_oop
+          && last->_to_phantom == field._to_phantom
+          && last->_offset + last->_length == field._offset) {
+        last->_length += field._length;
+        continue;
+      }
+    }
+    steps->append(field);
+  }
+
+  int length = steps->length();
+  DSUCopyStep* array = NULL;
+  if (length > 0) {
+    array = NEW_C_HEAP_ARRAY(DSUCopyStep, length, mtClass);
+    for (int i = 0; i < length; i++) {
+      array[i] = steps->at(i);
+    }
+  }
+  DSU_TRACE(0x00000002, ("Build copy plan of %s: %d fields in %d steps",
+      ik->name()->as_C_string(), fields->length(), length));
+  return new DSUCopyPlan(length, array);
+}
+
+DSUCopyPlan* DSUCopyPlan::plan_for(InstanceKlass* ik) {
+  DSUCopyPlan* plan = ik->copy_plan();
+  if (plan == NULL) {
+    plan = build(ik);
+    DSUCopyPlan* installed = ik->install_copy_plan(plan);
+    if (installed != plan) {
+      // another thread won the race
+      delete plan;
+      plan = installed;
+    }
+  }
+  return plan;
+}
+
+void DSUCopyPlan::copy(oop src, oop dst, oop phantom_dst) const {
+  bool dst_in_heap = Universe::heap()->is_in(dst);
+  bool phantom_in_heap = Universe::heap()->is_in(phantom_dst);
+  for (int i = 0; i < _length; i++) {
+    const DSUCopyStep* step = &_steps[i];
+    oop to = step->_to_phantom ? phantom_dst : dst;
+    if (!step->_is_oop) {
+      Copy::conjoint_memory_atomic((address)(oopDesc*)src + step->_offset,
+                                   (address)(oopDesc*)to + step->_offset,
+                                   step->_length);
+      continue;
+    }
+    bool in_heap = step->_to_phantom ? phantom_in_heap : dst_in_heap;
+    int end = step->_offset + step->_length;
+    for (int offset = step->_offset; offset < end; offset += heapOopSize) {
+      if (in_heap) {
+        to->obj_field_put(offset, src->obj_field(offset));
+      } else {
+        to->obj_field_put_raw(offset, src->obj_field(offset));
+      }
+    }
+  }
+}
+
+void DSUCopyPlan::flush(Klass* k) {
+  if (!k->oop_is_instance()) {
+    return;
+  }
+  InstanceKlass* ik = InstanceKlass::cast(k);
+  if (ik->has_dsu_info() && ik->_dsu_info->_copy_plan != NULL) {
+    delete ik->_dsu_info->_copy_plan;
+    ik->_dsu_info->_copy_plan = NULL;
+  }
+}
+
+// A plan covers the fields of all super classes,
+// so plans of sub classes are flushed as well.
+void DSUCopyPlan::flush_subclasses(Klass* k) {
+  flush(k);
+  for (Klass* sub = k->subklass(); sub != NULL; sub = sub->next_sibling()) {
+    flush_subclasses(sub);
+  }
+}
+
+void DSUCopyPlan::flush_updated(DSU* dsu) {
+  // no Java thread is copying with a plan at a safepoint
+  assert(SafepointSynchronize::is_at_safepoint(), "sanity");
+  for (DSUClassLoader* dsu_loader = dsu->first_class_loader(); dsu_loader != NULL; dsu_loader = dsu_loader->next()) {
+    for (DSUClass* dsu_class = dsu_loader->first_class(); dsu_class != NULL; dsu_class = dsu_class->next()) {
+      if (dsu_class->old_version_class() != NULL) {
+        flush_subclasses(dsu_class->old_version_class());
+      }
+      if (dsu_class->new_version_class() != NULL) {
+        flush_subclasses(dsu_class->new_version_class());
+      }
+    }
+  }
+}
+
+// --------------------- DSUTypeNarrowCache -------------------
+
+DSUTypeNarrowCache* DSUTypeNarrowCache::_first = NULL;
+
+DSUTypeNarrowCache::DSUTypeNarrowCache(Method* m) : _next(NULL), _prev(NULL) {
+  _length = m->code_size();
+  _entries = NEW_C_HEAP_ARRAY(intptr_t, _length, mtClass);
+  memset(_entries, 0, sizeof(intptr_t) * _length);
+  // wraps around, only the sum with a bcp of m is dereferenced
+  _bcp_base = (address) ((uintptr_t) _entries - (uintptr_t) m->code_base() * wordSize);
+}
+
+DSUTypeNarrowCache::~DSUTypeNarrowCache() {
+  FREE_C_HEAP_ARRAY(intptr_t, _entries, mtClass);
+}
+
+intptr_t DSUTypeNarrowCache::klass_word(oop obj) {
+  if (UseCompressedClassPointers) {
+    return (intptr_t) *obj->compressed_klass_addr();
+  }
+  return (intptr_t) obj->klass();
+}
+
+Klass* DSUTypeNarrowCache::decode_klass_word(intptr_t word) {
+  if (word == 0) {
+    return NULL;
+  }
+  if (UseCompressedClassPointers) {
+    return Klass::decode_klass_not_null((narrowKlass) word);
+  }
+  return (Klass*) word;
+}
+
+intptr_t DSUTypeNarrowCache::validated_klass_word(int bci) const {
+  assert(0 <= bci && bci < _length, "bci out of range");
+  return _entries[bci];
+}
+
+void DSUTypeNarrowCache::record(int bci, oop obj) {
+  assert(0 <= bci && bci < _length, "bci out of range");
+  // a single word, readers see either the old or the new klass
+  _entries[bci] = klass_word(obj);
+}
+
+void DSUTypeNarrowCache::clear() {
+  memset(_entries, 0, sizeof(intptr_t) * _length);
+}
+
+DSUTypeNarrowCache* DSUTypeNarrowCache::cache_for(Method* m, TRAPS) {
+  MethodCounters* mcs = m->method_counters();
+  if (mcs == NULL) {
+    mcs = Method::build_method_counters(m, CHECK_NULL);
+    if (mcs == NULL) {
+      return NULL;
+    }
+  }
+
+  DSUTypeNarrowCache* cache = mcs->type_narrow_cache();
+  if (cache != NULL) {
+    return cache;
+  }
+
+  cache = new DSUTypeNarrowCache(m);
+  if (!mcs->install_type_narrow_cache(cache)) {
+    // lost the race
+    delete cache;
+    return mcs->type_narrow_cache();
+  }
+
+  ThreadCritical tc;
+  cache->_next = _first;
+  if (_first != NULL) {
+    _first->_prev = cache;
+  }
+  _first = cache;
+  return cache;
+}
+
+void DSUTypeNarrowCache::release(DSUTypeNarrowCache* cache) {
+  {
+    ThreadCritical tc;
+    if (cache->_prev != NULL) {
+      cache->_prev->_next = cache->_next;
+    } else {
+      _first = cache->_next;
+    }
+    if (cache->_next != NULL) {
+      cache->_next->_prev = cache->_prev;
+    }
+  }
+  delete cache;
+}
+
+void DSUTypeNarrowCache::clear_all() {
+  // no interpreted frame is reading a cache at a safepoint
+  assert(SafepointSynchronize::is_at_safepoint(), "sanity");
+  for (DSUTypeNarrowCache* cache = _first; cache != NULL; cache = cache->_next) {
+    cache->clear();
+  }
+}
@@ -40,6 +40,11 @@ class DSUStreamProvider;
 class DSUPathEntryStreamProvider;
 class DSUDynamicPatchBuilder;
 class ClassPathEntry;
+class ArrayKlass;
+class DataLayout;
+class MethodData;
+class nmethod;
+class FlexibleWorkGang;
 
 class DoNothinCodeBlobClosure : public CodeBlobClosure {
 public:
@@ -159,6 +164,7 @@ typedef enum {
   DSU_REQUEST_FINISHED = 4,
   DSU_REQUEST_FAILED = 5,
   DSU_REQUEST_SYSTEM_MODIFIED = 6,
+  DSU_REQUEST_ESTIMATED = 7,
 } DSURequestState;
 
 typedef enum {
@@ -279,6 +285,23 @@ public:
   virtual void print();
 };
 
+// A vtable or itable entry of an unaffected subclass of a swapped class.
+// It is computed when the DSU is prepared and installed at the safepoint.
+class DSUDispatchEntry VALUE_OBJ_CLASS_SPEC {
+private:
+  Method** _adr;
+  Method*  _old_method;
+  Method*  _new_method;
+public:
+  DSUDispatchEntry() : _adr(NULL), _old_method(NULL), _new_method(NULL) {}
+  DSUDispatchEntry(Method** adr, Method* old_method, Method* new_method)
+  : _adr(adr), _old_method(old_method), _new_method(new_method) {}
+
+  // the entry still holds the method seen at prepare
+  bool is_unchanged() const { return *_adr == _old_method; }
+  void install()      const { *_adr = _new_method; }
+};
+
 // A DSUClass contains updating information about a class.
 // The class may be
 class DSUClass : public DSUObject {
@@ -378,6 +401,9 @@ private:
   // Both B and C are subject to stale object check
   GrowableArray<InstanceKlass*>* _type_narrowing_relevant_classes;
   GrowableArray<InstanceKlass*>* _super_classes_of_stale_class;
+
+  // dispatch table entries of unaffected subclasses replaced by swap_class
+  GrowableArray<DSUDispatchEntry>* _shadow_dispatch_entries;
 public:
   DSUClass();
   ~DSUClass();
@@ -413,6 +439,10 @@ public:
     return _resolved_reflections != NULL && _resolved_reflections->length() > 0;
   }
 
+  int resolved_reflections_count() const {
+    return _resolved_reflections == NULL ? 0 : _resolved_reflections->length();
+  }
+
   // set flags for fields;
   void compute_and_set_fields(InstanceKlass* old_version,
     InstanceKlass* new_version, TRAPS);
@@ -431,6 +461,7 @@ public:
   // set flags for methods;
   static void set_check_flags_for_methods(InstanceKlass* new_version, int min_vtable_length, TRAPS);
   static void set_check_flags_for_fields(InstanceKlass* new_version, int min_object_size, TRAPS);
+  static void set_type_narrow_check_flags(InstanceKlass* old_supertype);
   void set_restricted_methods();
 
   // changed classes and deleted classes have old versions
@@ -459,6 +490,8 @@ public:
 
   DSUError prepare(TRAPS);
   bool prepared() const { return _prepared; }
+  // undo flags and states set by prepare, used by a dry-run DSU.
+  void rollback_prepare();
 
   void update(TRAPS);
 
@@ -516,6 +549,14 @@ public:
   // after swap a class, we need to update vtable and itable of all its sub-classes.
   static void update_subklass_vtable_and_itable(InstanceKlass* old_version, TRAPS);
 
+  // compute the vtables and itables of the unaffected sub-classes out of the
+  // safepoint, so that swap_class only installs the changed entries.
+  void compute_shadow_dispatch_tables(TRAPS);
+  void collect_shadow_dispatch_entries(InstanceKlass* this_class);
+  // returns false if the sub-classes must be updated by update_subklass_vtable_and_itable
+  bool install_shadow_dispatch_tables();
+  void free_shadow_dispatch_tables();
+
   // compare and determine the updating type of these classes.
   DSUError compare_and_normalize_class(InstanceKlass* old_version,
     InstanceKlass* new_version, TRAPS);
@@ -697,6 +738,8 @@ public:
   DSUClass *last_class() const { return _last_class; }
   void add_class(DSUClass* klass);
   void remove_class(DSUClass* klass);
+  // move all classes to another class loader with the same id
+  void move_classes_to(DSUClassLoader* to);
 
   bool resolve_transformer(Symbol* transformer_name, TRAPS);
 
@@ -760,6 +803,7 @@ private:
 
   int  _system_dictionary_modification_number_at_prepare;
   int  _weak_reflection_number_at_prepare;
+  int  _class_unloading_epoch_at_prepare;
 
   int  _from_rn;
   int  _to_rn;
@@ -771,8 +815,17 @@ private:
   DSURequestState _request_state;
   const char * _dynamic_patch;
 
+  // A dry-run DSU is prepared and estimated but never installed.
+  bool _dry_run;
+
+  // All changed classes only change method bodies, see DSU::compute_body_only.
+  bool _body_only;
+
   DSU* _next;
 
+  // DSUs coalesced into this DSU, see DSU::coalesce
+  DSU* _coalesced;
+
   DSUStreamProvider* _shared_stream_provider;
 
   GrowableArray<DSUClass*>* _classes_in_order;
@@ -788,6 +841,8 @@ public:
 
   bool system_modified() const;
   bool reflection_modified() const;
+  // Unloading does not modify the system dictionary.
+  bool classes_unloaded() const;
 
   // prepare this DSU operation
   DSUError prepare(TRAPS);
@@ -795,6 +850,10 @@ public:
   // update this DSU
   DSUError update(TRAPS);
 
+  // estimate the cost of updating this DSU without installing it
+  DSUError estimate(TRAPS);
+  void rollback_prepare();
+
   void update_ordered_classes(TRAPS);
 
   DSURequestState request_state() const {
@@ -807,6 +866,15 @@ public:
   bool is_interrupted() const { return _request_state == DSU_REQUEST_INTERRUPTED; }
   bool is_init()        const { return _request_state == DSU_REQUEST_INIT; }
   bool is_system_modified() const { return _request_state == DSU_REQUEST_SYSTEM_MODIFIED; }
+  bool is_estimated()   const { return _request_state == DSU_REQUEST_ESTIMATED; }
+
+  bool is_dry_run()     const { return _dry_run; }
+  void set_dry_run(bool dry_run) { _dry_run = dry_run; }
+
+  // A body-only DSU is updated via a fast path that skips reflection
+  // updating and only invalidates nmethods depending on swapped classes.
+  bool is_body_only()   const { return _body_only; }
+  bool compute_body_only() const;
 
   // eager update: all objects are updated eagerly.
   // But no pointers are updated eagerly, i.e., we sill have to use MixObjects.
@@ -858,6 +926,7 @@ public:
   static void free_classes_to_relink();
 
   static void flush_dependent_code(TRAPS);
+  static void flush_swapped_dependent_code(TRAPS);
 
   void set_from_rn(int from_rn) {
     _from_rn = from_rn;
@@ -881,9 +950,15 @@ public:
   void add_class_loader(DSUClassLoader* class_loader);
   void add_class(DSUClass* dsu_class);
 
+  // merge a queued DSU into this one, so that both are updated at once
+  bool can_coalesce(DSU* other);
+  bool coalesce(DSU* other);
+
   // query DSUClass
   DSUClass* find_class_by_name(Symbol* name);
   DSUClass* find_class_by_name_and_loader(Symbol* name, Handle loader);
+  // the method replacing m if its holder will be swapped, or NULL
+  Method* find_swapped_method(Method* m) const;
 
   // id is a global Symbol* NOT is a java.lang.String object
   DSUClassLoader* find_class_loader_by_id(Symbol* id);
@@ -1022,6 +1097,8 @@ private:
   static Dictionary*            _dsu_dictionary;
   //static PlaceholderTable*      _dsu_placeholder;
   static DSUThread*             _dsu_thread;
+  // transforms stale instances in the background, see DSUBackgroundTransform
+  static DSUTransformerThread*  _transformer_thread;
 
   static Method*                _implicit_update_method;
 
@@ -1072,12 +1149,16 @@ public:
 
   static Klass* find_klass_in_system_dictionary(Symbol* name, ClassLoaderData* data);
   static void add_dsu_klass(InstanceKlass* k, TRAPS);
+  static void remove_dsu_klass(InstanceKlass* k);
   static void add_dsu_klass_place_holder(Handle loader, Symbol* class_name, TRAPS);
 
   static DSUThread* get_dsu_thread() { return _dsu_thread; }
 
   static DSUThread* make_dsu_thread(const char * name);
 
+  static DSUTransformerThread* get_transformer_thread() { return _transformer_thread; }
+  static DSUTransformerThread* make_transformer_thread(const char * name);
+
   static void repatch_method(Method* method,bool print_replace, TRAPS);
 
 
@@ -1087,6 +1168,10 @@ public:
   static oopDesc* merge_mixed_object(oopDesc* old_obj);
   static oopDesc* merge_mixed_object(oopDesc* old_obj, oopDesc* new_obj);
   static void dsu_thread_loop();
+  static void transformer_thread_loop();
+  // transform stale instances of classes dead at rn, returns false if
+  // another DSU is installed in the meantime.
+  static bool transform_stale_instances(DSUTransformerThread* thread, int rn);
 
 
   static void parse_old_field_annotation(InstanceKlass* the_class,
@@ -1095,6 +1180,9 @@ public:
   static void oops_do(OopClosure* f);
 
   static void transform_object(Handle h, TRAPS);
+  // check obj is still an instance of target_class after type narrowing
+  static void type_narrow_check(Handle obj, Klass* target_class, TRAPS);
+  static oop  allocate_phantom_object(InstanceKlass* phantom_klass, TRAPS);
   //the common stuff
   static bool transform_object_common(Handle recv, TRAPS);
   static bool transform_object_common_no_lock(Handle recv, TRAPS);
@@ -1102,7 +1190,7 @@ public:
   static void link_mixed_object(Handle inplace_object, Handle phantom_object, TRAPS);
   static void relink_mixed_object(Handle inplace_object, Handle old_phantom_object, Handle new_phantom_object, TRAPS);
   static void unlink_mixed_object(Handle inplace_object, Handle old_phantim_object, TRAPS);
-  static void link_mixed_object_slow(Handle inplace_object, Handle phantom_object, TRAPS);
+  static markOop lock_word_for(markOop mark, oop new_holder);
   // run transformer objects 
   static void run_transformer(Handle inplace_object, Handle old_phantom_object, Handle new_phantom_object,
                  InstanceKlass* old_phantom_klass, InstanceKlass* new_inplace_klass, InstanceKlass* new_phantom_klass, TRAPS);
@@ -1113,6 +1201,7 @@ public:
   static DSU* get_DSU(int from_rn);
 
   static void wakeup_DSU_thread();
+  static void wakeup_transformer_thread(int rn);
   static void waitRequest();
   static void waitRequest(long time);
   static void notifyRequest();
@@ -1128,10 +1217,16 @@ public:
   static bool is_class_dead_at(InstanceKlass* the_class, int rn) ;
   static bool is_class_dead(InstanceKlass* the_class, int rn) ;
 
+  // the stacks of application threads are walked in parallel by idle GC
+  // workers, see UseParallelDSUStackWalk.
+  static FlexibleWorkGang* safepoint_workers();
   static bool check_application_threads();
+  static bool check_application_thread(JavaThread* thr);
+  // count threads that have restricted methods on stack without installing barriers.
+  static int  count_blocked_application_threads();
   static void repair_application_threads();
+  static void repair_application_thread(JavaThread* thr);
 
-  static void install_return_barrier_all_threads();
   static void install_return_barrier_single_thread(JavaThread *thread, intptr_t * barrier);
 
   static bool check_single_thread(JavaThread * thread);
@@ -1167,6 +1262,272 @@ public:
   static void collect_dead_instances_at_safepoint(int dead_time, GrowableArray<jobject>* result, TRAPS);
 };
 
+// A bounded buffer of stale instances for the DSU transformer thread.
+// While it is enabled, collectors enqueue the stale instances they mark
+// or evacuate, so the transformer thread never walks the heap. Entries
+// are weak: they are processed together with the JNI weak global
+// handles, i.e., updated when objects move and cleared when they die.
+// Collectors only enqueue at safepoints and the transformer thread only
+// drains in VM state, so the two never run concurrently.
+class DSUStaleInstances : public AllStatic {
+private:
+  static oop*          _buffer;
+  static int           _capacity;
+  // may exceed _capacity at a safepoint, extra objects are dropped
+  static volatile jint _length;
+  // number of stale instances found so far, including dropped ones
+  static volatile jint _found;
+  static volatile bool _enabled;
+public:
+  static void initialize();
+
+  static bool is_enabled() { return _enabled; }
+  static void enable();
+  static void disable();
+
+  // Called by collectors with the from-space address of a copied object
+  // or the address of a marked object.
+  static void enqueue(oop obj);
+
+  static jint found() { return _found; }
+  // Move up to max entries into handles of the current thread.
+  static int  drain(GrowableArray<Handle>* result, int max);
+
+  static void weak_oops_do(BoolObjectClosure* is_alive, OopClosure* f);
+};
+
+// --------------------- DSUPlan -------------------
+
+// A prepared comparison between an old and a new version of a class.
+// The entry is keyed by the fingerprints of both versions.
+class DSUPlanEntry : public CHeapObj<mtInternal> {
+private:
+  Symbol*  _class_name;
+  julong   _old_fingerprint;
+  julong   _new_fingerprint;
+  DSUClassUpdatingType _updating_type;
+  // names and signatures of methods whose bytecodes are changed, in pairs
+  GrowableArray<Symbol*>* _changed_methods;
+  DSUPlanEntry* _next;
+public:
+  DSUPlanEntry(Symbol* class_name, julong old_fingerprint, julong new_fingerprint, DSUClassUpdatingType updating_type);
+  ~DSUPlanEntry();
+
+  Symbol* class_name()      const { return _class_name; }
+  julong  old_fingerprint() const { return _old_fingerprint; }
+  julong  new_fingerprint() const { return _new_fingerprint; }
+  DSUClassUpdatingType updating_type() const { return _updating_type; }
+  void set_updating_type(DSUClassUpdatingType updating_type) { _updating_type = updating_type; }
+
+  DSUPlanEntry* next() const { return _next; }
+  DSUPlanEntry** next_addr() { return &_next; }
+  void set_next(DSUPlanEntry* next) { _next = next; }
+
+  void add_changed_method(Symbol* name, Symbol* signature);
+  bool is_changed_method(Symbol* name, Symbol* signature) const;
+  int  changed_methods_count() const { return _changed_methods->length() / 2; }
+  Symbol* changed_method_name_at(int i) const { return _changed_methods->at(2 * i); }
+  Symbol* changed_method_signature_at(int i) const { return _changed_methods->at(2 * i + 1); }
+};
+
+// The DSU plan caches the results of comparing old and new versions
+// across VMs applying the same dynamic patch. It is loaded from and
+// saved to DSUPlanFile. Results that depend on the layout of metadata
+// in this VM, e.g., field offsets and affected types, are recomputed.
+class DSUPlan : public AllStatic {
+private:
+  static DSUPlanEntry* _entries;
+  static bool _loaded;
+  static bool _dirty;
+
+  static void parse_line(char* line, DSUPlanEntry* &current, TRAPS);
+public:
+  static bool is_enabled() { return DSUPlanFile != NULL; }
+
+  // A fingerprint of a loaded class, which only depends on its class file.
+  // It is computed on first use and kept in the DSU info of the class;
+  // 0 if the class file cannot be reconstituted.
+  static julong fingerprint(InstanceKlass* ik, TRAPS);
+
+  static void load(TRAPS);
+  static void save();
+
+  static DSUPlanEntry* lookup(Symbol* class_name, julong old_fingerprint, julong new_fingerprint);
+  static DSUPlanEntry* record(Symbol* class_name, julong old_fingerprint, julong new_fingerprint,
+                              DSUClassUpdatingType updating_type);
+  // remove a stale entry
+  static void discard(DSUPlanEntry* entry);
+};
+
+// --------------------- DSUReclaim -------------------
+
+// A dead class version together with the synthetic classes created for it.
+// _klass is either a redefined old version or the shell left by swapping
+// a class; _inplace_class and _stale_class are clones of its next version.
+class DSUReclaimGroup VALUE_OBJ_CLASS_SPEC {
+public:
+  InstanceKlass* _klass;
+  InstanceKlass* _inplace_class;
+  InstanceKlass* _stale_class;
+  bool           _referenced;
+  bool           _reclaimable;
+};
+
+// Maps a klass, a method or a mirror to the group it belongs to.
+class DSUReclaimEntry VALUE_OBJ_CLASS_SPEC {
+public:
+  address _key;
+  int     _group;
+};
+
+// A receiver row of a profile that refers to a candidate. The row is
+// hidden while marking and cleared only if its version is reclaimed.
+class DSUReclaimRow VALUE_OBJ_CLASS_SPEC {
+public:
+  DataLayout* _data;
+  uint        _row;
+  Klass*      _receiver;
+};
+
+// Reclaims metaspace of dead class versions once an update has converged,
+// i.e., no instance, frame, nmethod, compile task or reflection object
+// refers to them any more. The liveness check and the deallocation are
+// done at a safepoint in VM_DSUReclaim, which the DSU thread schedules
+// when no DSU request arrives within interval() milliseconds.
+class DSUReclaim : public AllStatic {
+private:
+  static volatile bool _has_dead_versions;
+  static jlong         _interval;
+
+  // valid only during reclaim_at_safepoint
+  static GrowableArray<DSUReclaimGroup>* _groups;
+  static GrowableArray<DSUReclaimEntry>* _metadata;
+  static GrowableArray<DSUReclaimEntry>* _mirrors;
+  static GrowableArray<int>*             _worklist;
+  static GrowableArray<objArrayOop>*     _loader_classes;
+  static GrowableArray<DSUReclaimRow>*   _rows;
+
+  static void add_candidate(Klass* k);
+  static void add_entry(GrowableArray<DSUReclaimEntry>* entries, address key, int group);
+  static int  lookup(GrowableArray<DSUReclaimEntry>* entries, address key);
+
+  static void mark_group(int group);
+  static void mark_klass(Klass* k);
+  static void mark_words(intptr_t* start, int length);
+
+  static void collect_loader_classes();
+  static void scan_roots();
+  static void scan_heap();
+  static void scan_klass(Klass* k);
+  static void scan_klass_if_live(Klass* k);
+  static void scan_method_data(MethodData* mdo);
+  static void scan_nmethod(nmethod* nm);
+
+  static bool is_reclaimable(int group);
+  static void clear_rows();
+  static void unlink_group(DSUReclaimGroup* group);
+  static bool has_jmethod_ids(InstanceKlass* ik);
+  static void free_klass(InstanceKlass* ik);
+  static void free_clone(InstanceKlass* ik, InstanceKlass* source);
+
+public:
+  static bool is_candidate(Metadata* md)   { return lookup(_metadata, (address)md) >= 0; }
+  static bool is_candidate_mirror(oop obj) { return lookup(_mirrors, (address)obj) >= 0; }
+  static bool is_loader_classes(oop obj);
+  static void mark_metadata(Metadata* md);
+  static void mark_mirror(oop obj);
+  static void fix_component_mirror(ArrayKlass* ak);
+
+  static bool  has_dead_versions() { return _has_dead_versions; }
+  static jlong interval()          { return _interval; }
+  // called at the safepoint of a DSU that swaps or redefines a class
+  static void record_dead_version();
+
+  // Called by the DSU thread after no request arrived within interval().
+  static void reclaim_dead_versions(TRAPS);
+  static void reclaim_at_safepoint(int* reclaimed, int* remaining);
+};
+
+// --------------------- DSUCopyPlan -------------------
+
+// A copy step covers either a run of contiguous primitive fields or a run
+// of contiguous oop fields of the same destination.
+class DSUCopyStep VALUE_OBJ_CLASS_SPEC {
+public:
+  int  _offset;
+  int  _length;      // in bytes
+  bool _is_oop;
+  bool _to_phantom;  // fields needing the mixed object check live in the phantom object
+};
+
+// A cached plan to copy all instance fields declared by a class and its
+// super classes, see ReplaceObject. Primitive runs are copied as raw
+// memory, only oop fields go through the barriers.
+// Plans are cached in the DSUKlassInfo of the class and flushed when an
+// update of the class or one of its super classes is installed, as the
+// update may change the mixed object checks.
+class DSUCopyPlan : public CHeapObj<mtClass> {
+private:
+  int          _length;
+  DSUCopyStep* _steps;
+
+  DSUCopyPlan(int length, DSUCopyStep* steps) : _length(length), _steps(steps) {}
+
+  static DSUCopyPlan* build(InstanceKlass* ik);
+  static void flush(Klass* k);
+  static void flush_subclasses(Klass* k);
+
+public:
+  ~DSUCopyPlan();
+
+  int length() const { return _length; }
+
+  // copy fields of src into dst and, for mixed objects, into phantom_dst
+  void copy(oop src, oop dst, oop phantom_dst) const;
+
+  static DSUCopyPlan* plan_for(InstanceKlass* ik);
+  // called when an update is installed, flushes the plans of the
+  // classes updated by dsu and of their sub classes
+  static void flush_updated(DSU* dsu);
+};
+
+// Klasses validated by the type-narrowing check at each bci of a method.
+// An entry holds the klass word of an object header, narrow or not, so the
+// interpreter compares it with the header of the checked object directly.
+// The caches are hung off MethodCounters and cleared when an update is
+// installed or classes are unloaded.
+class DSUTypeNarrowCache : public CHeapObj<mtClass> {
+private:
+  intptr_t*           _entries;
+  // _entries biased by the code base, indexed by a bcp in the interpreter
+  address             _bcp_base;
+  int                 _length;
+  DSUTypeNarrowCache* _next;
+  DSUTypeNarrowCache* _prev;
+
+  static DSUTypeNarrowCache* _first;
+
+  DSUTypeNarrowCache(Method* m);
+
+public:
+  ~DSUTypeNarrowCache();
+
+  static ByteSize bcp_base_offset() { return byte_offset_of(DSUTypeNarrowCache, _bcp_base); }
+
+  intptr_t validated_klass_word(int bci) const;
+  void record(int bci, oop obj);
+  void clear();
+
+  static intptr_t klass_word(oop obj);
+  static Klass*   decode_klass_word(intptr_t word);
+
+  // returns the cache of m, creating it if needed
+  static DSUTypeNarrowCache* cache_for(Method* m, TRAPS);
+  static void release(DSUTypeNarrowCache* cache);
+  // called when an update is installed or classes are unloaded
+  static void clear_all();
+};
+
 /////////////////////////////////////////////////////
 // Code copied from jvmtiRedefineClassesTrace.hpp
 ////////////////////////////////////////////////////
@@ -30,6 +30,7 @@
 #include "memory/heapInspection.hpp"
 #include "classfile/javaClasses.hpp"
 #include "code/codeCache.hpp"
+#include "runtime/biasedLocking.hpp"
 #include "runtime/deoptimization.hpp"
 #include "runtime/relocator.hpp"
 #include "runtime/javaCalls.hpp"
@@ -38,8 +39,80 @@
 
 
 
-DSUTask::DSUTask(VM_DSUOperation *op)
-: _op(op), _next(NULL) {}
+DSUTask::DSUTask(VM_DSUOperation *op, bool is_blocking)
+: _op(op), _next(NULL),
+  _is_blocking(is_blocking),
+  _is_complete(false),
+  _result(DSU_REQUEST_INIT),
+  _queued_time(0),
+  _started_time(0),
+  _completed_time(0),
+  _first_coalesced(NULL) {}
+
+double DSUTask::queued_seconds() const {
+  return (double)(_started_time - _queued_time) / NANOSECS_PER_SEC;
+}
+
+double DSUTask::process_seconds() const {
+  return (double)(_completed_time - _started_time) / NANOSECS_PER_SEC;
+}
+
+bool DSUTask::coalesce(DSUTask* task) {
+  assert(!task->is_complete(), "sanity check");
+  if (!operation()->dsu()->coalesce(task->operation()->dsu())) {
+    return false;
+  }
+  task->_started_time = os::javaTimeNanos();
+  task->set_next(_first_coalesced);
+  _first_coalesced = task;
+  return true;
+}
+
+void DSUTask::complete(DSUTask* task, DSURequestState result) {
+  jlong now = os::javaTimeNanos();
+  // complete the task together with all tasks coalesced into it
+  task->set_next(task->_first_coalesced);
+  task->_first_coalesced = NULL;
+
+  DSUTask* to_free = NULL;
+  {
+    MutexLocker locker(DSURequest_lock);
+    DSUTask* t = task;
+    while (t != NULL) {
+      DSUTask* next = t->next();
+      t->_result = result;
+      t->_completed_time = now;
+      DSU_INFO(("DSU request queue time: %3.7f (s).", t->queued_seconds()));
+      DSU_INFO(("DSU request process time: %3.7f (s).", t->process_seconds()));
+      if (t->is_blocking()) {
+        // the waiting thread frees t once we release the lock
+        t->set_next(NULL);
+        t->_is_complete = true;
+      } else {
+        t->set_next(to_free);
+        to_free = t;
+      }
+      t = next;
+    }
+    // Other threads waiting on DSURequest_lock, e.g., at return barriers,
+    // are woken up as well.
+    DSURequest_lock->notify_all();
+  }
+
+  while (to_free != NULL) {
+    DSUTask* next = to_free->next();
+    delete to_free;
+    to_free = next;
+  }
+}
+
+void DSUTask::wait_for_completion() {
+  assert(is_blocking(), "only blocking tasks can be waited for");
+  MutexLocker locker(DSURequest_lock);
+  while (!is_complete()) {
+    DSURequest_lock->wait();
+  }
+}
 
 VM_DSUOperation::VM_DSUOperation(DSU *dsu)
 : _dsu(dsu) {}
@@ -150,11 +223,19 @@ DSUError VM_DSUOperation::update_dsu(TRAPS) {
   return dsu()->update(THREAD);
 }
 
+DSUError VM_DSUOperation::estimate_dsu(TRAPS) {
+  return dsu()->estimate(THREAD);
+}
+
 // Perform the actual update.
 void VM_DSUOperation::doit() {
   Thread *thread = Thread::current();
 
-  _res = update_dsu(thread);
+  if (dsu()->is_dry_run()) {
+    _res = estimate_dsu(thread);
+  } else {
+    _res = update_dsu(thread);
+  }
 
   if (thread->has_pending_exception()) {
     oop exception = thread->pending_exception();
@@ -219,7 +300,11 @@ void VM_RelinkMixedObject::doit() {
   oop new_phantom_object = (*_new_phantom_object)();
 
   // set real mark to new mix new object
-  markOop real_mark = old_phantom_object->mark();
+  markOop real_mark = Javelus::lock_word_for(old_phantom_object->mark(), new_phantom_object);
+  if (real_mark == NULL) {
+    BiasedLocking::revoke_at_safepoint(*_inplace_object);
+    real_mark = old_phantom_object->mark();
+  }
   new_phantom_object->set_mark(real_mark);
 
   // link new mix new object to mix old object
@@ -239,6 +324,15 @@ void VM_UnlinkMixedObject::doit() {
   oop inplace_object     = (*_inplace_object)();
   oop old_phantom_object = (oop)inplace_object->mark()->decode_phantom_object_pointer();
 
-  markOop real_mark = old_phantom_object->mark();
+  markOop real_mark = Javelus::lock_word_for(old_phantom_object->mark(), inplace_object);
+  if (real_mark == NULL) {
+    BiasedLocking::revoke_at_safepoint(*_inplace_object);
+    real_mark = old_phantom_object->mark();
+  }
   inplace_object->set_mark(real_mark);
 }
+
+void VM_DSUReclaim::doit() {
+  ResourceMark rm;
+  DSUReclaim::reclaim_at_safepoint(&_reclaimed, &_remaining);
+}
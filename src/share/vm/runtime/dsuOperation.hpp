@@ -29,17 +29,52 @@
 
 class VM_DSUOperation;
 
+// A DSUTask is the completion handle of a DSU request.
+// A blocking task is freed by the requesting thread after
+// wait_for_completion returns, others are freed by the DSU thread.
 class DSUTask : public CHeapObj<mtInternal> {
 
 private:
   VM_DSUOperation * _op;
   DSUTask* _next;
+
+  bool            _is_blocking;
+  volatile bool   _is_complete;
+  DSURequestState _result;
+
+  // os::javaTimeNanos() when the task is queued, started and completed
+  jlong           _queued_time;
+  jlong           _started_time;
+  jlong           _completed_time;
+
+  // queued tasks coalesced into this task, see DSUTask::coalesce
+  DSUTask*        _first_coalesced;
 public:
-  DSUTask(VM_DSUOperation * op);
+  DSUTask(VM_DSUOperation * op, bool is_blocking = false);
 
   DSUTask* next() const            { return _next; }
   void     set_next(DSUTask* next) { _next = next; }
   VM_DSUOperation * operation()    {return _op; }
+
+  bool            is_blocking() const { return _is_blocking; }
+  bool            is_complete() const { return _is_complete; }
+  DSURequestState result()      const { return _result; }
+
+  double queued_seconds()  const;
+  double process_seconds() const;
+
+  void mark_queued()  { _queued_time = os::javaTimeNanos(); }
+  void mark_started() { _started_time = os::javaTimeNanos(); }
+
+  // Merge a queued compatible task into this one. The coalesced task
+  // completes with the result of this task.
+  bool coalesce(DSUTask* task);
+
+  // Called by the DSU thread. A non-blocking task is freed here.
+  static void complete(DSUTask* task, DSURequestState result);
+
+  // Called by the requesting thread of a blocking task.
+  void wait_for_completion();
 };
 
 class VM_DSUOperation : public VM_Operation {
@@ -69,6 +104,7 @@ public:
   bool is_interrupted()     const { return _dsu->is_interrupted(); }
   bool is_init()            const { return _dsu->is_init(); }
   bool is_system_modified() const { return _dsu->is_system_modified(); }
+  bool is_estimated()       const { return _dsu->is_estimated(); }
   void set_request_state(DSURequestState state){
     _dsu->set_request_state(state);
   }
@@ -79,6 +115,8 @@ public:
   DSUError prepare_dsu(TRAPS);
   // at VM safe points, update this dsu
   DSUError update_dsu(TRAPS);
+  // at VM safe points, estimate the cost of a dry-run dsu
+  DSUError estimate_dsu(TRAPS);
 };
 
 class VM_RelinkMixedObject : public VM_Operation {
@@ -104,4 +142,20 @@ public:
   virtual bool doit_prologue();
   virtual void doit();
 };
+
+// Reclaim metaspace of dead class versions that are no longer referenced.
+class VM_DSUReclaim : public VM_Operation {
+protected:
+  int _reclaimed;
+  int _remaining;
+
+public:
+  VM_DSUReclaim() : _reclaimed(0), _remaining(0) {}
+
+  virtual VMOp_Type type() const { return VMOp_DSUReclaim; }
+  virtual void doit();
+
+  int reclaimed() const { return _reclaimed; }
+  int remaining() const { return _remaining; }
+};
 #endif
@@ -923,6 +923,15 @@ class CommandLineFlags {
           "directory) of the dump file (defaults to java_pid<pid>.hprof "   \
           "in the working directory)")                                      \
                                                                             \
+  manageable(uintx, HeapDumpGzipLevel, 0,                                   \
+          "When non-zero, heap dumps written by HeapDumpBeforeFullGC, "     \
+          "HeapDumpAfterFullGC and HeapDumpOnOutOfMemoryError are gzip "    \
+          "compressed at this level (1 to 9)")                              \
+                                                                            \
+  product(bool, ParallelHeapDump, true,                                     \
+          "Dump the objects of the heap on the GC worker threads when "     \
+          "the heap supports it")                                           \
+                                                                            \
   develop(uintx, SegmentedHeapDumpThreshold, 2*G,                           \
           "Generate a segmented heap dump (JAVA PROFILE 1.0.2 format) "     \
           "when the heap usage is larger than this")                        \
@@ -1139,6 +1148,17 @@ class CommandLineFlags {
                                                                             \
   product(bool, MonitorInUseLists, false, "Track Monitors for Deflation")   \
                                                                             \
+  product(bool, AsyncDeflateIdleMonitors, false,                            \
+          "Deflate idle monitors on the service thread instead of at "      \
+          "safepoints; ignored with MonitorInUseLists or MonitorBound")     \
+                                                                            \
+  product(intx, AsyncDeflationInterval, 250,                                \
+          "Minimum time in ms between concurrent monitor deflation passes") \
+                                                                            \
+  product(uintx, MonitorUsedDeflationThreshold, 90,                         \
+          "Percentage of used monitors above which the service thread "     \
+          "deflates idle monitors; 0 deflates at every interval")           \
+                                                                            \
   product(intx, SyncFlags, 0, "(Unsafe, Unstable) Experimental Sync flags") \
                                                                             \
   product(intx, SyncVerbose, 0, "(Unstable)")                               \
@@ -2389,6 +2409,10 @@ class CommandLineFlags {
   manageable(bool, PrintClassHistogram, false,                              \
           "Print a histogram of class instances")                           \
                                                                             \
+  product(bool, ParallelHeapInspection, true,                               \
+          "Count the instances of a class histogram in parallel on "        \
+          "the GC worker threads, if the collector supports it")            \
+                                                                            \
   develop(bool, TraceWorkGang, false,                                       \
           "Trace activities of work gangs")                                 \
                                                                             \
@@ -3340,6 +3364,18 @@ class CommandLineFlags {
   product_pd(uintx, ReservedCodeCacheSize,                                  \
           "Reserved code cache size (in bytes) - maximum code cache size")  \
                                                                             \
+  product(bool, SegmentedCodeCache, false,                                  \
+          "Split the code cache into code heaps for non-nmethods, "         \
+          "profiled nmethods and non-profiled nmethods")                    \
+                                                                            \
+  product(uintx, NonNMethodCodeHeapSize, 0,                                 \
+          "Size of the non-nmethod code heap with SegmentedCodeCache "      \
+          "(in bytes), 0 to size it from ReservedCodeCacheSize")            \
+                                                                            \
+  product(uintx, ProfiledCodeHeapSize, 0,                                   \
+          "Size of the profiled nmethod code heap with SegmentedCodeCache " \
+          "(in bytes), 0 for half of the space left for nmethods")          \
+                                                                            \
   product(uintx, CodeCacheMinimumFreeSpace, 500*K,                          \
           "When less than X space left, we stop compiling")                 \
                                                                             \
@@ -3396,6 +3432,13 @@ class CommandLineFlags {
   product(ccstrlist, CompileCommand, "",                                    \
           "Prepend to .hotspot_compiler; e.g. log,java/lang/String.<init>") \
                                                                             \
+  product(ccstr, CompileCacheFile, NULL,                                    \
+          "Compile the methods listed in this file early, and save the "    \
+          "methods compiled by this VM to it at exit")                      \
+                                                                            \
+  diagnostic(bool, PrintCompileCache, false,                                \
+          "Print the methods compiled from the CompileCacheFile")           \
+                                                                            \
   develop(bool, ReplayCompiles, false,                                      \
           "Enable replay of compilations from ReplayDataFile")              \
                                                                             \
@@ -3879,6 +3922,10 @@ class CommandLineFlags {
   experimental(uintx, SymbolTableSize, defaultSymbolTableSize,              \
           "Number of buckets in the JVM internal Symbol table")             \
                                                                             \
+  product(uintx, TableGrowthLoadFactor, 4,                                  \
+          "Grow the Symbol and interned String tables concurrently once "   \
+          "they average more entries per bucket than this; 0 disables")     \
+                                                                            \
   product(bool, UseStringDeduplication, false,                              \
           "Use string deduplication")                                       \
                                                                             \
@@ -3972,6 +4019,42 @@ class CommandLineFlags {
            "when it cannot been defined eagerly" )                          \
   product(bool, EagerWakeupDSU, false, "wakeup DSU eagerly")                \
   product(intx, EagerWakeupDSUSleepTime, 1000, "time for wait DSU")         \
+  product(bool, DSUDryRun, false, "prepare DSU requests and report the "    \
+           "estimated update cost without installing them")                 \
+  product(bool, UsePhantomAllocBuffer, true, "allocate phantom objects "    \
+           "of mixed objects in a thread local buffer")                     \
+  product(uintx, PhantomAllocBufferSize, 64*K, "size in bytes of the "      \
+           "thread local buffer for phantom objects")                       \
+  product(bool, UseDSUBodyOnlyFastPath, true, "only invalidate "            \
+           "dependent nmethods when a DSU only changes method bodies")      \
+  product(ccstr, DSUPlanFile, NULL, "file caching prepared DSU results "    \
+           "shared by VMs applying the same dynamic patch")                 \
+  product(bool, DSUReclaimDeadVersions, false, "reclaim metaspace of "      \
+           "dead class versions when the DSU thread is idle")               \
+  product(intx, DSUReclaimInterval, 1000, "milliseconds the DSU "           \
+           "thread waits for requests before reclaiming dead versions")     \
+  product(bool, DSUCoalesceRequests, false, "merge queued DSU requests "    \
+           "updating disjoint classes into a single update")                \
+  product(bool, DSUBackgroundTransform, false, "transform stale "           \
+           "instances of lazily updated classes in a low-priority "         \
+           "background thread")                                             \
+  product(bool, UseParallelDSUStackWalk, true, "check and repair the "      \
+           "stacks of application threads with idle GC worker threads "     \
+           "at the DSU safepoint")                                          \
+  product(uintx, ParallelDSUStackWalkThreshold, 32, "minimum number of "    \
+           "application threads to walk their stacks in parallel")          \
+  product(bool, UseDSUCheckFreeInterpreter, true, "jump over DSU "          \
+           "checks in interpreted code until the first DSU is installed")   \
+  product(bool, UseDSUTypeNarrowCache, true, "cache the classes "           \
+           "validated by type-narrowing checks at each bytecode and "       \
+           "check them inline in interpreted and compiled code")            \
+  product(bool, DSUStableFieldLayout, true, "lay out the instance "         \
+           "fields of a new class version at the offsets they had in "      \
+           "the old version")                                               \
+  product(bool, UseDSUShadowDispatchTables, true, "compute the "            \
+           "vtables and itables of unaffected sub-classes of swapped "      \
+           "classes when a DSU is prepared and only install them at "       \
+           "the DSU safepoint")                                             \
 
 
 
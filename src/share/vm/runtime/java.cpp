@@ -28,6 +28,7 @@
 #include "classfile/systemDictionary.hpp"
 #include "code/codeCache.hpp"
 #include "compiler/compileBroker.hpp"
+#include "compiler/compileCache.hpp"
 #include "compiler/compilerOracle.hpp"
 #include "interpreter/bytecodeHistogram.hpp"
 #include "memory/genCollectedHeap.hpp"
@@ -83,6 +84,7 @@
 #include "gc_implementation/concurrentMarkSweep/concurrentMarkSweepThread.hpp"
 #include "gc_implementation/parallelScavenge/psScavenge.hpp"
 #include "gc_implementation/parallelScavenge/psScavenge.inline.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #endif // INCLUDE_ALL_GCS
 #ifdef COMPILER1
 #include "c1/c1_Compiler.hpp"
@@ -486,6 +488,11 @@ void before_exit(JavaThread * thread) {
     os::infinite_sleep();
   }
 
+  // Save the compiled methods for the next VM
+  if (CompileCache::is_enabled()) {
+    CompileCache::save(thread);
+  }
+
   // Terminate watcher thread - must before disenrolling any periodic task
   if (PeriodicTask::num_tasks() > 0)
     WatcherThread::stop();
@@ -502,6 +509,11 @@ void before_exit(JavaThread * thread) {
 
   // Stop concurrent GC threads
   Universe::heap()->stop();
+#if INCLUDE_ALL_GCS
+  if (StringDedup::is_enabled()) {
+    StringDedup::stop();
+  }
+#endif // INCLUDE_ALL_GCS
 
   // Print GC/heap related information.
   if (PrintGCDetails) {
@@ -26,6 +26,7 @@
 #include "classfile/systemDictionary.hpp"
 #include "oops/oop.inline.hpp"
 #include "prims/jvmtiExport.hpp"
+#include "runtime/dsu.hpp"
 #include "runtime/jniHandles.hpp"
 #include "runtime/mutexLocker.hpp"
 #include "runtime/thread.inline.hpp"
@@ -150,6 +151,8 @@ void JNIHandles::oops_do(OopClosure* f) {
 void JNIHandles::weak_oops_do(BoolObjectClosure* is_alive, OopClosure* f) {
   _weak_global_handles->weak_oops_do(is_alive, f);
   _weak_reflection_handles->weak_oops_do(is_alive, f);
+  // Stale instances found for the DSU transformer thread are weak too.
+  DSUStaleInstances::weak_oops_do(is_alive, f);
 }
 
 
@@ -90,6 +90,7 @@ Monitor* CompileThread_lock           = NULL;
 Monitor* DSUThread_lock               = NULL;
 Monitor* DSURequest_lock              = NULL;
 Monitor* DSUEagerUpdate_lock          = NULL;
+Monitor* DSUTransformer_lock          = NULL;
 Mutex*   DSUReflection_lock           = NULL;
 Mutex*   CompileTaskAlloc_lock        = NULL;
 Mutex*   CompileStatistics_lock       = NULL;
@@ -204,7 +205,8 @@ void mutex_init() {
     def(RootRegionScan_lock        , Monitor, leaf     ,   true );
     def(MMUTracker_lock            , Mutex  , leaf     ,   true );
     def(EvacFailureStack_lock      , Mutex  , nonleaf  ,   true );
-
+  }
+  if (UseStringDeduplication) {
     def(StringDedupQueue_lock      , Monitor, leaf,        true );
     def(StringDedupTable_lock      , Mutex  , leaf,        true );
   }
@@ -278,6 +280,7 @@ void mutex_init() {
   def(DSUThread_lock               , Monitor, nonleaf+5,   false);
   def(DSURequest_lock              , Monitor, nonleaf+5,   true );
   def(DSUEagerUpdate_lock          , Monitor, nonleaf+5,   false);
+  def(DSUTransformer_lock          , Monitor, nonleaf+5,   false);
   def(DSUReflection_lock           , Mutex  , nonleaf+5,   false); // locks weak reflection
   def(MethodData_lock              , Mutex  , nonleaf+3,   false);
 
@@ -109,6 +109,7 @@ extern Monitor* CompileThread_lock;              // a lock held by compile threa
 extern Monitor* DSUThread_lock;                  // a lock held by the DSU thread for threaded activities
 extern Monitor* DSURequest_lock;                 // a lock held by the DSU thread for requests manipulation
 extern Monitor* DSUEagerUpdate_lock;             // a lock held by eager updates.
+extern Monitor* DSUTransformer_lock;             // a lock held by the DSU transformer thread for requests
 extern Mutex*   DSUReflection_lock;              // a lock held by weak reflection.
 extern Mutex*   CompileTaskAlloc_lock;           // a lock held when CompileTasks are allocated
 extern Mutex*   CompileStatistics_lock;          // a lock held when updating compilation statistics
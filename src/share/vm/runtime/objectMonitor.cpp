@@ -149,6 +149,7 @@ HS_DTRACE_PROBE_DECL4(hotspot, monitor__contended__exit,
 // never be modified hence.  Consider using __read_mostly with GCC.
 
 int ObjectMonitor::Knob_Verbose    = 0 ;
+void* const ObjectMonitor::DEFLATER_MARKER = (void*)-1 ;
 int ObjectMonitor::Knob_SpinLimit  = 5000 ;    // derived by an external tool -
 static int Knob_LogSpins           = 0 ;       // enable jvmstat tally for spins
 static int Knob_HandOff            = 0 ;
@@ -314,7 +315,7 @@ bool ObjectMonitor::try_enter(Thread* THREAD) {
   }
 }
 
-void ATTR ObjectMonitor::enter(TRAPS) {
+bool ATTR ObjectMonitor::enter(TRAPS) {
   // The following code is ordered to check the most common cases first
   // and to reduce RTS->RTO cache line upgrades on SPARC and IA32 processors.
   Thread * const Self = THREAD ;
@@ -326,13 +327,13 @@ void ATTR ObjectMonitor::enter(TRAPS) {
      assert (_recursions == 0   , "invariant") ;
      assert (_owner      == Self, "invariant") ;
      // CONSIDER: set or assert OwnerIsThread == 1
-     return ;
+     return true ;
   }
 
   if (cur == Self) {
      // TODO-FIXME: check for integer overflow!  BUGID 6557169.
      _recursions ++ ;
-     return ;
+     return true ;
   }
 
   if (Self->is_lock_owned ((address)cur)) {
@@ -342,7 +343,7 @@ void ATTR ObjectMonitor::enter(TRAPS) {
     // a full-fledged "Thread *".
     _owner = Self ;
     OwnerIsThread = 1 ;
-    return ;
+    return true ;
   }
 
   // We've encountered genuine contention.
@@ -359,7 +360,7 @@ void ATTR ObjectMonitor::enter(TRAPS) {
      assert (_recursions == 0    , "invariant") ;
      assert (((oop)(object()))->mark()->is_mixed_object() || ((oop)(object()))->mark() == markOopDesc::encode(this), "invariant") ;
      Self->_Stalled = 0 ;
-     return ;
+     return true ;
   }
 
   assert (_owner != Self          , "invariant") ;
@@ -369,12 +370,20 @@ void ATTR ObjectMonitor::enter(TRAPS) {
   assert (!SafepointSynchronize::is_at_safepoint(), "invariant") ;
   assert (jt->thread_state() != _thread_blocked   , "invariant") ;
   assert (this->object() != NULL  , "invariant") ;
-  assert (_count >= 0, "invariant") ;
 
   // Prevent deflation at STW-time.  See deflate_idle_monitors() and is_busy().
   // Ensure the object-monitor relationship remains stable while there's contention.
   Atomic::inc_ptr(&_count);
 
+  // The service thread won the race to deflate the monitor, see
+  // ObjectSynchronizer::deflate_monitor_concurrently(). The object's
+  // mark no longer refers, or soon won't refer, to this monitor.
+  if (is_being_async_deflated()) {
+    Atomic::dec_ptr(&_count);
+    Self->_Stalled = 0 ;
+    return false ;
+  }
+
   EventJavaMonitorEnter event;
 
   { // Change java thread status to indicate blocked on monitor enter.
@@ -473,6 +482,7 @@ void ATTR ObjectMonitor::enter(TRAPS) {
   if (ObjectMonitor::_sync_ContendedLockAttempts != NULL) {
      ObjectMonitor::_sync_ContendedLockAttempts->inc() ;
   }
+  return true ;
 }
 
 
@@ -1393,16 +1403,18 @@ intptr_t ObjectMonitor::complete_exit(TRAPS) {
 
 // reenter() enters a lock and sets recursion count
 // complete_exit/reenter operate as a wait without waiting
-void ObjectMonitor::reenter(intptr_t recursions, TRAPS) {
+bool ObjectMonitor::reenter(intptr_t recursions, TRAPS) {
    Thread * const Self = THREAD;
    assert(Self->is_Java_thread(), "Must be Java thread!");
    JavaThread *jt = (JavaThread *)THREAD;
 
    guarantee(_owner != Self, "reenter already owner");
-   enter (THREAD);       // enter the monitor
+   if (!enter (THREAD)) {  // enter the monitor
+     return false;
+   }
    guarantee (_recursions == 0, "reenter recursion");
    _recursions = recursions;
-   return;
+   return true;
 }
 
 
@@ -1643,7 +1655,9 @@ void ObjectMonitor::wait(jlong millis, bool interruptible, TRAPS) {
      assert (_owner != Self, "invariant") ;
      ObjectWaiter::TStates v = node.TState ;
      if (v == ObjectWaiter::TS_RUN) {
-         enter (Self) ;
+         // _waiters keeps the monitor from being deflated
+         bool entered = enter (Self) ;
+         guarantee (entered, "monitor with waiters deflated") ;
      } else {
          guarantee (v == ObjectWaiter::TS_ENTER || v == ObjectWaiter::TS_CXQ, "invariant") ;
          ReenterI (Self, &node) ;
@@ -2276,7 +2290,7 @@ int ObjectMonitor::NotRunnable (Thread * Self, Thread * ox) {
     // Check either OwnerIsThread or ox->TypeTag == 2BAD.
     if (!OwnerIsThread) return 0 ;
 
-    if (ox == NULL) return 0 ;
+    if (ox == NULL || ox == (Thread *) DEFLATER_MARKER) return 0 ;
 
     // Avoid transitive spinning ...
     // Say T1 spins or blocks trying to acquire L.  T1._Stalled is set to L.
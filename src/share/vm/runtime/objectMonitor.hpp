@@ -111,6 +111,16 @@ class ObjectMonitor {
   markOop   header() const;
   void      set_header(markOop hdr);
 
+  // The owner of a monitor that the service thread is deflating, see
+  // ObjectSynchronizer::deflate_monitor_concurrently(). It is not the
+  // address of any thread or stack lock.
+  static void* const DEFLATER_MARKER;
+
+  // A monitor whose _count the service thread made negative is deflated,
+  // or about to be. Threads that find it through a stale mark must
+  // inflate the object again.
+  bool is_being_async_deflated() const { return _count < 0; }
+
   intptr_t is_busy() const {
     // TODO-FIXME: merge _count and _waiters.
     // TODO-FIXME: assert _owner == null implies _recursions = 0
@@ -195,7 +205,8 @@ public:
 #endif
 
   bool      try_enter (TRAPS) ;
-  void      enter(TRAPS);
+  // returns false if the monitor was deflated by the service thread
+  bool      enter(TRAPS);
   void      exit(bool not_suspended, TRAPS);
   void      wait(jlong millis, bool interruptable, TRAPS);
   void      notify(TRAPS);
@@ -203,7 +214,7 @@ public:
 
 // Use the following at your own risk
   intptr_t  complete_exit(TRAPS);
-  void      reenter(intptr_t recursions, TRAPS);
+  bool      reenter(intptr_t recursions, TRAPS);
 
  private:
   void      AddWaiter (ObjectWaiter * waiter) ;
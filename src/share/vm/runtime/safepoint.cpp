@@ -75,6 +75,7 @@
 #endif
 #if INCLUDE_ALL_GCS
 #include "gc_implementation/concurrentMarkSweep/concurrentMarkSweepThread.hpp"
+#include "gc_implementation/shared/stringDedup.hpp"
 #include "gc_implementation/shared/suspendibleThreadSet.hpp"
 #endif // INCLUDE_ALL_GCS
 #ifdef COMPILER1
@@ -111,7 +112,10 @@ void SafepointSynchronize::begin() {
     // In the future we should investigate whether CMS can use the
     // more-general mechanism below.  DLD (01/05).
     ConcurrentMarkSweepThread::synchronize(false);
-  } else if (UseG1GC) {
+  }
+  if (UseG1GC || StringDedup::is_enabled()) {
+    // The string deduplication thread joins the suspendible thread set
+    // whichever collector is in use.
     SuspendibleThreadSet::synchronize();
   }
 #endif // INCLUDE_ALL_GCS
@@ -487,7 +491,8 @@ void SafepointSynchronize::end() {
   // If there are any concurrent GC threads resume them.
   if (UseConcMarkSweepGC) {
     ConcurrentMarkSweepThread::desynchronize(false);
-  } else if (UseG1GC) {
+  }
+  if (UseG1GC || StringDedup::is_enabled()) {
     SuspendibleThreadSet::desynchronize();
   }
 #endif // INCLUDE_ALL_GCS
@@ -499,6 +504,9 @@ void SafepointSynchronize::end() {
 bool SafepointSynchronize::is_cleanup_needed() {
   // Need a safepoint if some inline cache buffers is non-empty
   if (!InlineCacheBuffer::is_empty()) return true;
+  // or to install the buckets of a grown symbol or string table
+  if (SymbolTable::is_growing() && !SymbolTable::has_buckets_to_move()) return true;
+  if (StringTable::is_growing() && !StringTable::has_buckets_to_move()) return true;
   return false;
 }
 
@@ -525,13 +533,24 @@ void SafepointSynchronize::do_cleanup_tasks() {
     NMethodSweeper::mark_active_nmethods();
   }
 
+  // Complete any growth before the tables are rehashed or walked by the GC
+  if (SymbolTable::is_growing()) {
+    TraceTime t5("growing symbol table", TraceSafepointCleanupTime);
+    SymbolTable::complete_growth();
+  }
+
+  if (StringTable::is_growing()) {
+    TraceTime t6("growing string table", TraceSafepointCleanupTime);
+    StringTable::complete_growth();
+  }
+
   if (SymbolTable::needs_rehashing()) {
-    TraceTime t5("rehashing symbol table", TraceSafepointCleanupTime);
+    TraceTime t7("rehashing symbol table", TraceSafepointCleanupTime);
     SymbolTable::rehash_table();
   }
 
   if (StringTable::needs_rehashing()) {
-    TraceTime t6("rehashing string table", TraceSafepointCleanupTime);
+    TraceTime t8("rehashing string table", TraceSafepointCleanupTime);
     StringTable::rehash_table();
   }
 
@@ -543,7 +562,7 @@ void SafepointSynchronize::do_cleanup_tasks() {
   {
     // CMS delays purging the CLDG until the beginning of the next safepoint and to
     // make sure concurrent sweep is done
-    TraceTime t7("purging class loader data graph", TraceSafepointCleanupTime);
+    TraceTime t9("purging class loader data graph", TraceSafepointCleanupTime);
     ClassLoaderDataGraph::purge_if_needed();
   }
 }
@@ -23,10 +23,14 @@
  */
 
 #include "precompiled.hpp"
+#include "classfile/symbolTable.hpp"
+#include "gc_interface/collectedHeap.hpp"
+#include "memory/universe.hpp"
 #include "runtime/interfaceSupport.hpp"
 #include "runtime/javaCalls.hpp"
 #include "runtime/serviceThread.hpp"
 #include "runtime/mutexLocker.hpp"
+#include "runtime/synchronizer.hpp"
 #include "prims/jvmtiImpl.hpp"
 #include "services/allocationContextService.hpp"
 #include "services/gcNotifier.hpp"
@@ -88,6 +92,9 @@ void ServiceThread::service_thread_entry(JavaThread* jt, TRAPS) {
     bool has_gc_notification_event = false;
     bool has_dcmd_notification_event = false;
     bool acs_notify = false;
+    bool periodic_collection = false;
+    bool deflate_monitors = false;
+    bool grow_tables = false;
     JvmtiDeferredEvent jvmti_event;
     {
       // Need state transition ThreadBlockInVM so that this thread
@@ -100,15 +107,27 @@ void ServiceThread::service_thread_entry(JavaThread* jt, TRAPS) {
 
       ThreadBlockInVM tbivm(jt);
 
+      // Wake up periodically if the heap does periodic collections
+      jlong periodic_interval = Universe::heap()->periodic_collection_interval();
+      // and to deflate idle monitors
+      if (AsyncDeflateIdleMonitors && !MonitorInUseLists &&
+          (periodic_interval == 0 || periodic_interval > AsyncDeflationInterval)) {
+        periodic_interval = AsyncDeflationInterval;
+      }
+
       MutexLockerEx ml(Service_lock, Mutex::_no_safepoint_check_flag);
       while (!(sensors_changed = LowMemoryDetector::has_pending_requests()) &&
              !(has_jvmti_events = JvmtiDeferredEventQueue::has_events()) &&
               !(has_gc_notification_event = GCNotifier::has_event()) &&
               !(has_dcmd_notification_event = DCmdFactory::has_pending_jmx_notification()) &&
-             !(acs_notify = AllocationContextService::should_notify())) {
+             !(acs_notify = AllocationContextService::should_notify()) &&
+             !(periodic_collection = Universe::heap()->should_do_periodic_collection()) &&
+             !(deflate_monitors = ObjectSynchronizer::is_async_deflation_needed()) &&
+             !(grow_tables = SymbolTable::has_buckets_to_move() ||
+                             StringTable::has_buckets_to_move())) {
         // wait until one of the sensors has pending requests, or there is a
         // pending JVMTI event or JMX GC notification to post
-        Service_lock->wait(Mutex::_no_safepoint_check_flag);
+        Service_lock->wait(Mutex::_no_safepoint_check_flag, periodic_interval);
       }
 
       if (has_jvmti_events) {
@@ -135,6 +154,19 @@ void ServiceThread::service_thread_entry(JavaThread* jt, TRAPS) {
     if (acs_notify) {
       AllocationContextService::notify(CHECK);
     }
+
+    if (periodic_collection) {
+      Universe::heap()->do_periodic_collection();
+    }
+
+    if (deflate_monitors) {
+      ObjectSynchronizer::deflate_idle_monitors_concurrently(jt);
+    }
+
+    if (grow_tables) {
+      SymbolTable::grow_concurrently(jt);
+      StringTable::grow_concurrently(jt);
+    }
   }
 }
 
@@ -132,6 +132,8 @@ void NMethodSweeper::record_sweep(nmethod* nm, int line) {
 #endif
 
 nmethod* NMethodSweeper::_current                      = NULL; // Current nmethod
+int      NMethodSweeper::_current_heap                 = 0;    // Index of the code heap of the current nmethod
+int      NMethodSweeper::_heaps_to_sweep               = 0;    // Code heaps swept in this pass
 long     NMethodSweeper::_traversals                   = 0;    // Stack scan count, also sweep ID.
 long     NMethodSweeper::_total_nof_code_cache_sweeps  = 0;    // Total number of full sweeps of the code cache
 long     NMethodSweeper::_time_counter                 = 0;    // Virtual time used to periodically invoke sweeper
@@ -144,7 +146,7 @@ int      NMethodSweeper::_marked_for_reclamation_count = 0;    // Nof. nmethods
 volatile bool NMethodSweeper::_should_sweep            = true; // Indicates if we should invoke the sweeper
 volatile int  NMethodSweeper::_sweep_fractions_left    = 0;    // Nof. invocations left until we are completed with this pass
 volatile int  NMethodSweeper::_sweep_started           = 0;    // Flag to control conc sweeper
-volatile int  NMethodSweeper::_bytes_changed           = 0;    // Counts the total nmethod size if the nmethod changed from:
+volatile int  NMethodSweeper::_bytes_changed[CodeBlobType::All] = { 0, 0, 0 }; // Counts per code heap the total nmethod size if the nmethod changed from:
                                                                //   1) alive       -> not_entrant
                                                                //   2) not_entrant -> zombie
                                                                //   3) zombie      -> marked_for_reclamation
@@ -216,6 +218,8 @@ void NMethodSweeper::mark_active_nmethods() {
   if (!sweep_in_progress()) {
     _seen = 0;
     _sweep_fractions_left = NmethodSweepFraction;
+    // The code heaps are chosen when the sweep starts
+    _heaps_to_sweep = 0;
     _current = CodeCache::first_nmethod();
     _traversals += 1;
     _total_time_this_sweep = Tickspan();
@@ -307,10 +311,14 @@ void NMethodSweeper::possibly_sweep() {
       // If there was enough state change, 'possibly_enable_sweeper()'
       // sets '_should_sweep' to true
       possibly_enable_sweeper();
-      // Reset _bytes_changed only if there was enough state change. _bytes_changed
-      // can further increase by calls to 'report_state_change'.
+      // Reset _bytes_changed of the swept code heaps only if there was enough state
+      // change. _bytes_changed can further increase by calls to 'report_state_change'.
       if (_should_sweep) {
-        _bytes_changed = 0;
+        for (int i = 0; i < CodeCache::number_of_heaps(); i++) {
+          if ((_heaps_to_sweep & (1 << i)) != 0 && percent_changed(i) > 1.0) {
+            _bytes_changed[i] = 0;
+          }
+        }
       }
     }
     // Release work, because another compiler thread could continue.
@@ -352,6 +360,10 @@ void NMethodSweeper::sweep_code_cache() {
   {
     MutexLockerEx mu(CodeCache_lock, Mutex::_no_safepoint_check_flag);
 
+    if (_heaps_to_sweep == 0) {
+      select_heaps_to_sweep();
+    }
+
     // The last invocation iterates until there are no more nmethods
     for (int i = 0; (i < todo || _sweep_fractions_left == 1) && _current != NULL; i++) {
       swept_count++;
@@ -369,7 +381,10 @@ void NMethodSweeper::sweep_code_cache() {
       // Since we will give up the CodeCache_lock, always skip ahead
       // to the next nmethod.  Other blobs can be deleted by other
       // threads but nmethods are only reclaimed by the sweeper.
-      nmethod* next = CodeCache::next_nmethod(_current);
+      nmethod* next = CodeCache::next_nmethod(CodeCache::heap_at(_current_heap), _current);
+      if (next == NULL) {
+        next = first_nmethod_to_sweep(_current_heap + 1);
+      }
 
       // Now ready to process nmethod and give up CodeCache_lock
       {
@@ -431,6 +446,63 @@ void NMethodSweeper::sweep_code_cache() {
   }
 }
 
+/**
+ * Chooses the code heaps swept in this pass: those with more than 1% state change
+ * of their capacity, or all of them if there are none, or if compilation is off
+ * because the code cache is full. Positions _current at the first nmethod to sweep.
+ */
+void NMethodSweeper::select_heaps_to_sweep() {
+  assert_locked_or_safepoint(CodeCache_lock);
+  int heaps = 0;
+  if (CompileBroker::should_compile_new_jobs()) {
+    for (int i = 0; i < CodeCache::number_of_heaps(); i++) {
+      if (percent_changed(i) > 1.0) {
+        heaps |= 1 << i;
+      }
+    }
+  }
+  if (heaps == 0) {
+    heaps = (1 << CodeCache::number_of_heaps()) - 1;
+  }
+  _heaps_to_sweep = heaps;
+  _current = first_nmethod_to_sweep(0);
+
+  if (PrintMethodFlushing) {
+    for (int i = 0; i < CodeCache::number_of_heaps(); i++) {
+      if ((_heaps_to_sweep & (1 << i)) != 0) {
+        tty->print_cr("### Sweep: sweeping %s", CodeCache::heap_at(i)->name());
+      }
+    }
+  }
+}
+
+/**
+ * Returns the first nmethod in the swept code heaps from the one at index on,
+ * and makes its code heap the current one.
+ */
+nmethod* NMethodSweeper::first_nmethod_to_sweep(int index) {
+  for (; index < CodeCache::number_of_heaps(); index++) {
+    if ((_heaps_to_sweep & (1 << index)) != 0) {
+      nmethod* nm = CodeCache::first_nmethod(CodeCache::heap_at(index));
+      if (nm != NULL) {
+        _current_heap = index;
+        return nm;
+      }
+    }
+  }
+  return NULL;
+}
+
+double NMethodSweeper::percent_changed(int index) {
+  return ((double)_bytes_changed[index] / (double)CodeCache::heap_at(index)->max_capacity()) * 100;
+}
+
+void NMethodSweeper::add_bytes_changed(nmethod* nm) {
+  int index = CodeCache::heap_index_containing(nm);
+  assert(index >= 0, "not in the code cache");
+  _bytes_changed[index] += nm->total_size();
+}
+
 /**
  * This function updates the sweeper statistics that keep track of nmethods
  * state changes. If there is 'enough' state change, the sweeper is invoked
@@ -440,19 +512,21 @@ void NMethodSweeper::sweep_code_cache() {
  * to invoke the sweeper if the code cache gets full.
  */
 void NMethodSweeper::report_state_change(nmethod* nm) {
-  _bytes_changed += nm->total_size();
+  add_bytes_changed(nm);
   possibly_enable_sweeper();
 }
 
 /**
  * Function determines if there was 'enough' state change in the code cache to invoke
  * the sweeper again. Currently, we determine 'enough' as more than 1% state change in
- * the code cache since the last sweep.
+ * any code heap since its last sweep.
  */
 void NMethodSweeper::possibly_enable_sweeper() {
-  double percent_changed = ((double)_bytes_changed / (double)ReservedCodeCacheSize) * 100;
-  if (percent_changed > 1.0) {
-    _should_sweep = true;
+  for (int i = 0; i < CodeCache::number_of_heaps(); i++) {
+    if (percent_changed(i) > 1.0) {
+      _should_sweep = true;
+      return;
+    }
   }
 }
 
@@ -531,7 +605,7 @@ int NMethodSweeper::process_nmethod(nmethod *nm) {
       }
       nm->mark_for_reclamation();
       // Keep track of code cache state change
-      _bytes_changed += nm->total_size();
+      add_bytes_changed(nm);
       _marked_for_reclamation_count++;
       SWEEP(nm);
     }
@@ -25,6 +25,7 @@
 #ifndef SHARE_VM_RUNTIME_SWEEPER_HPP
 #define SHARE_VM_RUNTIME_SWEEPER_HPP
 
+#include "code/codeBlob.hpp"
 #include "utilities/ticks.hpp"
 // An NmethodSweeper is an incremental cleaner for:
 //    - cleanup inline caches
@@ -52,6 +53,9 @@
 //     nmethod's space is freed. Sweeping is currently done by compiler threads between
 //     compilations or at least each 5 sec (NmethodSweepCheckInterval) when the code cache
 //     is full.
+// With SegmentedCodeCache, state changes are counted per code heap, and a pass only
+// sweeps the code heaps with enough state change. All code heaps are swept when none
+// has enough, i.e., on the periodic sweeps and when the code cache is full.
 
 class NMethodSweeper : public AllStatic {
   static long      _traversals;                     // Stack scan count, also sweep ID.
@@ -59,6 +63,8 @@ class NMethodSweeper : public AllStatic {
   static long      _time_counter;                   // Virtual time used to periodically invoke sweeper
   static long      _last_sweep;                     // Value of _time_counter when the last sweep happened
   static nmethod*  _current;                        // Current nmethod
+  static int       _current_heap;                   // Index of the code heap of the current nmethod
+  static int       _heaps_to_sweep;                 // Bit i is set if code heap i is swept in this pass, 0 if not yet chosen
   static int       _seen;                           // Nof. nmethod we have currently processed in current pass of CodeCache
   static int       _flushed_count;                  // Nof. nmethods flushed in current sweep
   static int       _zombified_count;                // Nof. nmethods made zombie in current sweep
@@ -67,7 +73,7 @@ class NMethodSweeper : public AllStatic {
   static volatile int  _sweep_fractions_left;       // Nof. invocations left until we are completed with this pass
   static volatile int  _sweep_started;              // Flag to control conc sweeper
   static volatile bool _should_sweep;               // Indicates if we should invoke the sweeper
-  static volatile int  _bytes_changed;              // Counts the total nmethod size if the nmethod changed from:
+  static volatile int  _bytes_changed[CodeBlobType::All]; // Counts per code heap the total nmethod size if the nmethod changed from:
                                                     //   1) alive       -> not_entrant
                                                     //   2) not_entrant -> zombie
                                                     //   3) zombie      -> marked_for_reclamation
@@ -87,6 +93,10 @@ class NMethodSweeper : public AllStatic {
 
   static bool sweep_in_progress();
   static void sweep_code_cache();
+  static void select_heaps_to_sweep();
+  static nmethod* first_nmethod_to_sweep(int index);
+  static double percent_changed(int index);
+  static void add_bytes_changed(nmethod* nm);
 
  public:
   static long traversal_count()              { return _traversals; }
@@ -156,6 +156,10 @@ int ObjectSynchronizer::gOmInUseCount = 0;
 static volatile intptr_t ListLock = 0 ;      // protects global monitor free-list cache
 static volatile int MonitorFreeCount  = 0 ;      // # on gFreeList
 static volatile int MonitorPopulation = 0 ;      // # Extant -- in circulation
+static ObjectMonitor * volatile gDeflatedList = NULL ; // deflated by the service thread, freed at the next safepoint
+static volatile int gDeflatedCount = 0 ;         // # on gDeflatedList
+static jlong gLastAsyncDeflation = 0 ;           // javaTimeMillis() of the last concurrent deflation pass
+static unsigned int gLastAsyncDeflationGC = 0 ;  // total_collections() at the last concurrent deflation pass
 #define CHAINMARKER (cast_to_oop<intptr_t>(-1))
 
 // -----------------------------------------------------------------------------
@@ -176,14 +180,13 @@ void ObjectSynchronizer::fast_enter(Handle obj, BasicLock* lock, bool attempt_re
       assert(!attempt_rebias, "can not rebias toward VM thread");
       BiasedLocking::revoke_at_safepoint(obj);
     }
-    assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
  }
 
  slow_enter (obj, lock, THREAD) ;
 }
 
 void ObjectSynchronizer::fast_exit(oop object, BasicLock* lock, TRAPS) {
-  assert(!object->mark()->has_bias_pattern(), "should not see bias pattern here");
   // if displaced header is null, the previous enter is recursive enter, no-op
   markOop dhw = lock->displaced_header();
   markOop mark = object->mark();
@@ -275,7 +278,11 @@ void ObjectSynchronizer::slow_enter(Handle obj, BasicLock* lock, TRAPS) {
   // must be non-zero to avoid looking like a re-entrant lock,
   // and must not look locked either.
   lock->set_displaced_header(markOopDesc::unused_mark());
-  ObjectSynchronizer::inflate(THREAD, obj())->enter(THREAD);
+  // enter() fails if the service thread deflated the monitor before this
+  // thread got in, in which case the object is inflated again
+  while (!ObjectSynchronizer::inflate(THREAD, obj())->enter(THREAD)) {
+    TEVENT (slow_enter: retry after async deflation) ;
+  }
 }
 
 // This routine is used to handle interpreter/compiler slow case
@@ -302,7 +309,7 @@ intptr_t ObjectSynchronizer::complete_exit(Handle obj, TRAPS) {
   TEVENT (complete_exit) ;
   if (UseBiasedLocking) {
     BiasedLocking::revoke_and_rebias(obj, false, THREAD);
-    assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
   }
 
   ObjectMonitor* monitor = ObjectSynchronizer::inflate(THREAD, obj());
@@ -315,12 +322,12 @@ void ObjectSynchronizer::reenter(Handle obj, intptr_t recursion, TRAPS) {
   TEVENT (reenter) ;
   if (UseBiasedLocking) {
     BiasedLocking::revoke_and_rebias(obj, false, THREAD);
-    assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
   }
 
-  ObjectMonitor* monitor = ObjectSynchronizer::inflate(THREAD, obj());
-
-  monitor->reenter(recursion, THREAD);
+  while (!ObjectSynchronizer::inflate(THREAD, obj())->reenter(recursion, THREAD)) {
+    TEVENT (reenter: retry after async deflation) ;
+  }
 }
 // -----------------------------------------------------------------------------
 // JNI locks on java objects
@@ -330,10 +337,12 @@ void ObjectSynchronizer::jni_enter(Handle obj, TRAPS) { // possible entry from j
   TEVENT (jni_enter) ;
   if (UseBiasedLocking) {
     BiasedLocking::revoke_and_rebias(obj, false, THREAD);
-    assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
   }
   THREAD->set_current_pending_monitor_is_from_java(false);
-  ObjectSynchronizer::inflate(THREAD, obj())->enter(THREAD);
+  while (!ObjectSynchronizer::inflate(THREAD, obj())->enter(THREAD)) {
+    TEVENT (jni_enter: retry after async deflation) ;
+  }
   THREAD->set_current_pending_monitor_is_from_java(true);
 }
 
@@ -341,11 +350,20 @@ void ObjectSynchronizer::jni_enter(Handle obj, TRAPS) { // possible entry from j
 bool ObjectSynchronizer::jni_try_enter(Handle obj, Thread* THREAD) {
   if (UseBiasedLocking) {
     BiasedLocking::revoke_and_rebias(obj, false, THREAD);
-    assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
   }
 
-  ObjectMonitor* monitor = ObjectSynchronizer::inflate_helper(obj());
-  return monitor->try_enter(THREAD);
+  for (;;) {
+    ObjectMonitor* monitor = ObjectSynchronizer::inflate_helper(obj());
+    if (monitor->try_enter(THREAD)) {
+      return true;
+    }
+    // a monitor deflated by the service thread can't be entered,
+    // but the object may be free
+    if (!monitor->is_being_async_deflated()) {
+      return false;
+    }
+  }
 }
 
 
@@ -357,7 +375,7 @@ void ObjectSynchronizer::jni_exit(oop obj, Thread* THREAD) {
     BiasedLocking::revoke_and_rebias(h_obj, false, THREAD);
     obj = h_obj();
   }
-  assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+  assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
 
   ObjectMonitor* monitor = ObjectSynchronizer::inflate(THREAD, obj);
   // If this thread has locked the object, exit the monitor.  Note:  can't use
@@ -396,7 +414,7 @@ ObjectLocker::~ObjectLocker() {
 void ObjectSynchronizer::wait(Handle obj, jlong millis, TRAPS) {
   if (UseBiasedLocking) {
     BiasedLocking::revoke_and_rebias(obj, false, THREAD);
-    assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
   }
   if (millis < 0) {
     TEVENT (wait - throw IAX) ;
@@ -415,7 +433,7 @@ void ObjectSynchronizer::wait(Handle obj, jlong millis, TRAPS) {
 void ObjectSynchronizer::waitUninterruptibly (Handle obj, jlong millis, TRAPS) {
   if (UseBiasedLocking) {
     BiasedLocking::revoke_and_rebias(obj, false, THREAD);
-    assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
   }
   if (millis < 0) {
     TEVENT (wait - throw IAX) ;
@@ -427,7 +445,7 @@ void ObjectSynchronizer::waitUninterruptibly (Handle obj, jlong millis, TRAPS) {
 void ObjectSynchronizer::notify(Handle obj, TRAPS) {
  if (UseBiasedLocking) {
     BiasedLocking::revoke_and_rebias(obj, false, THREAD);
-    assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
   }
 
   markOop mark = obj->mark();
@@ -448,7 +466,7 @@ void ObjectSynchronizer::notify(Handle obj, TRAPS) {
 void ObjectSynchronizer::notifyall(Handle obj, TRAPS) {
   if (UseBiasedLocking) {
     BiasedLocking::revoke_and_rebias(obj, false, THREAD);
-    assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
   }
 
   markOop mark = obj->mark();
@@ -631,6 +649,22 @@ static inline intptr_t get_next_hash(Thread * Self, oop obj) {
   TEVENT (hashCode: GENERATE) ;
   return value;
 }
+
+// Waits until the service thread has either deflated the monitor of the
+// object and restored the object's header, or given up deflating it.
+static void wait_for_async_deflation(oop obj, ObjectMonitor* monitor) {
+  while (monitor->is_being_async_deflated()) {
+    markOop mark = obj->mark();
+    if (mark->is_mixed_object()) {
+      mark = ((oop) mark->decode_phantom_object_pointer())->mark();
+    }
+    if (mark != markOopDesc::encode(monitor)) {
+      return;
+    }
+    SpinPause();
+  }
+}
+
 //
 intptr_t ObjectSynchronizer::FastHashCode (Thread * Self, oop obj) {
   markOop mark = ReadStableMark (obj);
@@ -649,8 +683,7 @@ intptr_t ObjectSynchronizer::FastHashCode (Thread * Self, oop obj) {
     // been checked to make sure they can handle a safepoint. The
     // added check of the bias pattern is to avoid useless calls to
     // thread-local storage.
-    assert(!obj->mark()->is_mixed_object(), "Mixed object should not be used with BiasedLocking");
-    if (obj->mark()->has_bias_pattern()) {
+    if (obj->mark_holder()->mark()->has_bias_pattern()) {
       // Box and unbox the raw reference just in case we cause a STW safepoint.
       Handle hobj (Self, obj) ;
       // Relaxing assertion for bug 6320749.
@@ -659,7 +692,7 @@ intptr_t ObjectSynchronizer::FastHashCode (Thread * Self, oop obj) {
              "biases should not be seen by VM thread here");
       BiasedLocking::revoke_and_rebias(hobj, false, JavaThread::current());
       obj = hobj() ;
-      assert(!obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+      assert(!obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
     }
   }
 
@@ -675,82 +708,103 @@ intptr_t ObjectSynchronizer::FastHashCode (Thread * Self, oop obj) {
   ObjectMonitor* monitor = NULL;
   markOop temp, test;
   intptr_t hash;
-  mark = ReadStableMark (obj);
-  if (mark->is_mixed_object()) {
-    mark_holder = (oop) mark->decode_phantom_object_pointer();
-    assert(Universe::heap()->is_in_reserved(mark_holder), "must be live");
-    mark = ReadStableMark (mark_holder);
-  }
-  // object should remain ineligible for biased locking
-  assert (!mark->has_bias_pattern(), "invariant") ;
-  assert (!mark->is_mixed_object(), "invariant") ;
 
-  if (mark->is_neutral()) {
-    hash = mark->hash();              // this is a normal header
-    if (hash) {                       // if it has hash, just return it
-      return hash;
+  // A hash code read from, or installed in, a monitor is only stable if
+  // the monitor is not being deflated by the service thread, which copies
+  // the monitor's header back to the object. Otherwise start over with
+  // the header the object gets back.
+  for (;;) {
+    mark_holder = obj;
+    mark = ReadStableMark (obj);
+    if (mark->is_mixed_object()) {
+      mark_holder = (oop) mark->decode_phantom_object_pointer();
+      assert(Universe::heap()->is_in_reserved(mark_holder), "must be live");
+      mark = ReadStableMark (mark_holder);
     }
-    hash = get_next_hash(Self, obj);  // allocate a new hash code
-    temp = mark->copy_set_hash(hash); // merge the hash code into header
-    // use (machine word version) atomic operation to install the hash
-    test = (markOop) Atomic::cmpxchg_ptr(temp, mark_holder->mark_addr(), mark);
-    if (test == mark) {
-      return hash;
+    // object should remain ineligible for biased locking
+    assert (!mark->has_bias_pattern(), "invariant") ;
+    assert (!mark->is_mixed_object(), "invariant") ;
+
+    if (mark->is_neutral()) {
+      hash = mark->hash();              // this is a normal header
+      if (hash) {                       // if it has hash, just return it
+        return hash;
+      }
+      hash = get_next_hash(Self, obj);  // allocate a new hash code
+      temp = mark->copy_set_hash(hash); // merge the hash code into header
+      // use (machine word version) atomic operation to install the hash
+      test = (markOop) Atomic::cmpxchg_ptr(temp, mark_holder->mark_addr(), mark);
+      if (test == mark) {
+        return hash;
+      }
+      // If atomic operation failed, we must inflate the header
+      // into heavy weight monitor. We could add more code here
+      // for fast path, but it does not worth the complexity.
+    } else if (mark->has_monitor()) {
+      monitor = mark->monitor();
+      temp = monitor->header();
+      assert (temp->is_neutral(), "invariant") ;
+      hash = temp->hash();
+      if (hash) {
+        OrderAccess::loadload();
+        if (!monitor->is_being_async_deflated()) {
+          return hash;
+        }
+        wait_for_async_deflation(obj, monitor);
+        continue;
+      }
+      // Skip to the following code to reduce code size
+    } else if (Self->is_lock_owned((address)mark->locker())) {
+      temp = mark->displaced_mark_helper(); // this is a lightweight monitor owned
+      assert (temp->is_neutral(), "invariant") ;
+      hash = temp->hash();              // by current thread, check if the displaced
+      if (hash) {                       // header contains hash code
+        return hash;
+      }
+      // WARNING:
+      //   The displaced header is strictly immutable.
+      // It can NOT be changed in ANY cases. So we have
+      // to inflate the header into heavyweight monitor
+      // even the current thread owns the lock. The reason
+      // is the BasicLock (stack slot) will be asynchronously
+      // read by other threads during the inflate() function.
+      // Any change to stack may not propagate to other threads
+      // correctly.
     }
-    // If atomic operation failed, we must inflate the header
-    // into heavy weight monitor. We could add more code here
-    // for fast path, but it does not worth the complexity.
-  } else if (mark->has_monitor()) {
-    monitor = mark->monitor();
-    temp = monitor->header();
-    assert (temp->is_neutral(), "invariant") ;
-    hash = temp->hash();
-    if (hash) {
-      return hash;
+
+    // Inflate the monitor to set hash code
+    monitor = ObjectSynchronizer::inflate(Self, obj);
+    // Load displaced header and check it has hash code
+    mark = monitor->header();
+    assert (mark->is_neutral(), "invariant") ;
+    assert (!mark->is_mixed_object(), "invariant") ;
+    hash = mark->hash();
+    if (hash == 0) {
+      hash = get_next_hash(Self, obj);
+      temp = mark->copy_set_hash(hash); // merge hash code into header
+      assert (temp->is_neutral(), "invariant") ;
+      assert (!temp->is_mixed_object(), "invariant") ;
+      test = (markOop) Atomic::cmpxchg_ptr(temp, monitor, mark);
+      if (test != mark) {
+        // The only update to the header in the monitor (outside GC)
+        // is install the hash code. If someone add new usage of
+        // displaced header, please update this code
+        hash = test->hash();
+        assert (test->is_neutral(), "invariant") ;
+        assert (hash != 0, "Trivial unexpected object/monitor header usage.");
+      }
+    } else {
+      OrderAccess::loadload();
     }
-    // Skip to the following code to reduce code size
-  } else if (Self->is_lock_owned((address)mark->locker())) {
-    temp = mark->displaced_mark_helper(); // this is a lightweight monitor owned
-    assert (temp->is_neutral(), "invariant") ;
-    hash = temp->hash();              // by current thread, check if the displaced
-    if (hash) {                       // header contains hash code
+    // The cmpxchg above, and the one that makes _count negative in
+    // deflate_monitor_concurrently(), are full fences, so either the
+    // deflater copies a header with the hash code or we see it here.
+    if (!monitor->is_being_async_deflated()) {
+      // We finally get the hash
       return hash;
     }
-    // WARNING:
-    //   The displaced header is strictly immutable.
-    // It can NOT be changed in ANY cases. So we have
-    // to inflate the header into heavyweight monitor
-    // even the current thread owns the lock. The reason
-    // is the BasicLock (stack slot) will be asynchronously
-    // read by other threads during the inflate() function.
-    // Any change to stack may not propagate to other threads
-    // correctly.
-  }
-
-  // Inflate the monitor to set hash code
-  monitor = ObjectSynchronizer::inflate(Self, obj);
-  // Load displaced header and check it has hash code
-  mark = monitor->header();
-  assert (mark->is_neutral(), "invariant") ;
-  assert (!mark->is_mixed_object(), "invariant") ;
-  hash = mark->hash();
-  if (hash == 0) {
-    hash = get_next_hash(Self, obj);
-    temp = mark->copy_set_hash(hash); // merge hash code into header
-    assert (temp->is_neutral(), "invariant") ;
-    assert (!temp->is_mixed_object(), "invariant") ;
-    test = (markOop) Atomic::cmpxchg_ptr(temp, monitor, mark);
-    if (test != mark) {
-      // The only update to the header in the monitor (outside GC)
-      // is install the hash code. If someone add new usage of
-      // displaced header, please update this code
-      hash = test->hash();
-      assert (test->is_neutral(), "invariant") ;
-      assert (hash != 0, "Trivial unexpected object/monitor header usage.");
-    }
+    wait_for_async_deflation(obj, monitor);
   }
-  // We finally get the hash
-  return hash;
 }
 
 // Deprecated -- use FastHashCode() instead.
@@ -764,7 +818,7 @@ bool ObjectSynchronizer::current_thread_holds_lock(JavaThread* thread,
                                                    Handle h_obj) {
   if (UseBiasedLocking) {
     BiasedLocking::revoke_and_rebias(h_obj, false, thread);
-    assert(!h_obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!h_obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
   }
 
   assert(thread == JavaThread::current(), "Can only be called on current thread");
@@ -808,10 +862,10 @@ ObjectSynchronizer::LockOwnership ObjectSynchronizer::query_lock_ownership
 
   // Possible mark states: neutral, biased, stack-locked, inflated
 
-  if (UseBiasedLocking && h_obj()->mark()->has_bias_pattern()) {
+  if (UseBiasedLocking && h_obj()->mark_holder()->mark()->has_bias_pattern()) {
     // CASE: biased
     BiasedLocking::revoke_and_rebias(h_obj, false, self);
-    assert(!h_obj->mark()->has_bias_pattern(),
+    assert(!h_obj->mark_holder()->mark()->has_bias_pattern(),
            "biases should be revoked by now");
   }
 
@@ -856,7 +910,7 @@ JavaThread* ObjectSynchronizer::get_lock_owner(Handle h_obj, bool doLock) {
     } else {
       BiasedLocking::revoke_and_rebias(h_obj, false, JavaThread::current());
     }
-    assert(!h_obj->mark()->has_bias_pattern(), "biases should be revoked by now");
+    assert(!h_obj->mark_holder()->mark()->has_bias_pattern(), "biases should be revoked by now");
   }
 
   oop obj = h_obj();
@@ -906,7 +960,9 @@ void ObjectSynchronizer::monitors_iterate(MonitorClosure* closure) {
     for (int i = _BLOCKSIZE - 1; i > 0; i--) {
       mid = block + i;
       oop object = (oop) mid->object();
-      if (object != NULL) {
+      // A monitor deflated by the service thread keeps its object until
+      // the next safepoint, but the object is no longer locked with it.
+      if (object != NULL && !mid->is_being_async_deflated()) {
         closure->do_monitor(mid);
       }
     }
@@ -956,6 +1012,16 @@ void ObjectSynchronizer::oops_do(OopClosure* f) {
 // --   assigned to an object.  The object is inflated and the mark refers
 //      to the objectmonitor.
 //
+// --   deflated by the service thread and on gDeflatedList.  The object's
+//      header has been restored, but threads may still hold a stale
+//      reference to the monitor.  Such threads see _count < 0 and retry.
+//      The list is moved to the global free list at the next safepoint,
+//      after which no thread can refer to the monitor any more.
+//
+// Unless MonitorInUseLists or MonitorBound is set, AsyncDeflateIdleMonitors
+// moves the scavenging of idle monitors out of the safepoint and into the
+// service thread.  See deflate_monitor_concurrently().
+//
 
 
 // Constraining monitor pool growth via MonitorBound ...
@@ -981,6 +1047,7 @@ static void InduceScavenge (Thread * Self, const char * Whence) {
   // More precisely, trigger an asynchronous STW safepoint as the number
   // of active monitors passes the specified threshold.
   // TODO: assert thread state is reasonable
+  // MonitorBound turns AsyncDeflateIdleMonitors off, see Arguments::apply_ergo().
 
   if (ForceMonitorScavenge == 0 && Atomic::xchg (1, &ForceMonitorScavenge) == 0) {
     if (ObjectMonitor::Knob_Verbose) {
@@ -1127,8 +1194,9 @@ ObjectMonitor * ATTR ObjectSynchronizer::omAlloc (Thread * Self) {
         // Add the new block to the list of extant blocks (gBlockList).
         // The very first objectMonitor in a block is reserved and dedicated.
         // It serves as blocklist "next" linkage.
+        // The service thread walks the block list without ListLock.
         temp[0].FreeNext = gBlockList;
-        gBlockList = temp;
+        OrderAccess::release_store_ptr(&gBlockList, temp);
 
         // Add the new string of objectMonitors to the global free list
         temp[_BLOCKSIZE - 1].FreeNext = gFreeList ;
@@ -1611,7 +1679,23 @@ void ObjectSynchronizer::deflate_idle_monitors() {
   // See e.g. 6320749
   Thread::muxAcquire (&ListLock, "scavenge - return") ;
 
-  if (MonitorInUseLists) {
+  if (AsyncDeflateIdleMonitors && !MonitorInUseLists) {
+    // The service thread has already deflated the idle monitors; no thread
+    // can refer to them across this safepoint, so they can be reused now.
+    for (ObjectMonitor* mid = gDeflatedList; mid != NULL; mid = mid->FreeNext) {
+      guarantee (mid->is_being_async_deflated(), "invariant") ;
+      mid->_count = 0 ;
+      mid->set_owner(NULL) ;
+      mid->clear() ;
+      FreeTail = mid ;
+      nScavenged ++ ;
+    }
+    FreeHead = gDeflatedList ;
+    gDeflatedList = NULL ;
+    gDeflatedCount = 0 ;
+    nInCirculation = MonitorPopulation ;
+    nInuse = MonitorPopulation - MonitorFreeCount - nScavenged ;
+  } else if (MonitorInUseLists) {
     int inUse = 0;
     for (JavaThread* cur = Threads::first(); cur != NULL; cur = cur->next()) {
       nInCirculation+= cur->omInUseCount;
@@ -1690,6 +1774,121 @@ void ObjectSynchronizer::deflate_idle_monitors() {
   GVars.stwCycle ++ ;
 }
 
+// Deflate a single monitor concurrently with the Java threads.
+// Return true if deflated, false if in use
+//
+// The monitor is claimed in two steps: first the owner is set to
+// DEFLATER_MARKER, which keeps enter() and the compiled fast path from
+// acquiring it, then _count is made negative, which makes every thread
+// that would block on the monitor retry with the object's new header.
+// Only then is the header restored, and only if the object still refers
+// to the monitor.
+bool ObjectSynchronizer::deflate_monitor_concurrently(ObjectMonitor* mid) {
+  oop obj = (oop) mid->object();
+  if (obj == NULL || mid->is_busy()) {
+    return false;
+  }
+  oop mark_holder = obj;
+  if (obj->mark()->is_mixed_object()) {
+    mark_holder = oop(obj->mark()->decode_phantom_object_pointer());
+    assert(Universe::heap()->is_in_reserved(mark_holder), "must be live");
+  }
+  // Monitors that are being inflated, or that are already deflated, are
+  // not (or no longer) published in the object's header.
+  markOop dmw = mid->header();
+  if (mark_holder->mark() != markOopDesc::encode(mid)) {
+    return false;
+  }
+  if (Atomic::cmpxchg_ptr(ObjectMonitor::DEFLATER_MARKER, &mid->_owner, NULL) != NULL) {
+    return false;
+  }
+  if (mid->_waiters == 0 && mid->_cxq == NULL && mid->_EntryList == NULL &&
+      Atomic::cmpxchg_ptr(-max_jint, &mid->_count, (intptr_t) 0) == 0) {
+    // The monitor can no longer be entered, but it may have got a hash
+    // code after we read the header.
+    dmw = mid->header();
+    assert (dmw->is_neutral(), "invariant") ;
+    if (Atomic::cmpxchg_ptr(dmw, mark_holder->mark_addr(), markOopDesc::encode(mid)) == markOopDesc::encode(mid)) {
+      TEVENT (deflate_idle_monitors_concurrently - scavenge1) ;
+      if (TraceMonitorInflation) {
+        if (mark_holder->is_instance()) {
+          ResourceMark rm;
+          tty->print_cr("Deflating object " INTPTR_FORMAT " , mark " INTPTR_FORMAT " , type %s",
+               (void *) obj, (intptr_t) obj->mark(), obj->klass()->external_name());
+        }
+      }
+      // Keep _owner and _count until the monitor is freed at the next
+      // safepoint; threads with a stale reference will retry.
+      mid->FreeNext = gDeflatedList ;
+      gDeflatedList = mid ;
+      gDeflatedCount ++ ;
+      return true;
+    }
+    // The object was relinked to a phantom object in the meantime.
+    Atomic::add_ptr(max_jint, &mid->_count);
+  }
+
+  // Back out.  A thread that exited the monitor while we owned it left
+  // the succession to us, so wake up a successor like exit() would.
+  ObjectWaiter* w = mid->_EntryList != NULL ? mid->_EntryList : mid->_cxq;
+  ParkEvent* trigger = (w != NULL && mid->_succ == NULL) ? w->_event : NULL;
+  OrderAccess::release_store_ptr(&mid->_owner, NULL);
+  OrderAccess::storeload();
+  if (trigger != NULL) {
+    trigger->unpark();
+  }
+  return false;
+}
+
+void ObjectSynchronizer::deflate_idle_monitors_concurrently(JavaThread* self) {
+  assert(AsyncDeflateIdleMonitors && !MonitorInUseLists, "invariant");
+  assert(self->thread_state() == _thread_in_vm, "invariant");
+  int nInCirculation = 0 ;
+  int nScavenged = 0 ;
+
+  TEVENT (deflate_idle_monitors_concurrently) ;
+  ObjectMonitor* block = (ObjectMonitor*) OrderAccess::load_ptr_acquire(&gBlockList);
+  for (; block != NULL; block = next(block)) {
+    assert(block->object() == CHAINMARKER, "must be a block header");
+    nInCirculation += _BLOCKSIZE ;
+    for (int i = 1 ; i < _BLOCKSIZE; i++) {
+      if (deflate_monitor_concurrently(&block[i])) {
+        nScavenged ++ ;
+      }
+    }
+    // Do not hold up a pending safepoint for the whole walk.
+    if (SafepointSynchronize::is_synchronizing()) {
+      ThreadBlockInVM tbivm(self);
+    }
+  }
+  gLastAsyncDeflation = os::javaTimeMillis();
+  gLastAsyncDeflationGC = Universe::heap()->total_collections();
+
+  if (ObjectMonitor::Knob_Verbose) {
+    ::printf ("Deflate concurrently: InCirc=%d Scavenged=%d : pop=%d free=%d\n",
+        nInCirculation, nScavenged,
+        MonitorPopulation, MonitorFreeCount) ;
+    ::fflush(stdout) ;
+  }
+}
+
+bool ObjectSynchronizer::is_async_deflation_needed() {
+  if (!AsyncDeflateIdleMonitors || MonitorInUseLists) {
+    return false;
+  }
+  if (os::javaTimeMillis() - gLastAsyncDeflation < AsyncDeflationInterval) {
+    return false;
+  }
+  // Monitors keep their objects alive, so let the objects of idle
+  // monitors die in the GC after next.
+  if (Universe::heap()->total_collections() != gLastAsyncDeflationGC) {
+    return true;
+  }
+  int population = MonitorPopulation ;
+  int used = population - MonitorFreeCount - gDeflatedCount ;
+  return population > 0 && (uintx) used * 100 / population > MonitorUsedDeflationThreshold ;
+}
+
 // Monitor cleanup on JavaThread::exit
 
 // Iterate through monitor cache and attempt to release thread's monitors
@@ -120,6 +120,11 @@ class ObjectSynchronizer : AllStatic {
                               ObjectMonitor** FreeTailp);
   static void oops_do(OopClosure* f);
 
+  // Service thread: deflate idle monitors without a safepoint; they are
+  // returned to the free list by deflate_idle_monitors() at the next one.
+  static void deflate_idle_monitors_concurrently(JavaThread* self);
+  static bool is_async_deflation_needed();
+
   // debugging
   static void verify() PRODUCT_RETURN;
   static int  verify_objmon_isinpool(ObjectMonitor *addr) PRODUCT_RETURN0;
@@ -133,6 +138,8 @@ class ObjectSynchronizer : AllStatic {
   static ObjectMonitor * volatile gOmInUseList; // for moribund thread, so monitors they inflated still get scanned
   static int gOmInUseCount;
 
+  static bool deflate_monitor_concurrently(ObjectMonitor* mid);
+
 };
 
 // ObjectLocker enforced balanced locking and can never thrown an
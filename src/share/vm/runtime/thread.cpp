@@ -29,6 +29,7 @@
 #include "classfile/vmSymbols.hpp"
 #include "code/scopeDesc.hpp"
 #include "compiler/compileBroker.hpp"
+#include "compiler/compileCache.hpp"
 #include "interpreter/interpreter.hpp"
 #include "interpreter/linkResolver.hpp"
 #include "interpreter/oopMapCache.hpp"
@@ -1504,10 +1505,24 @@ void JavaThread::initialize() {
   _current_revision = Javelus::system_revision_number();
   _return_barrier_id = NULL;
   _return_barrier_type = _no_return_barrier;
+  _phantom_buffer_top = NULL;
+  _phantom_buffer_end = NULL;
 
   pd_initialize();
 }
 
+void JavaThread::retire_phantom_buffer() {
+  if (_phantom_buffer_top == NULL) {
+    return;
+  }
+  assert(_phantom_buffer_top <= _phantom_buffer_end, "sanity");
+  if (_phantom_buffer_top < _phantom_buffer_end) {
+    CollectedHeap::fill_with_object(_phantom_buffer_top, _phantom_buffer_end);
+  }
+  _phantom_buffer_top = NULL;
+  _phantom_buffer_end = NULL;
+}
+
 #if INCLUDE_ALL_GCS
 SATBMarkQueueSet JavaThread::_satb_mark_queue_set;
 DirtyCardQueueSet JavaThread::_dirty_card_queue_set;
@@ -1913,6 +1928,8 @@ void JavaThread::exit(bool destroy_vm, ExitType exit_type) {
     tlab().make_parsable(true);  // retire TLAB
   }
 
+  retire_phantom_buffer();
+
   if (JvmtiEnv::environments_might_exist()) {
     JvmtiExport::cleanup_thread(this);
   }
@@ -1992,6 +2009,8 @@ void JavaThread::cleanup_failed_attach_current_thread() {
     tlab().make_parsable(true);  // retire TLAB, if any
   }
 
+  retire_phantom_buffer();
+
 #if INCLUDE_ALL_GCS
   if (UseG1GC) {
     flush_barrier_queues();
@@ -3272,23 +3291,48 @@ DSUThread::DSUThread()
 : JavaThread(&dsu_thread_entry){
   _task_queue = NULL;
   _lock = DSUThread_lock;
+  _class_being_updated = NULL;
 }
 
 void DSUThread::add_task(DSUTask * task) {
   MutexLocker locker(lock());
   assert(lock()->owned_by_self(), "must own lock");
   task->set_next(NULL);
+  task->mark_queued();
 
   if (_task_queue == NULL) {
     // The compile queue is empty.
     _task_queue = task;
   } else {
-  // Append the task to the queue.
-    _task_queue->set_next(task);
+    // Append the task to the tail of the queue.
+    DSUTask* last = _task_queue;
+    while (last->next() != NULL) {
+      last = last->next();
+    }
+    last->set_next(task);
   }
   lock()->notify_all();
 }
 
+void DSUThread::coalesce_queued_tasks(DSUTask* task) {
+  MutexLocker locker(lock());
+  DSUTask* prev = NULL;
+  DSUTask* queued = _task_queue;
+  while (queued != NULL) {
+    DSUTask* next = queued->next();
+    if (task->coalesce(queued)) {
+      if (prev == NULL) {
+        _task_queue = next;
+      } else {
+        prev->set_next(next);
+      }
+    } else {
+      prev = queued;
+    }
+    queued = next;
+  }
+}
+
 void DSUThread::sleep(long timeout) {
   MutexLocker locker(lock());
   lock()->wait();
@@ -3312,6 +3356,56 @@ DSUTask* DSUThread::next_task() {
   return task;
 }
 
+DSUTask* DSUThread::next_task(long timeout) {
+
+  MutexLocker locker(lock());
+
+  if (_task_queue == NULL) {
+    lock()->wait(!Mutex::_no_safepoint_check_flag, timeout);
+  }
+
+  if (_task_queue == NULL) {
+    return NULL;
+  }
+
+  DSUTask * task = _task_queue;
+  _task_queue = _task_queue->next();
+  return task;
+}
+
+static void dsu_transformer_thread_entry(JavaThread* thread, TRAPS) {
+  Javelus::transformer_thread_loop();
+}
+
+DSUTransformerThread::DSUTransformerThread()
+: JavaThread(&dsu_transformer_thread_entry){
+  _requested_rn = Javelus::system_revision_number();
+  _lock = DSUTransformer_lock;
+}
+
+void DSUTransformerThread::request(int rn) {
+  MutexLocker locker(lock());
+  if (rn > _requested_rn) {
+    _requested_rn = rn;
+  }
+  lock()->notify_all();
+}
+
+int DSUTransformerThread::next_request(int done_rn) {
+  MutexLocker locker(lock());
+  while (_requested_rn <= done_rn) {
+    lock()->wait();
+  }
+  return _requested_rn;
+}
+
+void DSUTransformerThread::wait_for_request(int rn, long timeout) {
+  MutexLocker locker(lock());
+  if (_requested_rn <= rn) {
+    lock()->wait(false, timeout);
+  }
+}
+
 // ======= Threads ========
 
 // The Threads class links together all active threads, and provides
@@ -3687,6 +3781,9 @@ jint Threads::create_vm(JavaVMInitArgs* args, bool* canTryAgain) {
   // initialize compiler(s)
 #if defined(COMPILER1) || defined(COMPILER2) || defined(SHARK)
   CompileBroker::compilation_init();
+  if (CompileCache::is_enabled()) {
+    CompileCache::load(CHECK_0);
+  }
 #endif
 
   Javelus::dsu_thread_init();
@@ -76,6 +76,7 @@ class CompilerCounters;
 class vframeArray;
 
 class DSUThread;
+class DSUTransformerThread;
 
 class DeoptResourceMark;
 class jvmtiDeferredLocalVariableSet;
@@ -800,6 +801,11 @@ private:
   intptr_t*  _return_barrier_id;
   int        _return_barrier_type;
 
+  // Thread local buffer for phantom objects of mixed objects,
+  // see CollectedHeap::phantom_obj_allocate.
+  HeapWord*  _phantom_buffer_top;
+  HeapWord*  _phantom_buffer_end;
+
 #ifdef ASSERT
  private:
   int _java_call_counter;
@@ -1056,6 +1062,16 @@ private:
   int current_revision() const                   { return _current_revision; }
   int increment_revision()                       { return ++_current_revision; }
 
+  HeapWord* phantom_buffer_top() const           { return _phantom_buffer_top; }
+  HeapWord* phantom_buffer_end() const           { return _phantom_buffer_end; }
+  void set_phantom_buffer_top(HeapWord* top)     { _phantom_buffer_top = top; }
+  void set_phantom_buffer(HeapWord* start, HeapWord* end) {
+    _phantom_buffer_top = start;
+    _phantom_buffer_end = end;
+  }
+  // fill the unused part of the phantom buffer and drop it.
+  void retire_phantom_buffer();
+
   ThreadPriority java_priority() const;          // Read from threadObj()
 
   // Prepare thread and add to priority queue.  If a priority is
@@ -1946,6 +1962,8 @@ private:
   DSUTask * _task_queue;
   DSUTask * _task;
   Monitor * _lock;
+  // the old version of the class whose new version is being parsed
+  InstanceKlass* _class_being_updated;
   void sleep(long timeout);
 public:
   static DSUThread* current();
@@ -1955,13 +1973,39 @@ public:
   Monitor * lock() {return _lock; }
   void wakeup();
   DSUTask * next_task();
+  // returns NULL if no task arrives within timeout milliseconds
+  DSUTask * next_task(long timeout);
+  // merge queued tasks compatible with task into it
+  void coalesce_queued_tasks(DSUTask* task);
   DSUTask * task() {return _task; }
+  InstanceKlass* class_being_updated() const { return _class_being_updated; }
+  void set_class_being_updated(InstanceKlass* k) { _class_being_updated = k; }
 };
 
 inline DSUThread* DSUThread::current() {
   return JavaThread::current()->as_DSUThread();
 }
 
+// A low-priority thread that transforms stale instances of lazily
+// updated classes in the background after a DSU has been installed.
+class DSUTransformerThread : public JavaThread {
+friend class VMStructs;
+private:
+  // the latest revision whose stale instances should be transformed
+  volatile int _requested_rn;
+  Monitor * _lock;
+public:
+  DSUTransformerThread();
+  Monitor * lock() { return _lock; }
+  // request transforming stale instances dead at rn
+  void request(int rn);
+  // block until a revision newer than done_rn is requested
+  int  next_request(int done_rn);
+  // block for at most timeout milliseconds unless a revision newer than rn is requested
+  void wait_for_request(int rn, long timeout);
+  int  requested_rn() const { return _requested_rn; }
+};
+
 // The active thread queue. It also keeps track of the current used
 // thread priorities.
 class Threads: AllStatic {
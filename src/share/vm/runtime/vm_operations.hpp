@@ -100,6 +100,7 @@
   template(DSU)                                   \
   template(RelinkMixedObject)                     \
   template(UnlinkMixedObject)                     \
+  template(DSUReclaim)                            \
 
 class VM_Operation: public CHeapObj<mtInternal> {
  public:
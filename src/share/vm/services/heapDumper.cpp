@@ -30,9 +30,12 @@
 #include "memory/gcLocker.inline.hpp"
 #include "memory/genCollectedHeap.hpp"
 #include "memory/universe.hpp"
+#include "oops/markOop.hpp"
 #include "oops/objArrayKlass.hpp"
+#include "runtime/dsu.hpp"
 #include "runtime/javaCalls.hpp"
 #include "runtime/jniHandles.hpp"
+#include "runtime/mutexLocker.hpp"
 #include "runtime/reflectionUtils.hpp"
 #include "runtime/vframe.hpp"
 #include "runtime/vmThread.hpp"
@@ -41,6 +44,7 @@
 #include "services/threadService.hpp"
 #include "utilities/ostream.hpp"
 #include "utilities/macros.hpp"
+#include "utilities/workgroup.hpp"
 #if INCLUDE_ALL_GCS
 #include "gc_implementation/parallelScavenge/parallelScavengeHeap.hpp"
 #endif // INCLUDE_ALL_GCS
@@ -367,12 +371,145 @@ enum {
   INITIAL_CLASS_COUNT = 200
 };
 
-// Supports I/O operations on a dump file
+// Compresses chunks of a heap dump into gzip members. zlib is loaded on
+// first use. gzip readers decompress a sequence of members as one
+// stream, so chunks can be compressed independently and in parallel.
+
+class DumpCompressor : AllStatic {
+ private:
+  // The layout of zlib's z_stream. zlib checks it against the size
+  // passed to deflateInit2_ and fails with Z_VERSION_ERROR on a mismatch.
+  typedef struct {
+    unsigned char* next_in;
+    unsigned int   avail_in;
+    unsigned long  total_in;
+    unsigned char* next_out;
+    unsigned int   avail_out;
+    unsigned long  total_out;
+    const char*    msg;
+    void*          state;
+    void*          zalloc;
+    void*          zfree;
+    void*          opaque;
+    int            data_type;
+    unsigned long  adler;
+    unsigned long  reserved;
+  } z_stream;
+
+  enum {
+    Z_OK          = 0,
+    Z_STREAM_END  = 1,
+    Z_FINISH      = 4,
+    Z_DEFLATED    = 8,
+    gzip_window   = 15 + 16,  // a gzip header and trailer around the deflate data
+    gzip_mem      = 8,
+    gzip_overhead = 18 + 64   // gzip header and trailer, and some slack
+  };
+
+  typedef int (*deflateInit2_func_t)(z_stream* strm, int level, int method, int window_bits,
+                                     int mem_level, int strategy, const char* version,
+                                     int stream_size);
+  typedef int (*deflate_func_t)(z_stream* strm, int flush);
+  typedef int (*deflateEnd_func_t)(z_stream* strm);
+
+  static volatile int        _state;  // 0 not loaded, 1 available, -1 not available
+  static deflateInit2_func_t _deflateInit2;
+  static deflate_func_t      _deflate;
+  static deflateEnd_func_t   _deflateEnd;
+  static char                _error[256];
+
+ public:
+  // returns NULL if zlib is available, otherwise the reason why not
+  static const char* initialize();
+
+  // an upper bound of the size of a compressed chunk of len bytes
+  static size_t max_compressed_size(size_t len) {
+    return len + (len >> 12) + (len >> 14) + (len >> 25) + gzip_overhead;
+  }
+
+  // compresses len bytes into a gzip member, returns the size of the
+  // member or 0 if the compression failed
+  static size_t compress(int level, void* in, size_t len, void* out, size_t out_len);
+};
+
+volatile int                          DumpCompressor::_state = 0;
+DumpCompressor::deflateInit2_func_t   DumpCompressor::_deflateInit2 = NULL;
+DumpCompressor::deflate_func_t        DumpCompressor::_deflate = NULL;
+DumpCompressor::deflateEnd_func_t     DumpCompressor::_deflateEnd = NULL;
+char                                  DumpCompressor::_error[256];
+
+const char* DumpCompressor::initialize() {
+  // Heap dumps are serialized by the VM operation, and loading zlib
+  // twice is harmless, so no lock is needed here.
+  if (_state == 0) {
+#if defined(_WINDOWS)
+    const char* zlib_name = "zlib1.dll";
+#elif defined(__APPLE__)
+    const char* zlib_name = "libz.1.dylib";
+#else
+    const char* zlib_name = "libz.so.1";
+#endif
+    char ebuf[128];
+    void* handle = os::dll_load(zlib_name, ebuf, sizeof(ebuf));
+    if (handle != NULL) {
+      _deflateInit2 = CAST_TO_FN_PTR(deflateInit2_func_t, os::dll_lookup(handle, "deflateInit2_"));
+      _deflate      = CAST_TO_FN_PTR(deflate_func_t,      os::dll_lookup(handle, "deflate"));
+      _deflateEnd   = CAST_TO_FN_PTR(deflateEnd_func_t,   os::dll_lookup(handle, "deflateEnd"));
+    }
+    if (_deflateInit2 != NULL && _deflate != NULL && _deflateEnd != NULL) {
+      _state = 1;
+    } else {
+      jio_snprintf(_error, sizeof(_error), "gzip compression is not available: %s",
+                   handle == NULL ? ebuf : "zlib entry points not found");
+      _state = -1;
+    }
+  }
+  return _state == 1 ? NULL : _error;
+}
+
+size_t DumpCompressor::compress(int level, void* in, size_t len, void* out, size_t out_len) {
+  assert(_state == 1, "zlib not loaded");
+  assert(len <= max_juint && out_len <= max_juint, "chunk too large");
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (_deflateInit2(&stream, level, Z_DEFLATED, gzip_window, gzip_mem, 0 /* default strategy */,
+                    "1.2.3", (int)sizeof(stream)) != Z_OK) {
+    return 0;
+  }
+
+  stream.next_in   = (unsigned char*)in;
+  stream.avail_in  = (unsigned int)len;
+  stream.next_out  = (unsigned char*)out;
+  stream.avail_out = (unsigned int)out_len;
+
+  int result = _deflate(&stream, Z_FINISH);
+  size_t compressed = (size_t)stream.total_out;
+  _deflateEnd(&stream);
+
+  return result == Z_STREAM_END ? compressed : 0;
+}
+
+// Supports I/O operations on a dump file.
+//
+// The sub-records of a segmented heap dump are written through segment
+// writers instead. A segment writer buffers whole sub-records in memory
+// and writes them to the dump file as one HPROF_HEAP_DUMP_SEGMENT record
+// once the segment is full, so several GC workers can each fill segments
+// of their own, and no record length has to be fixed up in the file
+// later. A sub-record larger than a segment is written through to the
+// dump file as a segment of its own, see start_sub_record.
+//
+// If the dump file is compressed, every buffer written to it is a gzip
+// member of its own. Segment writers compress their segments before
+// taking the file lock.
 
 class DumpWriter : public StackObj {
  private:
   enum {
-    io_buffer_size  = 8*M
+    io_buffer_size      = 8*M,
+    max_segment_size    = 1*M,
+    segment_header_size = 1 + 4 + 4  // tag, ticks and length
   };
 
   int _fd;              // file descriptor (-1 if dump file not open)
@@ -384,6 +521,16 @@ class DumpWriter : public StackObj {
 
   char* _error;   // error message when I/O fails
 
+  int _compression_level;   // gzip level of the dump file, 0 if not compressed
+  char* _compressed;        // buffer for compressed chunks
+  size_t _compressed_size;
+
+  // segment writers only
+  DumpWriter* _file_writer; // the writer of the dump file
+  Mutex* _file_lock;        // serializes writes to the dump file
+  size_t _segment_size;     // segments are flushed once they reach this size
+  bool _in_large_record;    // a sub-record is being written through
+
   void set_file_descriptor(int fd)              { _fd = fd; }
   int file_descriptor() const                   { return _fd; }
 
@@ -394,15 +541,27 @@ class DumpWriter : public StackObj {
 
   void set_error(const char* error)             { _error = (char*)os::strdup(error); }
 
+  bool is_segment_writer() const                { return _file_writer != NULL; }
+
   // all I/O go through this function
   void write_internal(void* s, int len);
+  void write_file(void* s, int len);
+
+  bool ensure_compressed_size(size_t len);
+  void write_to_segment(void* s, int len);
+  void flush_segment();
+  void fail(const char* error);
 
  public:
-  DumpWriter(const char* path);
+  DumpWriter(const char* path, int compression_level);
+  DumpWriter(DumpWriter* file_writer, Mutex* file_lock);
   ~DumpWriter();
 
   void close();
-  bool is_open() const                  { return file_descriptor() >= 0; }
+  bool is_open() const {
+    return is_segment_writer() ? _file_writer->is_open() : file_descriptor() >= 0;
+  }
+  bool is_compressed() const            { return _compression_level > 0; }
   void flush();
 
   // total number of bytes written to the disk
@@ -420,6 +579,17 @@ class DumpWriter : public StackObj {
   jlong current_offset();
   void seek_to_offset(jlong pos);
 
+  // writes a segment or a compressed chunk of a segment writer, with the
+  // file lock held
+  void write_segment(void* s, int len, bool compressed);
+
+  // Sub-record boundaries of a segmented heap dump. start_sub_record is
+  // called with the size of a sub-record that may be larger than a
+  // segment, end_sub_record after each sub-record or group of small
+  // sub-records. Both do nothing for the writer of the dump file.
+  void start_sub_record(size_t len);
+  void end_sub_record();
+
   // writer functions
   void write_raw(void* s, int len);
   void write_u1(u1 x)                   { write_raw((void*)&x, 1); }
@@ -432,7 +602,7 @@ class DumpWriter : public StackObj {
   void write_id(u4 x);
 };
 
-DumpWriter::DumpWriter(const char* path) {
+DumpWriter::DumpWriter(const char* path, int compression_level) {
   // try to allocate an I/O buffer of io_buffer_size. If there isn't
   // sufficient memory then reduce size until we can allocate something.
   _size = io_buffer_size;
@@ -446,6 +616,21 @@ DumpWriter::DumpWriter(const char* path) {
   _pos = 0;
   _error = NULL;
   _bytes_written = 0L;
+  _compression_level = compression_level;
+  _compressed = NULL;
+  _compressed_size = 0;
+  _file_writer = NULL;
+  _file_lock = NULL;
+  _segment_size = 0;
+  _in_large_record = false;
+
+  // compression needs the I/O buffer and a buffer for compressed chunks
+  if (is_compressed() && (_buffer == NULL || !ensure_compressed_size(_size))) {
+    _error = (char*)os::strdup("not enough memory for compressing the dump file");
+    _fd = -1;
+    return;
+  }
+
   _fd = os::create_binary_file(path, false);    // don't replace existing file
 
   // if the open failed we record the error
@@ -454,17 +639,49 @@ DumpWriter::DumpWriter(const char* path) {
   }
 }
 
+DumpWriter::DumpWriter(DumpWriter* file_writer, Mutex* file_lock) {
+  _fd = -1;
+  _bytes_written = 0L;
+  _segment_size = MIN2((size_t)HeapDumpSegmentSize, (size_t)max_segment_size);
+  _size = (int)_segment_size;
+  _buffer = (char*)os::malloc(_size, mtInternal);
+  _error = NULL;
+  _compression_level = file_writer->_compression_level;
+  _compressed = NULL;
+  _compressed_size = 0;
+  _file_writer = file_writer;
+  _file_lock = file_lock;
+  _in_large_record = false;
+
+  if (_buffer == NULL) {
+    _size = 0;
+    fail("not enough memory for a heap dump segment");
+  }
+
+  // the segment header, its length is fixed up when the segment is flushed
+  _pos = 0;
+  if (_buffer != NULL) {
+    _buffer[0] = (char)HPROF_HEAP_DUMP_SEGMENT;
+    memset(_buffer + 1, 0, segment_header_size - 1);
+    _pos = segment_header_size;
+  }
+}
+
 DumpWriter::~DumpWriter() {
-  // flush and close dump file
-  if (is_open()) {
+  if (is_segment_writer()) {
+    flush();
+  } else if (is_open()) {
+    // flush and close dump file
     close();
   }
   if (_buffer != NULL) os::free(_buffer);
+  if (_compressed != NULL) os::free(_compressed);
   if (_error != NULL) os::free(_error);
 }
 
 // closes dump file (if open)
 void DumpWriter::close() {
+  assert(!is_segment_writer(), "segment writers do not own the dump file");
   // flush and close dump file
   if (is_open()) {
     flush();
@@ -473,8 +690,54 @@ void DumpWriter::close() {
   }
 }
 
-// write directly to the file
+// records a failure of a segment writer in the writer of the dump file
+void DumpWriter::fail(const char* error) {
+  assert(is_segment_writer(), "only for segment writers");
+  MutexLockerEx ml(_file_lock, Mutex::_no_safepoint_check_flag);
+  if (_file_writer->is_open()) {
+    _file_writer->set_error(error);
+    ::close(_file_writer->file_descriptor());
+    _file_writer->set_file_descriptor(-1);
+  }
+}
+
+bool DumpWriter::ensure_compressed_size(size_t len) {
+  size_t needed = DumpCompressor::max_compressed_size(len);
+  if (_compressed_size < needed) {
+    char* compressed = (char*)os::realloc(_compressed, needed, mtInternal);
+    if (compressed == NULL) {
+      return false;
+    }
+    _compressed = compressed;
+    _compressed_size = needed;
+  }
+  return true;
+}
+
+// write to the file, compressing each chunk of at most buffer_size() bytes
 void DumpWriter::write_internal(void* s, int len) {
+  if (!is_compressed()) {
+    write_file(s, len);
+    return;
+  }
+  char* p = (char*)s;
+  while (len > 0 && is_open()) {
+    int chunk = MIN2(len, buffer_size());
+    size_t n = DumpCompressor::compress(_compression_level, p, chunk, _compressed, _compressed_size);
+    if (n == 0) {
+      set_error("gzip compression failed");
+      ::close(file_descriptor());
+      set_file_descriptor(-1);
+      return;
+    }
+    write_file(_compressed, (int)n);
+    p += chunk;
+    len -= chunk;
+  }
+}
+
+// write directly to the file
+void DumpWriter::write_file(void* s, int len) {
   if (is_open()) {
     int n = ::write(file_descriptor(), s, len);
     if (n > 0) {
@@ -494,6 +757,10 @@ void DumpWriter::write_internal(void* s, int len) {
 
 // write raw bytes
 void DumpWriter::write_raw(void* s, int len) {
+  if (is_segment_writer()) {
+    write_to_segment(s, len);
+    return;
+  }
   if (is_open()) {
     // flush buffer to make toom
     if ((position()+ len) >= buffer_size()) {
@@ -513,12 +780,108 @@ void DumpWriter::write_raw(void* s, int len) {
 
 // flush any buffered bytes to the file
 void DumpWriter::flush() {
+  if (is_segment_writer()) {
+    flush_segment();
+    return;
+  }
   if (is_open() && position() > 0) {
     write_internal(buffer(), position());
     set_position(0);
   }
 }
 
+void DumpWriter::write_segment(void* s, int len, bool compressed) {
+  assert(!is_segment_writer(), "only for the writer of the dump file");
+  assert(compressed == is_compressed(), "compressed segments only go to compressed files");
+  flush();
+  if (compressed) {
+    write_file(s, len);
+  } else {
+    write_internal(s, len);
+  }
+}
+
+// Sub-records of a segment are kept together in the buffer, which grows
+// if a sub-record does not fit.
+void DumpWriter::write_to_segment(void* s, int len) {
+  if (_in_large_record) {
+    _file_writer->write_raw(s, len);
+    return;
+  }
+  if (!is_open()) {
+    return;
+  }
+  if (position() + len > buffer_size()) {
+    int size = MAX2(buffer_size() * 2, position() + len);
+    char* buf = (char*)os::realloc(_buffer, size, mtInternal);
+    if (buf == NULL) {
+      fail("not enough memory for a heap dump segment");
+      return;
+    }
+    _buffer = buf;
+    _size = size;
+  }
+  memcpy(buffer() + position(), s, len);
+  set_position(position() + len);
+}
+
+void DumpWriter::flush_segment() {
+  if (position() <= segment_header_size || !is_open()) {
+    return;
+  }
+
+  // fix up the length of the segment
+  Bytes::put_Java_u4((address)(buffer() + 5), (u4)(position() - segment_header_size));
+
+  void* data = buffer();
+  int len = position();
+  if (is_compressed()) {
+    size_t n = 0;
+    if (ensure_compressed_size(len)) {
+      n = DumpCompressor::compress(_compression_level, data, len, _compressed, _compressed_size);
+    }
+    if (n == 0) {
+      fail("gzip compression failed");
+      return;
+    }
+    data = _compressed;
+    len = (int)n;
+  }
+
+  {
+    MutexLockerEx ml(_file_lock, Mutex::_no_safepoint_check_flag);
+    _file_writer->write_segment(data, len, is_compressed());
+  }
+  set_position(segment_header_size);
+}
+
+void DumpWriter::start_sub_record(size_t len) {
+  if (!is_segment_writer() || len <= _segment_size) {
+    return;
+  }
+  // a large sub-record is written through as a segment of its own
+  if (len > max_juint) {
+    warning("record is too large");
+  }
+  flush_segment();
+  _file_lock->lock_without_safepoint_check();
+  _in_large_record = true;
+  _file_writer->write_u1(HPROF_HEAP_DUMP_SEGMENT);
+  _file_writer->write_u4(0); // current ticks
+  _file_writer->write_u4((u4)len);
+}
+
+void DumpWriter::end_sub_record() {
+  if (!is_segment_writer()) {
+    return;
+  }
+  if (_in_large_record) {
+    _in_large_record = false;
+    _file_lock->unlock();
+  } else if ((size_t)position() >= _segment_size) {
+    flush_segment();
+  }
+}
 
 jlong DumpWriter::current_offset() {
   if (is_open()) {
@@ -610,6 +973,8 @@ class DumperSupport : AllStatic {
 
   // returns the size of the instance of the given class
   static u4 instance_size(Klass* k);
+  // returns the object holding the fields of a mixed object
+  static oop logical_object(oop o);
 
   // dump a jfloat
   static void dump_float(DumpWriter* writer, jfloat f);
@@ -625,6 +990,8 @@ class DumperSupport : AllStatic {
   static void dump_instance_field_descriptors(DumpWriter* writer, Klass* k);
   // creates HPROF_GC_INSTANCE_DUMP record for the given object
   static void dump_instance(DumpWriter* writer, oop o);
+  // returns the size of the sub-record dumped for the given object
+  static size_t sub_record_size(oop o);
   // creates HPROF_GC_CLASS_DUMP record for the given class and each of its
   // array classes
   static void dump_class_and_array_classes(DumpWriter* writer, Klass* k);
@@ -832,15 +1199,40 @@ void DumperSupport::dump_static_fields(DumpWriter* writer, Klass* k) {
   }
 }
 
+// returns the object holding the logical fields of the given object, the
+// phantom object of a mixed object or the object itself
+oop DumperSupport::logical_object(oop o) {
+  markOop mark = o->mark();
+  if (mark->is_mixed_object()) {
+    return (oop)mark->decode_phantom_object_pointer();
+  }
+  return o;
+}
+
 // dump the raw values of the instance fields of the given object
 void DumperSupport::dump_instance_fields(DumpWriter* writer, oop o) {
   HandleMark hm;
-  instanceKlassHandle ikh = instanceKlassHandle(Thread::current(), o->klass());
+  oop phantom = logical_object(o);
+  instanceKlassHandle ikh = instanceKlassHandle(Thread::current(), phantom->klass());
+  Array<u1>* inplace_fields = phantom == o ? (Array<u1>*)NULL : ikh->inplace_fields();
 
   for (FieldStream fld(ikh, false, false); !fld.eos(); fld.next()) {
     if (!fld.access_flags().is_static()) {
       Symbol* sig = fld.signature();
-      address addr = (address)o + fld.offset();
+      address addr = (address)phantom + fld.offset();
+
+      // fields of a mixed object that are still in the inplace object
+      if (inplace_fields != NULL) {
+        u4 offset = (u4)fld.offset();
+        for (int i = 0; i < inplace_fields->length(); i += DSUClass::next_inplace_field) {
+          u4 start = build_u4_from(inplace_fields->adr_at(i + DSUClass::inplace_field_offset));
+          u4 length = build_u4_from(inplace_fields->adr_at(i + DSUClass::inplace_field_length));
+          if (offset >= start && offset < start + length) {
+            addr = (address)o + fld.offset();
+            break;
+          }
+        }
+      }
 
       dump_field_value(writer, sig->byte_at(0), addr);
     }
@@ -873,7 +1265,8 @@ void DumperSupport::dump_instance_field_descriptors(DumpWriter* writer, Klass* k
 
 // creates HPROF_GC_INSTANCE_DUMP record for the given object
 void DumperSupport::dump_instance(DumpWriter* writer, oop o) {
-  Klass* k = o->klass();
+  // a mixed object is dumped as an instance of its logical class
+  Klass* k = logical_object(o)->klass();
 
   writer->write_u1(HPROF_GC_INSTANCE_DUMP);
   writer->write_objectID(o);
@@ -993,6 +1386,22 @@ void DumperSupport::dump_basic_type_array_class(DumpWriter* writer, Klass* k) {
   }
 }
 
+// returns the size of the sub-record dumped for the given object
+size_t DumperSupport::sub_record_size(oop o) {
+  if (o->is_instance()) {
+    // tag, object ID, stack trace serial number, class ID, size and fields
+    return 1 + 2 * sizeof(address) + 4 + 4 + instance_size(logical_object(o)->klass());
+  } else if (o->is_objArray()) {
+    // tag, array ID, stack trace serial number, length, class ID and elements
+    return 1 + 2 * sizeof(address) + 4 + 4 + (size_t)objArrayOop(o)->length() * sizeof(address);
+  } else {
+    assert(o->is_typeArray(), "must be a type array");
+    BasicType type = TypeArrayKlass::cast(o->klass())->element_type();
+    // tag, array ID, stack trace serial number, length, type and elements
+    return 1 + sizeof(address) + 4 + 4 + 1 + (size_t)typeArrayOop(o)->length() * type2aelembytes(type);
+  }
+}
+
 // creates HPROF_GC_OBJ_ARRAY_DUMP record for the given object array
 void DumperSupport::dump_object_array(DumpWriter* writer, objArrayOop array) {
 
@@ -1255,18 +1664,12 @@ class VM_HeapDumper;
 
 class HeapObjectDumper : public ObjectClosure {
  private:
-  VM_HeapDumper* _dumper;
   DumpWriter* _writer;
 
-  VM_HeapDumper* dumper()               { return _dumper; }
   DumpWriter* writer()                  { return _writer; }
 
-  // used to indicate that a record has been writen
-  void mark_end_of_record();
-
  public:
-  HeapObjectDumper(VM_HeapDumper* dumper, DumpWriter* writer) {
-    _dumper = dumper;
+  HeapObjectDumper(DumpWriter* writer) {
     _writer = writer;
   }
 
@@ -1285,25 +1688,47 @@ void HeapObjectDumper::do_object(oop o) {
     }
   }
 
-  // create a HPROF_GC_INSTANCE record for each object
+  if (!o->is_instance() && !o->is_objArray() && !o->is_typeArray()) {
+    return;
+  }
+
+  writer()->start_sub_record(DumperSupport::sub_record_size(o));
   if (o->is_instance()) {
+    // create a HPROF_GC_INSTANCE record for each object
     DumperSupport::dump_instance(writer(), o);
-    mark_end_of_record();
-  } else {
+  } else if (o->is_objArray()) {
     // create a HPROF_GC_OBJ_ARRAY_DUMP record for each object array
-    if (o->is_objArray()) {
-      DumperSupport::dump_object_array(writer(), objArrayOop(o));
-      mark_end_of_record();
-    } else {
-      // create a HPROF_GC_PRIM_ARRAY_DUMP record for each type array
-      if (o->is_typeArray()) {
-        DumperSupport::dump_prim_array(writer(), typeArrayOop(o));
-        mark_end_of_record();
-      }
-    }
+    DumperSupport::dump_object_array(writer(), objArrayOop(o));
+  } else {
+    // create a HPROF_GC_PRIM_ARRAY_DUMP record for each type array
+    DumperSupport::dump_prim_array(writer(), typeArrayOop(o));
   }
+  writer()->end_sub_record();
 }
 
+// Dumps the objects of the heap on the GC worker threads. Each worker
+// fills heap dump segments of its own.
+class ParHeapDumpTask : public AbstractGangTask {
+ private:
+  ParallelObjectIterator* _poi;
+  DumpWriter* _file_writer;
+  Mutex* _file_lock;
+
+ public:
+  ParHeapDumpTask(ParallelObjectIterator* poi, DumpWriter* file_writer, Mutex* file_lock) :
+    AbstractGangTask("Heap Dump"),
+    _poi(poi),
+    _file_writer(file_writer),
+    _file_lock(file_lock) { }
+
+  void work(uint worker_id) {
+    ResourceMark rm;
+    DumpWriter segment_writer(_file_writer, _file_lock);
+    HeapObjectDumper obj_dumper(&segment_writer);
+    _poi->object_iterate(&obj_dumper, worker_id);
+  }
+};
+
 // The VM operation that performs the heap dump
 class VM_HeapDumper : public VM_GC_Operation {
  private:
@@ -1362,14 +1787,17 @@ class VM_HeapDumper : public VM_GC_Operation {
   // HPROF_TRACE and HPROF_FRAME records
   void dump_stack_traces();
 
-  // writes a HPROF_HEAP_DUMP or HPROF_HEAP_DUMP_SEGMENT record
+  // writes a HPROF_HEAP_DUMP record
   void write_dump_header();
 
   // fixes up the length of the current dump record
   void write_current_dump_record_length();
 
-  // fixes up the current dump record )and writes HPROF_HEAP_DUMP_END
-  // record in the case of a segmented heap dump)
+  // writes the sub-records of the heap dump
+  void dump_heap(ParallelObjectIterator* poi, Mutex* file_lock);
+
+  // fixes up the length of the HPROF_HEAP_DUMP record, or writes the
+  // HPROF_HEAP_DUMP_END record in the case of a segmented heap dump
   void end_of_dump();
 
  public:
@@ -1409,8 +1837,6 @@ class VM_HeapDumper : public VM_GC_Operation {
   }
 
   VMOp_Type type() const { return VMOp_HeapDumper; }
-  // used to mark sub-record boundary
-  void check_segment_length();
   void doit();
 };
 
@@ -1426,14 +1852,11 @@ void VM_HeapDumper::set_dump_start(jlong pos) {
   _dump_start = pos;
 }
 
- // writes a HPROF_HEAP_DUMP or HPROF_HEAP_DUMP_SEGMENT record
+ // writes a HPROF_HEAP_DUMP record
 void VM_HeapDumper::write_dump_header() {
   if (writer()->is_open()) {
-    if (is_segmented_dump()) {
-      writer()->write_u1(HPROF_HEAP_DUMP_SEGMENT);
-    } else {
-      writer()->write_u1(HPROF_HEAP_DUMP);
-    }
+    assert(!is_segmented_dump(), "segments are written by segment writers");
+    writer()->write_u1(HPROF_HEAP_DUMP);
     writer()->write_u4(0); // current ticks
 
     // record the starting position for the dump (its length will be fixed up later)
@@ -1471,45 +1894,20 @@ void VM_HeapDumper::write_current_dump_record_length() {
   }
 }
 
-// used on a sub-record boundary to check if we need to start a
-// new segment.
-void VM_HeapDumper::check_segment_length() {
-  if (writer()->is_open()) {
-    if (is_segmented_dump()) {
-      // don't use current_offset that would be too expensive on a per record basis
-      jlong dump_end = writer()->bytes_written() + writer()->bytes_unwritten();
-      assert(dump_end == writer()->current_offset(), "checking");
-      jlong dump_len = (dump_end - dump_start() - 4);
-      assert(dump_len >= 0 && dump_len <= max_juint, "bad dump length");
-
-      if (dump_len > (jlong)HeapDumpSegmentSize) {
-        write_current_dump_record_length();
-        write_dump_header();
-      }
-    }
-  }
-}
-
-// fixes up the current dump record )and writes HPROF_HEAP_DUMP_END
-// record in the case of a segmented heap dump)
+// fixes up the length of the HPROF_HEAP_DUMP record, or writes the
+// HPROF_HEAP_DUMP_END record in the case of a segmented heap dump
 void VM_HeapDumper::end_of_dump() {
   if (writer()->is_open()) {
-    write_current_dump_record_length();
-
-    // for segmented dump we write the end record
     if (is_segmented_dump()) {
       writer()->write_u1(HPROF_HEAP_DUMP_END);
       writer()->write_u4(0);
       writer()->write_u4(0);
+    } else {
+      write_current_dump_record_length();
     }
   }
 }
 
-// marks sub-record boundary
-void HeapObjectDumper::mark_end_of_record() {
-  dumper()->check_segment_length();
-}
-
 // writes a HPROF_LOAD_CLASS record for the class (and each of its
 // array classes)
 void VM_HeapDumper::do_load_class(Klass* k) {
@@ -1547,6 +1945,7 @@ void VM_HeapDumper::do_load_class(Klass* k) {
 void VM_HeapDumper::do_class_dump(Klass* k) {
   if (k->oop_is_instance()) {
     DumperSupport::dump_class_and_array_classes(writer(), k);
+    writer()->end_sub_record();
   }
 }
 
@@ -1554,6 +1953,7 @@ void VM_HeapDumper::do_class_dump(Klass* k) {
 // array (and each multi-dimensional array too)
 void VM_HeapDumper::do_basic_type_array_class_dump(Klass* k) {
   DumperSupport::dump_basic_type_array_class(writer(), k);
+  writer()->end_sub_record();
 }
 
 // Walk the stack of the given thread.
@@ -1655,6 +2055,7 @@ void VM_HeapDumper::do_threads() {
     int num_frames = do_thread(thread, thread_serial_num);
     assert(num_frames == _stack_traces[i]->get_stack_depth(),
            "total number of Java frames not matched");
+    writer()->end_sub_record();
   }
 }
 
@@ -1681,6 +2082,12 @@ void VM_HeapDumper::do_threads() {
 // HPROF_GC_INSTANCE_DUMP, HPROF_GC_OBJ_ARRAY_DUMP, and HPROF_GC_PRIM_ARRAY_DUMP
 // records as we go. Once that is done we write records for some of the GC
 // roots.
+//
+// Large heaps, heaps dumped by several GC worker threads and compressed
+// dumps are written as a segmented heap dump instead, where the
+// sub-records are spread over HPROF_HEAP_DUMP_SEGMENT records that are
+// terminated by a HPROF_HEAP_DUMP_END record. The segments are buffered
+// by segment writers, so their lengths are known when they are written.
 
 void VM_HeapDumper::doit() {
 
@@ -1703,10 +2110,16 @@ void VM_HeapDumper::doit() {
   set_global_dumper();
   set_global_writer();
 
-  // Write the file header - use 1.0.2 for large heaps, otherwise 1.0.1
+  // dump the objects on the GC worker threads if the heap supports it
+  ParallelObjectIterator* poi = NULL;
+  if (ParallelHeapDump && ch->safepoint_workers_count() > 1) {
+    poi = ch->parallel_object_iterator(ch->safepoint_workers_count());
+  }
+
+  // Write the file header - use 1.0.2 for segmented dumps, otherwise 1.0.1
   size_t used = ch->used();
   const char* header;
-  if (used > (size_t)SegmentedHeapDumpThreshold) {
+  if (used > (size_t)SegmentedHeapDumpThreshold || writer()->is_compressed() || poi != NULL) {
     set_segmented_dump();
     header = "JAVA PROFILE 1.0.2";
   } else {
@@ -1731,48 +2144,72 @@ void VM_HeapDumper::doit() {
   // this must be called after _klass_map is built when iterating the classes above.
   dump_stack_traces();
 
-  // write HPROF_HEAP_DUMP or HPROF_HEAP_DUMP_SEGMENT
-  write_dump_header();
+  if (is_segmented_dump()) {
+    // the sub-records written by the VM thread go through a segment
+    // writer of its own
+    Mutex file_lock(Mutex::leaf, "Heap dump file lock");
+    {
+      DumpWriter segment_writer(_local_writer, &file_lock);
+      _global_writer = &segment_writer;
+      dump_heap(poi, &file_lock);
+      _global_writer = _local_writer;
+    }
+  } else {
+    // write HPROF_HEAP_DUMP
+    write_dump_header();
+    dump_heap(NULL, NULL);
+  }
 
+  if (poi != NULL) {
+    delete poi;
+  }
+
+  // fixes up the length of the dump record. In the case of a segmented
+  // heap then the HPROF_HEAP_DUMP_END record is written.
+  end_of_dump();
+
+  // Now we clear the global variables, so that a future dumper might run.
+  clear_global_dumper();
+  clear_global_writer();
+}
+
+// writes the sub-records of the heap dump. After each sub-record, or
+// group of small sub-records, end_sub_record is invoked. When generating
+// a segmented heap dump this allows the segment writers to write out a
+// segment that exceeds its size.
+void VM_HeapDumper::dump_heap(ParallelObjectIterator* poi, Mutex* file_lock) {
   // Writes HPROF_GC_CLASS_DUMP records
   ClassLoaderDataGraph::classes_do(&do_class_dump);
   Universe::basic_type_classes_do(&do_basic_type_array_class_dump);
-  check_segment_length();
 
   // writes HPROF_GC_INSTANCE_DUMP records.
-  // After each sub-record is written check_segment_length will be invoked. When
-  // generated a segmented heap dump this allows us to check if the current
-  // segment exceeds a threshold and if so, then a new segment is started.
   // The HPROF_GC_CLASS_DUMP and HPROF_GC_INSTANCE_DUMP are the vast bulk
   // of the heap dump.
-  HeapObjectDumper obj_dumper(this, writer());
-  Universe::heap()->safe_object_iterate(&obj_dumper);
+  if (poi != NULL) {
+    ParHeapDumpTask task(poi, _local_writer, file_lock);
+    Universe::heap()->run_task(&task);
+  } else {
+    HeapObjectDumper obj_dumper(writer());
+    Universe::heap()->safe_object_iterate(&obj_dumper);
+  }
 
   // HPROF_GC_ROOT_THREAD_OBJ + frames + jni locals
   do_threads();
-  check_segment_length();
 
   // HPROF_GC_ROOT_MONITOR_USED
   MonitorUsedDumper mon_dumper(writer());
   ObjectSynchronizer::oops_do(&mon_dumper);
-  check_segment_length();
+  writer()->end_sub_record();
 
   // HPROF_GC_ROOT_JNI_GLOBAL
   JNIGlobalsDumper jni_dumper(writer());
   JNIHandles::oops_do(&jni_dumper);
-  check_segment_length();
+  writer()->end_sub_record();
 
   // HPROF_GC_ROOT_STICKY_CLASS
   StickyClassDumper class_dumper(writer());
   SystemDictionary::always_strong_classes_do(&class_dumper);
-
-  // fixes up the length of the dump record. In the case of a segmented
-  // heap then the HPROF_HEAP_DUMP_END record is also written.
-  end_of_dump();
-
-  // Now we clear the global variables, so that a future dumper might run.
-  clear_global_dumper();
-  clear_global_writer();
+  writer()->end_sub_record();
 }
 
 void VM_HeapDumper::dump_stack_traces() {
@@ -1831,9 +2268,26 @@ void VM_HeapDumper::dump_stack_traces() {
 
 // dump the heap to given path.
 PRAGMA_FORMAT_NONLITERAL_IGNORED_EXTERNAL
-int HeapDumper::dump(const char* path) {
+int HeapDumper::dump(const char* path, int compression_level) {
   assert(path != NULL && strlen(path) > 0, "path missing");
 
+  // check the compression before the dump file is created
+  if (compression_level != 0) {
+    const char* compression_error = NULL;
+    if (compression_level < 1 || compression_level > 9) {
+      compression_error = "compression level must be between 1 and 9";
+    } else {
+      compression_error = DumpCompressor::initialize();
+    }
+    if (compression_error != NULL) {
+      set_error((char*)compression_error);
+      if (print_to_tty()) {
+        tty->print_cr("Unable to create %s: %s", path, compression_error);
+      }
+      return -1;
+    }
+  }
+
   // print message in interactive case
   if (print_to_tty()) {
     tty->print_cr("Dumping heap to %s ...", path);
@@ -1841,7 +2295,7 @@ int HeapDumper::dump(const char* path) {
   }
 
   // create the dump writer. If the file can be opened then bail
-  DumpWriter writer(path);
+  DumpWriter writer(path, compression_level);
   if (!writer.is_open()) {
     set_error(writer.error());
     if (print_to_tty()) {
@@ -1938,7 +2392,7 @@ void HeapDumper::dump_heap(bool oome) {
   const int max_digit_chars = 20;
 
   const char* dump_file_name = "java_pid";
-  const char* dump_file_ext  = ".hprof";
+  const char* dump_file_ext  = HeapDumpGzipLevel > 0 ? ".hprof.gz" : ".hprof";
 
   // The dump file defaults to java_pid<pid>.hprof in the current working
   // directory. HeapDumpPath=<file> can be used to specify an alternative
@@ -2006,6 +2460,6 @@ void HeapDumper::dump_heap(bool oome) {
   HeapDumper dumper(false /* no GC before heap dump */,
                     true  /* send to tty */,
                     oome  /* pass along out-of-memory-error flag */);
-  dumper.dump(my_path);
+  dumper.dump(my_path, (int)HeapDumpGzipLevel);
   os::free(my_path);
 }
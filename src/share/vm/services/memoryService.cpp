@@ -25,6 +25,7 @@
 #include "precompiled.hpp"
 #include "classfile/systemDictionary.hpp"
 #include "classfile/vmSymbols.hpp"
+#include "code/codeBlob.hpp"
 #include "gc_implementation/shared/mutableSpace.hpp"
 #include "memory/collectorPolicy.hpp"
 #include "memory/defNewGeneration.hpp"
@@ -63,7 +64,9 @@ GrowableArray<MemoryManager*>* MemoryService::_managers_list =
 
 GCMemoryManager* MemoryService::_minor_gc_manager      = NULL;
 GCMemoryManager* MemoryService::_major_gc_manager      = NULL;
-MemoryPool*      MemoryService::_code_heap_pool        = NULL;
+GrowableArray<MemoryPool*>* MemoryService::_code_heap_pools =
+  new (ResourceObj::C_HEAP, mtInternal) GrowableArray<MemoryPool*>(CodeBlobType::All, true);
+MemoryManager*   MemoryService::_code_cache_manager    = NULL;
 MemoryPool*      MemoryService::_metaspace_pool        = NULL;
 MemoryPool*      MemoryService::_compressed_class_pool = NULL;
 
@@ -391,15 +394,19 @@ void MemoryService::add_g1OldGen_memory_pool(G1CollectedHeap* g1h,
 }
 #endif // INCLUDE_ALL_GCS
 
+// One pool per code heap, all managed by the code cache memory manager
 void MemoryService::add_code_heap_memory_pool(CodeHeap* heap) {
-  _code_heap_pool = new CodeHeapPool(heap,
-                                     "Code Cache",
-                                     true /* support_usage_threshold */);
-  MemoryManager* mgr = MemoryManager::get_code_cache_memory_manager();
-  mgr->add_pool(_code_heap_pool);
+  MemoryPool* code_heap_pool = new CodeHeapPool(heap,
+                                                heap->name(),
+                                                true /* support_usage_threshold */);
+  if (_code_cache_manager == NULL) {
+    _code_cache_manager = MemoryManager::get_code_cache_memory_manager();
+    _managers_list->append(_code_cache_manager);
+  }
+  _code_cache_manager->add_pool(code_heap_pool);
 
-  _pools_list->append(_code_heap_pool);
-  _managers_list->append(mgr);
+  _code_heap_pools->append(code_heap_pool);
+  _pools_list->append(code_heap_pool);
 }
 
 void MemoryService::add_metaspace_memory_pools() {
@@ -154,6 +154,137 @@ template <MEMFLAGS F> void BasicHashtable<F>::free_buckets() {
   }
 }
 
+// The table grows once it holds more than TableGrowthLoadFactor entries per
+// bucket on average.  The grown buckets are only installed at a safepoint,
+// so growing is not started at a safepoint: the GC walks the buckets directly.
+
+template <class T, MEMFLAGS F> bool RehashableHashtable<T, F>::should_grow() {
+  if (TableGrowthLoadFactor == 0 || DumpSharedSpaces || is_growing() ||
+      SafepointSynchronize::is_at_safepoint()) {
+    return false;
+  }
+  return 2 * this->table_size() <= max_grown_size &&
+         (uintx)this->number_of_entries() > (uintx)this->table_size() * TableGrowthLoadFactor;
+}
+
+template <class T, MEMFLAGS F> void RehashableHashtable<T, F>::start_growth() {
+  assert(!is_growing(), "already growing");
+  const int grown_size = 2 * this->table_size();
+  HashtableBucket<F>* grown = NEW_C_HEAP_ARRAY2(HashtableBucket<F>, grown_size, F, CURRENT_PC);
+  for (int index = 0; index < grown_size; index++) {
+    grown[index].clear();
+  }
+  _grow_index = 0;
+  // The cleared buckets must be visible before any bucket is marked as moved.
+  OrderAccess::release_store_ptr(&_grown_buckets, grown);
+}
+
+// Move up to 'limit' buckets to the grown buckets.  An entry in old bucket i
+// goes to grown bucket i or i + table_size(), and no other old bucket feeds
+// these two, so they can be published as soon as bucket i has been split.
+// Returns true once every bucket has been moved.
+
+template <class T, MEMFLAGS F> bool RehashableHashtable<T, F>::grow_step(int limit) {
+  if (!is_growing()) {
+    return true;
+  }
+  const int size = this->table_size();
+  HashtableBucket<F>* grown = _grown_buckets;
+  const int end = MIN2(size, _grow_index + limit);
+
+  for (int i = _grow_index; i < end; ++i) {
+    // Keep the order of the chain, so that shared entries stay at its end.
+    HashtableEntry<T, F>* heads[2] = { NULL, NULL };
+    HashtableEntry<T, F>* tails[2] = { NULL, NULL };
+    for (HashtableEntry<T, F>* p = this->bucket(i); p != NULL; p = p->next()) {
+      HashtableEntry<T, F>* copy = this->new_entry(p->hash(), p->literal());
+      copy->set_next(NULL);
+      int half = (p->hash() % (unsigned int)(2 * size)) == (unsigned int)i ? 0 : 1;
+      if (tails[half] == NULL) {
+        heads[half] = copy;
+      } else {
+        bool shared = tails[half]->is_shared();
+        tails[half]->set_next(copy);
+        if (shared) {
+          tails[half]->set_shared();
+        }
+      }
+      if (p->is_shared()) {
+        copy->set_shared();
+      }
+      tails[half] = copy;
+    }
+    grown[i].set_entry(heads[0]);
+    grown[i + size].set_entry(heads[1]);
+    // From now on readers and writers use the grown buckets.
+    this->buckets()[i].set_moved();
+  }
+  _grow_index = end;
+  return end == size;
+}
+
+// Move what is left and install the grown buckets.  No reader can be on
+// an old chain at a safepoint, so the old entries can be recycled.
+
+template <class T, MEMFLAGS F> void RehashableHashtable<T, F>::complete_growth() {
+  assert(SafepointSynchronize::is_at_safepoint(), "must be at safepoint");
+  if (!is_growing()) {
+    return;
+  }
+  const int size = this->table_size();
+  grow_step(size);
+
+  for (int i = 0; i < size; ++i) {
+    BasicHashtableEntry<F>* p = HashtableBucket<F>::unmoved(BasicHashtable<F>::bucket(i));
+    while (p != NULL) {
+      BasicHashtableEntry<F>* next = p->next();
+      // Entries in the shared archive were not allocated by this table.
+      if (!UseSharedSpaces ||
+          !FileMapInfo::current_info()->is_in_shared_space(p)) {
+        this->recycle_entry(p);
+      }
+      p = next;
+    }
+  }
+  BasicHashtable<F>::free_buckets();
+  this->set_buckets(_grown_buckets, 2 * size);
+  _grown_buckets = NULL;
+  _grow_index = 0;
+}
+
+template <class T, MEMFLAGS F> void RehashableHashtable<T, F>::add_to_chain(int index, HashtableEntry<T, F>* entry) {
+  if (HashtableBucket<F>::is_moved(BasicHashtable<F>::bucket(index))) {
+    int grown_index = entry->hash() % (unsigned int)(2 * this->table_size());
+    this->add_entry(&_grown_buckets[grown_index], entry);
+  } else {
+    this->add_entry(index, entry);
+  }
+}
+
+// While the table grows, chain c is grown bucket c once old bucket
+// c % table_size() has been moved, and old bucket c before that.
+
+template <class T, MEMFLAGS F> HashtableEntry<T, F>* RehashableHashtable<T, F>::chain(int c) {
+  if (!is_growing()) {
+    return this->bucket(c);
+  }
+  const int size = this->table_size();
+  BasicHashtableEntry<F>* entry = BasicHashtable<F>::bucket(c % size);
+  if (HashtableBucket<F>::is_moved(entry)) {
+    return grown_bucket(c);
+  }
+  return c < size ? (HashtableEntry<T, F>*)entry : NULL;
+}
+
+template <class T, MEMFLAGS F> int RehashableHashtable<T, F>::chain_index(unsigned int hash) {
+  int index = this->hash_to_index(hash);
+  if (is_growing() &&
+      HashtableBucket<F>::is_moved(BasicHashtable<F>::bucket(index))) {
+    return hash % (unsigned int)(2 * this->table_size());
+  }
+  return index;
+}
+
 
 // Reverse the order of elements in the hash buckets.
 
@@ -259,9 +390,9 @@ template <class T, MEMFLAGS F> int RehashableHashtable<T, F>::literal_size(oop o
 template <class T, MEMFLAGS F> void RehashableHashtable<T, F>::dump_table(outputStream* st, const char *table_name) {
   NumberSeq summary;
   int literal_bytes = 0;
-  for (int i = 0; i < this->table_size(); ++i) {
+  for (int i = 0; i < chain_count(); ++i) {
     int count = 0;
-    for (HashtableEntry<T, F>* e = this->bucket(i);
+    for (HashtableEntry<T, F>* e = chain(i);
        e != NULL; e = e->next()) {
       count++;
       literal_bytes += literal_size(e->literal());
@@ -135,6 +135,17 @@ public:
 
   // The following method is not MT-safe and must be done under lock.
   BasicHashtableEntry<F>** entry_addr()  { return &_entry; }
+
+  // Used by RehashableHashtable while it grows.  Once the chain of a bucket
+  // has been copied to the grown buckets, bit 1 of _entry is set; the old
+  // chain itself is left intact for readers that are still walking it.
+  static bool is_moved(BasicHashtableEntry<F>* l) {
+    return ((intptr_t)l & 2) != 0;
+  }
+  static BasicHashtableEntry<F>* unmoved(BasicHashtableEntry<F>* l) {
+    return (BasicHashtableEntry<F>*)((intptr_t)l & ~(intptr_t)2);
+  }
+  void set_moved();
 };
 
 
@@ -215,6 +226,20 @@ protected:
   // Free the buckets in this hashtable
   void free_buckets();
 
+  // Used when growing the table
+  HashtableBucket<F>* buckets() const { return _buckets; }
+  void set_buckets(HashtableBucket<F>* buckets, int table_size) {
+    _buckets = buckets;
+    _table_size = table_size;
+  }
+  void add_entry(HashtableBucket<F>* bucket, BasicHashtableEntry<F>* entry);
+  // Return an entry that has been copied to the free list; the copy
+  // stays in the table, so the number of entries is unchanged.
+  void recycle_entry(BasicHashtableEntry<F>* entry) {
+    entry->set_next(_free_list);
+    _free_list = entry;
+  }
+
 public:
   int table_size() { return _table_size; }
   void set_entry(int index, BasicHashtableEntry<F>* entry);
@@ -274,24 +299,69 @@ protected:
 
 };
 
+// A RehashableHashtable can also grow while it is in use.  Readers are
+// lock-free and writers hold the table lock.  Growing is done in three steps:
+//  - start_growth() allocates twice as many buckets once the load factor
+//    exceeds TableGrowthLoadFactor;
+//  - grow_step() splits the chain of old bucket i into grown buckets i and
+//    i + table_size(), and then marks bucket i as moved.  Entries are
+//    copied rather than relinked, so that a reader walking the old chain
+//    still sees a consistent list;
+//  - complete_growth() moves what is left at the next safepoint, installs
+//    the grown buckets and recycles the old entries.
+// Between start_growth() and complete_growth() the table is seen as
+// chain_count() chains; walkers that may run outside a safepoint use
+// chain() and chain_index() rather than bucket() and hash_to_index().
+
 template <class T, MEMFLAGS F> class RehashableHashtable : public Hashtable<T, F> {
  protected:
 
   enum {
     rehash_count = 100,
-    rehash_multiple = 60
+    rehash_multiple = 60,
+    max_grown_size = 16*M
   };
 
   // Check that the table is unbalanced
   bool check_rehash_table(int count);
 
+ private:
+  HashtableBucket<F>* volatile _grown_buckets;
+  volatile int                 _grow_index;    // next bucket to move
+
+  HashtableEntry<T, F>* grown_bucket(int i);
+
  public:
   RehashableHashtable(int table_size, int entry_size)
-    : Hashtable<T, F>(table_size, entry_size) { }
+    : Hashtable<T, F>(table_size, entry_size),
+      _grown_buckets(NULL), _grow_index(0) { }
 
   RehashableHashtable(int table_size, int entry_size,
                    HashtableBucket<F>* buckets, int number_of_entries)
-    : Hashtable<T, F>(table_size, entry_size, buckets, number_of_entries) { }
+    : Hashtable<T, F>(table_size, entry_size, buckets, number_of_entries),
+      _grown_buckets(NULL), _grow_index(0) { }
+
+  // Lock-free lookup: the chain that holds 'hash', with index == hash_to_index(hash).
+  HashtableEntry<T, F>* chain_for(int index, unsigned int hash);
+  // Add to the chain that holds the hash of 'entry'.  Must hold the table lock.
+  void add_to_chain(int index, HashtableEntry<T, F>* entry);
+
+  // Iteration that is safe while the table grows
+  int chain_count() {
+    return is_growing() ? 2 * this->table_size() : this->table_size();
+  }
+  HashtableEntry<T, F>* chain(int c);
+  int chain_index(unsigned int hash);
+
+  // Growing
+  bool is_growing() const      { return _grown_buckets != NULL; }
+  bool has_buckets_to_move() {
+    return is_growing() && _grow_index < this->table_size();
+  }
+  bool should_grow();
+  void start_growth();
+  bool grow_step(int limit);
+  void complete_growth();
 
 
   // Function to move these elements into the new table.
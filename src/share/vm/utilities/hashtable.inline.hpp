@@ -95,14 +95,23 @@ template <MEMFLAGS F> inline BasicHashtableEntry<F>* HashtableBucket<F>::get_ent
 }
 
 
+template <MEMFLAGS F> inline void HashtableBucket<F>::set_moved() {
+  set_entry((BasicHashtableEntry<F>*)((intptr_t)_entry | 2));
+}
+
+
 template <MEMFLAGS F> inline void BasicHashtable<F>::set_entry(int index, BasicHashtableEntry<F>* entry) {
   _buckets[index].set_entry(entry);
 }
 
 
 template <MEMFLAGS F> inline void BasicHashtable<F>::add_entry(int index, BasicHashtableEntry<F>* entry) {
-  entry->set_next(bucket(index));
-  _buckets[index].set_entry(entry);
+  add_entry(&_buckets[index], entry);
+}
+
+template <MEMFLAGS F> inline void BasicHashtable<F>::add_entry(HashtableBucket<F>* bucket, BasicHashtableEntry<F>* entry) {
+  entry->set_next(bucket->get_entry());
+  bucket->set_entry(entry);
   ++_number_of_entries;
 }
 
@@ -112,4 +121,22 @@ template <MEMFLAGS F> inline void BasicHashtable<F>::free_entry(BasicHashtableEn
   --_number_of_entries;
 }
 
+
+template <class T, MEMFLAGS F> inline HashtableEntry<T, F>* RehashableHashtable<T, F>::grown_bucket(int i) {
+  // Published before the first bucket is marked as moved.
+  HashtableBucket<F>* grown =
+    (HashtableBucket<F>*)OrderAccess::load_ptr_acquire(&_grown_buckets);
+  return (HashtableEntry<T, F>*)grown[i].get_entry();
+}
+
+// The following method is MT-safe and may be used with caution.
+template <class T, MEMFLAGS F> inline HashtableEntry<T, F>* RehashableHashtable<T, F>::chain_for(int index, unsigned int hash) {
+  // Read the bucket only once: it may be marked as moved at any time.
+  BasicHashtableEntry<F>* entry = BasicHashtable<F>::bucket(index);
+  if (HashtableBucket<F>::is_moved(entry)) {
+    return grown_bucket(hash % (unsigned int)(2 * this->table_size()));
+  }
+  return (HashtableEntry<T, F>*)entry;
+}
+
 #endif // SHARE_VM_UTILITIES_HASHTABLE_INLINE_HPP
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Test that the VM starts with a segmented code cache, with and
+ *          without tiered compilation, rejects code heaps that do not fit
+ *          into ReservedCodeCacheSize, and sweeps only the code heap that
+ *          changed after a mass deoptimization
+ * @library /testlibrary /testlibrary/whitebox
+ * @build CheckSegmentedCodeCache
+ * @run main ClassFileInstaller sun.hotspot.WhiteBox
+ * @run main CheckSegmentedCodeCache
+ *
+ */
+import java.lang.reflect.Method;
+import java.lang.reflect.Modifier;
+
+import com.oracle.java.testlibrary.*;
+import sun.hotspot.WhiteBox;
+
+public class CheckSegmentedCodeCache {
+  private static final String SWEEPING = "### Sweep: sweeping ";
+  private static final String NON_NMETHODS = "CodeHeap 'non-nmethods'";
+  private static final String NON_PROFILED = "CodeHeap 'non-profiled nmethods'";
+
+  // Fills the non-profiled code heap with C2 code and deoptimizes all of it.
+  public static class DeoptimizeApp {
+    private static final Class<?>[] CLASSES = {
+      String.class, StringBuilder.class, Integer.class, Long.class, Character.class,
+      java.util.ArrayList.class, java.util.HashMap.class, java.util.TreeMap.class,
+      java.util.Arrays.class, java.math.BigInteger.class
+    };
+
+    public static void main(String[] args) throws Exception {
+      WhiteBox wb = WhiteBox.getWhiteBox();
+      int compiled = 0;
+      for (Class<?> c : CLASSES) {
+        for (Method m : c.getDeclaredMethods()) {
+          if (Modifier.isAbstract(m.getModifiers()) || Modifier.isNative(m.getModifiers())) {
+            continue;
+          }
+          // -Xbatch blocks until the method is compiled
+          wb.enqueueMethodForCompilation(m, 4);
+          if (wb.isMethodCompiled(m)) {
+            compiled++;
+          }
+        }
+      }
+      System.out.println("Compiled " + compiled + " methods");
+      wb.deoptimizeAll();
+      // safepoints start sweeps, which compiler threads perform while idle
+      for (int i = 0; i < 10; i++) {
+        System.gc();
+        Thread.sleep(1000);
+      }
+    }
+  }
+
+  // Returns true if a sweep pass selected the non-profiled heap alone.
+  private static boolean sweptNonProfiledAlone(String output) {
+    boolean inPass = false;
+    boolean nonProfiled = false;
+    boolean nonNMethods = false;
+    for (String line : output.split("\\R")) {
+      if (line.startsWith(SWEEPING)) {
+        inPass = true;
+        nonProfiled |= line.endsWith(NON_PROFILED);
+        nonNMethods |= line.endsWith(NON_NMETHODS);
+        continue;
+      }
+      if (inPass && nonProfiled && !nonNMethods) {
+        return true;
+      }
+      inPass = nonProfiled = nonNMethods = false;
+    }
+    return inPass && nonProfiled && !nonNMethods;
+  }
+
+  public static void main(String[] args) throws Exception {
+    ProcessBuilder pb;
+    OutputAnalyzer out;
+
+    pb = ProcessTools.createJavaProcessBuilder("-XX:+SegmentedCodeCache",
+                                               "-XX:+TieredCompilation",
+                                               "-XX:+PrintCodeCache", "-version");
+    out = new OutputAnalyzer(pb.start());
+    out.shouldContain("CodeHeap 'non-nmethods'");
+    out.shouldContain("CodeHeap 'profiled nmethods'");
+    out.shouldContain("CodeHeap 'non-profiled nmethods'");
+    out.shouldHaveExitValue(0);
+
+    pb = ProcessTools.createJavaProcessBuilder("-XX:+SegmentedCodeCache",
+                                               "-XX:-TieredCompilation",
+                                               "-XX:+PrintCodeCache", "-version");
+    out = new OutputAnalyzer(pb.start());
+    out.shouldContain("CodeHeap 'non-nmethods'");
+    out.shouldNotContain("CodeHeap 'profiled nmethods'");
+    out.shouldHaveExitValue(0);
+
+    pb = ProcessTools.createJavaProcessBuilder("-XX:+SegmentedCodeCache",
+                                               "-XX:ReservedCodeCacheSize=32m",
+                                               "-XX:NonNMethodCodeHeapSize=16m",
+                                               "-XX:ProfiledCodeHeapSize=16m",
+                                               "-XX:+TieredCompilation", "-version");
+    out = new OutputAnalyzer(pb.start());
+    out.shouldContain("Not enough space in ReservedCodeCacheSize for the code heaps");
+    out.shouldHaveExitValue(1);
+
+    // Without tiered compilation all nmethods live in the non-profiled heap,
+    // deoptimizing them must not make the sweeper walk the non-nmethods heap.
+    pb = ProcessTools.createJavaProcessBuilder("-Xbootclasspath/a:.",
+                                               "-XX:+UnlockDiagnosticVMOptions",
+                                               "-XX:+WhiteBoxAPI", "-Xbatch",
+                                               "-XX:+SegmentedCodeCache",
+                                               "-XX:-TieredCompilation",
+                                               "-XX:ReservedCodeCacheSize=20m",
+                                               "-XX:NonNMethodCodeHeapSize=4m",
+                                               "-XX:+PrintMethodFlushing",
+                                               "-cp", System.getProperty("test.class.path"),
+                                               DeoptimizeApp.class.getName());
+    out = new OutputAnalyzer(pb.start());
+    out.shouldHaveExitValue(0);
+    out.shouldContain(SWEEPING + NON_PROFILED);
+    if (!sweptNonProfiledAlone(out.getStdout())) {
+      throw new RuntimeException("No sweep was limited to " + NON_PROFILED);
+    }
+  }
+}
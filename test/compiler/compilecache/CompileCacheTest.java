@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Test that methods compiled by one VM are saved to the
+ *          CompileCacheFile and compiled early by the next VM, and that the
+ *          file is ignored when the compilation flags differ
+ * @library /testlibrary
+ * @run main CompileCacheTest
+ */
+import java.io.File;
+import com.oracle.java.testlibrary.*;
+
+public class CompileCacheTest {
+  public static void main(String[] args) throws Exception {
+    File file = new File("compile-cache.txt");
+    file.delete();
+    String cacheFile = "-XX:CompileCacheFile=" + file.getAbsolutePath();
+
+    OutputAnalyzer out = run(cacheFile, "-XX:+TieredCompilation");
+    out.shouldContain("Compile cache: saved");
+    out.shouldHaveExitValue(0);
+    if (!file.exists()) {
+      throw new RuntimeException("compile cache was not saved");
+    }
+
+    out = run(cacheFile, "-XX:+TieredCompilation");
+    out.shouldContain("Compile cache: compiling CompileCacheTest$Hot.work(I)I");
+    out.shouldHaveExitValue(0);
+
+    out = run(cacheFile, "-XX:-TieredCompilation");
+    out.shouldContain("was created by another VM or with other flags, ignored");
+    out.shouldNotContain("Compile cache: compiling CompileCacheTest$Hot.work(I)I");
+    out.shouldHaveExitValue(0);
+  }
+
+  static OutputAnalyzer run(String cacheFile, String tiered) throws Exception {
+    ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(cacheFile, tiered,
+        "-XX:+UnlockDiagnosticVMOptions", "-XX:+PrintCompileCache",
+        Hot.class.getName());
+    return new OutputAnalyzer(pb.start());
+  }
+
+  public static class Hot {
+    static int work(int n) {
+      int sum = 0;
+      for (int i = 0; i < n; i++) {
+        sum += i ^ (sum >>> 3);
+      }
+      return sum;
+    }
+
+    public static void main(String[] args) {
+      int sum = 0;
+      for (int i = 0; i < 100000; i++) {
+        sum += work(100);
+      }
+      System.out.println(sum);
+    }
+  }
+}
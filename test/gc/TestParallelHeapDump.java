@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test TestParallelHeapDump
+ * @key gc
+ * @summary Check that heap dumps written on the GC worker threads and gzip compressed heap dumps are well-formed
+ * @library /testlibrary
+ * @run main/othervm TestParallelHeapDump
+ */
+
+import java.io.BufferedInputStream;
+import java.io.DataInputStream;
+import java.io.EOFException;
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.InputStream;
+import java.util.zip.GZIPInputStream;
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+import com.oracle.java.testlibrary.ProcessTools;
+
+public class TestParallelHeapDump {
+  private static final int HPROF_HEAP_DUMP         = 0x0C;
+  private static final int HPROF_HEAP_DUMP_SEGMENT = 0x1C;
+  private static final int HPROF_HEAP_DUMP_END     = 0x2C;
+
+  static class Allocator {
+    static Object[] objects;
+
+    public static void main(String args[]) {
+      objects = new Object[100000];
+      for (int i = 0; i < objects.length; i++) {
+        objects[i] = (i % 2 == 0) ? new int[i % 100] : new Object[] { objects };
+      }
+      System.gc();
+    }
+  }
+
+  // walks the top-level records of the dump and checks that the heap dump
+  // records are complete
+  private static void checkDump(File file, boolean compressed) throws Exception {
+    InputStream in = new BufferedInputStream(new FileInputStream(file));
+    if (compressed) {
+      in = new GZIPInputStream(in);
+    }
+    try (DataInputStream data = new DataInputStream(in)) {
+      StringBuilder header = new StringBuilder();
+      for (int c = data.read(); c != 0; c = data.read()) {
+        header.append((char)c);
+      }
+      if (!header.toString().startsWith("JAVA PROFILE 1.0.")) {
+        throw new RuntimeException("Unexpected header: " + header);
+      }
+      data.readInt();  // identifier size
+      data.readLong(); // time stamp
+
+      int heapDumps = 0;
+      int lastTag = -1;
+      while (true) {
+        int tag = data.read();
+        if (tag < 0) {
+          break;
+        }
+        data.readInt();  // ticks
+        long length = data.readInt() & 0xFFFFFFFFL;
+        while (length > 0) {
+          long skipped = data.skip(length);
+          if (skipped <= 0) {
+            throw new EOFException("Truncated record " + tag);
+          }
+          length -= skipped;
+        }
+        if (tag == HPROF_HEAP_DUMP || tag == HPROF_HEAP_DUMP_SEGMENT) {
+          heapDumps++;
+        }
+        lastTag = tag;
+      }
+
+      if (heapDumps == 0) {
+        throw new RuntimeException("No heap dump records in " + file);
+      }
+      if (header.toString().equals("JAVA PROFILE 1.0.2") && lastTag != HPROF_HEAP_DUMP_END) {
+        throw new RuntimeException("Segmented heap dump not terminated in " + file);
+      }
+    }
+  }
+
+  private static void testDump(String gc, String parallel, int level) throws Exception {
+    File file = new File("TestParallelHeapDump.hprof" + (level > 0 ? ".gz" : ""));
+    file.delete();
+    ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(gc,
+                                                              parallel,
+                                                              "-XX:ParallelGCThreads=4",
+                                                              "-XX:+HeapDumpBeforeFullGC",
+                                                              "-XX:HeapDumpPath=" + file.getName(),
+                                                              "-XX:HeapDumpGzipLevel=" + level,
+                                                              Allocator.class.getName());
+    OutputAnalyzer output = new OutputAnalyzer(pb.start());
+    System.out.println(output.getOutput());
+
+    output.shouldHaveExitValue(0);
+    output.shouldContain("Heap dump file created");
+    checkDump(file, level > 0);
+    file.delete();
+  }
+
+  public static void main(String args[]) throws Exception {
+    String[] collectors = { "-XX:+UseG1GC", "-XX:+UseParallelGC", "-XX:+UseSerialGC" };
+    for (String gc : collectors) {
+      testDump(gc, "-XX:+ParallelHeapDump", 0);
+      testDump(gc, "-XX:+ParallelHeapDump", 1);
+      testDump(gc, "-XX:-ParallelHeapDump", 0);
+    }
+  }
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test TestParallelHeapInspection
+ * @key gc
+ * @summary Check that class histograms counted on the GC worker threads match the serial count
+ * @library /testlibrary
+ * @run main/othervm TestParallelHeapInspection
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+import com.oracle.java.testlibrary.ProcessTools;
+
+public class TestParallelHeapInspection {
+  private static final int MARKERS = 100000;
+
+  static class Marker {
+    long value;
+  }
+
+  static class Allocator {
+    static Marker[] markers;
+
+    public static void main(String args[]) {
+      markers = new Marker[MARKERS];
+      for (int i = 0; i < MARKERS; i++) {
+        markers[i] = new Marker();
+      }
+      System.gc();
+    }
+  }
+
+  private static void testHistogram(String gc, String parallel) throws Exception {
+    ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(gc,
+                                                              parallel,
+                                                              "-XX:ParallelGCThreads=4",
+                                                              "-XX:+PrintClassHistogramBeforeFullGC",
+                                                              Allocator.class.getName());
+    OutputAnalyzer output = new OutputAnalyzer(pb.start());
+    System.out.println(output.getOutput());
+
+    output.shouldHaveExitValue(0);
+    output.shouldMatch("\\s+" + MARKERS + "\\s+\\d+\\s+TestParallelHeapInspection\\$Marker");
+  }
+
+  public static void main(String args[]) throws Exception {
+    String[] collectors = { "-XX:+UseG1GC", "-XX:+UseParallelGC", "-XX:+UseSerialGC" };
+    for (String gc : collectors) {
+      testHistogram(gc, "-XX:+ParallelHeapInspection");
+      testHistogram(gc, "-XX:-ParallelHeapInspection");
+    }
+  }
+}
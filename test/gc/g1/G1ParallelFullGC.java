@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+
+/*
+ * @test
+ * @summary Full GCs of G1 run with the parallel GC threads and still merge
+ *          the mixed objects left behind by a DSU
+ * @key gc
+ * @library /testlibrary /runtime/DSU
+ * @build DSUTestUtils G1ParallelFullGC
+ * @run main/timeout=300 G1ParallelFullGC
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class G1ParallelFullGC {
+    static final int INSTANCES = 100000;
+
+    public interface Item {
+        Item create(int a);
+        int value();
+    }
+
+    static String source(String extraField) {
+        return "public class GCItem implements G1ParallelFullGC.Item {" +
+               "  int a; Object next;" + extraField +
+               "  public G1ParallelFullGC.Item create(int a) {" +
+               "    GCItem item = new GCItem(); item.a = a; item.next = new int[a % 16]; return item;" +
+               "  }" +
+               "  public int value() { return a; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "GCItem", source(""));
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "GCItem", source(" long b; long c;"));
+        DSUTestUtils.writePatch("GCItem");
+
+        for (String flag : new String[] { "-XX:+G1ParallelFullGC", "-XX:-G1ParallelFullGC" }) {
+            OutputAnalyzer output = DSUTestUtils.run("G1ParallelFullGC$App", "-XX:+UseG1GC",
+                                                     "-XX:ParallelGCThreads=4", flag);
+            output.shouldContain("DSU Request is finished");
+            output.shouldHaveExitValue(0);
+        }
+    }
+
+    public static class App {
+        static Object sink;
+
+        public static void main(String[] args) throws Exception {
+            Item[] items = new Item[INSTANCES];
+            int[] hashes = new int[INSTANCES];
+            Item proto = (Item) Class.forName("GCItem").newInstance();
+            for (int i = 0; i < INSTANCES; i++) {
+                items[i] = proto.create(i);
+                hashes[i] = System.identityHashCode(items[i]);
+                if (i % 3 == 0) {
+                    items[i] = null; // leave garbage between the live objects
+                }
+            }
+
+            DSUTestUtils.invokeDSU(args[0], true);
+
+            // touch half of the items so they become mixed objects
+            for (int i = 0; i < INSTANCES; i += 2) {
+                if (items[i] != null) {
+                    items[i].value();
+                }
+            }
+
+            for (int round = 0; round < 3; round++) {
+                // dead humongous objects are freed while regions are claimed
+                for (int i = 0; i < 8; i++) {
+                    sink = new byte[2 * 1024 * 1024];
+                }
+                sink = null;
+                System.gc();
+                for (int i = 0; i < INSTANCES; i++) {
+                    if (items[i] == null) {
+                        continue;
+                    }
+                    DSUTestUtils.failIf(items[i].value() != i, "field is lost by the full GC");
+                    DSUTestUtils.failIf(System.identityHashCode(items[i]) != hashes[i],
+                                        "identity hash is lost by the full GC");
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test TestPeriodicCollection
+ * @requires vm.gc=="G1" | vm.gc=="null"
+ * @summary Verify that an idle G1 heap starts periodic collections and
+ * gives the memory of free regions back without a full GC
+ * @library /testlibrary
+ * @run main/timeout=300 TestPeriodicCollection
+ */
+
+import java.util.ArrayList;
+import java.util.List;
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+import com.oracle.java.testlibrary.ProcessTools;
+
+public class TestPeriodicCollection {
+
+    public static void main(String[] args) throws Exception {
+        // A concurrent cycle reclaims the old regions, the next periodic
+        // pause uncommits them.
+        OutputAnalyzer output = run("-XX:+G1PeriodicGCInvokesConcurrent");
+        output.shouldContain("(G1 Periodic Collection)");
+        output.shouldContain("(initial-mark)");
+        output.shouldNotContain("Full GC");
+        output.shouldContain("Heap shrunk");
+        output.shouldHaveExitValue(0);
+
+        output = run("-XX:-G1PeriodicGCInvokesConcurrent");
+        output.shouldContain("(G1 Periodic Collection)");
+        output.shouldNotContain("Full GC");
+        output.shouldHaveExitValue(0);
+
+        output = run("-XX:G1PeriodicGCInterval=0");
+        output.shouldNotContain("(G1 Periodic Collection)");
+        output.shouldHaveExitValue(0);
+    }
+
+    private static OutputAnalyzer run(String flag) throws Exception {
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder("-XX:+UseG1GC",
+                                                                  "-Xms16m",
+                                                                  "-Xmx512m",
+                                                                  "-XX:G1HeapRegionSize=1m",
+                                                                  "-XX:MinHeapFreeRatio=10",
+                                                                  "-XX:MaxHeapFreeRatio=30",
+                                                                  "-XX:G1PeriodicGCInterval=1000",
+                                                                  flag,
+                                                                  "-XX:+PrintGC",
+                                                                  IdleApp.class.getName());
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        System.out.println(output.getStdout());
+        return output;
+    }
+
+    static class IdleApp {
+        static List<byte[]> live = new ArrayList<byte[]>();
+
+        public static void main(String[] args) throws Exception {
+            // Grow the heap with a live set that dies before the idle phase
+            for (int i = 0; i < 2000; i++) {
+                live.add(new byte[64 * 1024]);
+            }
+            long committedBefore = Runtime.getRuntime().totalMemory();
+            live = null;
+
+            Thread.sleep(10000);
+
+            long committedAfter = Runtime.getRuntime().totalMemory();
+            if (committedAfter < committedBefore) {
+                System.out.println("Heap shrunk from " + committedBefore + " to " + committedAfter);
+            }
+        }
+    }
+}
@@ -168,18 +168,29 @@ class TestStringDeduplicationTools {
         }
     }
 
+    private static boolean selectsCollector(String... args) {
+        for (String arg : args) {
+            if (arg.matches("-XX:\\+Use\\w+GC")) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     private static OutputAnalyzer runTest(String... extraArgs) throws Exception {
         String[] defaultArgs = new String[] {
             "-Xmn" + Xmn + "m",
             "-Xms" + Xms + "m",
             "-Xmx" + Xmx + "m",
-            "-XX:+UseG1GC",
             "-XX:+UnlockDiagnosticVMOptions",
             "-XX:+VerifyAfterGC" // Always verify after GC
         };
 
         ArrayList<String> args = new ArrayList<String>();
         args.addAll(Arrays.asList(defaultArgs));
+        if (!selectsCollector(extraArgs)) {
+            args.add("-XX:+UseG1GC");
+        }
         args.addAll(Arrays.asList(extraArgs));
 
         ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(args.toArray(new String[args.size()]));
@@ -426,6 +437,32 @@ class TestStringDeduplicationTools {
         output.shouldHaveExitValue(0);
     }
 
+    public static void testCollectors() throws Exception {
+        String[][] collectors = new String[][] {
+            { "-XX:+UseParallelGC", "-XX:+UseParallelOldGC" },
+            { "-XX:+UseParallelGC", "-XX:-UseParallelOldGC" },
+            { "-XX:+UseConcMarkSweepGC" },
+            { "-XX:+UseSerialGC" }
+        };
+
+        for (String[] collector : collectors) {
+            for (String gcType : new String[] { YoungGC, FullGC }) {
+                ArrayList<String> args = new ArrayList<String>();
+                args.addAll(Arrays.asList(collector));
+                args.add("-XX:+PrintGC");
+                args.add("-XX:+PrintStringDeduplicationStatistics");
+
+                OutputAnalyzer output = DeduplicationTest.run(LargeNumberOfStrings,
+                                                              DefaultAgeThreshold,
+                                                              gcType,
+                                                              args.toArray(new String[args.size()]));
+                output.shouldContain("GC concurrent-string-deduplication");
+                output.shouldContain("Deduplicated:");
+                output.shouldHaveExitValue(0);
+            }
+        }
+    }
+
     public static void testInterned() throws Exception {
         // Test that interned strings are deduplicated before being interned
         OutputAnalyzer output = InternedTest.run();
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+
+/*
+ * @test
+ * @summary Transform stale instances of lazily updated classes in the background
+ * @library /testlibrary
+ * @build DSUTestUtils BackgroundTransformTest
+ * @run main/timeout=300 BackgroundTransformTest
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class BackgroundTransformTest {
+    static final int INSTANCES = 10000;
+
+    public interface Item {
+        Item create(int a);
+        int value();
+    }
+
+    static String source(int version, String extraField) {
+        return "public class StaleItem implements BackgroundTransformTest.Item {" +
+               "  int a;" + extraField +
+               "  public BackgroundTransformTest.Item create(int a) {" +
+               "    StaleItem item = new StaleItem(); item.a = a; return item;" +
+               "  }" +
+               "  public int value() { return a + " + version + "; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "StaleItem", source(0, ""));
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "StaleItem", source(1, " long b;"));
+        DSUTestUtils.writePatch("StaleItem");
+
+        OutputAnalyzer output = DSUTestUtils.run("BackgroundTransformTest$App",
+                                                 "-XX:+DSUBackgroundTransform",
+                                                 "-XX:+UseSerialGC");
+        output.shouldContain("DSU Request is finished");
+        output.shouldMatch("DSU background transforms [1-9][0-9]* objects time:");
+        output.shouldHaveExitValue(0);
+        DSUTestUtils.reportTimes("BackgroundTransformTest", output);
+    }
+
+    public static class App {
+        static long sum(Item[] items) {
+            long sum = 0;
+            for (Item item : items) {
+                sum += item.value();
+            }
+            return sum;
+        }
+
+        public static void main(String[] args) throws Exception {
+            Item[] items = new Item[INSTANCES];
+            Item proto = (Item) Class.forName("StaleItem").newInstance();
+            for (int i = 0; i < INSTANCES; i++) {
+                items[i] = proto.create(i);
+            }
+            proto = null;
+            long expected = (long) INSTANCES * (INSTANCES - 1) / 2;
+            DSUTestUtils.failIf(sum(items) != expected, "unexpected old values");
+
+            DSUTestUtils.invokeDSU(args[0], true);
+            // leave the stale instances to the transformer thread, which is
+            // fed by collections and done after a collection finds none
+            for (int i = 0; i < 6; i++) {
+                System.gc();
+                Thread.sleep(500);
+            }
+
+            DSUTestUtils.failIf(sum(items) != expected + INSTANCES,
+                                "fields are lost by the background transformation");
+        }
+    }
+}
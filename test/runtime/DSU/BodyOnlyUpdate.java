@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Update only method bodies and check that compiled callers see the new bodies
+ * @library /testlibrary
+ * @build DSUTestUtils BodyOnlyUpdate
+ * @run main/timeout=300 BodyOnlyUpdate
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class BodyOnlyUpdate {
+    static final int ITERATIONS = 200000;
+
+    public interface Valued {
+        int value();
+    }
+
+    static String source(int value) {
+        return "public class BodyOnlyItem implements BodyOnlyUpdate.Valued {" +
+               "  public int value() { return " + value + "; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "BodyOnlyItem", source(0));
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "BodyOnlyItem", source(1));
+        DSUTestUtils.writePatch("BodyOnlyItem");
+
+        OutputAnalyzer output = DSUTestUtils.run("BodyOnlyUpdate$App");
+        output.shouldContain("take the body-only fast path");
+        output.shouldContain("DSU Request is finished");
+        DSUTestUtils.reportTimes("BodyOnlyUpdate", output);
+
+        // the fast path can be switched off
+        output = DSUTestUtils.run("BodyOnlyUpdate$App", "-XX:-UseDSUBodyOnlyFastPath");
+        output.shouldNotContain("take the body-only fast path");
+        output.shouldContain("DSU Request is finished");
+    }
+
+    public static class App {
+        // the compiled caller inlines the monomorphic call to value()
+        static int sum(Valued v) {
+            int sum = 0;
+            for (int i = 0; i < 100; i++) {
+                sum += v.value();
+            }
+            return sum;
+        }
+
+        public static void main(String[] args) throws Exception {
+            Valued v = (Valued) Class.forName("BodyOnlyItem").newInstance();
+            for (int i = 0; i < ITERATIONS; i++) {
+                DSUTestUtils.failIf(sum(v) != 0, "unexpected value before the update");
+            }
+
+            DSUTestUtils.invokeDSU(args[0], true);
+            DSUTestUtils.failIf(sum(v) != 100, "compiled caller still runs the old body");
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+
+/*
+ * @test
+ * @summary Interpreted code runs without DSU checks until the first DSU,
+ *          stale objects are still updated after it
+ * @library /testlibrary
+ * @build DSUTestUtils CheckFreeInterpreter
+ * @run main/timeout=300 CheckFreeInterpreter
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class CheckFreeInterpreter {
+    static final int INSTANCES = 1000;
+
+    public interface Item {
+        Item create(int a);
+        int value();
+    }
+
+    static String source(String extraField) {
+        return "public class CheckedItem implements CheckFreeInterpreter.Item {" +
+               "  int a;" + extraField +
+               "  public CheckFreeInterpreter.Item create(int a) {" +
+               "    CheckedItem item = new CheckedItem(); item.a = a; return item;" +
+               "  }" +
+               "  public int value() { return a; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "CheckedItem", source(""));
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "CheckedItem", source(" long b;"));
+        DSUTestUtils.writePatch("CheckedItem");
+
+        OutputAnalyzer output = DSUTestUtils.run("CheckFreeInterpreter$App", "-Xint");
+        output.shouldMatch("Enable [1-9][0-9]* DSU checks in the interpreter");
+        output.shouldContain("DSU Request is finished");
+        output.shouldHaveExitValue(0);
+
+        output = DSUTestUtils.run("CheckFreeInterpreter$App", "-Xint",
+                                  "-XX:-UseDSUCheckFreeInterpreter");
+        output.shouldNotContain("DSU checks in the interpreter");
+        output.shouldContain("DSU Request is finished");
+        output.shouldHaveExitValue(0);
+    }
+
+    public static class App {
+        public static void main(String[] args) throws Exception {
+            Item[] items = new Item[INSTANCES];
+            Item proto = (Item) Class.forName("CheckedItem").newInstance();
+            for (int i = 0; i < INSTANCES; i++) {
+                items[i] = proto.create(i);
+            }
+
+            DSUTestUtils.invokeDSU(args[0], true);
+
+            // the stale items are updated lazily by the interpreter checks
+            for (int i = 0; i < INSTANCES; i++) {
+                DSUTestUtils.failIf(items[i].value() != i, "field is lost by the update");
+            }
+        }
+    }
+}
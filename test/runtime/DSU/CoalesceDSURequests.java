@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Concurrent synchronous DSU requests each wait for their own completion
+ * @library /testlibrary
+ * @build DSUTestUtils CoalesceDSURequests
+ * @run main/timeout=300 CoalesceDSURequests
+ */
+
+import java.io.File;
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class CoalesceDSURequests {
+    static final int REQUESTS = 4;
+
+    public interface Item {
+        int version();
+    }
+
+    static String source(String name, int version) {
+        return "public class " + name + " implements CoalesceDSURequests.Item {" +
+               "  public int version() { return " + version + "; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        for (int i = 0; i < REQUESTS; i++) {
+            DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "Item" + i, source("Item" + i, 0));
+            DSUTestUtils.compileTo(DSUTestUtils.newDir(), "Item" + i, source("Item" + i, 1));
+        }
+        // Each request updates its own class, so that they can be coalesced.
+        for (int i = 0; i < REQUESTS; i++) {
+            DSUTestUtils.writePatch(new File("dsu." + i + ".patch"), "Item" + i);
+        }
+        // the default patch only locates the directory of the patches
+        DSUTestUtils.writePatch();
+
+        OutputAnalyzer output = DSUTestUtils.run("CoalesceDSURequests$App",
+                                                 "-XX:+DSUCoalesceRequests");
+        output.shouldContain("DSU Request is finished");
+        output.shouldContain("DSU request queue time:");
+        DSUTestUtils.reportTimes("CoalesceDSURequests", output);
+    }
+
+    public static class App {
+        public static void main(String[] args) throws Exception {
+            final File dir = new File(args[0]).getParentFile();
+            final Item[] items = new Item[REQUESTS];
+            for (int i = 0; i < REQUESTS; i++) {
+                items[i] = (Item) Class.forName("Item" + i).newInstance();
+            }
+
+            Thread[] threads = new Thread[REQUESTS];
+            final Throwable[] failures = new Throwable[REQUESTS];
+            for (int i = 0; i < REQUESTS; i++) {
+                final int index = i;
+                threads[i] = new Thread() {
+                    public void run() {
+                        try {
+                            File patch = new File(dir, "dsu." + index + ".patch");
+                            DSUTestUtils.invokeDSU(patch.getPath(), true);
+                            // a synchronous request returns after its own update
+                            DSUTestUtils.failIf(items[index].version() != 1,
+                                                "Item" + index + " is not updated");
+                        } catch (Throwable t) {
+                            failures[index] = t;
+                        }
+                    }
+                };
+                threads[i].start();
+            }
+            for (int i = 0; i < REQUESTS; i++) {
+                threads[i].join();
+                if (failures[i] != null) {
+                    throw new RuntimeException("request " + i + " failed", failures[i]);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Reuse the prepared DSU plan of a previous VM applying the same patch
+ * @library /testlibrary
+ * @build DSUTestUtils DSUPlanTest
+ * @run main/timeout=300 DSUPlanTest
+ */
+
+import java.io.File;
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class DSUPlanTest {
+    public interface Valued {
+        int value();
+        int other();
+    }
+
+    static String source(int value) {
+        return "public class PlanItem implements DSUPlanTest.Valued {" +
+               "  public int value() { return " + value + "; }" +
+               "  public int other() { return 42; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "PlanItem", source(0));
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "PlanItem", source(1));
+        DSUTestUtils.writePatch("PlanItem");
+
+        File plan = new File("dsu.plan");
+        plan.delete();
+        String planFlag = "-XX:DSUPlanFile=" + plan.getAbsolutePath();
+
+        // the first VM computes the plan
+        OutputAnalyzer output = DSUTestUtils.run("DSUPlanTest$App", planFlag);
+        output.shouldNotContain("Reuse DSU plan");
+        output.shouldContain("DSU Request is finished");
+        DSUTestUtils.failIf(!plan.exists(), "DSU plan is not saved");
+        DSUTestUtils.reportTimes("DSUPlanTest-compute", output);
+
+        // the second VM reuses it
+        output = DSUTestUtils.run("DSUPlanTest$App", planFlag);
+        output.shouldContain("Reuse DSU plan of class PlanItem");
+        output.shouldNotContain("DSU plan of class PlanItem expects");
+        output.shouldContain("DSU Request is finished");
+        DSUTestUtils.reportTimes("DSUPlanTest-reuse", output);
+    }
+
+    public static class App {
+        public static void main(String[] args) throws Exception {
+            Valued v = (Valued) Class.forName("PlanItem").newInstance();
+            DSUTestUtils.failIf(v.value() != 0, "unexpected value before the update");
+
+            DSUTestUtils.invokeDSU(args[0], true);
+            DSUTestUtils.failIf(v.value() != 1, "PlanItem is not updated");
+            DSUTestUtils.failIf(v.other() != 42, "unchanged method is broken");
+        }
+    }
+}
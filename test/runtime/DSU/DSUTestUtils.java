@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+import java.io.File;
+import java.io.IOException;
+import java.io.PrintWriter;
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
+import javax.tools.ToolProvider;
+
+import com.oracle.java.testlibrary.InMemoryJavaCompiler;
+import com.oracle.java.testlibrary.OutputAnalyzer;
+import com.oracle.java.testlibrary.ProcessTools;
+
+/**
+ * Shared helpers of the DSU tests.
+ *
+ * A test is a driver that compiles the old and the new versions of the
+ * application classes into two directories, writes a dynamic patch and runs
+ * the application in a child VM with the DSU timers enabled.
+ */
+public class DSUTestUtils {
+    public static final String OLD_DIR = "dsu.old";
+    public static final String NEW_DIR = "dsu.new";
+    public static final String PATCH  = "dsu.patch";
+    public static final String SRC_DIR = "dsu.src";
+
+    private static final Pattern TIME_PATTERN =
+        Pattern.compile("\\[DSU\\]-\\[Info\\]: (DSU .*) time: ([0-9.]+) \\(s\\)");
+
+    public static File oldDir() {
+        return new File(OLD_DIR).getAbsoluteFile();
+    }
+
+    public static File newDir() {
+        return new File(NEW_DIR).getAbsoluteFile();
+    }
+
+    /**
+     * Compile a class in the unnamed package and write it to dir. The source
+     * may refer to classes compiled to dir or to oldDir() before.
+     */
+    public static void compileTo(File dir, String className, String source) throws IOException {
+        dir.mkdirs();
+        File src = new File(SRC_DIR, className + ".java").getAbsoluteFile();
+        src.getParentFile().mkdirs();
+        PrintWriter pw = new PrintWriter(src);
+        try {
+            pw.print(source);
+        } finally {
+            pw.close();
+        }
+        String classPath = System.getProperty("test.class.path") + File.pathSeparator +
+                           dir.getPath() + File.pathSeparator + oldDir().getPath();
+        int rc = ToolProvider.getSystemJavaCompiler().run(null, null, null,
+                     "-d", dir.getPath(), "-cp", classPath, src.getPath());
+        if (rc != 0) {
+            throw new RuntimeException("Could not compile " + className + " with source code " + source);
+        }
+    }
+
+    public static byte[] compile(String className, String source) {
+        return InMemoryJavaCompiler.compile(className, source);
+    }
+
+    /**
+     * Write a dynamic patch that loads new versions from newDir().
+     * Every line must be terminated as the VM parses line by line.
+     */
+    public static String writePatch(String... modifiedClasses) throws IOException {
+        return writePatch(new File(PATCH), modifiedClasses);
+    }
+
+    public static String writePatch(File file, String... modifiedClasses) throws IOException {
+        File patch = file.getAbsoluteFile();
+        PrintWriter pw = new PrintWriter(patch);
+        try {
+            pw.print("classpath " + newDir().getPath() + "\n");
+            for (String name : modifiedClasses) {
+                pw.print("modclass " + name.replace('.', '/') + "\n");
+            }
+        } finally {
+            pw.close();
+        }
+        return patch.getPath();
+    }
+
+    /**
+     * Run mainClass in a child VM with the old versions on the class path.
+     */
+    public static OutputAnalyzer run(String mainClass, String... vmArgs) throws Exception {
+        List<String> args = new ArrayList<String>();
+        args.add("-XX:TraceDSU=1");
+        Collections.addAll(args, vmArgs);
+        args.add("-cp");
+        args.add(System.getProperty("test.class.path") + File.pathSeparator + oldDir().getPath());
+        args.add(mainClass);
+        args.add(new File(PATCH).getAbsolutePath());
+        ProcessBuilder pb = ProcessTools.createJavaProcessBuilder(true, args.toArray(new String[args.size()]));
+        OutputAnalyzer output = new OutputAnalyzer(pb.start());
+        System.out.println(output.getOutput());
+        output.shouldHaveExitValue(0);
+        return output;
+    }
+
+    /**
+     * Print the per-phase DSU timers of a child VM so that the
+     * results of a run can be compared with a previous one.
+     */
+    public static void reportTimes(String test, OutputAnalyzer output) {
+        Matcher m = TIME_PATTERN.matcher(output.getOutput());
+        while (m.find()) {
+            System.out.println("[" + test + "] " + m.group(1) + ": " + m.group(2) + " s");
+        }
+    }
+
+    public static void report(String test, String what, long nanos) {
+        System.out.println("[" + test + "] " + what + ": " + (nanos / 1e9) + " s");
+    }
+
+    // org.javelus.DeveloperInterface is created by the VM, so it is only
+    // reachable through reflection.
+    private static Method developerMethod(String name, Class<?>... types) throws Exception {
+        Class<?> c = Class.forName("org.javelus.DeveloperInterface");
+        return c.getMethod(name, types);
+    }
+
+    public static void invokeDSU(String patch, boolean sync) throws Exception {
+        developerMethod("invokeDSU", String.class, boolean.class).invoke(null, patch, sync);
+    }
+
+    public static void estimateDSU(String patch) throws Exception {
+        developerMethod("estimateDSU", String.class).invoke(null, patch);
+    }
+
+    public static Object replaceObject(Object oldObject, Object newObject) throws Exception {
+        return developerMethod("replaceObject", Object.class, Object.class).invoke(null, oldObject, newObject);
+    }
+
+    public static void replaceObjects(Object[] oldObjects, Object[] newObjects) throws Exception {
+        developerMethod("replaceObjects", Object[].class, Object[].class).invoke(null, oldObjects, newObjects);
+    }
+
+    public static void failIf(boolean condition, String msg) {
+        if (condition) {
+            throw new RuntimeException(msg);
+        }
+    }
+}
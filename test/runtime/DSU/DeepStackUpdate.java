@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Update a method that is active in a deep stack; the update is
+ *          interrupted until the restricted frames return
+ * @library /testlibrary
+ * @build DSUTestUtils DeepStackUpdate
+ * @run main/timeout=600 DeepStackUpdate
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class DeepStackUpdate {
+    static final int DEPTH = 2000;
+
+    public interface Recursive {
+        int recurse(int depth, Object lock);
+    }
+
+    static String source(int base) {
+        return "public class DeepFrame implements DeepStackUpdate.Recursive {" +
+               "  public int recurse(int depth, Object lock) {" +
+               "    if (depth == 0) {" +
+               "      synchronized (lock) {" +
+               "        DeepStackUpdate.App.reached = true;" +
+               "        lock.notifyAll();" +
+               "        while (!DeepStackUpdate.App.release) {" +
+               "          try { lock.wait(); } catch (InterruptedException e) { }" +
+               "        }" +
+               "      }" +
+               "      return " + base + ";" +
+               "    }" +
+               "    return recurse(depth - 1, lock);" +
+               "  }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "DeepFrame", source(0));
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "DeepFrame", source(1));
+        DSUTestUtils.writePatch("DeepFrame");
+
+        OutputAnalyzer output = DSUTestUtils.run("DeepStackUpdate$App", "-Xss16m");
+        output.shouldContain("Not at DSU safe point");
+        output.shouldContain("DSU Request is finished");
+        DSUTestUtils.reportTimes("DeepStackUpdate", output);
+    }
+
+    public static class App {
+        static volatile boolean reached = false;
+        static volatile boolean release = false;
+
+        public static void main(final String[] args) throws Exception {
+            final Object lock = new Object();
+            final Recursive frame = (Recursive) Class.forName("DeepFrame").newInstance();
+
+            Thread deep = new Thread() {
+                public void run() {
+                    frame.recurse(DEPTH, lock);
+                }
+            };
+            deep.start();
+
+            synchronized (lock) {
+                while (!reached) {
+                    lock.wait();
+                }
+            }
+
+            final long start = System.nanoTime();
+            Thread invoker = new Thread() {
+                public void run() {
+                    try {
+                        DSUTestUtils.invokeDSU(args[0], true);
+                    } catch (Exception e) {
+                        throw new RuntimeException(e);
+                    }
+                    DSUTestUtils.report("DeepStackUpdate", "invokeDSU", System.nanoTime() - start);
+                }
+            };
+            invoker.start();
+
+            // keep the restricted frames alive for a while
+            Thread.sleep(2000);
+            synchronized (lock) {
+                release = true;
+                lock.notifyAll();
+            }
+
+            deep.join();
+            invoker.join();
+
+            reached = false;
+            release = true;
+            DSUTestUtils.failIf(frame.recurse(1, lock) != 1, "DeepFrame is not updated");
+        }
+    }
+}
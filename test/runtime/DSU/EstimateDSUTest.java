@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Estimate the cost of a DSU without applying it
+ * @library /testlibrary
+ * @build DSUTestUtils EstimateDSUTest
+ * @run main/timeout=300 EstimateDSUTest
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class EstimateDSUTest {
+    static final int INSTANCES = 10000;
+
+    public interface Item {
+        Item create();
+        int version();
+    }
+
+    static String source(int version, String extraField) {
+        return "public class EstimateItem implements EstimateDSUTest.Item {" +
+               "  int a;" + extraField +
+               "  public EstimateDSUTest.Item create() { return new EstimateItem(); }" +
+               "  public int version() { return " + version + "; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "EstimateItem", source(0, ""));
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "EstimateItem", source(1, " long b;"));
+        DSUTestUtils.writePatch("EstimateItem");
+
+        OutputAnalyzer output = DSUTestUtils.run("EstimateDSUTest$App");
+        output.shouldContain("DSU Request is estimated");
+        output.shouldMatch("\\[DSU\\]-\\[Estimate\\]: +EstimateItem .* " + INSTANCES + " instances");
+        output.shouldContain("[DSU]-[Estimate]: classes to relink:");
+        output.shouldContain("DSU Request is finished");
+        DSUTestUtils.reportTimes("EstimateDSUTest", output);
+    }
+
+    public static class App {
+        public static void main(String[] args) throws Exception {
+            Item proto = (Item) Class.forName("EstimateItem").newInstance();
+            Item[] items = new Item[INSTANCES];
+            for (int i = 0; i < INSTANCES; i++) {
+                items[i] = proto.create();
+            }
+            // the census counts every object in the heap, drop the prototype
+            proto = null;
+            System.gc();
+
+            DSUTestUtils.estimateDSU(args[0]);
+            DSUTestUtils.failIf(items[0].version() != 0, "a dry-run DSU must not be installed");
+
+            // the real update must still be possible after an estimation
+            DSUTestUtils.invokeDSU(args[0], true);
+            DSUTestUtils.failIf(items[0].version() != 1, "EstimateItem is not updated");
+        }
+    }
+}
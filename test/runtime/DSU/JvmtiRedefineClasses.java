@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary JVMTI RedefineClasses is performed by VM_RedefineClasses, not
+ *          as a DSU: a body change is applied, a layout change is rejected
+ * @library /testlibrary
+ * @build DSUTestUtils DSUAgent JvmtiRedefineClasses
+ * @run main ClassFileInstaller DSUAgent
+ * @run main/timeout=300 JvmtiRedefineClasses
+ */
+
+import java.io.File;
+import java.io.PrintWriter;
+import java.lang.instrument.ClassDefinition;
+import java.nio.file.Files;
+
+import com.oracle.java.testlibrary.JDKToolFinder;
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class JvmtiRedefineClasses {
+    public interface Counter {
+        int count();
+    }
+
+    static String source(String extraField, String body) {
+        return "public class JvmtiTarget implements JvmtiRedefineClasses.Counter {" +
+               "  int a = 1;" + extraField +
+               "  public int count() { return " + body + "; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "JvmtiTarget", source("", "a"));
+        DSUTestUtils.compileTo(new File("body"), "JvmtiTarget", source("", "a + 1"));
+        DSUTestUtils.compileTo(new File("layout"), "JvmtiTarget", source(" int b = 2;", "a + b"));
+
+        PrintWriter pw = new PrintWriter("MANIFEST.MF");
+        pw.println("Premain-Class: DSUAgent");
+        pw.println("Can-Redefine-Classes: true");
+        pw.close();
+
+        ProcessBuilder pb = new ProcessBuilder();
+        pb.command(new String[] { JDKToolFinder.getJDKTool("jar"), "cmf", "MANIFEST.MF", "dsuagent.jar", "DSUAgent.class"});
+        pb.start().waitFor();
+
+        OutputAnalyzer output = DSUTestUtils.run("JvmtiRedefineClasses$App",
+                                                 "-javaagent:dsuagent.jar",
+                                                 "-XX:+UseJavelusInJvmti");
+        output.shouldNotContain("DSU Request is finished");
+        output.shouldHaveExitValue(0);
+    }
+
+    public static class App {
+        static byte[] bytes(String dir) throws Exception {
+            return Files.readAllBytes(new File(dir, "JvmtiTarget.class").toPath());
+        }
+
+        public static void main(String[] args) throws Exception {
+            Class<?> target = Class.forName("JvmtiTarget");
+            Counter counter = (Counter) target.newInstance();
+            DSUTestUtils.failIf(counter.count() != 1, "unexpected old version");
+
+            // VM_RedefineClasses rejects a schema change, and the error
+            // must reach the agent
+            try {
+                DSUAgent.instrumentation.redefineClasses(new ClassDefinition(target, bytes("layout")));
+                throw new RuntimeException("a layout change must be rejected");
+            } catch (UnsupportedOperationException e) {
+                System.out.println("Expected: " + e);
+            }
+            DSUTestUtils.failIf(counter.count() != 1, "a rejected redefinition is applied");
+
+            DSUAgent.instrumentation.redefineClasses(new ClassDefinition(target, bytes("body")));
+            DSUTestUtils.failIf(counter.count() != 2, "JvmtiTarget is not redefined");
+        }
+    }
+}
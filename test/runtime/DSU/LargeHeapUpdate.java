@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Add a field to a class with many live instances and measure
+ *          lazy transformation and the GC cost of mixed objects
+ * @library /testlibrary
+ * @build DSUTestUtils LargeHeapUpdate
+ * @run main/timeout=600 LargeHeapUpdate
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class LargeHeapUpdate {
+    static final int INSTANCES = 500000;
+
+    public interface Node {
+        Node create(int a);
+        int get();
+    }
+
+    static final String OLD_SOURCE =
+        "public class HeapNode implements LargeHeapUpdate.Node {" +
+        "  int a;" +
+        "  public LargeHeapUpdate.Node create(int a) { HeapNode n = new HeapNode(); n.a = a; return n; }" +
+        "  public int get() { return a; }" +
+        "}";
+
+    // the new version grows, so every old instance becomes a mixed object
+    static final String NEW_SOURCE =
+        "public class HeapNode implements LargeHeapUpdate.Node {" +
+        "  int a;" +
+        "  long b;" +
+        "  long c;" +
+        "  public LargeHeapUpdate.Node create(int a) { HeapNode n = new HeapNode(); n.a = a; return n; }" +
+        "  public int get() { return a + (int) b + (int) c; }" +
+        "}";
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "HeapNode", OLD_SOURCE);
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "HeapNode", NEW_SOURCE);
+        DSUTestUtils.writePatch("HeapNode");
+
+        OutputAnalyzer output = DSUTestUtils.run("LargeHeapUpdate$App", "-Xmx512m");
+        output.shouldContain("DSU Request is finished");
+        DSUTestUtils.reportTimes("LargeHeapUpdate", output);
+    }
+
+    public static class App {
+        public static void main(String[] args) throws Exception {
+            Node proto = (Node) Class.forName("HeapNode").newInstance();
+            Node[] nodes = new Node[INSTANCES];
+            for (int i = 0; i < INSTANCES; i++) {
+                nodes[i] = proto.create(i);
+            }
+
+            long start = System.nanoTime();
+            DSUTestUtils.invokeDSU(args[0], true);
+            DSUTestUtils.report("LargeHeapUpdate", "invokeDSU", System.nanoTime() - start);
+
+            // The first access to each stale object transforms it.
+            start = System.nanoTime();
+            for (int i = 0; i < INSTANCES; i++) {
+                DSUTestUtils.failIf(nodes[i].get() != i, "field a is lost in transformation");
+            }
+            DSUTestUtils.report("LargeHeapUpdate", "transform " + INSTANCES + " objects", System.nanoTime() - start);
+
+            // Full GCs merge the mixed objects created above.
+            start = System.nanoTime();
+            System.gc();
+            DSUTestUtils.report("LargeHeapUpdate", "first full gc", System.nanoTime() - start);
+
+            start = System.nanoTime();
+            System.gc();
+            DSUTestUtils.report("LargeHeapUpdate", "second full gc", System.nanoTime() - start);
+
+            for (int i = 0; i < INSTANCES; i++) {
+                DSUTestUtils.failIf(nodes[i].get() != i, "field a is lost after gc");
+            }
+        }
+    }
+}
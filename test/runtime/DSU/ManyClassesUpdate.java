@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Update the method bodies of many classes while threads keep calling them
+ * @library /testlibrary
+ * @build DSUTestUtils ManyClassesUpdate
+ * @run main/timeout=600 ManyClassesUpdate
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class ManyClassesUpdate {
+    static final int CLASSES = 200;
+    static final int THREADS = 4;
+
+    public interface Valued {
+        int value();
+    }
+
+    static String source(int i, int value) {
+        return "public class Many" + i + " implements ManyClassesUpdate.Valued {" +
+               "  public int value() { return " + value + "; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        String[] names = new String[CLASSES];
+        for (int i = 0; i < CLASSES; i++) {
+            names[i] = "Many" + i;
+            DSUTestUtils.compileTo(DSUTestUtils.oldDir(), names[i], source(i, 0));
+            DSUTestUtils.compileTo(DSUTestUtils.newDir(), names[i], source(i, 1));
+        }
+        DSUTestUtils.writePatch(names);
+
+        OutputAnalyzer output = DSUTestUtils.run("ManyClassesUpdate$App");
+        output.shouldContain("DSU Request is finished");
+        DSUTestUtils.reportTimes("ManyClassesUpdate", output);
+    }
+
+    public static class App {
+        static volatile boolean stop = false;
+
+        public static void main(String[] args) throws Exception {
+            final Valued[] objects = new Valued[CLASSES];
+            for (int i = 0; i < CLASSES; i++) {
+                objects[i] = (Valued) Class.forName("Many" + i).newInstance();
+            }
+
+            Thread[] workers = new Thread[THREADS];
+            for (int t = 0; t < THREADS; t++) {
+                workers[t] = new Thread() {
+                    public void run() {
+                        long sum = 0;
+                        while (!stop) {
+                            for (Valued v : objects) {
+                                sum += v.value();
+                            }
+                        }
+                        System.out.println(getName() + " " + sum);
+                    }
+                };
+                workers[t].start();
+            }
+
+            // let the callers get compiled
+            Thread.sleep(1000);
+
+            long start = System.nanoTime();
+            DSUTestUtils.invokeDSU(args[0], true);
+            DSUTestUtils.report("ManyClassesUpdate", "invokeDSU", System.nanoTime() - start);
+
+            stop = true;
+            for (Thread t : workers) {
+                t.join();
+            }
+
+            for (Valued v : objects) {
+                DSUTestUtils.failIf(v.value() != 1, v.getClass().getName() + " is not updated");
+            }
+        }
+    }
+}
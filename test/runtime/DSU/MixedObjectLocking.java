@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Lock mixed objects from several threads, with and without biased
+ *          locking, while and after their class is updated, and check that
+ *          mutual exclusion and identity hash codes survive the update
+ * @library /testlibrary
+ * @build DSUTestUtils MixedObjectLocking
+ * @run main/timeout=300 MixedObjectLocking
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class MixedObjectLocking {
+    static final int INSTANCES = 64;
+    static final int THREADS = 4;
+    static final int ITERATIONS = 100000;
+
+    public interface Counter {
+        Counter create();
+        void increment();
+        long get();
+    }
+
+    static final String OLD_SOURCE =
+        "public class SyncCounter implements MixedObjectLocking.Counter {" +
+        "  long count;" +
+        "  public MixedObjectLocking.Counter create() { return new SyncCounter(); }" +
+        "  public synchronized void increment() { count++; }" +
+        "  public synchronized long get() { return count; }" +
+        "}";
+
+    // the new version grows, so every old instance becomes a mixed object
+    static final String NEW_SOURCE =
+        "public class SyncCounter implements MixedObjectLocking.Counter {" +
+        "  long count;" +
+        "  long increments;" +
+        "  long padding;" +
+        "  public MixedObjectLocking.Counter create() { return new SyncCounter(); }" +
+        "  public synchronized void increment() { count++; increments++; }" +
+        "  public synchronized long get() { return count; }" +
+        "}";
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "SyncCounter", OLD_SOURCE);
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "SyncCounter", NEW_SOURCE);
+        DSUTestUtils.writePatch("SyncCounter");
+
+        String[][] flags = {
+            { "-XX:+UseBiasedLocking", "-XX:BiasedLockingStartupDelay=0" },
+            { "-XX:-UseBiasedLocking" },
+        };
+        for (String[] f : flags) {
+            OutputAnalyzer output = DSUTestUtils.run("MixedObjectLocking$App", f);
+            output.shouldContain("DSU Request is finished");
+            output.shouldHaveExitValue(0);
+        }
+    }
+
+    public static class App {
+        static Counter[] counters = new Counter[INSTANCES];
+        static int[] hashes = new int[INSTANCES];
+        // only locked by the main thread and not hashed before the update,
+        // so they are still biased toward it when the DSU runs
+        static Counter[] biased = new Counter[INSTANCES];
+
+        static void work(int seed) {
+            int i = seed;
+            for (int n = 0; n < ITERATIONS; n++) {
+                i = (i * 31 + 17) & (INSTANCES - 1);
+                Counter c = counters[i];
+                c.increment();
+                synchronized (c) {
+                    c.increment();
+                }
+            }
+        }
+
+        public static void main(String[] args) throws Exception {
+            Counter proto = (Counter) Class.forName("SyncCounter").newInstance();
+            for (int i = 0; i < INSTANCES; i++) {
+                counters[i] = proto.create();
+                // a hashed object can no longer be biased, so hash only half
+                if ((i & 1) != 0) {
+                    hashes[i] = System.identityHashCode(counters[i]);
+                }
+                biased[i] = proto.create();
+                biased[i].increment();
+                biased[i].increment();
+            }
+
+            Thread[] threads = new Thread[THREADS];
+            for (int t = 0; t < THREADS; t++) {
+                final int seed = t;
+                threads[t] = new Thread() {
+                    public void run() {
+                        work(seed);
+                    }
+                };
+                threads[t].start();
+            }
+
+            // update while the counters are being locked, and while this
+            // thread holds the lock of one of them
+            synchronized (counters[1]) {
+                DSUTestUtils.invokeDSU(args[0], true);
+                counters[1].increment();
+            }
+
+            // the phantom objects of the biased counters are still biased
+            // toward this thread: lock them again, then revoke the bias from
+            // another thread, then hash them
+            for (Counter b : biased) {
+                b.increment();
+                synchronized (b) {
+                    b.increment();
+                }
+            }
+            Thread revoker = new Thread() {
+                public void run() {
+                    for (Counter b : biased) {
+                        b.increment();
+                    }
+                }
+            };
+            revoker.start();
+            revoker.join();
+            for (Counter b : biased) {
+                int hash = System.identityHashCode(b);
+                b.increment();
+                DSUTestUtils.failIf(System.identityHashCode(b) != hash,
+                                    "identity hash code of a biased object changed");
+                DSUTestUtils.failIf(b.get() != 6, "lost increments of a biased object: " + b.get());
+            }
+
+            work(THREADS);
+            for (Thread t : threads) {
+                t.join();
+            }
+
+            long total = 0;
+            for (int i = 0; i < INSTANCES; i++) {
+                total += counters[i].get();
+                DSUTestUtils.failIf((i & 1) != 0 && System.identityHashCode(counters[i]) != hashes[i],
+                                    "identity hash code changed by the update");
+            }
+            DSUTestUtils.failIf(total != 1 + 2L * (THREADS + 1) * ITERATIONS,
+                                "lost increments: " + total);
+        }
+    }
+}
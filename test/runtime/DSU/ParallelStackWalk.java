@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+
+/*
+ * @test
+ * @summary Check and repair the stacks of many application threads with
+ *          GC worker threads at the DSU safepoint
+ * @library /testlibrary
+ * @build DSUTestUtils ParallelStackWalk
+ * @run main/timeout=300 ParallelStackWalk
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class ParallelStackWalk {
+    static final int THREADS = 64;
+
+    public interface Worker {
+        int work(Object lock);
+    }
+
+    static String source(int version) {
+        return "public class StackWorker implements ParallelStackWalk.Worker {" +
+               "  public int work(Object lock) {" +
+               "    park(lock);" +
+               "    return value();" +
+               "  }" +
+               "  void park(Object lock) {" +
+               "    synchronized (lock) {" +
+               "      ParallelStackWalk.App.parked++;" +
+               "      lock.notifyAll();" +
+               "      while (!ParallelStackWalk.App.release) {" +
+               "        try { lock.wait(); } catch (InterruptedException e) { }" +
+               "      }" +
+               "    }" +
+               "  }" +
+               "  int value() { return " + version + "; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "StackWorker", source(0));
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "StackWorker", source(1));
+        DSUTestUtils.writePatch("StackWorker");
+
+        for (String gc : new String[] { "-XX:+UseG1GC", "-XX:+UseSerialGC" }) {
+            OutputAnalyzer output = DSUTestUtils.run("ParallelStackWalk$App", gc,
+                                                     "-XX:ParallelDSUStackWalkThreshold=1");
+            output.shouldContain("DSU phase check application threads time:");
+            output.shouldContain("DSU phase repair application threads time:");
+            output.shouldContain("DSU Request is finished");
+            output.shouldHaveExitValue(0);
+            DSUTestUtils.reportTimes("ParallelStackWalk" + gc, output);
+        }
+    }
+
+    public static class App {
+        static int parked = 0;
+        static volatile boolean release = false;
+
+        public static void main(String[] args) throws Exception {
+            final Object lock = new Object();
+            final Worker worker = (Worker) Class.forName("StackWorker").newInstance();
+            final int[] results = new int[THREADS];
+            Thread[] threads = new Thread[THREADS];
+            for (int i = 0; i < THREADS; i++) {
+                final int index = i;
+                threads[i] = new Thread() {
+                    public void run() {
+                        results[index] = worker.work(lock);
+                    }
+                };
+                threads[i].start();
+            }
+
+            synchronized (lock) {
+                while (parked < THREADS) {
+                    lock.wait();
+                }
+            }
+
+            // park is unchanged, so the parked frames are repaired in place
+            DSUTestUtils.invokeDSU(args[0], true);
+
+            synchronized (lock) {
+                release = true;
+                lock.notifyAll();
+            }
+            for (Thread t : threads) {
+                t.join();
+            }
+            for (int result : results) {
+                DSUTestUtils.failIf(result != 1, "repaired thread runs an old method");
+            }
+        }
+    }
+}
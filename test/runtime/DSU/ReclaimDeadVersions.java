@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Reclaim dead class versions once no object refers to them
+ * @library /testlibrary
+ * @build DSUTestUtils ReclaimDeadVersions
+ * @run main/timeout=300 ReclaimDeadVersions
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class ReclaimDeadVersions {
+    static final int INSTANCES = 1000;
+
+    public interface Item {
+        Item create();
+        int version();
+    }
+
+    static String source(String name, int version, String extraField) {
+        return "public class " + name + " implements ReclaimDeadVersions.Item {" +
+               "  int a;" + extraField +
+               "  public ReclaimDeadVersions.Item create() { return new " + name + "(); }" +
+               "  public int version() { return " + version + "; }" +
+               "}";
+    }
+
+    public static void main(String[] args) throws Exception {
+        // a swapped class and a redefined class
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "SwappedItem", source("SwappedItem", 0, ""));
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "SwappedItem", source("SwappedItem", 1, ""));
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "RedefinedItem", source("RedefinedItem", 0, ""));
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "RedefinedItem", source("RedefinedItem", 1, " long b;"));
+        DSUTestUtils.writePatch("SwappedItem", "RedefinedItem");
+
+        OutputAnalyzer output = DSUTestUtils.run("ReclaimDeadVersions$App",
+                                                 "-XX:+DSUReclaimDeadVersions",
+                                                 "-XX:DSUReclaimInterval=200");
+        output.shouldContain("DSU Request is finished");
+        output.shouldMatch("Reclaimed [1-9][0-9]* dead class versions");
+        output.shouldContain("DSU reclaim time:");
+        output.shouldHaveExitValue(0);
+        DSUTestUtils.reportTimes("ReclaimDeadVersions", output);
+    }
+
+    public static class App {
+        static int run(Item[] items) {
+            int sum = 0;
+            for (Item item : items) {
+                sum += item.version();
+            }
+            return sum;
+        }
+
+        public static void main(String[] args) throws Exception {
+            Item[] swapped = new Item[INSTANCES];
+            Item[] redefined = new Item[INSTANCES];
+            Item swappedProto = (Item) Class.forName("SwappedItem").newInstance();
+            Item redefinedProto = (Item) Class.forName("RedefinedItem").newInstance();
+            for (int i = 0; i < INSTANCES; i++) {
+                swapped[i] = swappedProto.create();
+                redefined[i] = redefinedProto.create();
+            }
+            swappedProto = null;
+            redefinedProto = null;
+            DSUTestUtils.failIf(run(swapped) + run(redefined) != 0, "unexpected old versions");
+
+            DSUTestUtils.invokeDSU(args[0], true);
+            DSUTestUtils.failIf(run(swapped) + run(redefined) != 2 * INSTANCES,
+                                "items are not updated");
+
+            // old versions are unreachable after all instances have been transformed
+            swapped = null;
+            redefined = null;
+            System.gc();
+            Thread.sleep(3000);
+
+            // the live versions must be intact after the reclamation
+            Item swappedItem = (Item) Class.forName("SwappedItem").newInstance();
+            Item redefinedItem = (Item) Class.forName("RedefinedItem").newInstance();
+            DSUTestUtils.failIf(swappedItem.version() != 1 || redefinedItem.version() != 1,
+                                "live versions are broken by the reclamation");
+        }
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Replace objects one by one and in bulk with cached copy plans
+ * @library /testlibrary
+ * @build DSUTestUtils ReplaceObjectsTest
+ * @run main/timeout=300 ReplaceObjectsTest
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class ReplaceObjectsTest {
+    static final int OBJECTS = 200000;
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.writePatch();
+        OutputAnalyzer output = DSUTestUtils.run("ReplaceObjectsTest$App");
+        output.shouldContain("replaced");
+    }
+
+    static class Base {
+        byte b;
+        Object ref;
+        long l;
+    }
+
+    static class Item extends Base {
+        int i;
+        double d;
+        Object other;
+        char c;
+
+        Item(int seed) {
+            b = (byte) seed;
+            ref = Integer.valueOf(seed);
+            l = seed * 3L;
+            i = seed;
+            d = seed / 2.0;
+            other = "item" + seed;
+            c = (char) ('a' + seed % 26);
+        }
+
+        boolean sameAs(Item that) {
+            return b == that.b && ref == that.ref && l == that.l && i == that.i
+                && d == that.d && other == that.other && c == that.c;
+        }
+    }
+
+    public static class App {
+        static Item[] create(int base) {
+            Item[] items = new Item[OBJECTS];
+            for (int i = 0; i < OBJECTS; i++) {
+                items[i] = new Item(base + i);
+            }
+            return items;
+        }
+
+        static void check(Item[] olds, Item[] news) {
+            for (int i = 0; i < OBJECTS; i++) {
+                DSUTestUtils.failIf(!olds[i].sameAs(news[i]), "object " + i + " is not replaced");
+            }
+        }
+
+        public static void main(String[] args) throws Exception {
+            Item[] olds = create(0);
+            Item[] news = create(OBJECTS);
+            long start = System.nanoTime();
+            for (int i = 0; i < OBJECTS; i++) {
+                DSUTestUtils.failIf(DSUTestUtils.replaceObject(olds[i], news[i]) != olds[i],
+                                    "replaceObject must return the old object");
+            }
+            DSUTestUtils.report("ReplaceObjectsTest", "replaceObject", System.nanoTime() - start);
+            check(olds, news);
+
+            olds = create(0);
+            news = create(OBJECTS);
+            start = System.nanoTime();
+            DSUTestUtils.replaceObjects(olds, news);
+            DSUTestUtils.report("ReplaceObjectsTest", "replaceObjects", System.nanoTime() - start);
+            check(olds, news);
+
+            try {
+                DSUTestUtils.replaceObjects(new Object[1], new Object[2]);
+                throw new RuntimeException("arrays of different lengths are accepted");
+            } catch (java.lang.reflect.InvocationTargetException e) {
+                DSUTestUtils.failIf(!(e.getCause() instanceof IllegalArgumentException),
+                                    "unexpected exception " + e.getCause());
+            }
+            System.out.println("All objects are replaced");
+        }
+    }
+}
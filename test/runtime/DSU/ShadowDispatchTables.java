@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+
+/*
+ * @test
+ * @summary Swap the method bodies of a class with a hierarchy of unchanged
+ *          sub-classes, and check that virtual and interface calls on the
+ *          sub-classes reach the new bodies
+ * @library /testlibrary
+ * @build DSUTestUtils ShadowDispatchTables
+ * @run main/timeout=300 ShadowDispatchTables
+ */
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class ShadowDispatchTables {
+    public interface Valued {
+        int value();
+    }
+
+    public interface Tagged {
+        int tag();
+    }
+
+    // only the method bodies change, so the class is swapped
+    static final String NEW_SOURCE =
+        "class ShadowBase implements ShadowDispatchTables.Valued {" +
+        "  public int value() { return 1; }" +
+        "  public int tag() { return 11; }" +
+        "}";
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "ShadowBase", NEW_SOURCE);
+        DSUTestUtils.writePatch("ShadowBase");
+
+        String[][] flags = {
+            { "-XX:+UseDSUShadowDispatchTables" },
+            { "-XX:-UseDSUShadowDispatchTables" },
+        };
+        for (String[] f : flags) {
+            OutputAnalyzer output = DSUTestUtils.run("ShadowDispatchTables$App", f);
+            output.shouldContain("DSU Request is finished");
+            output.shouldHaveExitValue(0);
+        }
+    }
+
+    public static class Sub1 extends ShadowBase {
+    }
+
+    public static class Sub2 extends Sub1 {
+        public int tag() { return 20; }
+    }
+
+    public static class Sub3 extends Sub2 implements Tagged {
+    }
+
+    public static class Sub4 extends Sub1 implements Tagged {
+    }
+
+    public static class App {
+        static int sum(ShadowBase[] objects) {
+            int sum = 0;
+            for (ShadowBase o : objects) {
+                sum += o.value() * 1000 + o.tag();
+                sum += ((Valued) o).value() * 100;
+                if (o instanceof Tagged) {
+                    sum += ((Tagged) o).tag();
+                }
+            }
+            return sum;
+        }
+
+        public static void main(String[] args) throws Exception {
+            ShadowBase[] objects = {
+                new ShadowBase(), new Sub1(), new Sub2(), new Sub3(), new Sub4()
+            };
+            // value: 0, tag: 10 + 10 + 20 + 20 + 10, tagged: 20 + 10
+            DSUTestUtils.failIf(sum(objects) != 70 + 30, "unexpected result before the update");
+
+            DSUTestUtils.invokeDSU(args[0], true);
+
+            // value: 5 * 1100, tag: 11 + 11 + 20 + 20 + 11, tagged: 20 + 11
+            DSUTestUtils.failIf(sum(objects) != 5 * 1100 + 73 + 31, "sub-classes still call the old bodies");
+        }
+    }
+}
+
+class ShadowBase implements ShadowDispatchTables.Valued {
+    public int value() { return 0; }
+    public int tag() { return 10; }
+}
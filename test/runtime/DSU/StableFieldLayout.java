@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Update a class that deletes, adds and keeps fields, and check
+ *          that the kept fields stay at their old offsets and keep their
+ *          values in the updated objects
+ * @library /testlibrary
+ * @build DSUTestUtils StableFieldLayout
+ * @run main/timeout=300 StableFieldLayout
+ */
+
+import java.lang.reflect.Field;
+import com.oracle.java.testlibrary.OutputAnalyzer;
+import sun.misc.Unsafe;
+
+public class StableFieldLayout {
+    static final int INSTANCES = 1000;
+
+    public interface Holder {
+        Holder create(int i);
+        long count();
+        Object ref();
+    }
+
+    static final String OLD_SOURCE =
+        "public class Fields implements StableFieldLayout.Holder {" +
+        "  int id;" +
+        "  Object deleted;" +
+        "  long count;" +
+        "  Object ref;" +
+        "  public StableFieldLayout.Holder create(int i) {" +
+        "    Fields f = new Fields(); f.id = i; f.count = i * 3L; f.ref = \"ref\" + i;" +
+        "    return f;" +
+        "  }" +
+        "  public long count() { return count; }" +
+        "  public Object ref() { return ref; }" +
+        "}";
+
+    // deletes a field and adds two, which fit in and after the hole
+    static final String NEW_SOURCE =
+        "public class Fields implements StableFieldLayout.Holder {" +
+        "  byte added;" +
+        "  Object ref;" +
+        "  long count;" +
+        "  Object other;" +
+        "  int id;" +
+        "  public StableFieldLayout.Holder create(int i) {" +
+        "    Fields f = new Fields(); f.id = i; f.count = i * 3L; f.ref = \"ref\" + i;" +
+        "    return f;" +
+        "  }" +
+        "  public long count() { other = this; added++; return count; }" +
+        "  public Object ref() { return ref; }" +
+        "}";
+
+    public static void main(String[] args) throws Exception {
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "Fields", OLD_SOURCE);
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "Fields", NEW_SOURCE);
+        DSUTestUtils.writePatch("Fields");
+
+        String[][] flags = {
+            { "-XX:+DSUStableFieldLayout", "-Dexpect.stable=true" },
+            { "-XX:-DSUStableFieldLayout", "-Dexpect.stable=false" },
+        };
+        for (String[] f : flags) {
+            OutputAnalyzer output = DSUTestUtils.run("StableFieldLayout$App", f);
+            output.shouldContain("DSU Request is finished");
+            output.shouldHaveExitValue(0);
+        }
+    }
+
+    public static class App {
+        static long[] offsets(Unsafe unsafe, Class<?> c) throws Exception {
+            String[] names = { "id", "count", "ref" };
+            long[] offsets = new long[names.length];
+            for (int i = 0; i < names.length; i++) {
+                Field f = c.getDeclaredField(names[i]);
+                offsets[i] = unsafe.objectFieldOffset(f);
+            }
+            return offsets;
+        }
+
+        public static void main(String[] args) throws Exception {
+            Field theUnsafe = Unsafe.class.getDeclaredField("theUnsafe");
+            theUnsafe.setAccessible(true);
+            Unsafe unsafe = (Unsafe) theUnsafe.get(null);
+
+            Holder proto = (Holder) Class.forName("Fields").newInstance();
+            Holder[] holders = new Holder[INSTANCES];
+            for (int i = 0; i < INSTANCES; i++) {
+                holders[i] = proto.create(i);
+            }
+            long[] before = offsets(unsafe, holders[0].getClass());
+
+            DSUTestUtils.invokeDSU(args[0], true);
+
+            long[] after = offsets(unsafe, holders[0].getClass());
+            if (Boolean.getBoolean("expect.stable")) {
+                for (int i = 0; i < before.length; i++) {
+                    DSUTestUtils.failIf(before[i] != after[i],
+                                        "field " + i + " moved from " + before[i] + " to " + after[i]);
+                }
+            }
+            for (int i = 0; i < INSTANCES; i++) {
+                DSUTestUtils.failIf(holders[i].count() != i * 3L, "count lost by the update");
+                DSUTestUtils.failIf(!("ref" + i).equals(holders[i].ref()), "ref lost by the update");
+            }
+        }
+    }
+}
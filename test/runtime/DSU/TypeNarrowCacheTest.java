@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+
+/*
+ * @test
+ * @summary Type narrowing checks that passed before are cached per bytecode,
+ *          still validate objects of type narrowed classes and miss once
+ *          a later update breaks the cached subtype relation
+ * @library /testlibrary
+ * @build DSUTestUtils TypeNarrowCacheTest
+ * @run main/timeout=300 TypeNarrowCacheTest
+ */
+
+import java.io.File;
+
+import com.oracle.java.testlibrary.OutputAnalyzer;
+
+public class TypeNarrowCacheTest {
+    static final int INSTANCES = 1000;
+    static final int ROUNDS = 20;
+    static final String OTHER_PATCH = "dsu.other.patch";
+
+    public static class Base {
+        public int v;
+        public int value() { return v; }
+    }
+
+    // accesses objects as instances of Middle, which is not known here
+    public interface MiddleUser {
+        void prepare(Base[] items);
+        int sum();
+    }
+
+    public static void main(String[] args) throws Exception {
+        // Narrowed loses Middle from its super types after the update
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "Middle",
+            "public class Middle extends TypeNarrowCacheTest.Base {" +
+            "  public int m;" +
+            "  public int middle() { return m + 1; }" +
+            "}");
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "Narrowed",
+            "public class Narrowed extends Middle {}");
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "Narrowed",
+            "public class Narrowed extends TypeNarrowCacheTest.Base {}");
+        DSUTestUtils.writePatch("Narrowed");
+
+        // Other loses Middle first, so checks on Middle pass for Narrowed
+        // and are cached before Narrowed is narrowed as well
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "Other",
+            "public class Other extends Middle {}");
+        DSUTestUtils.compileTo(DSUTestUtils.newDir(), "Other",
+            "public class Other extends TypeNarrowCacheTest.Base {}");
+        DSUTestUtils.writePatch(new File(OTHER_PATCH), "Other");
+        DSUTestUtils.compileTo(DSUTestUtils.oldDir(), "MiddleUserImpl",
+            "public class MiddleUserImpl implements TypeNarrowCacheTest.MiddleUser {" +
+            "  Middle[] ms;" +
+            "  public void prepare(TypeNarrowCacheTest.Base[] items) {" +
+            "    ms = new Middle[items.length];" +
+            "    for (int i = 0; i < items.length; i++) {" +
+            "      ms[i] = (Middle) items[i]; ms[i].m = i;" +
+            "    }" +
+            "  }" +
+            "  public int sum() {" +
+            "    int sum = 0;" +
+            "    for (int i = 0; i < ms.length; i++) {" +
+            "      sum += ms[i].m + ms[i].middle();" +
+            "    }" +
+            "    return sum;" +
+            "  }" +
+            "}");
+
+        String[][] configs = {
+            { "-Xint" },
+            { "-Xint", "-XX:-UseDSUTypeNarrowCache" },
+            { "-XX:-TieredCompilation", "-XX:CompileThreshold=100" },
+            { "-XX:-TieredCompilation", "-XX:CompileThreshold=100",
+              "-XX:-UseDSUTypeNarrowCache" },
+        };
+        for (String[] vmArgs : configs) {
+            OutputAnalyzer output = DSUTestUtils.run("TypeNarrowCacheTest$App", vmArgs);
+            output.shouldContain("DSU Request is finished");
+            output.shouldHaveExitValue(0);
+
+            output = DSUTestUtils.run("TypeNarrowCacheTest$BrokenSubtypeApp", vmArgs);
+            output.shouldContain("DSU Request is finished");
+            output.shouldHaveExitValue(0);
+        }
+    }
+
+    public static class App {
+        static int sum(Base[] items) {
+            int sum = 0;
+            for (int i = 0; i < items.length; i++) {
+                sum += items[i].v + items[i].value();
+            }
+            return sum;
+        }
+
+        public static void main(String[] args) throws Exception {
+            Base[] items = new Base[INSTANCES];
+            Class<?> narrowed = Class.forName("Narrowed");
+            int expected = 0;
+            for (int i = 0; i < INSTANCES; i++) {
+                items[i] = (Base) narrowed.newInstance();
+                items[i].v = i;
+                expected += 2 * i;
+            }
+
+            DSUTestUtils.invokeDSU(args[0], true);
+
+            // Base is still a super type of Narrowed, accessing it never fails
+            for (int r = 0; r < ROUNDS; r++) {
+                DSUTestUtils.failIf(sum(items) != expected, "field is lost by the update");
+            }
+        }
+    }
+
+    public static class BrokenSubtypeApp {
+        public static void main(String[] args) throws Exception {
+            Base[] items = new Base[INSTANCES];
+            Class<?> narrowed = Class.forName("Narrowed");
+            for (int i = 0; i < INSTANCES; i++) {
+                items[i] = (Base) narrowed.newInstance();
+            }
+            MiddleUser user = (MiddleUser) Class.forName("MiddleUserImpl").newInstance();
+            user.prepare(items);
+            int expected = INSTANCES * (INSTANCES - 1) + INSTANCES;
+
+            // Middle becomes a type narrowing relevant type
+            File dir = new File(args[0]).getParentFile();
+            DSUTestUtils.invokeDSU(new File(dir, OTHER_PATCH).getPath(), true);
+
+            // Narrowed is still a Middle. The first round validates the
+            // objects and later rounds hit the cache.
+            for (int r = 0; r < ROUNDS; r++) {
+                DSUTestUtils.failIf(user.sum() != expected, "field is lost by the update");
+            }
+
+            DSUTestUtils.invokeDSU(args[0], true);
+
+            // The cached klass of Narrowed is no longer a Middle. A check that
+            // hit the cache would let the access through.
+            try {
+                user.sum();
+                throw new RuntimeException("a Narrowed object is accessed as a Middle");
+            } catch (ClassCastException e) {
+                // expected
+            }
+        }
+    }
+}
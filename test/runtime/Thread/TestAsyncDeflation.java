@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test
+ * @summary Contends for, waits on and hashes objects while the service
+ *      thread keeps deflating their monitors, and checks that mutual
+ *      exclusion and identity hash codes are preserved.
+ *
+ * @run main/othervm -XX:+AsyncDeflateIdleMonitors -XX:AsyncDeflationInterval=1
+ *      -XX:MonitorUsedDeflationThreshold=0 TestAsyncDeflation
+ * @run main/othervm -XX:+AsyncDeflateIdleMonitors -XX:AsyncDeflationInterval=1
+ *      -XX:MonitorUsedDeflationThreshold=0 -XX:-UseBiasedLocking TestAsyncDeflation
+ */
+
+public class TestAsyncDeflation {
+    static final int LOCKS = 256;
+    static final int THREADS = 8;
+    static final int ITERATIONS = 200000;
+
+    static final Object[] locks = new Object[LOCKS];
+    static final int[] hashes = new int[LOCKS];
+    static final long[] counters = new long[LOCKS];
+
+    public static void main(String[] args) throws Exception {
+        for (int i = 0; i < LOCKS; i++) {
+            locks[i] = new Object();
+        }
+        Thread[] threads = new Thread[THREADS];
+        for (int t = 0; t < THREADS; t++) {
+            final int seed = t;
+            threads[t] = new Thread() {
+                public void run() {
+                    int i = seed;
+                    for (int n = 0; n < ITERATIONS; n++) {
+                        i = (i * 31 + 17) & (LOCKS - 1);
+                        Object lock = locks[i];
+                        synchronized (lock) {
+                            counters[i]++;
+                            if ((n & 1023) == 0) {
+                                try {
+                                    lock.wait(1);
+                                } catch (InterruptedException e) {
+                                    throw new RuntimeException(e);
+                                }
+                            }
+                        }
+                        int hash = System.identityHashCode(lock);
+                        synchronized (hashes) {
+                            if (hashes[i] == 0) {
+                                hashes[i] = hash;
+                            } else if (hashes[i] != hash) {
+                                throw new RuntimeException("Identity hash code of lock " + i +
+                                                           " changed from " + hashes[i] + " to " + hash);
+                            }
+                        }
+                    }
+                }
+            };
+            threads[t].start();
+        }
+
+        long total = 0;
+        for (Thread t : threads) {
+            t.join();
+        }
+        for (int i = 0; i < LOCKS; i++) {
+            total += counters[i];
+        }
+        if (total != (long) THREADS * ITERATIONS) {
+            throw new RuntimeException("Lost updates: " + total + " != " + (long) THREADS * ITERATIONS);
+        }
+        System.out.println("Test passed");
+    }
+}
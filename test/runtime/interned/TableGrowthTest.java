@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2012  Tianxiao Gu. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * Please contact Institute of Computer Software, Nanjing University,
+ * 163 Xianlin Avenue, Nanjing, Jiangsu Province, 210046, China,
+ * or visit moon.nju.edu.cn if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * @test TableGrowthTest
+ * @summary Intern strings and create symbols from several threads while the
+ *          string and symbol tables grow, with safepoints in between, and
+ *          check that every lookup still finds the interned instance.
+ * @run main/othervm -XX:StringTableSize=1009 -XX:+UnlockExperimentalVMOptions
+ *      -XX:SymbolTableSize=1009 -XX:TableGrowthLoadFactor=1
+ *      -XX:+UnlockDiagnosticVMOptions -XX:+VerifyBeforeGC
+ *      -XX:+VerifyStringTableAtExit TableGrowthTest
+ */
+
+public class TableGrowthTest {
+    static final int THREADS = 4;
+    static final int STRINGS = 50000;
+
+    static final String[][] interned = new String[THREADS][STRINGS];
+
+    public static void main(String... args) throws Exception {
+        Thread[] threads = new Thread[THREADS];
+        for (int t = 0; t < THREADS; t++) {
+            final int id = t;
+            threads[t] = new Thread() {
+                public void run() {
+                    for (int i = 0; i < STRINGS; i++) {
+                        // shared between the threads, so that they race to add
+                        interned[id][i] = new String("TableGrowthTest-" + i).intern();
+                        try {
+                            // creates the symbol for the class name
+                            Class.forName("TableGrowthTest$Missing" + (i * THREADS + id));
+                            throw new RuntimeException("class should not exist");
+                        } catch (ClassNotFoundException e) {
+                            // expected
+                        }
+                    }
+                }
+            };
+            threads[t].start();
+        }
+        for (int i = 0; i < 10; i++) {
+            System.gc();
+            Thread.sleep(10);
+        }
+        for (Thread t : threads) {
+            t.join();
+        }
+
+        for (int i = 0; i < STRINGS; i++) {
+            String s = ("TableGrowthTest-" + i).intern();
+            for (int t = 0; t < THREADS; t++) {
+                if (interned[t][i] != s) {
+                    throw new RuntimeException("Interned twice: " + s);
+                }
+            }
+        }
+        System.out.println("Test passed");
+    }
+}